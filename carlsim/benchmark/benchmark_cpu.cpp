@@ -0,0 +1,524 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+/*
+ * benchmark_cpu: CPU_MODE throughput benchmark
+ *
+ * Usage:
+ *   carlsim-benchmark [options]
+ *
+ * Every option that describes the network takes a comma-separated list of values. The benchmark runs every
+ * combination (the Cartesian product) and reports one row per combination and repetition:
+ *   --neurons n,...        number of excitatory and inhibitory neurons (80:20), default 10000
+ *   --fanin k,...          number of synapses per neuron, default 100
+ *   --delay d,...          maximum delay (ms) of excitatory synapses, default 20
+ *   --regime r,...         firing regime: quiet, ai (asynchronous irregular), burst; default ai
+ *   --model m,...          cuba or coba, default cuba
+ *   --stp 0|1,...          short-term plasticity on excitatory synapses (forces --delay 1), default 0
+ *   --stdp 0|1,...         E-STDP on excitatory-to-excitatory synapses, default 0
+ *   --substeps s,...       integration steps per ms, default 2
+ *   --partitions p,...     number of CPU partitions (each runs one worker thread), default 1
+ *   --monitor m,...        monitors on the excitatory groups during the timed run, default none (see below)
+ * Other options:
+ *   --affinity core|node   placement of the partition threads (see CARLsim::setCPUAffinityPolicy), default core
+ *   --time ms              simulated time of the timed run, default 1000
+ *   --repeat n             number of repetitions of every combination (with seeds seed, seed+1, ...), default 1
+ *   --seed s               random seed of the first repetition, default 42
+ *   --label text           free-form label written to every row (e.g., a commit hash), default empty
+ *   --csv | --json         output format (default: csv); json writes one object per line
+ *   --out file             append the results to a file instead of writing them to stdout
+ *   --monitor-dir dir      directory of the monitor files (removed after every run), default .
+ *
+ * Setup time covers CARLsim::setupNetwork. Run time is the wall-clock time of the timed CARLsim::runNetwork call;
+ * the real-time factor is the simulated time divided by it. Synaptic events are the spikes delivered to
+ * post-synaptic neurons (see EventCounts). The mean firing rate of the excitatory neurons is measured in a separate
+ * one-second run after the timed run, so that the spike monitor does not add to the run time.
+ *
+ * Monitor scenarios, to be compared against the monitor-free baseline none:
+ *   spike-aer, spike-file       SpikeMonitor recording spike times, or writing them to a file
+ *   neuron-aer, neuron-file     NeuronMonitor recording neuron states, or writing them to a file
+ *   group-aer, group-file       GroupMonitor recording the group state, or writing it to a file
+ *   conn-file                   ConnectionMonitor writing a weight snapshot of exc-to-exc every second
+ * The spike monitors of the firing rate probe are idle during the timed run, which costs nothing; a SpikeMonitor in
+ * COUNT mode takes the same path in the kernel.
+ *
+ * Example, comparing two commits:
+ *   carlsim-benchmark --neurons 1000,10000,100000 --regime quiet,ai,burst --label $(git rev-parse --short HEAD) \
+ *       --out results/benchmark.csv
+ */
+
+#include <carlsim.h>
+#include <stopwatch.h>
+
+#include <stdio.h>			// printf, fprintf, remove
+#include <stdlib.h>			// atoi
+#include <algorithm>		// std::min
+#include <string>
+#include <vector>
+
+#define BENCHMARK_MAX_DELAY 20 // maximum synaptic delay supported by the kernel (MAX_SYN_DELAY)
+
+enum BenchmarkRegime { REGIME_QUIET, REGIME_AI, REGIME_BURST };
+static const char* benchmarkRegime_string[] = { "quiet", "ai", "burst" };
+
+enum BenchmarkMonitor { MONITOR_NONE, MONITOR_SPIKE_AER, MONITOR_SPIKE_FILE, MONITOR_NEURON_AER, MONITOR_NEURON_FILE,
+	MONITOR_GROUP_AER, MONITOR_GROUP_FILE, MONITOR_CONN_FILE };
+static const char* benchmarkMonitor_string[] = { "none", "spike-aer", "spike-file", "neuron-aer", "neuron-file",
+	"group-aer", "group-file", "conn-file" };
+
+enum OutputFormat { OUTPUT_CSV, OUTPUT_JSON };
+
+//! one combination of network parameters
+struct BenchmarkConfig {
+	int numN;
+	int fanIn;
+	int maxDelay;
+	BenchmarkRegime regime;
+	bool withCOBA;
+	bool withSTP;
+	bool withSTDP;
+	int numSubsteps;
+	int numPartitions;
+	BenchmarkMonitor monitor;
+};
+
+//! the measurements of one run
+struct BenchmarkResult {
+	int numSynapses;
+	double setupMs;
+	double runMs;
+	double realTimeFactor;
+	double synEventsPerSec;
+	double meanRateHz;
+};
+
+//! the lists of values to sweep, and the options that are not swept
+struct BenchmarkOptions {
+	std::vector<int> numN;
+	std::vector<int> fanIn;
+	std::vector<int> maxDelay;
+	std::vector<int> regime;
+	std::vector<int> withCOBA;
+	std::vector<int> withSTP;
+	std::vector<int> withSTDP;
+	std::vector<int> numSubsteps;
+	std::vector<int> numPartitions;
+	std::vector<int> monitor;
+	CPUAffinityPolicy affinity;
+	int runTimeMs;
+	int numRepeats;
+	int randSeed;
+	std::string label;
+	OutputFormat format;
+	std::string outFile;
+	std::string monitorDir;
+
+	BenchmarkOptions() : affinity(CORE_PER_PARTITION), runTimeMs(1000), numRepeats(1), randSeed(42),
+		format(OUTPUT_CSV), monitorDir(".") {}
+};
+
+static void printUsage() {
+	fprintf(stderr,
+		"Usage: carlsim-benchmark [options]\n"
+		"  swept options (comma-separated lists): --neurons n, --fanin k, --delay ms, --regime quiet|ai|burst,\n"
+		"    --model cuba|coba, --stp 0|1, --stdp 0|1, --substeps s, --partitions p,\n"
+		"    --monitor none|spike-aer|spike-file|neuron-aer|neuron-file|group-aer|group-file|conn-file\n"
+		"  other options: --affinity core|node, --time ms, --repeat n, --seed s, --label text, --csv, --json,\n"
+		"    --out file, --monitor-dir dir\n");
+}
+
+// splits a comma-separated list, returns false if a value is not one of names (if given) or not a positive int
+static bool parseList(const std::string& arg, std::vector<int>& values, const char** names=NULL, int numNames=0) {
+	values.clear();
+	size_t start = 0;
+	while (start <= arg.size()) {
+		size_t end = arg.find(',', start);
+		if (end == std::string::npos)
+			end = arg.size();
+		std::string item = arg.substr(start, end - start);
+		int value = -1;
+		if (names != NULL) {
+			for (int i = 0; i < numNames; i++)
+				if (item == names[i])
+					value = i;
+		} else {
+			value = atoi(item.c_str());
+		}
+		if (value < 0 || (names == NULL && value == 0 && item != "0"))
+			return false;
+		values.push_back(value);
+		start = end + 1;
+	}
+	return !values.empty();
+}
+
+/*!
+ * \brief builds, sets up and runs one network, and measures it
+ *
+ * The network is a balanced network of excitatory (regular spiking) and inhibitory (fast spiking) neurons driven by
+ * one Poisson input per excitatory neuron. It is split evenly into numPartitions CPU partitions. Excitatory neurons
+ * project to all partitions, so that spikes are routed between them; inhibitory neurons project within their own
+ * partition. 80% of the fan-in of every neuron is excitatory. The firing regime sets the input rate and the
+ * strength of recurrent excitation and inhibition; excitatory neurons are chattering neurons in the burst regime.
+ * The monitor of the scenario is placed on the excitatory group (or its recurrent connection) of every partition.
+ */
+static BenchmarkResult runBenchmark(const BenchmarkConfig& cfg, const BenchmarkOptions& opt, int randSeed) {
+	// input rate (Hz), input weight, recurrent excitatory and inhibitory weights (summed over the fan-in)
+	float inputRate, wtIn, wtExcTotal, wtInhTotal;
+	switch (cfg.regime) {
+	case REGIME_QUIET:
+		inputRate = 2.0f;  wtIn = 20.0f; wtExcTotal = 100.0f; wtInhTotal = 300.0f;
+		break;
+	case REGIME_BURST:
+		inputRate = 2.0f;  wtIn = 30.0f; wtExcTotal = 200.0f; wtInhTotal = 400.0f;
+		break;
+	default: // REGIME_AI
+		inputRate = 10.0f; wtIn = 30.0f; wtExcTotal = 400.0f; wtInhTotal = 500.0f;
+		break;
+	}
+	if (cfg.withCOBA) {
+		// conductances instead of currents, recurrent excitation is scaled down more to keep the regimes apart
+		wtIn *= 0.02f; wtExcTotal *= 0.01f; wtInhTotal *= 0.02f;
+	}
+
+	int numPartitions = cfg.numPartitions;
+	int numExc = cfg.numN * 8 / 10 / numPartitions;
+	int numInh = cfg.numN * 2 / 10 / numPartitions;
+	int fanInExc = cfg.fanIn * 8 / 10;
+	int fanInInh = cfg.fanIn - fanInExc;
+	float wtExc = wtExcTotal / cfg.fanIn;
+	float wtInh = wtInhTotal / cfg.fanIn;
+	float pExc = std::min(1.0f, (float)fanInExc / (numExc * numPartitions));
+	float pInh = std::min(1.0f, (float)fanInInh / numInh);
+
+	CARLsim* sim = new CARLsim("benchmark_cpu", CPU_MODE, SILENT, 0, randSeed);
+	sim->setCPUAffinityPolicy(opt.affinity);
+
+	std::vector<int> gExc(numPartitions), gInh(numPartitions), gIn(numPartitions);
+	for (int p = 0; p < numPartitions; p++) {
+		char suffix[12]; // fits any int
+		snprintf(suffix, sizeof(suffix), "%d", p);
+		gExc[p] = sim->createGroup(std::string("exc") + suffix, numExc, EXCITATORY_NEURON, p, CPU_CORES);
+		if (cfg.regime == REGIME_BURST)
+			sim->setNeuronParameters(gExc[p], 0.02f, 0.2f, -50.0f, 2.0f); // CH
+		else
+			sim->setNeuronParameters(gExc[p], 0.02f, 0.2f, -65.0f, 8.0f); // RS
+		gInh[p] = sim->createGroup(std::string("inh") + suffix, numInh, INHIBITORY_NEURON, p, CPU_CORES);
+		sim->setNeuronParameters(gInh[p], 0.1f, 0.2f, -65.0f, 2.0f); // FS
+		gIn[p] = sim->createSpikeGeneratorGroup(std::string("input") + suffix, numExc, EXCITATORY_NEURON, p, CPU_CORES);
+	}
+
+	bool excPlastic = cfg.withSTDP ? SYN_PLASTIC : SYN_FIXED;
+	for (int p = 0; p < numPartitions; p++) {
+		sim->connect(gIn[p], gExc[p], "one-to-one", RangeWeight(wtIn), 1.0f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+		for (int q = 0; q < numPartitions; q++) {
+			RangeWeight wtRange = cfg.withSTDP ? RangeWeight(0.0f, wtExc, 2 * wtExc) : RangeWeight(wtExc);
+			sim->connect(gExc[p], gExc[q], "random", wtRange, pExc,
+				RangeDelay(1, cfg.maxDelay), RadiusRF(-1), excPlastic);
+			sim->connect(gExc[p], gInh[q], "random", RangeWeight(wtExc), pExc, RangeDelay(1, cfg.maxDelay),
+				RadiusRF(-1), SYN_FIXED);
+		}
+		sim->connect(gInh[p], gExc[p], "random", RangeWeight(wtInh), pInh, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gInh[p], gInh[p], "random", RangeWeight(wtInh), pInh, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+
+		if (cfg.withSTP)
+			sim->setSTP(gExc[p], true);
+		if (cfg.withSTDP)
+			sim->setESTDP(gExc[p], true, STANDARD, ExpCurve(2e-4f, 20.0f, -6.6e-5f, 60.0f));
+	}
+
+	sim->setConductances(cfg.withCOBA);
+	sim->setIntegrationMethod(FORWARD_EULER, cfg.numSubsteps);
+
+	// monitor files of this run, "NULL" if the scenario does not write to a file
+	std::vector<std::string> monFiles(numPartitions, "NULL");
+	bool writesFile = cfg.monitor == MONITOR_SPIKE_FILE || cfg.monitor == MONITOR_NEURON_FILE
+		|| cfg.monitor == MONITOR_GROUP_FILE || cfg.monitor == MONITOR_CONN_FILE;
+	for (int p = 0; writesFile && p < numPartitions; p++) {
+		char fileName[64];
+		snprintf(fileName, sizeof(fileName), "/benchmark_%s_%d.dat", benchmarkMonitor_string[cfg.monitor], p);
+		monFiles[p] = opt.monitorDir + fileName;
+	}
+
+	// neuron monitors can only be set in CONFIG_STATE
+	std::vector<NeuronMonitor*> nrnMons(numPartitions, (NeuronMonitor*)NULL);
+	if (cfg.monitor == MONITOR_NEURON_AER || cfg.monitor == MONITOR_NEURON_FILE)
+		for (int p = 0; p < numPartitions; p++)
+			nrnMons[p] = sim->setNeuronMonitor(gExc[p], monFiles[p]);
+
+	BenchmarkResult result;
+	Stopwatch watch(false);
+	watch.start();
+	sim->setupNetwork();
+	result.setupMs = watch.stop(false);
+	result.numSynapses = sim->getNumSynapses();
+
+	std::vector<PoissonRate*> rates(numPartitions);
+	std::vector<SpikeMonitor*> spkMons(numPartitions);
+	std::vector<GroupMonitor*> grpMons(numPartitions, (GroupMonitor*)NULL);
+	for (int p = 0; p < numPartitions; p++) {
+		rates[p] = new PoissonRate(numExc);
+		rates[p]->setRates(inputRate);
+		sim->setSpikeRate(gIn[p], rates[p]);
+		spkMons[p] = sim->setSpikeMonitor(gExc[p], cfg.monitor == MONITOR_SPIKE_FILE ? monFiles[p] : "NULL");
+		if (cfg.monitor == MONITOR_GROUP_AER || cfg.monitor == MONITOR_GROUP_FILE)
+			grpMons[p] = sim->setGroupMonitor(gExc[p], monFiles[p]);
+		if (cfg.monitor == MONITOR_CONN_FILE)
+			sim->setConnectionMonitor(gExc[p], gExc[p], monFiles[p]);
+	}
+
+	// timed run
+	for (int p = 0; p < numPartitions; p++) {
+		if (cfg.monitor == MONITOR_SPIKE_AER)
+			spkMons[p]->startRecording();
+		else if (cfg.monitor == MONITOR_NEURON_AER)
+			nrnMons[p]->startRecording();
+		else if (cfg.monitor == MONITOR_GROUP_AER)
+			grpMons[p]->startRecording();
+	}
+	sim->runNetwork(opt.runTimeMs / 1000, opt.runTimeMs % 1000, false);
+	for (int p = 0; p < numPartitions; p++) {
+		if (cfg.monitor == MONITOR_SPIKE_AER)
+			spkMons[p]->stopRecording();
+		else if (cfg.monitor == MONITOR_NEURON_AER)
+			nrnMons[p]->stopRecording();
+		else if (cfg.monitor == MONITOR_GROUP_AER)
+			grpMons[p]->stopRecording();
+	}
+	PerformanceReport report = sim->getPerformanceReport();
+	result.runMs = report.runTimeMs;
+	result.realTimeFactor = report.runTimeMs > 0.0 ? opt.runTimeMs / report.runTimeMs : 0.0;
+	result.synEventsPerSec = report.runTimeMs > 0.0 ? report.events.synEvents * 1000.0 / report.runTimeMs : 0.0;
+
+	// firing rate probe
+	for (int p = 0; p < numPartitions; p++)
+		spkMons[p]->startRecording();
+	sim->runNetwork(1, 0, false);
+	result.meanRateHz = 0.0;
+	for (int p = 0; p < numPartitions; p++) {
+		spkMons[p]->stopRecording();
+		result.meanRateHz += spkMons[p]->getPopMeanFiringRate() / numPartitions;
+	}
+
+	delete sim;
+	for (int p = 0; p < numPartitions; p++) {
+		delete rates[p];
+		if (writesFile)
+			remove(monFiles[p].c_str());
+	}
+
+	return result;
+}
+
+static void printHeader(FILE* fp) {
+	fprintf(fp, "label,neurons,fanin,delay,regime,model,stp,stdp,substeps,partitions,monitor,seed,synapses,setup_ms,run_ms,"
+		"sim_ms,realtime_factor,syn_events_per_sec,mean_rate_hz\n");
+}
+
+static void printResult(FILE* fp, const BenchmarkConfig& cfg, const BenchmarkOptions& opt, int randSeed,
+	const BenchmarkResult& res) {
+	if (opt.format == OUTPUT_JSON) {
+		fprintf(fp, "{\"label\":\"%s\",\"neurons\":%d,\"fanin\":%d,\"delay\":%d,\"regime\":\"%s\",\"model\":\"%s\","
+			"\"stp\":%d,\"stdp\":%d,\"substeps\":%d,\"partitions\":%d,\"monitor\":\"%s\",\"seed\":%d,\"synapses\":%d,\"setup_ms\":%.3f,"
+			"\"run_ms\":%.3f,\"sim_ms\":%d,\"realtime_factor\":%.4f,\"syn_events_per_sec\":%.1f,\"mean_rate_hz\":%.3f}\n",
+			opt.label.c_str(), cfg.numN, cfg.fanIn, cfg.maxDelay, benchmarkRegime_string[cfg.regime],
+			cfg.withCOBA ? "coba" : "cuba", cfg.withSTP, cfg.withSTDP, cfg.numSubsteps, cfg.numPartitions,
+			benchmarkMonitor_string[cfg.monitor], randSeed, res.numSynapses, res.setupMs, res.runMs, opt.runTimeMs, res.realTimeFactor, res.synEventsPerSec,
+			res.meanRateHz);
+	} else {
+		fprintf(fp, "%s,%d,%d,%d,%s,%s,%d,%d,%d,%d,%s,%d,%d,%.3f,%.3f,%d,%.4f,%.1f,%.3f\n", opt.label.c_str(),
+			cfg.numN, cfg.fanIn, cfg.maxDelay, benchmarkRegime_string[cfg.regime], cfg.withCOBA ? "coba" : "cuba",
+			cfg.withSTP, cfg.withSTDP, cfg.numSubsteps, cfg.numPartitions, benchmarkMonitor_string[cfg.monitor],
+			randSeed, res.numSynapses, res.setupMs, res.runMs,
+			opt.runTimeMs, res.realTimeFactor, res.synEventsPerSec, res.meanRateHz);
+	}
+	fflush(fp);
+}
+
+int main(int argc, char* argv[]) {
+	BenchmarkOptions opt;
+	opt.numN.push_back(10000);
+	opt.fanIn.push_back(100);
+	opt.maxDelay.push_back(20);
+	opt.regime.push_back(REGIME_AI);
+	opt.withCOBA.push_back(0);
+	opt.withSTP.push_back(0);
+	opt.withSTDP.push_back(0);
+	opt.numSubsteps.push_back(2);
+	opt.numPartitions.push_back(1);
+	opt.monitor.push_back(MONITOR_NONE);
+
+	const char* modelNames[] = { "cuba", "coba" };
+	const char* affinityNames[] = { "core", "node" };
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		bool valid = true;
+		std::vector<int> values;
+		if (arg == "--csv") {
+			opt.format = OUTPUT_CSV;
+		} else if (arg == "--json") {
+			opt.format = OUTPUT_JSON;
+		} else if (arg == "--out" && hasValue) {
+			opt.outFile = argv[++i];
+		} else if (arg == "--label" && hasValue) {
+			opt.label = argv[++i];
+		} else if (arg == "--neurons" && hasValue) {
+			valid = parseList(argv[++i], opt.numN);
+		} else if (arg == "--fanin" && hasValue) {
+			valid = parseList(argv[++i], opt.fanIn);
+		} else if (arg == "--delay" && hasValue) {
+			valid = parseList(argv[++i], opt.maxDelay);
+		} else if (arg == "--regime" && hasValue) {
+			valid = parseList(argv[++i], opt.regime, benchmarkRegime_string, 3);
+		} else if (arg == "--model" && hasValue) {
+			valid = parseList(argv[++i], opt.withCOBA, modelNames, 2);
+		} else if (arg == "--stp" && hasValue) {
+			valid = parseList(argv[++i], opt.withSTP);
+		} else if (arg == "--stdp" && hasValue) {
+			valid = parseList(argv[++i], opt.withSTDP);
+		} else if (arg == "--substeps" && hasValue) {
+			valid = parseList(argv[++i], opt.numSubsteps);
+		} else if (arg == "--partitions" && hasValue) {
+			valid = parseList(argv[++i], opt.numPartitions);
+		} else if (arg == "--monitor" && hasValue) {
+			valid = parseList(argv[++i], opt.monitor, benchmarkMonitor_string, 8);
+		} else if (arg == "--monitor-dir" && hasValue) {
+			opt.monitorDir = argv[++i];
+		} else if (arg == "--affinity" && hasValue) {
+			valid = parseList(argv[++i], values, affinityNames, 2) && values.size() == 1;
+			opt.affinity = valid && values[0] == 1 ? NODE_PER_PARTITION : CORE_PER_PARTITION;
+		} else if (arg == "--time" && hasValue) {
+			opt.runTimeMs = atoi(argv[++i]);
+			valid = opt.runTimeMs > 0;
+		} else if (arg == "--repeat" && hasValue) {
+			opt.numRepeats = atoi(argv[++i]);
+			valid = opt.numRepeats > 0;
+		} else if (arg == "--seed" && hasValue) {
+			opt.randSeed = atoi(argv[++i]);
+		} else {
+			fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+			printUsage();
+			return 1;
+		}
+
+		if (!valid) {
+			fprintf(stderr, "Invalid value of option %s\n", arg.c_str());
+			printUsage();
+			return 1;
+		}
+	}
+
+	// every partition needs at least one inhibitory neuron, every neuron at least one inhibitory synapse
+	for (int i = 0; i < opt.numN.size(); i++)
+		for (int k = 0; k < opt.numPartitions.size(); k++)
+			if (opt.numN[i] < 10 * opt.numPartitions[k]) {
+				fprintf(stderr, "--neurons must be at least 10 times --partitions\n");
+				return 1;
+			}
+	for (int i = 0; i < opt.fanIn.size(); i++)
+		if (opt.fanIn[i] < 5) {
+			fprintf(stderr, "--fanin must be at least 5\n");
+			return 1;
+		}
+	for (int i = 0; i < opt.maxDelay.size(); i++)
+		if (opt.maxDelay[i] < 1 || opt.maxDelay[i] > BENCHMARK_MAX_DELAY) {
+			fprintf(stderr, "--delay must be in [1,%d]\n", BENCHMARK_MAX_DELAY);
+			return 1;
+		}
+	for (int i = 0; i < opt.numSubsteps.size(); i++)
+		if (opt.numSubsteps[i] < 1 || opt.numSubsteps[i] > 100) {
+			fprintf(stderr, "--substeps must be in [1,100]\n");
+			return 1;
+		}
+
+	// the header is only written to new (or empty) files, so that results of several runs can be appended
+	FILE* fp = stdout;
+	bool needHeader = opt.format == OUTPUT_CSV;
+	if (!opt.outFile.empty()) {
+		fp = fopen(opt.outFile.c_str(), "a");
+		if (fp == NULL) {
+			fprintf(stderr, "Could not open output file %s\n", opt.outFile.c_str());
+			return 1;
+		}
+		needHeader = needHeader && ftell(fp) == 0;
+	}
+	if (needHeader)
+		printHeader(fp);
+
+	BenchmarkConfig cfg;
+	for (int a = 0; a < opt.numN.size(); a++)
+	for (int b = 0; b < opt.fanIn.size(); b++)
+	for (int c = 0; c < opt.maxDelay.size(); c++)
+	for (int d = 0; d < opt.regime.size(); d++)
+	for (int e = 0; e < opt.withCOBA.size(); e++)
+	for (int f = 0; f < opt.withSTP.size(); f++)
+	for (int g = 0; g < opt.withSTDP.size(); g++)
+	for (int h = 0; h < opt.numSubsteps.size(); h++)
+	for (int k = 0; k < opt.numPartitions.size(); k++)
+	for (int m = 0; m < opt.monitor.size(); m++) {
+		cfg.numN = opt.numN[a];
+		cfg.fanIn = opt.fanIn[b];
+		cfg.regime = (BenchmarkRegime)opt.regime[d];
+		cfg.withCOBA = opt.withCOBA[e] != 0;
+		cfg.withSTP = opt.withSTP[f] != 0;
+		cfg.maxDelay = cfg.withSTP ? 1 : opt.maxDelay[c]; // the kernel supports STP only with 1 ms delays
+		cfg.withSTDP = opt.withSTDP[g] != 0;
+		cfg.numSubsteps = opt.numSubsteps[h];
+		cfg.numPartitions = opt.numPartitions[k];
+		cfg.monitor = (BenchmarkMonitor)opt.monitor[m];
+		for (int r = 0; r < opt.numRepeats; r++) {
+			int randSeed = opt.randSeed + r;
+			BenchmarkResult res = runBenchmark(cfg, opt, randSeed);
+			printResult(fp, cfg, opt, randSeed, res);
+		}
+	}
+
+	if (fp != stdout)
+		fclose(fp);
+	return 0;
+}
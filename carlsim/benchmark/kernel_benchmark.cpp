@@ -0,0 +1,532 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+/*
+ * kernel_benchmark: microbenchmarks of the CPU kernels
+ *
+ * Usage:
+ *   carlsim-kernel-benchmark [options]
+ *
+ * Every kernel is timed on the runtime data of one CPU partition, without the runNetwork machinery around it. The
+ * runtime data comes from a synthetic network (one recurrently connected group of excitatory neurons) that is set
+ * up with SNN::setupNetwork. The benchmark then writes the spikes and the state a kernel reads directly into the
+ * runtime data and calls the kernel repeatedly. Kernels and the unit their time is reported in:
+ *   state        globalStateUpdate_CPU per neuron model (izh4, izh9, lif) and integrator (euler, rk4), ns/neuron;
+ *                one call integrates one ms, i.e. all substeps
+ *   firing       findFiring_CPU with --fire of the neurons spiking, ns/neuron
+ *   deliver_d1   doCurrentUpdateD1_CPU (all delays 1 ms) for cuba/coba, with and without STP, ns/synaptic event
+ *   deliver_d2   doCurrentUpdateD2_CPU (delays up to --delay ms) for cuba/coba, ns/synaptic event
+ *   psp          generatePostSynapticSpike alone for cuba/coba, with and without STP, ns/synaptic event
+ *   ltp          updateLTP of every neuron (E-STDP), ns/synapse
+ *   weights      updateWeights_CPU (E-STDP), ns/synapse
+ *
+ * Options:
+ *   --kernels k,...   comma-separated list of the kernels to time (see above), default all
+ *   --neurons n       number of neurons, default 2000
+ *   --fanin k         number of synapses per neuron, default 100
+ *   --delay d         maximum delay (ms) of the deliver_d2 network, default 20
+ *   --fire f          fraction of the neurons that spike in one ms, default 0.02
+ *   --substeps s      integration steps per ms, default 2
+ *   --samples n       number of samples of every kernel, default 20
+ *   --iters n         kernel calls per sample, default 10
+ *   --seed s          random seed, default 42
+ *   --label text      free-form label written to every row (e.g., a commit hash), default empty
+ *   --csv             write CSV instead of a table
+ *   --out file        append the results to a file instead of writing them to stdout
+ *
+ * A sample is the time per unit averaged over --iters calls. The report lists the mean, standard deviation, minimum
+ * and median of the samples. Only the kernel calls are timed; the input of the next call is written in between.
+ */
+
+#include <snn.h>
+
+#include <stdio.h>			// printf, fprintf
+#include <stdlib.h>			// atoi, atof, rand
+#include <math.h>			// sqrt
+#include <algorithm>		// std::min, std::sort, std::random_shuffle
+#include <string>
+#include <vector>
+
+#define KERNEL_BENCHMARK_SIM_TIME 100 // simulation time (ms) the kernels are called at, leaves room for past spikes
+
+enum KernelId { KERNEL_STATE, KERNEL_FIRING, KERNEL_DELIVER_D1, KERNEL_DELIVER_D2, KERNEL_PSP, KERNEL_LTP,
+	KERNEL_WEIGHTS, NUM_KERNELS };
+static const char* kernelId_string[] = { "state", "firing", "deliver_d1", "deliver_d2", "psp", "ltp", "weights" };
+static const char* kernelUnit_string[] = { "neuron", "neuron", "syn_event", "syn_event", "syn_event", "synapse",
+	"synapse" };
+
+enum NeuronModel { MODEL_IZH4, MODEL_IZH9, MODEL_LIF };
+static const char* neuronModel_string[] = { "izh4", "izh9", "lif" };
+
+//! the network a kernel is timed on
+struct KernelNetwork {
+	NeuronModel model;
+	integrationMethod_t integrator;
+	int maxDelay;
+	bool withCOBA;
+	bool withSTP;
+	bool withSTDP;
+
+	KernelNetwork() : model(MODEL_IZH4), integrator(FORWARD_EULER), maxDelay(1), withCOBA(false), withSTP(false),
+		withSTDP(false) {}
+
+	std::string getVariant() const {
+		std::string variant = std::string(neuronModel_string[model]) + (integrator == RUNGE_KUTTA4 ? "/rk4" : "/euler");
+		variant += withCOBA ? "/coba" : "/cuba";
+		if (withSTP)
+			variant += "/stp";
+		if (withSTDP)
+			variant += "/stdp";
+		return variant;
+	}
+};
+
+struct KernelOptions {
+	std::vector<int> kernels;
+	int numN;
+	int fanIn;
+	int maxDelay;
+	float fireFraction;
+	int numSubsteps;
+	int numSamples;
+	int numIters;
+	int randSeed;
+	std::string label;
+	bool csv;
+	std::string outFile;
+
+	KernelOptions() : numN(2000), fanIn(100), maxDelay(20), fireFraction(0.02f), numSubsteps(2), numSamples(20),
+		numIters(10), randSeed(42), csv(false) {}
+};
+
+//! statistics of the samples of one kernel, in ns per unit
+struct KernelStats {
+	long long unitsPerCall;
+	double mean;
+	double stddev;
+	double min;
+	double median;
+};
+
+/*!
+ * \brief times the CPU kernels of SNN on the runtime data of one partition
+ *
+ * KernelBenchmark is a friend of SNN, so that it can write the input of a kernel into the runtime data and call the
+ * (private) kernel directly.
+ */
+class KernelBenchmark {
+public:
+	KernelBenchmark(const KernelOptions& opt) : opt_(opt), snn_(NULL), netId_(CPU_RUNTIME_BASE), numPlasticSyn_(0) {}
+	~KernelBenchmark() { delete snn_; }
+
+	//! builds and sets up the network, and writes the spikes and state the kernels read
+	void setupNetwork(const KernelNetwork& net);
+
+	//! times a kernel on the current network
+	KernelStats run(KernelId kernel);
+
+private:
+	//! writes the input of the next call of a kernel
+	void prepare(KernelId kernel);
+
+	//! calls a kernel once, returns the number of units it processed
+	long long call(KernelId kernel);
+
+	const KernelOptions& opt_;
+	SNN* snn_;
+	int netId_;
+
+	std::vector<int> firedNIds_;	//!< neurons that spike in one ms, in random order
+	std::vector<int> pspPreNIds_;	//!< synaptic events of the spikes in firedNIds_ (for the psp kernel)
+	std::vector<int> pspPostNIds_;
+	std::vector<int> pspSynIds_;
+	long long numPlasticSyn_;		//!< number of plastic synapses (for the ltp and weights kernels)
+};
+
+void KernelBenchmark::setupNetwork(const KernelNetwork& net) {
+	delete snn_;
+	snn_ = new SNN("kernel_benchmark", CPU_MODE, SILENT, opt_.randSeed);
+	srand(opt_.randSeed);
+
+	int grpId;
+	if (net.model == MODEL_LIF) {
+		grpId = snn_->createGroupLIF("exc", Grid3D(opt_.numN, 1, 1), EXCITATORY_NEURON, 0, CPU_CORES);
+		snn_->setNeuronParametersLIF(grpId, 10, 2, -50.0f, -65.0f, 1.0, 1.0);
+	} else {
+		grpId = snn_->createGroup("exc", Grid3D(opt_.numN, 1, 1), EXCITATORY_NEURON, 0, CPU_CORES);
+		if (net.model == MODEL_IZH9) // RS neuron (Izhikevich, 2007)
+			snn_->setNeuronParameters(grpId, 100.0f, 0.0f, 0.7f, 0.0f, -60.0f, 0.0f, -40.0f, 0.0f, 0.03f, 0.0f, -2.0f,
+				0.0f, 35.0f, 0.0f, -50.0f, 0.0f, 100.0f, 0.0f);
+		else // RS neuron
+			snn_->setNeuronParameters(grpId, 0.02f, 0.0f, 0.2f, 0.0f, -65.0f, 0.0f, 8.0f, 0.0f);
+	}
+
+	float wt = net.withCOBA ? 0.005f : 0.5f;
+	float prob = std::min(1.0f, (float)opt_.fanIn / opt_.numN);
+	snn_->connect(grpId, grpId, "random", wt, net.withSTDP ? 2 * wt : wt, prob, 1, net.maxDelay, RadiusRF(-1),
+		1.0f, 1.0f, net.withSTDP ? SYN_PLASTIC : SYN_FIXED);
+
+	if (net.withCOBA)
+		snn_->setConductances(true, 5, 0, 150, 6, 0, 150);
+	else
+		snn_->setConductances(false, 0, 0, 0, 0, 0, 0);
+	snn_->setIntegrationMethod(net.integrator, opt_.numSubsteps);
+	if (net.withSTP)
+		snn_->setSTP(grpId, true, 0.45f, 50.0f, 750.0f);
+	if (net.withSTDP)
+		snn_->setESTDP(grpId, true, STANDARD, EXP_CURVE, 2e-4f, 20.0f, -6.6e-5f, 60.0f, 0.0f);
+
+	snn_->setupNetwork();
+
+	// the kernels are called at a fixed time within the first second
+	snn_->simTimeSec = 0;
+	snn_->simTimeMs = KERNEL_BENCHMARK_SIM_TIME;
+	snn_->simTime = KERNEL_BENCHMARK_SIM_TIME;
+
+	RuntimeData& rtd = snn_->runtimeData[netId_];
+	NetworkConfigRT& config = snn_->networkConfigs[netId_];
+
+	// a constant input current makes every model fire tonically
+	float extCurrent = net.model == MODEL_IZH9 ? 100.0f : (net.model == MODEL_LIF ? 20.0f : 10.0f);
+	for (int lNId = 0; lNId < config.numNReg; lNId++)
+		rtd.extCurrent[lNId] = extCurrent;
+
+	// the spikes of one ms
+	std::vector<int> nIds(config.numNReg);
+	for (int lNId = 0; lNId < config.numNReg; lNId++)
+		nIds[lNId] = lNId;
+	std::random_shuffle(nIds.begin(), nIds.end());
+	int numFired = std::max(1, (int)(opt_.fireFraction * config.numNReg));
+	firedNIds_.assign(nIds.begin(), nIds.begin() + numFired);
+
+	// firing tables: all spikes at the current time (delay 1) or spread evenly over the last maxDelay ms (delays 2+)
+	int t = snn_->simTimeMs;
+	if (config.maxDelay == 1) {
+		int numSpikes = std::min(numFired, (int)config.maxSpikesD1 - 1);
+		for (int i = 0; i < numSpikes; i++)
+			rtd.firingTableD1[i] = firedNIds_[i];
+		rtd.timeTableD1[t + config.maxDelay] = 0;
+		rtd.timeTableD1[t + config.maxDelay + 1] = numSpikes;
+	} else {
+		int numPerMs = std::min(numFired, ((int)config.maxSpikesD2 - 1) / config.maxDelay);
+		rtd.timeTableD2[t + 1] = 0;
+		for (int d = 0; d < config.maxDelay; d++) {
+			for (int i = 0; i < numPerMs; i++)
+				rtd.firingTableD2[d * numPerMs + i] = nIds[(d * numPerMs + i) % config.numNReg];
+			rtd.timeTableD2[t + 2 + d] = (d + 1) * numPerMs;
+		}
+	}
+
+	// the synaptic events of the spikes at the current time, in the order doCurrentUpdateD1_CPU delivers them
+	pspPreNIds_.clear(); pspPostNIds_.clear(); pspSynIds_.clear();
+	for (int i = 0; i < numFired; i++) {
+		int lNId = firedNIds_[i];
+		DelayInfo dPar = rtd.postDelayInfo[lNId * (config.maxDelay + 1)];
+		unsigned int offset = rtd.cumulativePost[lNId];
+		for (int idx_d = dPar.delay_index_start; idx_d < dPar.delay_index_start + dPar.delay_length; idx_d++) {
+			SynInfo postInfo = rtd.postSynapticIds[offset + idx_d];
+			pspPreNIds_.push_back(lNId);
+			pspPostNIds_.push_back(GET_CONN_NEURON_ID(postInfo));
+			pspSynIds_.push_back(GET_CONN_SYN_ID(postInfo));
+		}
+	}
+
+	// STDP: pre-synaptic spikes in the last 20 ms, and small pending weight changes
+	numPlasticSyn_ = 0;
+	if (net.withSTDP) {
+		for (int lNId = 0; lNId < config.numNReg; lNId++) {
+			unsigned int offset = rtd.cumulativePre[lNId];
+			for (int j = 0; j < rtd.Npre_plastic[lNId]; j++) {
+				rtd.synSpikeTime[offset + j] = snn_->simTime - 1 - rand() % 20;
+				rtd.wtChange[offset + j] = 1e-4f * (rand() % 100 - 50);
+			}
+			numPlasticSyn_ += rtd.Npre_plastic[lNId];
+		}
+	}
+}
+
+void KernelBenchmark::prepare(KernelId kernel) {
+	if (kernel != KERNEL_FIRING)
+		return;
+
+	// findFiring_CPU consumes the spikes flagged by the state update and appends them to the firing tables
+	RuntimeData& rtd = snn_->runtimeData[netId_];
+	rtd.spikeCountD1Sec = 0;
+	rtd.spikeCountD2Sec = 0;
+	rtd.spikeCountLastSecLeftD2 = 0;
+	for (int i = 0; i < firedNIds_.size(); i++)
+		rtd.curSpike[firedNIds_[i]] = true;
+}
+
+long long KernelBenchmark::call(KernelId kernel) {
+	int numNReg = snn_->networkConfigs[netId_].numNReg;
+	long long synEvents = snn_->eventCounters_[netId_].counts.synEvents;
+
+	switch (kernel) {
+	case KERNEL_STATE:
+		snn_->globalStateUpdate_CPU(netId_);
+		return numNReg;
+	case KERNEL_FIRING:
+		snn_->findFiring_CPU(netId_);
+		return numNReg;
+	case KERNEL_DELIVER_D1:
+		snn_->doCurrentUpdateD1_CPU(netId_);
+		return snn_->eventCounters_[netId_].counts.synEvents - synEvents;
+	case KERNEL_DELIVER_D2:
+		snn_->doCurrentUpdateD2_CPU(netId_);
+		return snn_->eventCounters_[netId_].counts.synEvents - synEvents;
+	case KERNEL_PSP:
+		for (int i = 0; i < pspPreNIds_.size(); i++)
+			snn_->generatePostSynapticSpike(pspPreNIds_[i], pspPostNIds_[i], pspSynIds_[i], 0, netId_);
+		return pspPreNIds_.size();
+	case KERNEL_LTP:
+		for (int lNId = 0; lNId < numNReg; lNId++)
+			snn_->updateLTP(lNId, snn_->runtimeData[netId_].grpIds[lNId], netId_);
+		return numPlasticSyn_;
+	case KERNEL_WEIGHTS:
+		snn_->updateWeights_CPU(netId_);
+		return numPlasticSyn_;
+	default:
+		return 0;
+	}
+}
+
+KernelStats KernelBenchmark::run(KernelId kernel) {
+	// warm-up call, so that the first sample does not pay for cold caches
+	prepare(kernel);
+	call(kernel);
+
+	std::vector<double> samples(opt_.numSamples);
+	long long unitsPerCall = 0;
+	for (int s = 0; s < opt_.numSamples; s++) {
+		unsigned long long timeNs = 0;
+		long long numUnits = 0;
+		for (int i = 0; i < opt_.numIters; i++) {
+			prepare(kernel);
+			unsigned long long startNs = getProfilerTimeNs();
+			numUnits += call(kernel);
+			timeNs += getProfilerTimeNs() - startNs;
+		}
+		samples[s] = numUnits > 0 ? (double)timeNs / numUnits : 0.0;
+		unitsPerCall = numUnits / opt_.numIters;
+	}
+
+	KernelStats stats;
+	stats.unitsPerCall = unitsPerCall;
+	stats.mean = 0.0;
+	for (int s = 0; s < opt_.numSamples; s++)
+		stats.mean += samples[s] / opt_.numSamples;
+	stats.stddev = 0.0;
+	for (int s = 0; s < opt_.numSamples; s++)
+		stats.stddev += (samples[s] - stats.mean) * (samples[s] - stats.mean);
+	stats.stddev = opt_.numSamples > 1 ? sqrt(stats.stddev / (opt_.numSamples - 1)) : 0.0;
+	std::sort(samples.begin(), samples.end());
+	stats.min = samples[0];
+	stats.median = opt_.numSamples % 2 ? samples[opt_.numSamples / 2]
+		: (samples[opt_.numSamples / 2 - 1] + samples[opt_.numSamples / 2]) / 2;
+	return stats;
+}
+
+static void printUsage() {
+	fprintf(stderr,
+		"Usage: carlsim-kernel-benchmark [options]\n"
+		"  --kernels state,firing,deliver_d1,deliver_d2,psp,ltp,weights (default all), --neurons n, --fanin k,\n"
+		"  --delay ms, --fire f, --substeps s, --samples n, --iters n, --seed s, --label text, --csv, --out file\n");
+}
+
+static void printHeader(FILE* fp, bool csv) {
+	if (csv)
+		fprintf(fp, "label,kernel,variant,neurons,fanin,unit,units_per_call,mean_ns,stddev_ns,min_ns,median_ns\n");
+	else
+		fprintf(fp, "%-11s %-24s %-10s %14s %10s %10s %10s %10s\n", "kernel", "variant", "unit", "units/call",
+			"mean ns", "stddev ns", "min ns", "median ns");
+}
+
+static void printStats(FILE* fp, const KernelOptions& opt, KernelId kernel, const KernelNetwork& net,
+	const KernelStats& stats) {
+	if (opt.csv)
+		fprintf(fp, "%s,%s,%s,%d,%d,%s,%lld,%.4f,%.4f,%.4f,%.4f\n", opt.label.c_str(), kernelId_string[kernel],
+			net.getVariant().c_str(), opt.numN, opt.fanIn, kernelUnit_string[kernel], stats.unitsPerCall, stats.mean,
+			stats.stddev, stats.min, stats.median);
+	else
+		fprintf(fp, "%-11s %-24s %-10s %14lld %10.3f %10.3f %10.3f %10.3f\n", kernelId_string[kernel],
+			net.getVariant().c_str(), kernelUnit_string[kernel], stats.unitsPerCall, stats.mean, stats.stddev,
+			stats.min, stats.median);
+	fflush(fp);
+}
+
+int main(int argc, char* argv[]) {
+	KernelOptions opt;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		bool valid = true;
+		if (arg == "--csv") {
+			opt.csv = true;
+		} else if (arg == "--out" && hasValue) {
+			opt.outFile = argv[++i];
+		} else if (arg == "--label" && hasValue) {
+			opt.label = argv[++i];
+		} else if (arg == "--kernels" && hasValue) {
+			std::string list = std::string(argv[++i]) + ",";
+			opt.kernels.clear();
+			for (size_t start = 0, end; (end = list.find(',', start)) != std::string::npos; start = end + 1) {
+				std::string name = list.substr(start, end - start);
+				int kernel = 0;
+				while (kernel < NUM_KERNELS && name != kernelId_string[kernel])
+					kernel++;
+				valid = valid && kernel < NUM_KERNELS;
+				opt.kernels.push_back(kernel);
+			}
+		} else if (arg == "--neurons" && hasValue) {
+			opt.numN = atoi(argv[++i]);
+			valid = opt.numN >= 10;
+		} else if (arg == "--fanin" && hasValue) {
+			opt.fanIn = atoi(argv[++i]);
+			valid = opt.fanIn >= 1;
+		} else if (arg == "--delay" && hasValue) {
+			opt.maxDelay = atoi(argv[++i]);
+			valid = opt.maxDelay >= 2 && opt.maxDelay <= MAX_SYN_DELAY;
+		} else if (arg == "--fire" && hasValue) {
+			opt.fireFraction = atof(argv[++i]);
+			valid = opt.fireFraction > 0.0f && opt.fireFraction <= 1.0f;
+		} else if (arg == "--substeps" && hasValue) {
+			opt.numSubsteps = atoi(argv[++i]);
+			valid = opt.numSubsteps >= 1 && opt.numSubsteps <= 100;
+		} else if (arg == "--samples" && hasValue) {
+			opt.numSamples = atoi(argv[++i]);
+			valid = opt.numSamples >= 1;
+		} else if (arg == "--iters" && hasValue) {
+			opt.numIters = atoi(argv[++i]);
+			valid = opt.numIters >= 1;
+		} else if (arg == "--seed" && hasValue) {
+			opt.randSeed = atoi(argv[++i]);
+		} else {
+			fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+			printUsage();
+			return 1;
+		}
+
+		if (!valid) {
+			fprintf(stderr, "Invalid value of option %s\n", arg.c_str());
+			printUsage();
+			return 1;
+		}
+	}
+	if (opt.kernels.empty())
+		for (int kernel = 0; kernel < NUM_KERNELS; kernel++)
+			opt.kernels.push_back(kernel);
+
+	// the header is only written to new (or empty) files, so that results of several runs can be appended
+	FILE* fp = stdout;
+	bool needHeader = true;
+	if (!opt.outFile.empty()) {
+		fp = fopen(opt.outFile.c_str(), "a");
+		if (fp == NULL) {
+			fprintf(stderr, "Could not open output file %s\n", opt.outFile.c_str());
+			return 1;
+		}
+		needHeader = ftell(fp) == 0;
+	}
+	if (needHeader)
+		printHeader(fp, opt.csv);
+
+	KernelBenchmark bench(opt);
+	for (int k = 0; k < opt.kernels.size(); k++) {
+		KernelId kernel = (KernelId)opt.kernels[k];
+
+		// the networks a kernel is timed on
+		std::vector<KernelNetwork> nets;
+		KernelNetwork net;
+		switch (kernel) {
+		case KERNEL_STATE:
+			for (int model = MODEL_IZH4; model <= MODEL_LIF; model++) {
+				net.model = (NeuronModel)model;
+				net.integrator = FORWARD_EULER;
+				nets.push_back(net);
+				net.integrator = RUNGE_KUTTA4;
+				nets.push_back(net);
+			}
+			break;
+		case KERNEL_DELIVER_D1:
+		case KERNEL_PSP:
+			for (int coba = 0; coba <= 1; coba++) {
+				net.withCOBA = coba;
+				net.withSTP = false;
+				nets.push_back(net);
+				net.withSTP = true;
+				nets.push_back(net);
+			}
+			break;
+		case KERNEL_DELIVER_D2:
+			net.maxDelay = opt.maxDelay;
+			nets.push_back(net);
+			net.withCOBA = true;
+			nets.push_back(net);
+			break;
+		case KERNEL_LTP:
+		case KERNEL_WEIGHTS:
+			net.withSTDP = true;
+			nets.push_back(net);
+			break;
+		default: // KERNEL_FIRING
+			nets.push_back(net);
+			break;
+		}
+
+		for (int n = 0; n < nets.size(); n++) {
+			bench.setupNetwork(nets[n]);
+			printStats(fp, opt, kernel, nets[n], bench.run(kernel));
+		}
+	}
+
+	if (fp != stdout)
+		fclose(fp);
+
+	return 0;
+}
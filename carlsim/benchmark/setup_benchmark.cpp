@@ -0,0 +1,323 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+/*
+ * setup_benchmark: CARLsim::setupNetwork benchmark
+ *
+ * Usage:
+ *   carlsim-setup-benchmark [options]
+ *
+ * Every network consists of two groups of the same size on a square 2D grid, connected by one connection of the
+ * given type. The benchmark sets up every combination of the swept options, and reports one row per combination and
+ * repetition with the time of every stage of CARLsim::setupNetwork (see CARLsim::getSetupReport):
+ *   --neurons n,...        number of neurons per group (rounded to a square grid), default 1000,2000,4000
+ *   --conn c,...           connection type: random, full, gaussian, one-to-one, user-defined, kernel (weight-sharing);
+ *                          default all
+ *   --fanin k,...          number of synapses per neuron of random, gaussian, user-defined and kernel connections,
+ *                          default 100
+ * Other options:
+ *   --repeat n             number of repetitions of every combination (with seeds seed, seed+1, ...), default 1
+ *   --seed s               random seed of the first repetition, default 42
+ *   --label text           free-form label written to every row (e.g., a commit hash), default empty
+ *   --csv | --json         output format (default: csv); json writes one object per line
+ *   --out file             append the results to a file instead of writing them to stdout
+ *
+ * connect_ms is the time of the stage that generates the synapses of the connection type (e.g., connectRandom).
+ * us_per_synapse is the total setup time divided by the number of synapses. peak_rss_mb is the peak resident set
+ * size of the process at the end of the setup; it never decreases, so networks are best compared in separate runs
+ * or in order of increasing size.
+ *
+ * Example, tracking the setup time of two commits:
+ *   carlsim-setup-benchmark --neurons 1000,4000,16000 --conn random,gaussian --label $(git rev-parse --short HEAD) \
+ *       --out results/setup.csv
+ */
+
+#include <carlsim.h>
+
+#include <stdio.h>			// printf, fprintf
+#include <stdlib.h>			// atoi, rand
+#include <math.h>			// sqrt
+#include <algorithm>		// std::min, std::max
+#include <string>
+#include <vector>
+
+enum SetupConnType { CONN_TYPE_RANDOM, CONN_TYPE_FULL, CONN_TYPE_GAUSSIAN, CONN_TYPE_ONE_TO_ONE,
+	CONN_TYPE_USER_DEFINED, CONN_TYPE_KERNEL, NUM_CONN_TYPES };
+static const char* setupConnType_string[] = { "random", "full", "gaussian", "one-to-one", "user-defined", "kernel" };
+
+// the setup stage that generates the synapses of every connection type
+static const SetupStage setupConnType_stage[] = { SETUP_CONNECT_RANDOM, SETUP_CONNECT_FULL, SETUP_CONNECT_GAUSSIAN,
+	SETUP_CONNECT_ONE_TO_ONE, SETUP_CONNECT_USER_DEFINED, SETUP_CONNECT_SHARED_KERNEL };
+
+enum OutputFormat { OUTPUT_CSV, OUTPUT_JSON };
+
+//! the lists of values to sweep, and the options that are not swept
+struct SetupOptions {
+	std::vector<int> numN;
+	std::vector<int> connType;
+	std::vector<int> fanIn;
+	int numRepeats;
+	int randSeed;
+	std::string label;
+	OutputFormat format;
+	std::string outFile;
+
+	SetupOptions() : numRepeats(1), randSeed(42), format(OUTPUT_CSV) {}
+};
+
+//! connects every pair of neurons with probability fanIn / numN
+class RandomConnection : public ConnectionGenerator {
+public:
+	RandomConnection(float prob) : prob_(prob) {}
+
+	void connect(CARLsim* s, int srcGrpId, int i, int destGrpId, int j, float& weight, float& maxWt, float& delay,
+		bool& connected) {
+		connected = rand() < prob_ * RAND_MAX;
+		weight = 0.5f;
+		maxWt = 0.5f;
+		delay = 1;
+	}
+
+private:
+	float prob_;
+};
+
+static void printUsage() {
+	fprintf(stderr,
+		"Usage: carlsim-setup-benchmark [options]\n"
+		"  swept options (comma-separated lists): --neurons n,\n"
+		"    --conn random|full|gaussian|one-to-one|user-defined|kernel, --fanin k\n"
+		"  other options: --repeat n, --seed s, --label text, --csv, --json, --out file\n");
+}
+
+// splits a comma-separated list, returns false if a value is not one of names (if given) or not a positive int
+static bool parseList(const std::string& arg, std::vector<int>& values, const char** names=NULL, int numNames=0) {
+	values.clear();
+	size_t start = 0;
+	while (start <= arg.size()) {
+		size_t end = arg.find(',', start);
+		if (end == std::string::npos)
+			end = arg.size();
+		std::string item = arg.substr(start, end - start);
+		int value = -1;
+		if (names != NULL) {
+			for (int i = 0; i < numNames; i++)
+				if (item == names[i])
+					value = i;
+		} else {
+			value = atoi(item.c_str());
+		}
+		if (value <= 0 && (names == NULL || value < 0))
+			return false;
+		values.push_back(value);
+		start = end + 1;
+	}
+	return !values.empty();
+}
+
+/*!
+ * \brief builds and sets up one network, and returns its setup report
+ *
+ * Gaussian connections use a circular receptive field whose area matches the fan-in; weight-sharing connections use
+ * the smallest odd square kernel with at least fan-in entries.
+ */
+static SetupReport runBenchmark(int side, SetupConnType connType, int fanIn, int randSeed, int& numSynapses) {
+	int numN = side * side;
+	float prob = std::min(1.0f, (float)fanIn / numN);
+
+	CARLsim* sim = new CARLsim("setup_benchmark", CPU_MODE, SILENT, 0, randSeed);
+	srand(randSeed);
+	int gPre = sim->createGroup("pre", Grid3D(side, side, 1), EXCITATORY_NEURON, 0, CPU_CORES);
+	sim->setNeuronParameters(gPre, 0.02f, 0.2f, -65.0f, 8.0f);
+	int gPost = sim->createGroup("post", Grid3D(side, side, 1), EXCITATORY_NEURON, 0, CPU_CORES);
+	sim->setNeuronParameters(gPost, 0.02f, 0.2f, -65.0f, 8.0f);
+
+	RandomConnection* userConn = NULL;
+	switch (connType) {
+	case CONN_TYPE_RANDOM:
+		sim->connect(gPre, gPost, "random", RangeWeight(0.5f), prob, RangeDelay(1, 20));
+		break;
+	case CONN_TYPE_FULL:
+		sim->connect(gPre, gPost, "full", RangeWeight(0.5f), 1.0f, RangeDelay(1, 20));
+		break;
+	case CONN_TYPE_GAUSSIAN: {
+		double radius = sqrt(fanIn / M_PI);
+		sim->connect(gPre, gPost, "gaussian", RangeWeight(0.5f), 1.0f, RangeDelay(1, 20), RadiusRF(radius, radius, 0));
+		break;
+	}
+	case CONN_TYPE_ONE_TO_ONE:
+		sim->connect(gPre, gPost, "one-to-one", RangeWeight(0.5f), 1.0f, RangeDelay(1, 20));
+		break;
+	case CONN_TYPE_USER_DEFINED:
+		userConn = new RandomConnection(prob);
+		sim->connect(gPre, gPost, userConn);
+		break;
+	default: { // CONN_TYPE_KERNEL
+		int size = (int)ceil(sqrt((double)fanIn));
+		size += 1 - size % 2;
+		sim->connect(gPre, gPost, Grid3D(size, size, 1), std::vector<float>(size * size, 0.5f), 0.5f,
+			RangeDelay(1, 20));
+		break;
+	}
+	}
+
+	sim->setupNetwork();
+	SetupReport report = sim->getSetupReport();
+	numSynapses = sim->getNumSynapses();
+
+	delete sim;
+	delete userConn;
+
+	return report;
+}
+
+static void printHeader(FILE* fp) {
+	fprintf(fp, "label,neurons,conn,fanin,seed,synapses,setup_ms,compile_ms,partition_ms,connect_ms,"
+		"generate_runtime_ms,connection_runtime_ms,allocate_ms,us_per_synapse,peak_rss_mb\n");
+}
+
+static void printResult(FILE* fp, const SetupOptions& opt, int numN, SetupConnType connType, int fanIn, int randSeed,
+	int numSynapses, const SetupReport& rep) {
+	double usPerSynapse = numSynapses > 0 ? rep.setupTimeMs * 1000.0 / numSynapses : 0.0;
+	if (opt.format == OUTPUT_JSON) {
+		fprintf(fp, "{\"label\":\"%s\",\"neurons\":%d,\"conn\":\"%s\",\"fanin\":%d,\"seed\":%d,\"synapses\":%d,"
+			"\"setup_ms\":%.3f,\"compile_ms\":%.3f,\"partition_ms\":%.3f,\"connect_ms\":%.3f,"
+			"\"generate_runtime_ms\":%.3f,\"connection_runtime_ms\":%.3f,\"allocate_ms\":%.3f,"
+			"\"us_per_synapse\":%.4f,\"peak_rss_mb\":%.2f}\n",
+			opt.label.c_str(), numN, setupConnType_string[connType], fanIn, randSeed, numSynapses, rep.setupTimeMs,
+			rep.stageTimeMs[SETUP_COMPILE], rep.stageTimeMs[SETUP_PARTITION],
+			rep.stageTimeMs[setupConnType_stage[connType]], rep.stageTimeMs[SETUP_GENERATE_RUNTIME],
+			rep.stageTimeMs[SETUP_CONNECTION_RUNTIME], rep.stageTimeMs[SETUP_ALLOCATE], usPerSynapse,
+			rep.peakRssBytes / (1024.0 * 1024.0));
+	} else {
+		fprintf(fp, "%s,%d,%s,%d,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.4f,%.2f\n", opt.label.c_str(), numN,
+			setupConnType_string[connType], fanIn, randSeed, numSynapses, rep.setupTimeMs,
+			rep.stageTimeMs[SETUP_COMPILE], rep.stageTimeMs[SETUP_PARTITION],
+			rep.stageTimeMs[setupConnType_stage[connType]], rep.stageTimeMs[SETUP_GENERATE_RUNTIME],
+			rep.stageTimeMs[SETUP_CONNECTION_RUNTIME], rep.stageTimeMs[SETUP_ALLOCATE], usPerSynapse,
+			rep.peakRssBytes / (1024.0 * 1024.0));
+	}
+	fflush(fp);
+}
+
+int main(int argc, char* argv[]) {
+	SetupOptions opt;
+	opt.numN.push_back(1000);
+	opt.numN.push_back(2000);
+	opt.numN.push_back(4000);
+	for (int c = 0; c < NUM_CONN_TYPES; c++)
+		opt.connType.push_back(c);
+	opt.fanIn.push_back(100);
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		bool valid = true;
+		if (arg == "--csv") {
+			opt.format = OUTPUT_CSV;
+		} else if (arg == "--json") {
+			opt.format = OUTPUT_JSON;
+		} else if (arg == "--out" && hasValue) {
+			opt.outFile = argv[++i];
+		} else if (arg == "--label" && hasValue) {
+			opt.label = argv[++i];
+		} else if (arg == "--neurons" && hasValue) {
+			valid = parseList(argv[++i], opt.numN);
+		} else if (arg == "--conn" && hasValue) {
+			valid = parseList(argv[++i], opt.connType, setupConnType_string, NUM_CONN_TYPES);
+		} else if (arg == "--fanin" && hasValue) {
+			valid = parseList(argv[++i], opt.fanIn);
+		} else if (arg == "--repeat" && hasValue) {
+			opt.numRepeats = atoi(argv[++i]);
+			valid = opt.numRepeats > 0;
+		} else if (arg == "--seed" && hasValue) {
+			opt.randSeed = atoi(argv[++i]);
+		} else {
+			fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+			printUsage();
+			return 1;
+		}
+
+		if (!valid) {
+			fprintf(stderr, "Invalid value of option %s\n", arg.c_str());
+			printUsage();
+			return 1;
+		}
+	}
+
+	// the header is only written to new (or empty) files, so that results of several runs can be appended
+	FILE* fp = stdout;
+	bool needHeader = opt.format == OUTPUT_CSV;
+	if (!opt.outFile.empty()) {
+		fp = fopen(opt.outFile.c_str(), "a");
+		if (fp == NULL) {
+			fprintf(stderr, "Could not open output file %s\n", opt.outFile.c_str());
+			return 1;
+		}
+		needHeader = needHeader && ftell(fp) == 0;
+	}
+	if (needHeader)
+		printHeader(fp);
+
+	for (int a = 0; a < opt.numN.size(); a++)
+	for (int b = 0; b < opt.connType.size(); b++)
+	for (int c = 0; c < opt.fanIn.size(); c++) {
+		int side = std::max(1, (int)(sqrt((double)opt.numN[a]) + 0.5));
+		SetupConnType connType = (SetupConnType)opt.connType[b];
+		for (int r = 0; r < opt.numRepeats; r++) {
+			int randSeed = opt.randSeed + r;
+			int numSynapses = 0;
+			SetupReport report = runBenchmark(side, connType, opt.fanIn[c], randSeed, numSynapses);
+			printResult(fp, opt, side * side, connType, opt.fanIn[c], randSeed, numSynapses, report);
+		}
+	}
+
+	if (fp != stdout)
+		fclose(fp);
+	return 0;
+}
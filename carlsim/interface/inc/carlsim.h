@@ -247,6 +247,41 @@ public:
 		const RangeDelay& delay=RangeDelay(1), const RadiusRF& radRF=RadiusRF(-1.0), bool synWtType=SYN_FIXED,
 		float mulSynFast=1.0f, float mulSynSlow=1.0f);
 
+	/*!
+	 * \brief Connects two groups with a weight-sharing (convolutional) kernel
+	 *
+	 * Neuron pre is connected to neuron post if the grid offset of pre relative to post falls inside the kernel, and
+	 * the corresponding kernel entry is non-zero. Offsets are measured in units of the post grid: if the two grids
+	 * differ in size, every pre-neuron is mapped to the post-grid cell that contains it. All synapses that map to the
+	 * same kernel entry share a single weight: there is only one copy of the kernel per connection, and STDP updates
+	 * (if synWtType is SYN_PLASTIC) are accumulated over all synapses of an entry and applied to the kernel once per
+	 * weight update.
+	 *
+	 * Only the weights are stored once. Every synapse still occupies the connectivity arrays (ids, delays) and the
+	 * per-synapse weight slots of the network, so the memory of the connection stays proportional to the number of
+	 * synapses.
+	 *
+	 * The kernel is stored x-fastest, i.e. entry (dx,dy,dz) is found at
+	 * kernel[((dz+radZ)*kernelSize.numY + (dy+radY))*kernelSize.numX + (dx+radX)], with rad = (kernelSize-1)/2.
+	 *
+	 * \note Shared-kernel connections are only supported if the post-synaptic group runs on a CPU partition.
+	 * \note Individual synapses cannot be changed via setWeight, biasWeights, or scaleWeights.
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] grpId1     ID of the pre-synaptic group
+	 * \param[in] grpId2     ID of the post-synaptic group
+	 * \param[in] kernelSize size of the kernel in 3 dimensions, each of which must be odd
+	 * \param[in] kernel     non-negative kernel weights (magnitudes), must have kernelSize.N entries
+	 * \param[in] maxWt      upper bound of every kernel weight (magnitude)
+	 * \param[in] delay      A struct specifying the range of delay values (ms)
+	 * \param[in] synWtType  specifies whether the kernel should be fixed (SYN_FIXED) or plastic (SYN_PLASTIC)
+	 * \param[in] mulSynFast a multiplication factor to be applied to the fast synaptic current. Default: 1.0
+	 * \param[in] mulSynSlow a multiplication factor to be applied to the slow synaptic current. Default: 1.0
+	 * \returns a unique ID associated with the newly created connection
+	 * \see getSharedKernel
+	 */
+	short int connect(int grpId1, int grpId2, const Grid3D& kernelSize, const std::vector<float>& kernel, float maxWt,
+		const RangeDelay& delay=RangeDelay(1), bool synWtType=SYN_FIXED, float mulSynFast=1.0f, float mulSynSlow=1.0f);
+
 	/*!
 	 * \brief Shortcut to make connections with custom connectivity profile but omit scaling factors for synaptic
 	 * conductances (default is 1.0 for both)
@@ -498,6 +533,75 @@ public:
 	*/
 	void setIntegrationMethod(integrationMethod_t method, int numStepsPerMs);
 
+	/*!
+	* \brief Sets the memory layout of neurons within their groups
+	*
+	* This function specifies an optional reordering pass that renumbers the neurons of each group before the synaptic
+	* connectivity is built, so that neurons that are close in space (according to their Grid3D) are also close in
+	* memory. This reduces the number of cache misses when spikes are delivered to the post-synaptic neurons of a
+	* topographic connection.
+	*
+	* The reordering is internal only: neuron IDs exposed by SpikeMonitor, NeuronMonitor, ConnectionMonitor,
+	* getNeuronLocation3D, setWeight, setExternalCurrent, etc. are not changed.
+	*
+	* By default, neurons are stored in creation order (CREATION_ORDER).
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] ordering the neuron ordering to use
+	* \note The reordering is only applied to regular (non-Poisson, non-compartmental) groups that run on a CPU
+	* partition. All other groups keep their creation order.
+	*/
+	void setNeuronOrdering(NeuronOrdering ordering);
+
+	/*!
+	* \brief Sets the policy that places the worker threads of CPU partitions on cores
+	*
+	* By default, each CPU partition runs on a core of its own (CORE_PER_PARTITION). On machines with several NUMA
+	* nodes, NODE_PER_PARTITION keeps each partition and its runtime data on one node, which avoids cross-node memory
+	* traffic. Explicit core lists set with setCPUAffinity take precedence over the policy.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] policy the placement policy to use
+	* \note Thread placement is only supported on Linux. The policy is ignored on other platforms.
+	* \sa setCPUAffinity
+	*/
+	void setCPUAffinityPolicy(CPUAffinityPolicy policy);
+
+	/*!
+	* \brief Restricts the worker threads of a CPU partition to an explicit list of cores
+	*
+	* The worker threads of the partition, as well as the thread that first touches its runtime data, may only run on
+	* the given cores. Cores that are not online are ignored; if none of the cores is online, the partition falls back
+	* to the policy set with setCPUAffinityPolicy.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] partition the partition ID, as passed to createGroup with CPU_CORES as backend
+	* \param[in] cores a non-empty list of core IDs
+	* \note Thread placement is only supported on Linux. The core list is ignored on other platforms.
+	* \sa setCPUAffinityPolicy
+	*/
+	void setCPUAffinity(int partition, const std::vector<int>& cores);
+
+	/*!
+	* \brief Caches the connectivity of the compiled network in a file to speed up later runs
+	*
+	* Generating the synapses of a large network can take much longer than simulating its first second. With a
+	* network image, setupNetwork writes the partitioned connectivity (synapse counts, pre- and post-synaptic IDs,
+	* delays, initial weights, and connection IDs) to fileName. The next time the same network is set up with the
+	* same file, the connectivity is mapped from the image instead of being generated, so that setup time is mostly
+	* bounded by disk bandwidth.
+	*
+	* The image is tied to a hash of the network configuration (groups, grids, connections, shared kernels, random
+	* seed, simulation mode, neuron ordering). If the configuration changed, the image is rebuilt and overwritten.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] fileName path of the network image; it is created during setupNetwork if it does not exist
+	* \note The output of ConnectionGenerator callbacks (user-defined connections) cannot be hashed. Delete the image
+	* whenever such a callback changes.
+	* \note Images are platform-specific and should not be shared between machines with different architectures.
+	*/
+	void setNetworkImage(const std::string& fileName);
+
 	/*!
 	 * \brief Sets Izhikevich params a, b, c, and d with as mean +- standard deviation
 	 *
@@ -839,6 +943,59 @@ public:
 	 */
 	void saveSimulation(const std::string& fileName, bool saveSynapseInfo=true);
 
+	/*!
+	 * \brief Saves the complete dynamic state of the network to a checkpoint file
+	 *
+	 * A checkpoint contains everything that changes while the network is running: membrane potentials and recovery
+	 * variables, conductances, short-term plasticity history, synaptic weights and weight changes, last spike times,
+	 * firing tables, the simulation time, and the state of the random number generator. A network that was set up
+	 * from the same configuration and random seed can be brought back to that state with CARLsim::loadCheckpoint,
+	 * for example to resume a long training run after a crash.
+	 *
+	 * The state is copied into a snapshot buffer right away. Unless <tt>blocking</tt> is set, the file is written by
+	 * a background thread while the simulation continues. The file is first written to <tt>fileName.tmp</tt> and
+	 * then renamed, so that an existing checkpoint is only replaced by a complete one.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \param[in] fileName  name of the checkpoint file
+	 * \param[in] blocking  whether to wait until the file has been written
+	 * \note Checkpoints are only supported for networks that run on CPU cores.
+	 * \note Monitors and user-defined spike generators are not part of a checkpoint. Spike generators are queried
+	 * again, starting from the last spike time of each neuron.
+	 * \see CARLsim::loadCheckpoint
+	 * \see CARLsim::setCheckpointInterval
+	 * \since v4.0
+	 */
+	void saveCheckpoint(const std::string& fileName, bool blocking=false);
+
+	/*!
+	 * \brief Restores the dynamic state of the network from a checkpoint file
+	 *
+	 * The network must have been set up from the same configuration and random seed as the one that wrote the
+	 * checkpoint, so that it has the same connectivity and neuron parameters. If the connectivity depends on
+	 * random delays, use CARLsim::setNetworkImage or CARLsim::loadSimulation to reproduce it.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \param[in] fileName  name of a checkpoint file written by CARLsim::saveCheckpoint
+	 * \see CARLsim::saveCheckpoint
+	 * \since v4.0
+	 */
+	void loadCheckpoint(const std::string& fileName);
+
+	/*!
+	 * \brief Takes a checkpoint periodically during CARLsim::runNetwork
+	 *
+	 * Every <tt>intervalMs</tt> of simulation time, CARLsim::saveCheckpoint is called (non-blocking) with the same
+	 * file name, so that the file always holds the most recent complete checkpoint.
+	 *
+	 * \STATE ::CONFIG_STATE, ::SETUP_STATE, ::RUN_STATE
+	 * \param[in] intervalMs  checkpoint interval in ms of simulation time, 0 disables periodic checkpoints
+	 * \param[in] fileName    name of the checkpoint file
+	 * \see CARLsim::saveCheckpoint
+	 * \since v4.0
+	 */
+	void setCheckpointInterval(int intervalMs, const std::string& fileName);
+
 	/*!
 	 * \brief Sets the name of the log file
 	 *
@@ -918,6 +1075,8 @@ public:
 	 * groups, connections, and neurons as the one stored with CARLsim::saveSimulation.
 	 * \note In addition, CARLsim::saveSimulation must have been called with flag <tt>saveSynapseInfo</tt> set to
 	 * <tt>true</tt>.
+	 * \note The stored synapses replace the connectivity that would otherwise be generated by CARLsim::connect.
+	 * Shared-kernel connections are generated as usual, and only their kernel weights are restored.
 	 * \attention Wait with calling fclose on the file pointer until ::SETUP_STATE!
 	 * \see CARLsim::saveSimulation
 	 * \since v2.0
@@ -998,9 +1157,75 @@ public:
 	 * \param[in] fname         file name of the binary to be created
 	 * \see ch7s2_connection_monitor
 	 * \see ch9s1_matlab_oat
+	 * \see CARLsim::setConnectFileFormat
 	 */
 	ConnectionMonitor* setConnectionMonitor(int grpIdPre, int grpIdPost, const std::string& fname);
 
+	/*!
+	 * \brief Sets the format of connection files
+	 *
+	 * By default, every snapshot in a connection file is the dense pre x post weight matrix (::CONNECT_FILE_DENSE).
+	 * For large, sparsely connected groups, most of this matrix is NAN: a 10k x 10k connection at 1% density takes
+	 * 400 MB per snapshot. ::CONNECT_FILE_SPARSE instead lists the (pre, post) neuron IDs of all synapses once, and
+	 * stores a single weight per synapse in every snapshot. ::CONNECT_FILE_SPARSE_DELTA only stores the weights that
+	 * have changed since the previous snapshot in the file, as (synapse index, weight) pairs, which keeps snapshots
+	 * of fixed or slowly changing connections small. The MATLAB ConnectionReader reads all formats.
+	 *
+	 * The format applies to all connection files that are opened afterwards by CARLsim::setConnectionMonitor.
+	 *
+	 * \STATE ::CONFIG_STATE, ::SETUP_STATE
+	 * \param[in] format  the connection file format
+	 * \see CARLsim::setConnectionMonitor
+	 * \since v4.0
+	 */
+	void setConnectFileFormat(ConnectFileFormat format);
+
+	/*!
+	 * \brief Enables hardware performance counters per simulation phase
+	 *
+	 * On Linux, this attaches perf_event counters (instructions, cycles, last-level cache misses, branch misses) to
+	 * the thread that calls CARLsim::runNetwork and to all CPU worker threads it creates. The counts are attributed
+	 * to the phases of the simulation step and reported by CARLsim::getPerformanceReport (see
+	 * PerformanceReport::phaseHwCounts). The counters are opened as one group and scaled if the hardware had to
+	 * multiplex them. The counts of a worker thread only reach the counters when the thread exits, which can be after
+	 * the phase that joined it has been read, so part of a phase's worker counts can show up in the following phase.
+	 *
+	 * Reading the counters takes a few system calls per phase, so this should only be enabled for tuning runs. If
+	 * the counters cannot be opened (e.g., not Linux, perf access not permitted by kernel.perf_event_paranoid, or
+	 * no hardware events in a virtual machine), a warning is printed and the simulation runs without them.
+	 * Hardware counters are not available if CARLsim was compiled with CARLSIM_NO_PROFILING.
+	 *
+	 * \STATE ::CONFIG_STATE, ::SETUP_STATE
+	 * \param[in] enable  whether to measure hardware counters
+	 * \see CARLsim::getPerformanceReport
+	 * \since v4.0
+	 */
+	void setHardwareCounters(bool enable);
+
+	/*!
+	 * \brief Records the phases of sampled simulation steps into a Chrome trace file
+	 *
+	 * Every recorded step contributes one event per phase for the manager thread and for the worker thread of every
+	 * CPU partition, which shows stragglers among the partitions, the cost of the routeSpikes barrier, and the monitor
+	 * flushes and spike table shifts at the end of every second. The events are kept in a ring buffer per thread and
+	 * appended to the file at the end of every CARLsim::runNetwork call. The file is complete once the CARLsim object
+	 * is deleted, and can be opened in chrome://tracing or https://ui.perfetto.dev.
+	 *
+	 * Only every <tt>sampleIntervalMs</tt>-th step is recorded, plus every step that finishes a second. If more than
+	 * <tt>maxEventsPerThread</tt> events of a thread are recorded in one CARLsim::runNetwork call, the oldest ones
+	 * are overwritten (and a warning is printed). Tracing is not available if CARLsim was compiled with
+	 * CARLSIM_NO_PROFILING.
+	 *
+	 * \STATE ::CONFIG_STATE, ::SETUP_STATE
+	 * \param[in] fileName            name of the trace file (JSON)
+	 * \param[in] sampleIntervalMs    record every sampleIntervalMs-th simulation step
+	 * \param[in] maxEventsPerThread  capacity of the ring buffer of every thread
+	 * \attention Make sure the directory exists!
+	 * \see CARLsim::getPerformanceReport
+	 * \since v4.0
+	 */
+	void setTraceFile(const std::string& fileName, int sampleIntervalMs=10, int maxEventsPerThread=100000);
+
 	/*!
 	 * \brief Sets the amount of current (mA) to inject into a group
 	 *
@@ -1073,6 +1298,11 @@ public:
 	/*!
 	 * \brief Sets a group monitor for a group, custom GroupMonitor class
 	 *
+	 * Unless fname is "NULL", the group data (currently the dopamine concentration) of every ms is written to a binary
+	 * file (version 0.3) by a background thread. The header (signature, version, grid dimensions, number of values per
+	 * ms) is followed by chunks of (int time of first ms, int number of ms) and the values of each ms (floats). A
+	 * chunk usually covers one second.
+	 *
 	 * \TODO finish docu
 	 * \STATE ::SETUP_STATE
 	 */
@@ -1169,6 +1399,52 @@ public:
 	 */
 	SpikeMonitor* setSpikeMonitor(int grpId, const std::string& fileName);
 
+	/*!
+	 * \brief Sets how spike files are buffered
+	 *
+	 * Spike files are not written on the simulation thread. Instead, the spikes of every spike file are collected in a
+	 * buffer of <tt>bufferSizeKB</tt> KB, and full buffers are written by a dedicated I/O thread. At the end of every
+	 * CARLsim::runNetwork call, all buffers are written and all spike files are complete. The file format is not
+	 * affected.
+	 *
+	 * By default, a buffer is only handed to the I/O thread once it is full, which batches the writes of many
+	 * simulated seconds. Set <tt>flushEverySecond</tt> to hand over every buffer once per simulated second instead,
+	 * so that the spike files grow steadily during a long run.
+	 *
+	 * \STATE ::CONFIG_STATE, ::SETUP_STATE
+	 * \param[in] bufferSizeKB      size of the buffer of each spike file in KB. Default: 256
+	 * \param[in] flushEverySecond  whether buffers are handed to the I/O thread every second. Default: false
+	 * \note The buffer size can only be changed before the first spike file is opened.
+	 * \see CARLsim::setSpikeMonitor
+	 * \since v4.0
+	 */
+	void setSpikeFileBuffering(int bufferSizeKB, bool flushEverySecond=false);
+
+	/*!
+	 * \brief Sets the format of spike files
+	 *
+	 * By default, spike files contain (spike time, neuron ID) pairs of ints (::SPIKE_FILE_FLAT). Long recordings of
+	 * large groups quickly reach hundreds of GB in this format. ::SPIKE_FILE_CHUNKED instead stores the spikes of
+	 * every <tt>chunkLengthMs</tt> milliseconds in a compressed chunk (delta-encoded spike times and neuron IDs as
+	 * variable-length integers), and appends an index of all chunks when the file is closed. A time window can then
+	 * be read without scanning the whole file (see SpikeFileReader). SpikeGeneratorFromFile and the MATLAB
+	 * SpikeReader read both formats.
+	 *
+	 * The format applies to all spike files that are opened afterwards by CARLsim::setSpikeMonitor.
+	 *
+	 * \STATE ::CONFIG_STATE, ::SETUP_STATE
+	 * \param[in] format         the spike file format
+	 * \param[in] chunkLengthMs  time covered by a chunk (ms), only used by ::SPIKE_FILE_CHUNKED. Default: 1000
+	 * \note A chunk is also ended at the end of every CARLsim::runNetwork call (so that the spike file is complete),
+	 * and every second if CARLsim::setSpikeFileBuffering is set to flush every second.
+	 * \note The chunk index is written when the spike file is closed. Files without an index (e.g., while the
+	 * simulation is still running) can be read as well, but opening them requires reading all chunk headers.
+	 * \see CARLsim::setSpikeMonitor
+	 * \see SpikeFileReader
+	 * \since v4.0
+	 */
+	void setSpikeFileFormat(SpikeFileFormat format, int chunkLengthMs=1000);
+
 	/*!
 	* \brief Sets a Neuron Monitor for a groups, print voltage, recovery, and total current values to binary file
 	*
@@ -1210,9 +1486,38 @@ public:
 	* and total current values) over a long period of time.
 	* \see ???
 	* \see ch9s1_matlab_oat
+	* \see setNeuronMonitorSampling
 	*/
 	NeuronMonitor* setNeuronMonitor(int grpId, const std::string& fileName);
 
+	/*!
+	* \brief Streams the state of a subset of neurons of a group to the neuron state file
+	*
+	* By default, a NeuronMonitor records every neuron state value of the first 128 (MAX_NEURON_MON_GRP_SZIE) neurons
+	* of a group every millisecond. This function instead makes the NeuronMonitor sample an arbitrary subset of
+	* neurons of a group of any size every strideMs milliseconds. The samples are written to the binary file of the
+	* NeuronMonitor (version 0.3) in blocks while the network is running; they are not kept in memory, so they cannot
+	* be retrieved via the NeuronMonitor object.
+	*
+	* The file header lists the number of sampled neurons, the sampling interval, and the sampled neuron IDs. It is
+	* followed by blocks of (int time of first sample, int number of samples) and, for each sample, the voltage,
+	* recovery, and current of all sampled neurons (floats).
+	*
+	* The samples are collected in a ring buffer of at most 4 MB per group, which holds only the sampled neurons. It
+	* holds window = min(1000, 4 MB / (12 bytes * number of sampled neurons)) samples and is drained every
+	* window * strideMs milliseconds. The drain period therefore shrinks with the number of sampled neurons: sampling
+	* 50,000 neurons every millisecond gives a window of 6 samples, i.e. the buffer is fetched and written every 6 ms.
+	* The buffer additionally keeps one int per neuron between the smallest and the largest sampled neuron ID.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] grpId    the group ID, which must already have a NeuronMonitor that writes to a file
+	* \param[in] neurIds  neuron IDs (0-indexed within the group) to sample. Leave empty to sample all neurons.
+	* \param[in] strideMs sampling interval (ms). Default: 1
+	* \see setNeuronMonitor
+	* \since v4.0
+	*/
+	void setNeuronMonitorSampling(int grpId, const std::vector<int>& neurIds, int strideMs=1);
+
 	/*!
 	 * \brief Sets a spike rate
 	 * \TODO finish docu
@@ -1485,6 +1790,15 @@ public:
 	 */
 	int getNumSynapticConnections(short int connectionId);
 
+	/*!
+	 * \brief returns the current weights (magnitudes) of a shared-kernel connection
+	 *
+	 * The returned vector has the same layout as the kernel passed to CARLsim::connect.
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \param[in] connectionId the ID of a connection created with a shared kernel
+	 */
+	std::vector<float> getSharedKernel(short int connectionId);
+
 	/*!
 	 * \brief returns the number of groups in the network
 	 *
@@ -1608,6 +1922,69 @@ public:
 	 */
 	GroupNeuromodulatorInfo getGroupNeuromodulatorInfo(int grpId);
 
+	/*!
+	 * \brief returns the wall-clock time spent in each phase of the simulation
+	 *
+	 * This function returns the time spent in every phase of CARLsim::runNetwork (see ::ProfilerPhase), accumulated
+	 * over all calls so far, both overall and per CPU partition. It also lists the hot-path events (synaptic events,
+	 * STDP evaluations, routed and dropped spikes, Poisson draws) counted by every CPU partition (see ::EventCounts).
+	 * The same report is printed at the end of the simulation (unless in SILENT mode).
+	 *
+	 * The instrumentation costs a few clock reads per simulated ms. It can be compiled out with
+	 * <tt>cmake -DCARLSIM_NO_PROFILING=ON</tt>, in which case only the total run time is reported.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \sa PerformanceReport
+	 * \since v4.0
+	 */
+	PerformanceReport getPerformanceReport();
+
+	/*!
+	 * \brief returns the memory footprint of the network, per partition and per array
+	 *
+	 * This function lists every runtime array of the manager and of every CPU partition, the buffers of all monitors,
+	 * and the connectivity lists that CARLsim::setupNetwork builds and releases again. It also returns the peak
+	 * resident set size of the process at the end of CARLsim::setupNetwork. The totals per partition are printed at
+	 * the end of the simulation (unless in SILENT mode). The arrays of GPU partitions are listed with their sizes,
+	 * but device memory is not measured.
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \sa MemoryReport
+	 * \sa CARLsim::estimateMemory
+	 * \since v4.0
+	 */
+	MemoryReport getMemoryReport();
+
+	/*!
+	 * \brief estimates the memory footprint of the network before it is set up
+	 *
+	 * This function returns the breakdown of CARLsim::getMemoryReport as it would be after CARLsim::setupNetwork,
+	 * without allocating anything. It is computed from the group sizes and the expected number of synapses of every
+	 * connection; connections restricted by a receptive field and user-defined connections are estimated by an upper
+	 * bound. Monitors are not part of the estimate.
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \sa MemoryReport
+	 * \sa CARLsim::getMemoryReport
+	 * \since v4.0
+	 */
+	MemoryReport estimateMemory();
+
+	/*!
+	 * \brief returns the wall-clock time spent in each stage of CARLsim::setupNetwork
+	 *
+	 * This function breaks the time of CARLsim::setupNetwork down into its stages (see ::SetupStage): compiling and
+	 * partitioning the network, generating the synapses of every connection type, and building and allocating the
+	 * runtime data of every partition. It also returns the number of synapses generated per connection type and the
+	 * peak resident set size of the process at the end of every stage. The stages are printed at the end of the
+	 * simulation (unless in SILENT mode).
+	 *
+	 * \STATE ::SETUP_STATE, ::RUN_STATE
+	 * \sa SetupReport
+	 * \since v4.0
+	 */
+	SetupReport getSetupReport();
+
 	/*!
 	 * \brief returns
 	 *
@@ -50,6 +50,8 @@
 #define _CARLSIM_DATASTRUCTURES_H_
 
 #include <ostream>			// print struct info
+#include <string>			// std::string
+#include <vector>			// std::vector
 #include <user_errors.h>	// CARLsim user errors
 
 /*!
@@ -139,6 +141,48 @@ static const char* integrationMethod_string[] = {
 };
 
 
+/*!
+* \brief Neuron orderings
+*
+* Determines how the neurons of a group are laid out in memory. This only affects the internal (local) neuron IDs,
+* the neuron IDs exposed by monitors, getNeuronLocation3D, setWeight, etc. are not changed.
+*
+* CREATION_ORDER: Neurons are stored in the order of their IDs (x-fastest over Grid3D).
+* HILBERT_ORDER:  Neurons are stored along a 3D Hilbert curve over the group's Grid3D, so that neurons that are close
+*                 in space are also close in memory. This improves cache hits during spike delivery for topographic
+*                 (e.g., Gaussian or shared-kernel) connections.
+*/
+enum NeuronOrdering {
+	CREATION_ORDER,
+	HILBERT_ORDER,
+	UNKNOWN_ORDERING
+};
+static const char* neuronOrdering_string[] = {
+	"creation order", "Hilbert order", "Unknown neuron ordering"
+};
+
+
+/*!
+* \brief Thread placement policies for CPU partitions
+*
+* Determines on which cores the worker threads of a CPU partition run. The placement of a partition is fixed for the
+* whole simulation (i.e., it is the same in every phase of runNetwork), and the runtime data of the partition is
+* first touched by a thread with the same placement, so that it resides on the memory node that computes on it.
+* Partitions are counted in the order of their partition IDs, skipping partitions that have no groups.
+*
+* CORE_PER_PARTITION: The i-th CPU partition runs on core (i mod number of cores).
+* NODE_PER_PARTITION: The i-th CPU partition runs on any core of NUMA node (i mod number of nodes).
+*/
+enum CPUAffinityPolicy {
+	CORE_PER_PARTITION,
+	NODE_PER_PARTITION,
+	UNKNOWN_AFFINITY_POLICY
+};
+static const char* cpuAffinityPolicy_string[] = {
+	"one core per partition", "one NUMA node per partition", "Unknown affinity policy"
+};
+
+
 /*!
  * \brief computing backend
  * 
@@ -205,6 +249,42 @@ static const char* spikeMonMode_string[] = {
 	"SpikeCount Mode","SpikeTime Mode"
 };
 
+/*!
+ * \brief spike file formats
+ *
+ * SpikeMonitors can write their spike files in two formats (see CARLsim::setSpikeFileFormat and SpikeFileReader).
+ * SPIKE_FILE_FLAT:    (spike time, neuron ID) pairs of ints (version 0.2).
+ * SPIKE_FILE_CHUNKED: Compressed chunks of spikes with a chunk index at the end of the file (version 0.3). A time
+ *                     window can be read without scanning the whole file.
+ */
+enum SpikeFileFormat {
+	SPIKE_FILE_FLAT,    //!< (time, neuron ID) pairs of ints
+	SPIKE_FILE_CHUNKED  //!< compressed, indexed chunks
+};
+static const char* spikeFileFormat_string[] = {
+	"flat spike file", "chunked spike file"
+};
+
+/*!
+ * \brief connection file formats
+ *
+ * ConnectionMonitors can write their weight snapshots in three formats (see CARLsim::setConnectFileFormat).
+ * CONNECT_FILE_DENSE:        Every snapshot is the full pre x post weight matrix, NAN for non-existent synapses
+ *                            (version 0.3).
+ * CONNECT_FILE_SPARSE:       The (pre, post) neuron IDs of all synapses are listed once after the header, every
+ *                            snapshot contains one weight per synapse (version 0.4).
+ * CONNECT_FILE_SPARSE_DELTA: Like CONNECT_FILE_SPARSE, but every snapshot contains only the weights that have
+ *                            changed since the last snapshot in the file (version 0.4).
+ */
+enum ConnectFileFormat {
+	CONNECT_FILE_DENSE,        //!< full weight matrix per snapshot
+	CONNECT_FILE_SPARSE,       //!< one weight per synapse per snapshot
+	CONNECT_FILE_SPARSE_DELTA  //!< changed weights per snapshot
+};
+static const char* connectFileFormat_string[] = {
+	"dense connect file", "sparse connect file", "sparse delta connect file"
+};
+
 /*!
  * \brief GroupMonitor flag
  *
@@ -265,6 +345,84 @@ static const char* carlsimState_string[] = {
 	"Configuration state", "Setup state", "Run state"
 };
 
+/*!
+ * \brief phases of a simulation step measured by the profiler
+ *
+ * Every ms, CARLsim::runNetwork steps all partitions through the phases PROFILER_STP_DECAY to
+ * PROFILER_CLEAR_EXT_FIRING (in that order). Weights are updated every wtANDwtChangeUpdateInterval ms, and monitors
+ * are updated once per second. Spike counts are only fetched when queried, e.g. by CARLsim::runNetwork printing a
+ * run summary (PROFILER_SPIKE_COUNT).
+ * At the end of every second, the spike tables are shifted (PROFILER_SHIFT_SPIKE_TABLES).
+ * \see CARLsim::getPerformanceReport
+ */
+enum ProfilerPhase {
+	PROFILER_STP_DECAY,          //!< short-term plasticity update and conductance decay
+	PROFILER_SPIKE_GENERATOR,    //!< Poisson and user-defined spike generators
+	PROFILER_FIND_FIRING,        //!< finding the neurons that fired
+	PROFILER_TIMING_TABLE,       //!< updating the spike timing tables
+	PROFILER_ROUTE_SPIKES,       //!< routing spikes between partitions
+	PROFILER_CURRENT_UPDATE,     //!< delivering spikes to post-synaptic neurons
+	PROFILER_STATE_UPDATE,       //!< integrating the neuron state
+	PROFILER_CLEAR_EXT_FIRING,   //!< clearing the external firing tables
+	PROFILER_UPDATE_WEIGHTS,     //!< applying weight changes of plastic synapses
+	PROFILER_SPIKE_MONITOR,      //!< updating SpikeMonitors
+	PROFILER_GROUP_MONITOR,      //!< updating GroupMonitors
+	PROFILER_CONNECTION_MONITOR, //!< updating ConnectionMonitors
+	PROFILER_NEURON_MONITOR,     //!< updating NeuronMonitors
+	PROFILER_SPIKE_COUNT,        //!< fetching the spike counts of a group on query
+	PROFILER_SHIFT_SPIKE_TABLES, //!< shiftSpikeTables
+	NUM_PROFILER_PHASES          //!< number of profiler phases
+};
+static const char* profilerPhase_string[] = {
+	"doSTPUpdateAndDecayCond", "spikeGeneratorUpdate", "findFiring", "updateTimingTable", "routeSpikes",
+	"doCurrentUpdate", "globalStateUpdate", "clearExtFiringTable", "updateWeights", "SpikeMonitor", "GroupMonitor",
+	"ConnectionMonitor", "NeuronMonitor", "fetchNeuronSpikeCount", "shiftSpikeTables"
+};
+
+/*!
+ * \brief stages of CARLsim::setupNetwork measured by the setup timer
+ *
+ * The stages are nested: SETUP_PARTITION contains SETUP_CONNECT, which contains one SETUP_CONNECT_* stage per
+ * connection, and SETUP_GENERATE_RUNTIME contains SETUP_CONNECTION_RUNTIME and SETUP_ALLOCATE of every partition.
+ * \see CARLsim::getSetupReport
+ */
+enum SetupStage {
+	SETUP_COMPILE,               //!< compiling the group and connection configs (compileSNN)
+	SETUP_PARTITION,             //!< assigning groups and connections to partitions (partitionSNN)
+	SETUP_CONNECT,               //!< generating the synapses of all connections (connectNetwork)
+	SETUP_CONNECT_RANDOM,        //!< "random" connections
+	SETUP_CONNECT_FULL,          //!< "full" and "full-no-direct" connections
+	SETUP_CONNECT_GAUSSIAN,      //!< "gaussian" connections
+	SETUP_CONNECT_ONE_TO_ONE,    //!< "one-to-one" connections
+	SETUP_CONNECT_USER_DEFINED,  //!< connections defined by a ConnectionGenerator
+	SETUP_CONNECT_SHARED_KERNEL, //!< weight-sharing (convolutional) connections
+	SETUP_GENERATE_RUNTIME,      //!< building the runtime data of all partitions (generateRuntimeSNN)
+	SETUP_CONNECTION_RUNTIME,    //!< building the synapse tables of a partition (generateConnectionRuntime)
+	SETUP_ALLOCATE,              //!< allocating and copying the runtime data of a partition (allocateSNN)
+	NUM_SETUP_STAGES             //!< number of setup stages
+};
+static const char* setupStage_string[] = {
+	"compileSNN", "partitionSNN", "connectNetwork", "connectRandom", "connectFull", "connectGaussian",
+	"connectOneToOne", "connectUserDefined", "connectSharedKernel", "generateRuntimeSNN", "generateConnectionRuntime",
+	"allocateSNN"
+};
+
+/*!
+ * \brief hardware performance counters measured per profiler phase
+ *
+ * \see CARLsim::setHardwareCounters
+ */
+enum HardwareCounter {
+	HW_INSTRUCTIONS,   //!< retired instructions
+	HW_CYCLES,         //!< CPU cycles
+	HW_LLC_MISSES,     //!< last-level cache misses
+	HW_BRANCH_MISSES,  //!< mispredicted branches
+	NUM_HW_COUNTERS    //!< number of hardware counters
+};
+static const char* hardwareCounter_string[] = {
+	"instructions", "cycles", "LLC misses", "branch misses"
+};
+
 /*!
  * \brief a range struct for synaptic delays
  *
@@ -451,6 +609,162 @@ typedef struct GroupNeuromodulatorInfo_s {
 	float		decayNE;		//!< decay rate for Noradrenaline
 } GroupNeuromodulatorInfo;
 
+/*!
+ * \brief A struct for retrieving the number of hot-path events processed by a partition
+ *
+ * The counters are kept by the CPU runtime, so that throughput (e.g., synaptic events per second) and efficiency
+ * per core can be computed together with the times of a PerformanceReport. GPU partitions are not instrumented.
+ *
+ * \sa PerformanceReport
+ * \since v4.0
+ */
+struct EventCounts {
+	EventCounts() : synEvents(0), ltpEvals(0), ltdEvals(0), extSpikesRouted(0), spikesDropped(0), poissonDraws(0) {}
+
+	EventCounts& operator+=(const EventCounts& rhs) {
+		synEvents += rhs.synEvents;
+		ltpEvals += rhs.ltpEvals;
+		ltdEvals += rhs.ltdEvals;
+		extSpikesRouted += rhs.extSpikesRouted;
+		spikesDropped += rhs.spikesDropped;
+		poissonDraws += rhs.poissonDraws;
+		return *this;
+	}
+
+	long long synEvents;        //!< spikes delivered to post-synaptic neurons (doCurrentUpdate)
+	long long ltpEvals;         //!< STDP evaluations when a post-synaptic neuron fires (LTP)
+	long long ltdEvals;         //!< STDP evaluations when a pre-synaptic spike arrives (LTD)
+	long long extSpikesRouted;  //!< spikes received from other partitions
+	long long spikesDropped;    //!< spikes dropped because the firing table was full
+	long long poissonDraws;     //!< random numbers drawn for Poisson spike generators
+};
+
+/*!
+ * \brief A struct for retrieving the wall-clock time spent in each phase of the simulation
+ *
+ * CARLsim::getPerformanceReport returns the times accumulated over all calls to CARLsim::runNetwork so far.
+ * phaseTimeMs measures every phase from the manager thread, including the time to launch and join the worker
+ * threads of CPU partitions. partitionTimeMs measures the work done by each CPU partition within a phase, so that
+ * load imbalance between partitions can be spotted. GPU partitions only contribute to phaseTimeMs.
+ *
+ * The event counters (see EventCounts) of every CPU partition are listed in the same order as partitionNames.
+ *
+ * If hardware counters were enabled with CARLsim::setHardwareCounters (and could be opened), phaseHwCounts holds the
+ * hardware events (see ::HardwareCounter) of the phases of advSimStep and updateWeights, summed over the manager and
+ * all CPU worker threads. E.g., the IPC of a phase is phaseHwCounts[phase][HW_INSTRUCTIONS] /
+ * phaseHwCounts[phase][HW_CYCLES].
+ *
+ * If CARLsim was compiled with CARLSIM_NO_PROFILING, all times except runTimeMs are zero (enabled is false), but the
+ * event counters are still filled in.
+ *
+ * \sa CARLsim::getPerformanceReport()
+ * \sa ProfilerPhase
+ * \since v4.0
+ */
+struct PerformanceReport {
+	PerformanceReport() : enabled(false), numSteps(0), runTimeMs(0.0), hwCountersEnabled(false) {
+		for (int i = 0; i < NUM_PROFILER_PHASES; i++) {
+			phaseTimeMs[i] = 0.0;
+			phaseCalls[i] = 0;
+			for (int j = 0; j < NUM_HW_COUNTERS; j++)
+				phaseHwCounts[i][j] = 0;
+		}
+	}
+
+	bool enabled;                                       //!< whether the profiler was compiled in
+	long long numSteps;                                 //!< number of simulated ms
+	double runTimeMs;                                   //!< wall-clock time (ms) spent in CARLsim::runNetwork
+	double phaseTimeMs[NUM_PROFILER_PHASES];            //!< wall-clock time (ms) spent in each phase
+	long long phaseCalls[NUM_PROFILER_PHASES];          //!< number of times each phase was run
+	std::vector<std::string> partitionNames;            //!< name of every CPU partition, e.g. "CPU 0"
+	std::vector<std::vector<double> > partitionTimeMs;  //!< [partition][phase] time (ms) spent by a partition
+	std::vector<EventCounts> partitionEvents;           //!< events counted by every CPU partition so far
+	std::vector<EventCounts> partitionEventsLastSec;    //!< events counted in the last complete simulated second
+	EventCounts events;                                 //!< events counted by all partitions so far
+	bool hwCountersEnabled;                             //!< whether hardware counters were measured
+	long long phaseHwCounts[NUM_PROFILER_PHASES][NUM_HW_COUNTERS]; //!< hardware events of each phase
+};
+
+/*!
+ * \brief memory held by one array (or one family of arrays) of a partition
+ *
+ * \sa MemoryReport
+ * \since v4.0
+ */
+struct MemoryUsage {
+	MemoryUsage(const std::string& _partition, const std::string& _array, size_t _bytes) : partition(_partition),
+		array(_array), bytes(_bytes) {}
+
+	std::string partition; //!< "manager", "CPU 0", "CPU 1", ..., "GPU 0", ..., "monitors" or "setup"
+	std::string array;     //!< name of the array (e.g., "wt" or "firingTableD2")
+	size_t bytes;          //!< number of bytes
+};
+
+/*!
+ * \brief A struct for retrieving the memory footprint of a network
+ *
+ * CARLsim::getMemoryReport lists every runtime array of the manager and of every CPU partition, the buffers of all
+ * monitors, and the setup-phase temporaries (connectivity lists, which are released at the end of
+ * CARLsim::setupNetwork). peakRssBytes is the peak resident set size of the process at the end of
+ * CARLsim::setupNetwork, as reported by the operating system.
+ *
+ * CARLsim::estimateMemory returns the same breakdown before anything is allocated. The estimate is computed from the
+ * group sizes and the expected number of synapses of every connection (isEstimate is true, and peakRssBytes is 0).
+ *
+ * \sa CARLsim::getMemoryReport()
+ * \sa CARLsim::estimateMemory()
+ * \since v4.0
+ */
+struct MemoryReport {
+	MemoryReport() : isEstimate(false), peakRssBytes(0) {}
+
+	//! returns the number of bytes of a partition (or of all partitions, if partition is empty)
+	size_t getBytes(const std::string& partition="") const {
+		size_t bytes = 0;
+		for (size_t i = 0; i < arrays.size(); i++)
+			if (partition.empty() || arrays[i].partition == partition)
+				bytes += arrays[i].bytes;
+		return bytes;
+	}
+
+	bool isEstimate;                 //!< whether this is a dry-run estimate
+	std::vector<MemoryUsage> arrays; //!< per-partition, per-array breakdown
+	size_t peakRssBytes;             //!< peak resident set size at the end of setupNetwork (0 if unknown)
+};
+
+/*!
+ * \brief A struct for retrieving the wall-clock time spent in each stage of CARLsim::setupNetwork
+ *
+ * CARLsim::getSetupReport returns the time of every stage (see ::SetupStage) summed over all its calls, e.g. over all
+ * "random" connections for SETUP_CONNECT_RANDOM. stageSynapses counts the synapses generated by the SETUP_CONNECT_*
+ * stages (it is 0 for the other stages). stagePeakRssBytes is the peak resident set size of the process at the end of
+ * the last call of a stage, so that the stage that drives up the memory footprint can be spotted; it is 0 if the
+ * operating system does not report it.
+ *
+ * The setup timer is always on: it reads the clock a few times per connection and partition.
+ *
+ * \sa CARLsim::getSetupReport()
+ * \sa SetupStage
+ * \since v4.0
+ */
+struct SetupReport {
+	SetupReport() : setupTimeMs(0.0), peakRssBytes(0) {
+		for (int i = 0; i < NUM_SETUP_STAGES; i++) {
+			stageTimeMs[i] = 0.0;
+			stageCalls[i] = 0;
+			stageSynapses[i] = 0;
+			stagePeakRssBytes[i] = 0;
+		}
+	}
+
+	double setupTimeMs;                          //!< wall-clock time (ms) spent in CARLsim::setupNetwork
+	double stageTimeMs[NUM_SETUP_STAGES];        //!< wall-clock time (ms) spent in each stage
+	long long stageCalls[NUM_SETUP_STAGES];      //!< number of times each stage was run
+	long long stageSynapses[NUM_SETUP_STAGES];   //!< synapses generated by each connection stage
+	size_t stagePeakRssBytes[NUM_SETUP_STAGES];  //!< peak resident set size at the end of each stage
+	size_t peakRssBytes;                         //!< peak resident set size at the end of setupNetwork
+};
+
 /*!
  * \brief A struct to arrange neurons on a 3D grid (a primitive cubic Bravais lattice with cubic side length 1)
  *
@@ -186,6 +186,49 @@ public:
 			radRF, mulSynFast, mulSynSlow, synWtType);
 	}
 
+	// weight-sharing (convolutional) connection
+	short int connect(int grpId1, int grpId2, const Grid3D& kernelSize, const std::vector<float>& kernel, float maxWt,
+		const RangeDelay& delay, bool synWtType, float mulSynFast, float mulSynSlow)
+	{
+		std::string funcName = "connect(\""+getGroupName(grpId1)+"\",\""+getGroupName(grpId2)+"\")";
+		std::stringstream grpId1str; grpId1str << "Group Id " << grpId1;
+		std::stringstream grpId2str; grpId2str << "Group Id " << grpId2;
+		UserErrors::assertTrue(grpId1!=ALL, UserErrors::ALL_NOT_ALLOWED, funcName, grpId1str.str()); // grpId can't be ALL
+		UserErrors::assertTrue(grpId2!=ALL, UserErrors::ALL_NOT_ALLOWED, funcName, grpId2str.str());
+		UserErrors::assertTrue(!isPoissonGroup(grpId2), UserErrors::WRONG_NEURON_TYPE, funcName, grpId2str.str() +
+			" is PoissonGroup, connect");
+		UserErrors::assertTrue(kernelSize.numX%2==1 && kernelSize.numY%2==1 && kernelSize.numZ%2==1,
+			UserErrors::MUST_BE_SET_TO, funcName, "Every dimension of kernelSize", "an odd number");
+		UserErrors::assertTrue(kernel.size()==kernelSize.N, UserErrors::MUST_BE_IDENTICAL, funcName,
+			"kernel.size() and kernelSize.N");
+		UserErrors::assertTrue(maxWt>=0.0f, UserErrors::CANNOT_BE_NEGATIVE, funcName, "maxWt");
+		for (int i=0; i<kernel.size(); i++) {
+			UserErrors::assertTrue(kernel[i]>=0.0f, UserErrors::CANNOT_BE_NEGATIVE, funcName, "kernel weights");
+			UserErrors::assertTrue(kernel[i]<=maxWt, UserErrors::CANNOT_BE_LARGER, funcName, "kernel weights", "maxWt");
+		}
+		UserErrors::assertTrue(delay.min>0, UserErrors::MUST_BE_POSITIVE, funcName, "delay.min");
+		UserErrors::assertTrue(mulSynFast>=0.0f, UserErrors::CANNOT_BE_NEGATIVE, funcName, "mulSynFast");
+		UserErrors::assertTrue(mulSynSlow>=0.0f, UserErrors::CANNOT_BE_NEGATIVE, funcName, "mulSynSlow");
+
+		UserErrors::assertTrue(carlsimState_==CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+		assert(++numConnections_ <= MAX_CONN_PER_SNN);
+
+		// groups cannot be both chemically (synaptically) and electrically (compartmentally) connected
+		UserErrors::assertTrue(std::find(connComp_[grpId1].begin(), connComp_[grpId1].end(), grpId2) ==
+			connComp_[grpId1].end(), UserErrors::CANNOT_BE_CONN_SYN_AND_COMP, funcName,
+			grpId1str.str() + " and " + grpId2str.str());
+		UserErrors::assertTrue(std::find(connComp_[grpId2].begin(), connComp_[grpId2].end(), grpId1) ==
+			connComp_[grpId2].end(), UserErrors::CANNOT_BE_CONN_SYN_AND_COMP, funcName,
+			grpId1str.str() + " and " + grpId2str.str());
+
+		// add synaptic connection to 2D matrix
+		connSyn_[grpId1].push_back(grpId2);
+
+		return snn_->connect(grpId1, grpId2, kernelSize, kernel, maxWt, delay.min, delay.max, mulSynFast, mulSynSlow,
+			synWtType);
+	}
+
 	// custom connectivity profile
 	short int connect(int grpId1, int grpId2, ConnectionGenerator* conn, bool synWtType) {
 		std::string funcName = "connect(\""+getGroupName(grpId1)+"\",\""+getGroupName(grpId2)+"\")";
@@ -558,6 +601,50 @@ public:
 		//std::cout << "numStepsPerMs is (in interface): " + numStepsPerMs << std::endl;
 	}
 
+	// sets the memory layout of neurons within their groups (CREATION_ORDER, HILBERT_ORDER)
+	void setNeuronOrdering(NeuronOrdering ordering) {
+		std::string funcName = "setNeuronOrdering()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+		UserErrors::assertTrue(ordering != UNKNOWN_ORDERING, UserErrors::CANNOT_BE_UNKNOWN, funcName, "ordering");
+
+		snn_->setNeuronOrdering(ordering);
+	}
+
+	// sets the policy that places the worker threads of CPU partitions on cores
+	void setCPUAffinityPolicy(CPUAffinityPolicy policy) {
+		std::string funcName = "setCPUAffinityPolicy()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+		UserErrors::assertTrue(policy != UNKNOWN_AFFINITY_POLICY, UserErrors::CANNOT_BE_UNKNOWN, funcName, "policy");
+
+		snn_->setCPUAffinityPolicy(policy);
+	}
+
+	// restricts the worker threads of a CPU partition to a list of cores
+	void setCPUAffinity(int partition, const std::vector<int>& cores) {
+		std::string funcName = "setCPUAffinity()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+		UserErrors::assertTrue(partition >= 0 && partition < MAX_NET_PER_SNN - CPU_RUNTIME_BASE,
+			UserErrors::MUST_BE_IN_RANGE, funcName, "partition", "[0, number of CPU partitions)");
+		UserErrors::assertTrue(cores.size() > 0, UserErrors::CANNOT_BE_ZERO, funcName, "cores.size()");
+		for (size_t i = 0; i < cores.size(); i++)
+			UserErrors::assertTrue(cores[i] >= 0, UserErrors::CANNOT_BE_NEGATIVE, funcName, "cores");
+
+		snn_->setCPUAffinity(partition, cores);
+	}
+
+	// caches the connectivity of the compiled network in a file
+	void setNetworkImage(const std::string& fileName) {
+		std::string funcName = "setNetworkImage()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+		UserErrors::assertTrue(fileName.length() > 0, UserErrors::CANNOT_BE_ZERO, funcName, "fileName.length()");
+
+		snn_->setNetworkImage(fileName);
+	}
+
 	// set neuron parameters for Izhikevich neuron, with standard deviations
 	void setNeuronParameters(int grpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd,
 		float izh_c, float izh_c_sd, float izh_d, float izh_d_sd)
@@ -894,6 +981,33 @@ public:
 		fclose(fpSave);
 	}
 
+	void saveCheckpoint(const std::string& fileName, bool blocking) {
+		std::string funcName = "saveCheckpoint()";
+		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
+		UserErrors::assertTrue(fileName.length() > 0, UserErrors::CANNOT_BE_ZERO, funcName, "fileName.length()");
+
+		snn_->saveCheckpoint(fileName, blocking);
+	}
+
+	void loadCheckpoint(const std::string& fileName) {
+		std::string funcName = "loadCheckpoint()";
+		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
+		UserErrors::assertTrue(fileName.length() > 0, UserErrors::CANNOT_BE_ZERO, funcName, "fileName.length()");
+
+		snn_->loadCheckpoint(fileName);
+	}
+
+	void setCheckpointInterval(int intervalMs, const std::string& fileName) {
+		std::string funcName = "setCheckpointInterval()";
+		UserErrors::assertTrue(intervalMs >= 0, UserErrors::CANNOT_BE_NEGATIVE, funcName, "intervalMs");
+		UserErrors::assertTrue(intervalMs == 0 || fileName.length() > 0, UserErrors::CANNOT_BE_ZERO, funcName,
+			"fileName.length()");
+
+		snn_->setCheckpointInterval(intervalMs, fileName);
+	}
+
 	void setLogFile(const std::string& fileName) {
 		std::string funcName = "setLogFile("+fileName+")";
 		UserErrors::assertTrue(loggerMode_!=CUSTOM,UserErrors::CANNOT_BE_SET_TO, funcName, "Logger mode", "CUSTOM");
@@ -1012,6 +1126,41 @@ public:
 	return snn_->setConnectionMonitor(grpIdPre, grpIdPost, fid);
 }
 
+	// set the format of connection files
+	void setConnectFileFormat(ConnectFileFormat format) {
+		std::string funcName = "setConnectFileFormat()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE || carlsimState_ == SETUP_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "CONFIG or SETUP.");
+
+		snn_->setConnectFileFormat(format);
+	}
+
+	// enable hardware counters per simulation phase
+	void setHardwareCounters(bool enable) {
+		std::string funcName = "setHardwareCounters()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE || carlsimState_ == SETUP_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "CONFIG or SETUP.");
+
+		snn_->setHardwareCounters(enable);
+	}
+
+	// record sampled simulation steps into a Chrome trace file
+	void setTraceFile(const std::string& fileName, int sampleIntervalMs, int maxEventsPerThread) {
+		std::string funcName = "setTraceFile(\""+fileName+"\")";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE || carlsimState_ == SETUP_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "CONFIG or SETUP.");
+		UserErrors::assertTrue(sampleIntervalMs > 0, UserErrors::MUST_BE_POSITIVE, funcName, "sampleIntervalMs");
+		UserErrors::assertTrue(maxEventsPerThread > 0, UserErrors::MUST_BE_POSITIVE, funcName, "maxEventsPerThread");
+
+		FILE* fid = fopen(fileName.c_str(), "w");
+		if (fid == NULL) {
+			std::string fileError = " Double-check file permissions and make sure directory exists.";
+			UserErrors::assertTrue(false, UserErrors::FILE_CANNOT_OPEN, funcName, fileName, fileError);
+		}
+
+		snn_->setTraceFile(fid, sampleIntervalMs, maxEventsPerThread);
+	}
+
 	void setExternalCurrent(int grpId, const std::vector<float>& current) {
 		std::string funcName = "setExternalCurrent(\""+getGroupName(grpId)+"\")";
 		UserErrors::assertTrue(grpId!=ALL, UserErrors::ALL_NOT_ALLOWED, funcName, "grpId");
@@ -1085,6 +1234,26 @@ public:
 		snn_->setSpikeGenerator(grpId, SGC);
 	}
 
+	// set how spike files are buffered
+	void setSpikeFileBuffering(int bufferSizeKB, bool flushEverySecond) {
+		std::string funcName = "setSpikeFileBuffering()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE || carlsimState_ == SETUP_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "CONFIG or SETUP.");
+		UserErrors::assertTrue(bufferSizeKB > 0, UserErrors::MUST_BE_POSITIVE, funcName, "bufferSizeKB");
+
+		snn_->setSpikeFileBuffering(bufferSizeKB, flushEverySecond);
+	}
+
+	// set the format of spike files
+	void setSpikeFileFormat(SpikeFileFormat format, int chunkLengthMs) {
+		std::string funcName = "setSpikeFileFormat()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE || carlsimState_ == SETUP_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "CONFIG or SETUP.");
+		UserErrors::assertTrue(chunkLengthMs > 0, UserErrors::MUST_BE_POSITIVE, funcName, "chunkLengthMs");
+
+		snn_->setSpikeFileFormat(format, chunkLengthMs);
+	}
+
 	// set spike monitor for group and write spikes to file
 	SpikeMonitor* setSpikeMonitor(int grpId, const std::string& fileName) {
 		std::string funcName = "setSpikeMonitor(\""+getGroupName(grpId)+"\",\""+fileName+"\")";
@@ -1159,6 +1328,24 @@ public:
 		return snn_->setNeuronMonitor(grpId, fid);
 	}
 
+	// stream a subset of neurons to the neuron state file
+	void setNeuronMonitorSampling(int grpId, const std::vector<int>& neurIds, int strideMs) {
+		std::string funcName = "setNeuronMonitorSampling(\"" + getGroupName(grpId) + "\")";
+		UserErrors::assertTrue(grpId != ALL, UserErrors::ALL_NOT_ALLOWED, funcName, "grpId");
+		UserErrors::assertTrue(grpId >= 0, UserErrors::CANNOT_BE_NEGATIVE, funcName, "grpId");
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "CONFIG.");
+		UserErrors::assertTrue(snn_->getNeuronMonitor(grpId) != NULL, UserErrors::CANNOT_BE_NULL, funcName,
+			"NeuronMonitor", "Call setNeuronMonitor first.");
+		UserErrors::assertTrue(strideMs > 0, UserErrors::MUST_BE_POSITIVE, funcName, "strideMs");
+		for (size_t i = 0; i < neurIds.size(); i++) {
+			UserErrors::assertTrue(neurIds[i] >= 0 && neurIds[i] < getGroupNumNeurons(grpId),
+				UserErrors::MUST_BE_IN_RANGE, funcName, "neurIds", "[0, number of neurons in the group)");
+		}
+
+		snn_->setNeuronMonitorSampling(grpId, neurIds, strideMs);
+	}
+
 	// assign spike rate to poisson group
 	void setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod) {
 		std::string funcName = "setSpikeRate()";
@@ -1349,6 +1536,16 @@ public:
 		return snn_->getNumSynapticConnections(connectionId);
 	}
 
+	std::vector<float> getSharedKernel(short int connectionId) {
+		std::stringstream funcName;	funcName << "getSharedKernel(" << connectionId << ")";
+		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName.str(), funcName.str(), "SETUP or RUN.");
+		UserErrors::assertTrue(connectionId!=ALL, UserErrors::ALL_NOT_ALLOWED, funcName.str(), "connectionId");
+		UserErrors::assertTrue(connectionId>=0 && connectionId<getNumConnections(), UserErrors::MUST_BE_IN_RANGE,
+			funcName.str(), "connectionId", "[0,getNumConnections()]");
+		return snn_->getSharedKernel(connectionId);
+	}
+
 	int getNumSynapses() {
 		std::string funcName = "getNumSynapses()";
 		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
@@ -1372,6 +1569,34 @@ public:
 		return snn_->getGroupNeuromodulatorInfo(grpId);
 	}
 
+	PerformanceReport getPerformanceReport() {
+		std::string funcName = "getPerformanceReport()";
+		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
+		return snn_->getPerformanceReport();
+	}
+
+	MemoryReport getMemoryReport() {
+		std::string funcName = "getMemoryReport()";
+		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
+		return snn_->getMemoryReport();
+	}
+
+	MemoryReport estimateMemory() {
+		std::string funcName = "estimateMemory()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName,
+			funcName, "CONFIG.");
+		return snn_->estimateMemory();
+	}
+
+	SetupReport getSetupReport() {
+		std::string funcName = "getSetupReport()";
+		UserErrors::assertTrue(carlsimState_ == SETUP_STATE || carlsimState_ == RUN_STATE,
+			UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName, "SETUP or RUN.");
+		return snn_->getSetupReport();
+	}
+
 	int getSimTime() { return snn_->getSimTime(); }
 	int getSimTimeSec() { return snn_->getSimTimeSec(); }
 	int getSimTimeMsec() { return snn_->getSimTimeMs(); }
@@ -1741,6 +1966,12 @@ short int CARLsim::connect(int grpId1, int grpId2, const std::string& connType,
 	return _impl->connect(grpId1, grpId2, connType, wt, connProb, delay, radRF, synWtType, mulSynFast, mulSynSlow);
 }
 
+// connect with a shared (convolutional) kernel
+short int CARLsim::connect(int grpId1, int grpId2, const Grid3D& kernelSize, const std::vector<float>& kernel,
+		float maxWt, const RangeDelay& delay, bool synWtType, float mulSynFast, float mulSynSlow) {
+	return _impl->connect(grpId1, grpId2, kernelSize, kernel, maxWt, delay, synWtType, mulSynFast, mulSynSlow);
+}
+
 // connect with custom ConnectionGenerator (short)
 // TODO: don't need two versions of this... make it (grpId1, grpId2, conn, synWtType, mulSynFast, mulSynSlow)
 short int CARLsim::connect(int grpId1, int grpId2, ConnectionGenerator* conn, bool synWtType) {
@@ -1811,6 +2042,22 @@ void CARLsim::setIntegrationMethod(integrationMethod_t method, int numStepsPerMs
 	_impl->setIntegrationMethod(method, numStepsPerMs);
 }
 
+void CARLsim::setNeuronOrdering(NeuronOrdering ordering) {
+	_impl->setNeuronOrdering(ordering);
+}
+
+void CARLsim::setCPUAffinityPolicy(CPUAffinityPolicy policy) {
+	_impl->setCPUAffinityPolicy(policy);
+}
+
+void CARLsim::setCPUAffinity(int partition, const std::vector<int>& cores) {
+	_impl->setCPUAffinity(partition, cores);
+}
+
+void CARLsim::setNetworkImage(const std::string& fileName) {
+	_impl->setNetworkImage(fileName);
+}
+
 // set neuron params
 void CARLsim::setNeuronParameters(int grpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd, float izh_c, 
 	float izh_c_sd, float izh_d, float izh_d_sd)
@@ -1923,6 +2170,18 @@ void CARLsim::saveSimulation(const std::string& fileName, bool saveSynapseInfo)
 	_impl->saveSimulation(fileName, saveSynapseInfo);
 }
 
+void CARLsim::saveCheckpoint(const std::string& fileName, bool blocking) {
+	_impl->saveCheckpoint(fileName, blocking);
+}
+
+void CARLsim::loadCheckpoint(const std::string& fileName) {
+	_impl->loadCheckpoint(fileName);
+}
+
+void CARLsim::setCheckpointInterval(int intervalMs, const std::string& fileName) {
+	_impl->setCheckpointInterval(intervalMs, fileName);
+}
+
 // Sets the name of the log file
 void CARLsim::setLogFile(const std::string& fileName) { _impl->setLogFile(fileName); }
 
@@ -1950,6 +2209,16 @@ ConnectionMonitor* CARLsim::setConnectionMonitor(int grpIdPre, int grpIdPost, co
 	return _impl->setConnectionMonitor(grpIdPre, grpIdPost, fname);
 }
 
+void CARLsim::setConnectFileFormat(ConnectFileFormat format) {
+	_impl->setConnectFileFormat(format);
+}
+
+void CARLsim::setHardwareCounters(bool enable) { _impl->setHardwareCounters(enable); }
+
+void CARLsim::setTraceFile(const std::string& fileName, int sampleIntervalMs, int maxEventsPerThread) {
+	_impl->setTraceFile(fileName, sampleIntervalMs, maxEventsPerThread);
+}
+
 // Sets the amount of current (mA) to inject into a group
 void CARLsim::setExternalCurrent(int grpId, const std::vector<float>& current) {
 	_impl->setExternalCurrent(grpId, current);
@@ -1973,11 +2242,23 @@ SpikeMonitor* CARLsim::setSpikeMonitor(int grpId, const std::string& fileName) {
 	return _impl->setSpikeMonitor(grpId, fileName);
 }
 
+void CARLsim::setSpikeFileBuffering(int bufferSizeKB, bool flushEverySecond) {
+	_impl->setSpikeFileBuffering(bufferSizeKB, flushEverySecond);
+}
+
+void CARLsim::setSpikeFileFormat(SpikeFileFormat format, int chunkLengthMs) {
+	_impl->setSpikeFileFormat(format, chunkLengthMs);
+}
+
 // Sets a Neuron Monitor for a groups, prints neuron state values (voltage, recovery, and total current values) to binary file
 NeuronMonitor* CARLsim::setNeuronMonitor(int grpId, const std::string& fileName) {
 	return _impl->setNeuronMonitor(grpId, fileName);
 }
 
+void CARLsim::setNeuronMonitorSampling(int grpId, const std::vector<int>& neurIds, int strideMs) {
+	_impl->setNeuronMonitorSampling(grpId, neurIds, strideMs);
+}
+
 // Sets a spike rate
 void CARLsim::setSpikeRate(int grpId, PoissonRate* spikeRate, int refPeriod) {
 	_impl->setSpikeRate(grpId, spikeRate, refPeriod);
@@ -2038,6 +2319,7 @@ int CARLsim::getMaxNumCompConnections() { return _impl->getMaxNumCompConnections
 
 // returns the number of connections associated with a connection ID
 int CARLsim::getNumSynapticConnections(short int connectionId) { return _impl->getNumSynapticConnections(connectionId); }
+std::vector<float> CARLsim::getSharedKernel(short int connectionId) { return _impl->getSharedKernel(connectionId); }
 
 // returns the number of groups in the network
 int CARLsim::getNumGroups() { return _impl->getNumGroups(); }
@@ -2083,6 +2365,14 @@ GroupNeuromodulatorInfo CARLsim::getGroupNeuromodulatorInfo(int grpId) {
 	return _impl->getGroupNeuromodulatorInfo(grpId);
 }
 
+PerformanceReport CARLsim::getPerformanceReport() { return _impl->getPerformanceReport(); }
+
+MemoryReport CARLsim::getMemoryReport() { return _impl->getMemoryReport(); }
+
+MemoryReport CARLsim::estimateMemory() { return _impl->estimateMemory(); }
+
+SetupReport CARLsim::getSetupReport() { return _impl->getSetupReport(); }
+
 int CARLsim::getSimTime() { return _impl->getSimTime(); }
 
 int CARLsim::getSimTimeSec() { return _impl->getSimTimeSec(); }
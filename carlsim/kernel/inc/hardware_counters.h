@@ -0,0 +1,113 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+#ifndef _HARDWARE_COUNTERS_H_
+#define _HARDWARE_COUNTERS_H_
+
+#include <carlsim_datastructures.h> // HardwareCounter, NUM_HW_COUNTERS
+#include <string>
+
+
+/*!
+ * \brief Hardware performance counters of the simulation threads (Linux perf_event)
+ *
+ * HardwareCounters::open attaches one counter per HardwareCounter to the calling thread as a single perf event
+ * group, with the inherit flag set, so that every thread the calling thread creates afterwards is counted as well.
+ * The group is always scheduled onto the PMU as a whole and read with one system call, so the values belong to the
+ * same interval. If the PMU is shared with other events, the values are scaled by time enabled / time running.
+ *
+ * Since the CPU runtime creates and joins its worker threads within every phase, the difference of two
+ * HardwareCounters::read calls around a phase (in the manager thread) covers the manager and the workers of that
+ * phase. This is approximate: pthread_join returns as soon as a worker has released its thread id, which happens
+ * before the kernel folds the worker's counts into the inherited counters on exit. Counts that are folded in after
+ * the read that ends a phase are attributed to the next phase, so per-phase deltas of the workers can leak into the
+ * following phase.
+ *
+ * Only user-space events are counted. Opening fails gracefully (see HardwareCounters::getErrorMessage) if the
+ * platform is not Linux, if perf access is not permitted (kernel.perf_event_paranoid), or if the hardware events are
+ * not available (e.g., in some virtual machines).
+ *
+ * \since v4.0
+ */
+class HardwareCounters {
+public:
+	HardwareCounters();
+	~HardwareCounters();
+
+	/*!
+	 * \brief opens the counters for the calling thread and all threads it creates from now on
+	 * \returns true on success; on failure, all counters are closed and getErrorMessage explains why
+	 */
+	bool open();
+
+	//! closes all counters
+	void close();
+
+	//! returns whether the counters are open
+	bool isOpen() { return isOpen_; }
+
+	//! returns the reason why open failed
+	const std::string& getErrorMessage() { return errorMessage_; }
+
+	/*!
+	 * \brief reads the current value of all counters (events since open, scaled if the group was multiplexed)
+	 * \returns false if the counters are not open or could not be read, in which case all values are zero
+	 */
+	bool read(long long values[NUM_HW_COUNTERS]);
+
+private:
+	// no copies
+	HardwareCounters(const HardwareCounters&);
+	HardwareCounters& operator=(const HardwareCounters&);
+
+	int fd_[NUM_HW_COUNTERS];
+	bool isOpen_;
+	std::string errorMessage_;
+};
+
+#endif
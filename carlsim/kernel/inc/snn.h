@@ -88,6 +88,8 @@
 
 #include <snn_definitions.h>
 #include <snn_datastructures.h>
+#include <snn_profiler.h>
+#include <snn_tracer.h>
 
 // #include <spike_buffer.h>
 #include <poisson_rate.h>
@@ -100,6 +102,7 @@ class ConnectionMonitorCore;
 class ConnectionMonitor;
 
 class SpikeBuffer;
+class SpikeFileWriter;
 
 
 /// **************************************************************************************************************** ///
@@ -132,6 +135,11 @@ public:
 	 */
 	~SNN();
 
+	//! SNN holds cache-line aligned members (see CACHE_LINE_ALIGNED), which the global operator new only respects
+	//! since C++17
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr);
+
 	// +++++ PUBLIC PROPERTIES ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 
 	const static unsigned int MAJOR_VERSION = 4; //!< major release version, as in CARLsim X
@@ -175,6 +183,18 @@ public:
 	short int connect(int gIDpre, int gIDpost, ConnectionGeneratorCore* conn, float mulSynFast, float mulSynSlow,
 		bool synWtType);
 
+	/* Creates weight-sharing (convolutional) synaptic projections backed by a single kernel.
+	 *
+	 * Every post-synaptic neuron applies the same kernel, indexed by the Grid3D offset between the (scaled) pre-
+	 * and the post-neuron location. Kernel entries are weight magnitudes, zero entries create no synapse.
+	 * \param kernelSize the extent of the kernel (must be odd in every dimension)
+	 * \param kernel the kernel weights, x varies fastest, then y, then z
+	 * \param maxWt upper bound on weight strength of every kernel weight
+	 * \return ID of the created connection
+	 */
+	short int connect(int gIDpre, int gIDpost, const Grid3D& kernelSize, const std::vector<float>& kernel, float maxWt,
+		uint8_t minDelay, uint8_t maxDelay, float mulSynFast, float mulSynSlow, bool synWtType);
+
 	/* Creates synaptic projections using a callback mechanism.
 	*
 	* \param _grpId1:ID lower layer group
@@ -244,6 +264,24 @@ public:
 	//! Sets the integration method and the number of integration steps per 1ms simulation time step
 	void setIntegrationMethod(integrationMethod_t method, int numStepsPerMs);
 
+	//! Sets the memory layout of neurons within their groups (see generateNeuronOrder)
+	void setNeuronOrdering(NeuronOrdering ordering);
+
+	//! Sets the policy that places the worker threads of CPU partitions on cores (see assignCPUAffinity)
+	void setCPUAffinityPolicy(CPUAffinityPolicy policy);
+
+	//! Restricts the worker threads of a CPU partition to a list of cores
+	void setCPUAffinity(int partition, const std::vector<int>& cores);
+
+	//! Sets the file that caches the connectivity of the compiled network (see loadNetworkImage)
+	void setNetworkImage(const std::string& fileName);
+
+	//! Sets the buffer size of spike files and whether the buffers are handed to the I/O thread every second
+	void setSpikeFileBuffering(int bufferSizeKB, bool flushEverySecond);
+
+	//! Sets the format of spike files opened from now on, and the time covered by a chunk of chunked spike files
+	void setSpikeFileFormat(SpikeFileFormat format, int chunkLengthMs);
+
 	//! Sets the Izhikevich parameters a, b, c, and d of a neuron group.
 	/*!
 	 * \brief Parameter values for each neuron are given by a normal distribution with mean _a, _b, _c, _d and standard deviation _a_sd, _b_sd, _c_sd, and _d_sd, respectively
@@ -428,6 +466,15 @@ public:
 	 */
 	ConnectionMonitor* setConnectionMonitor(int grpIdPre, int grpIdPost, FILE* fid);
 
+	//! Sets the format of connection files opened from now on
+	void setConnectFileFormat(ConnectFileFormat format) { connectFileFormat_ = format; }
+
+	//! enables hardware counters per phase; they are opened at the beginning of the next runNetwork
+	void setHardwareCounters(bool enable);
+
+	//! records sampled simulation steps into a Chrome trace file (see SimTracer), which is closed by the SNN
+	void setTraceFile(FILE* fp, int sampleIntervalMs, int maxEventsPerThread);
+
 	//! injects current (mA) into the soma of every neuron in the group
 	void setExternalCurrent(int grpId, const std::vector<float>& current);
 
@@ -450,6 +497,9 @@ public:
 	*/
 	NeuronMonitor* setNeuronMonitor(int gid, FILE* fid);
 
+	//! streams the state of a subset of neurons of a group with a NeuronMonitor to its file every strideMs ms
+	void setNeuronMonitorSampling(int gGrpId, const std::vector<int>& neurIds, int strideMs);
+
 	//!Sets the Poisson spike rate for a group. For information on how to set up spikeRate, see Section Poisson spike generators in the Tutorial.
 	/*!Input arguments:
 	 * \param grpId ID of the neuron group
@@ -497,12 +547,34 @@ public:
 	*/
 	void updateNeuronMonitor(int grpId = ALL);
 
+	/*!
+	* \brief drains the ring buffers of sampling NeuronMonitors to their files
+	*
+	* Called every time step by runNetwork. A group is drained before its ring buffer wraps around, or in any case if
+	* force is true.
+	*/
+	void updateNeuronMonitorStreams(bool force);
+
 	//! stores the pre and post synaptic neuron ids with the weight and delay
 	/*
 	 * \param fid file pointer
 	 */
 	void saveSimulation(FILE* fid, bool saveSynapseInfo = false);
 
+	/*!
+	 * \brief stores the complete dynamic state of the network in a checkpoint file
+	 *
+	 * The state is copied into a snapshot buffer at the current step boundary. The file is written by a background
+	 * thread (to fileName.tmp, then renamed), so that the simulation only stalls for the copy, unless blocking is set.
+	 */
+	void saveCheckpoint(const std::string& fileName, bool blocking);
+
+	//! restores the dynamic state of the network from a checkpoint file written by saveCheckpoint
+	void loadCheckpoint(const std::string& fileName);
+
+	//! takes a checkpoint every intervalMs during runNetwork (0 disables periodic checkpoints)
+	void setCheckpointInterval(int intervalMs, const std::string& fileName);
+
 	//! function writes population weights from gIDpre to gIDpost to file fname in binary.
 	//void writePopWeights(std::string fname, int gIDpre, int gIDpost);
 
@@ -550,6 +622,18 @@ public:
 	GroupSTDPInfo getGroupSTDPInfo(int grpId);
 	GroupNeuromodulatorInfo getGroupNeuromodulatorInfo(int grpId);
 
+	//! returns the wall-clock time spent in each phase of all runNetwork calls so far
+	PerformanceReport getPerformanceReport();
+
+	//! returns the memory held by the manager, every partition, all monitors, and the setup temporaries
+	MemoryReport getMemoryReport();
+
+	//! estimates getMemoryReport() from the network configuration, before anything is allocated
+	MemoryReport estimateMemory();
+
+	//! returns the wall-clock time and the peak RSS of each stage of setupNetwork
+	SetupReport getSetupReport();
+
 	LoggerMode getLoggerMode() { return loggerMode_; }
 
 	// get functions for GroupInfo
@@ -588,6 +672,14 @@ public:
 	//! Should not be exposed to user interface
 	SpikeMonitorCore* getSpikeMonitorCore(int grpId);
 
+	//! Returns the writer of all spike files, which is created on first use.
+	//! Should not be exposed to user interface
+	SpikeFileWriter* getSpikeFileWriter();
+
+	SpikeFileFormat getSpikeFileFormat() { return spikeFileFormat_; }
+	int getSpikeFileChunkLength() { return spikeFileChunkLengthMs_; }
+	ConnectFileFormat getConnectFileFormat() { return connectFileFormat_; }
+
 	//! Returns pointer to existing NeuronMonitor object, NULL else
 	NeuronMonitor* getNeuronMonitor(int grpId);
 
@@ -600,6 +692,15 @@ public:
 
 	std::vector< std::vector<float> > getWeightMatrix2D(short int connId);
 
+	//! returns the weights of all synapses of a connection in coordinate format (pre-synaptic neuron ID,
+	//! post-synaptic neuron ID, weight). The synapses are listed in the order they are stored in, which does not
+	//! change over the course of a simulation, so that the weights of two calls can be compared element-wise.
+	void getWeightsSparse(short int connId, std::vector<int>& preIds, std::vector<int>& postIds,
+		std::vector<float>& weights);
+
+	//! returns the (current) weights of a shared-kernel connection, in the layout given to connect
+	std::vector<float> getSharedKernel(short int connId);
+
 	std::vector<float> getConductanceAMPA(int grpId);
 	std::vector<float> getConductanceNMDA(int grpId);
 	std::vector<float> getConductanceGABAa(int grpId);
@@ -645,6 +746,9 @@ public:
 	// **************************************************************************************************************** //
 
 private:
+	//! times the CPU kernels on the runtime data of a set-up network (see carlsim/benchmark/kernel_benchmark.cpp)
+	friend class KernelBenchmark;
+
 	//! all unsafe operations of constructor
 	void SNNinit();
 
@@ -661,6 +765,21 @@ private:
 	void generateConnectionRuntime(int netId);
 	void generateCompConnectionRuntime(int netId);
 
+	/*!
+	 * \brief renumbers the neurons of each eligible group in a local network according to neuronOrdering_
+	 *
+	 * The group boundaries (lStartN, lEndN) are not changed, only the neurons within a group are permuted. Must be
+	 * called before generateConnectionRuntime, which builds the synaptic connectivity on the renumbered IDs.
+	 */
+	void generateNeuronOrder(int netId);
+
+	//! maps a local neuron ID in creation order to its renumbered local ID
+	int renumberLNId(int netId, int lNId) { return neuronRenumber[netId].empty() ? lNId : neuronRenumber[netId][lNId]; }
+	//! maps a renumbered local neuron ID back to its local ID in creation order
+	int restoreLNId(int netId, int lNId) { return neuronRenumberInv[netId].empty() ? lNId : neuronRenumberInv[netId][lNId]; }
+	//! maps a global neuron ID of group gGrpId to the global position its state is fetched to
+	int renumberGNId(int gGrpId, int gNId);
+
 	/*!
 	 * \brief scan all GroupConfigs and ConnectConfigs for generating the configuration of a local network
 	 */
@@ -688,6 +807,42 @@ private:
 	void connectRandom(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
 	void connectGaussian(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
 	void connectUserDefined(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
+	void connectSharedKernel(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
+	void generateSharedKernelConfig(int netId, const ConnectConfig& connConfig);
+	void generateSharedKernelGridPos(int netId);
+
+	//! returns the index into kernelWt of a shared-kernel synapse, given by the grid offset of pre relative to post
+	int getSharedKernelIdx(int netId, short int connId, int lNIdPre, int lNIdPost) {
+		const ConnectConfigRT& kernelConfig = connectConfigs[netId][connId];
+		const int* posPre = &sharedKernelGridPos[netId][3 * lNIdPre];
+		const int* posPost = &sharedKernelGridPos[netId][3 * lNIdPost];
+		return kernelConfig.kernelCenter
+			+ (sharedKernelGridMap[kernelConfig.kernelGridMapZ + posPre[2]] - posPost[2]) * kernelConfig.kernelStrideZ
+			+ (sharedKernelGridMap[kernelConfig.kernelGridMapY + posPre[1]] - posPost[1]) * kernelConfig.kernelStrideY
+			+ (sharedKernelGridMap[kernelConfig.kernelGridMapX + posPre[0]] - posPost[0]);
+	}
+	void connectLoaded(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
+
+	/*!
+	 * \brief maps the network image and restores the result of connectNetwork from it
+	 *
+	 * Returns false (and leaves the network untouched) if no image file was set, the file does not exist, or it was
+	 * written for a different configuration, in which case the connectivity has to be generated by connectNetwork.
+	 * On success, the mapping stays open until generateRuntimeSNN has copied the connectivity of every local network.
+	 */
+	bool loadNetworkImage();
+	void loadNetworkImageConnections(int netId); //!< copies the connectivity of a local network from the image
+	void writeNetworkImageHeader();              //!< writes the header and partition section of a new image
+	void writeNetworkImageConnections(int netId);//!< appends the connectivity of a local network to a new image
+	void closeNetworkImage();
+	uint64_t computeNetworkConfigHash();         //!< hashes every configuration item the connectivity depends on
+
+	void collectCheckpointArrays_CPU(int netId, std::vector<CheckpointArray>& arrays); //!< dynamic state of a CPU runtime
+	uint64_t computeStaticStateHash();    //!< hashes the connectivity and neuron parameters, which a checkpoint does not contain
+	void takeCheckpointSnapshot(std::vector<char>& buffer); //!< serializes the dynamic state into buffer
+	void joinCheckpointWriter();          //!< waits for the background write of the last checkpoint to finish
+	void writeCheckpointBuffer();         //!< writes the snapshot buffer of the pending checkpoint to its file
+	static void* helperWriteCheckpoint(void*);
 
 	void deleteObjects();			//!< deallocates all used data structures in snn_cpu.cpp
 
@@ -757,7 +912,10 @@ private:
 	void printStatusSpikeMonitor(int gGrpId = ALL);
 	void printSikeRoutingInfo();
 
-	int loadSimulation_internal(bool onlyPlastic);
+	//! reads the header, group, and synapse sections of the file passed to loadSimulation (see connectLoaded)
+	void loadSimulation_internal();
+	//! writes the synapses of a partition as contiguous arrays, grouped by connection
+	void saveSimulationSynapses(FILE* fid, int netId);
 
 	void resetConductances(int netId);
 	void resetCurrent(int netId);
@@ -785,6 +943,9 @@ private:
 	void startTiming();
 	void stopTiming();
 
+	void reduceEventCounters(); //!< adds the event counters of the last second to the totals
+	void dumpTrace();           //!< appends the events recorded during runNetwork to the trace file
+
 	void generateUserDefinedSpikes();
 
 	void allocateManagerSpikeTables();
@@ -806,6 +967,7 @@ private:
 	void resetSpikeCnt(int gGrpId);
 	void shiftSpikeTables();
 	void spikeGeneratorUpdate();
+	void updateSpikeMonitorPartition(int netId, int gGrpId); //!< demultiplexes the spikes of a partition to its SpikeMonitors
 	void updateTimingTable();
 	void updateWeights();
 	void updateNetworkConfig(int netId);
@@ -822,6 +984,8 @@ private:
 	// Abstract layer for trasferring data (local-to-local copy)
 	void fetchSpikeTables(int netId);
 	void fetchNeuronStateBuffer(int netId, int lGrpId);
+	void fetchNeuronStreamBuffer(int netId, int lGrpId);
+	void fillNeuronStreamSlots(int netId, int* slots);
 	void fetchGroupState(int netId, int lGrpId);
 	void fetchWeightState(int netId, int lGrpId);
 	void fetchGrpIdsLookupArray(int netId);
@@ -903,6 +1067,7 @@ private:
 	void copyGroupState(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, cudaMemcpyKind kind, bool allocateMem);
 	void copyNeuronState(int netId, int lGrpId, RuntimeData* dest, cudaMemcpyKind kind, bool allocateMem);
 	void copyNeuronStateBuffer(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, cudaMemcpyKind kind, bool allocateMem);
+	void copyNeuronStreamBuffer(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, cudaMemcpyKind kind, bool allocateMem);
 	void copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, cudaMemcpyKind kind, bool allocateMem, int destOffset);
 	void copySynapseState(int netId, RuntimeData* dest, RuntimeData* src, cudaMemcpyKind kind, bool allocateMem);
 	void copySTPState(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, cudaMemcpyKind kind, bool allocateMem);
@@ -938,6 +1103,7 @@ private:
 	void copyGroupState(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, cudaMemcpyKind kind, bool allocateMem) { assert(false); }
 	void copyNeuronState(int netId, int lGrpId, RuntimeData* dest, cudaMemcpyKind kind, bool allocateMem) { assert(false); }
 	void copyNeuronStateBuffer(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, cudaMemcpyKind kind, bool allocateMem) { assert(false); }
+	void copyNeuronStreamBuffer(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, cudaMemcpyKind kind, bool allocateMem) { assert(false); }
 	void copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, cudaMemcpyKind kind, bool allocateMem, int destOffset) { assert(false); }
 	void copySynapseState(int netId, RuntimeData* dest, RuntimeData* src, cudaMemcpyKind kind, bool allocateMem) { assert(false); }
 	void copySTPState(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, cudaMemcpyKind kind, bool allocateMem) { assert(false); }
@@ -960,6 +1126,25 @@ private:
 	//allocates runtime data on CPU memory
 	void allocateSNN_CPU(int netId); 
 
+	//! decides on which cores the worker threads of each CPU runtime run (fills runtimeCores)
+	void assignCPUAffinity();
+
+	// single-region memory management of CPU runtime data
+	size_t computeRuntimeArenaSize_CPU(int netId);
+	void allocateRuntimeArena_CPU(int netId);
+	void* carveRuntimeArena_CPU(int netId, size_t bytes);
+	void freeRuntimeArena_CPU(int netId);
+
+	//! hands out an array of length elements from the arena of CPU runtime netId, accounted under name
+	template<typename T> T* allocateRuntimeArray_CPU(int netId, size_t length, const char* name) {
+		runtimeArrayBytes[netId][name] += sizeof(T) * length;
+		return static_cast<T*>(carveRuntimeArena_CPU(netId, sizeof(T) * length));
+	}
+
+	//! lists the runtime arrays (and their sizes) that allocateSNN_CPU allocates for a local network config
+	void listRuntimeArrays_CPU(const NetworkConfigRT& config, const std::vector<int>& extFiringGroupSizes,
+		bool withFixedWts, const std::string& partition, std::vector<MemoryUsage>& arrays);
+
 	// runNetwork functions - multithreaded in LINUX using pthreads
 #if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 	void assignPoissonFiringRate_CPU(int netId);
@@ -1003,6 +1188,10 @@ private:
 	static void* helperDoCurrentUpdateD1_CPU(void*);
 	static void* helperDoSTPUpdateAndDecayCond_CPU(void*);
 	static void* helperDeleteRuntimeData_CPU(void*);
+	static void* helperTouchRuntimeArena_CPU(void*);
+
+	//! restricts a thread that is about to be created for CPU runtime netId to the cores of that runtime
+	void setThreadAffinity_CPU(int netId, pthread_attr_t* attr);
 	static void* helperFindFiring_CPU(void*);
 	static void* helperGlobalStateUpdate_CPU(void*);
 	static void* helperResetSpikeCnt_CPU(void*);
@@ -1024,6 +1213,7 @@ private:
 	void copyNeuronParameters(int netId, int lGrpId, RuntimeData* dest, bool allocateMem);	
 	void copyGroupState(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, bool allocateMem);
 	void copyNeuronStateBuffer(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, bool allocateMem);
+	void copyNeuronStreamBuffer(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, bool allocateMem);
 	void copyNeuronState(int netId, int lGrpId, RuntimeData* dest, bool allocateMem);	
 	void copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, bool allocateMem, int destOffset);	
 	void copySynapseState(int netId, RuntimeData* dest, RuntimeData* src, bool allocateMem);	
@@ -1051,6 +1241,16 @@ private:
 	SNNState snnState; //!< state of the network
 	FILE* loadSimFID;
 
+	// synapses read from a saveSimulation file, consumed by connectNetwork
+	std::vector<int> loadedSynPreIds;
+	std::vector<int> loadedSynPostIds;
+	std::vector<float> loadedSynWt;
+	std::vector<float> loadedSynMaxWt;
+	std::vector<uint8_t> loadedSynDelay;
+	std::vector<uint8_t> loadedSynPlastic;
+	std::map<int, std::pair<int, int> > loadedSynRange; //!< connId to (first synapse, number of synapses)
+	std::vector<float> loadedKernelWt[MAX_NET_PER_SNN];  //!< saved kernels of shared-kernel connections, per partition
+
 	const std::string networkName_;	//!< network name
 	const LoggerMode loggerMode_;	//!< current logger mode (USER, DEVELOPER, SILENT, CUSTOM)
 	const SimMode preferredSimMode_;//!< preferred simulation mode
@@ -1089,9 +1289,62 @@ private:
 	float 		*mulSynFast;	//!< scaling factor for fast synaptic currents, per connection
 	float 		*mulSynSlow;	//!< scaling factor for slow synaptic currents, per connection
 
+	//! weight magnitudes of all shared-kernel connections, indexed by ConnectConfig::kernelOffset
+	std::vector<float> sharedKernelTable;
+	//! post-grid coordinate of every pre-grid coordinate (x, then y, then z), indexed by ConnectConfig::kernelGridMapOffset
+	std::vector<int> sharedKernelGridMap;
+	//! grid coordinates (x,y,z) of every local neuron within its group, only filled if there are shared kernels
+	std::vector<int> sharedKernelGridPos[MAX_NET_PER_SNN];
+
+	// locality-aware neuron ordering
+	NeuronOrdering neuronOrdering_; //!< the memory layout of neurons within their groups
+	std::vector<int> neuronRenumber[MAX_NET_PER_SNN];    //!< creation-order local ID to renumbered local ID, empty if identity
+	std::vector<int> neuronRenumberInv[MAX_NET_PER_SNN]; //!< renumbered local ID to creation-order local ID, empty if identity
+
+	// placement of CPU worker threads
+	CPUAffinityPolicy cpuAffinityPolicy_;              //!< placement of partitions without explicit core list
+	std::vector<int> cpuAffinityUser_[MAX_NET_PER_SNN]; //!< core lists set by the user, empty if none
+	std::vector<int> runtimeCores[MAX_NET_PER_SNN];     //!< cores the worker threads of a CPU runtime may run on
+
+	// cached network image
+	std::string networkImageFileName_; //!< file name of the network image, empty if disabled
+	FILE* networkImageFid;             //!< image that is being written during generateRuntimeSNN, NULL otherwise
+	char* networkImage;                //!< mapped image that is being loaded during setupNetwork, NULL otherwise
+	size_t networkImageSize;
+	size_t networkImageNetOffset[MAX_NET_PER_SNN]; //!< byte offset of the connectivity of each local network
+
+	// checkpoints
+	int checkpointIntervalMs_;            //!< periodic checkpoint interval during runNetwork, 0 if disabled
+	std::string checkpointFileName_;      //!< file of the periodic checkpoints
+	std::vector<char> checkpointBuffer[2];//!< double-buffered snapshots, one can be written while the other is filled
+	int checkpointBufferId;               //!< index of the snapshot buffer used by the pending checkpoint
+	std::string checkpointWriteFileName;  //!< file of the pending checkpoint
+	bool checkpointWriterActive;          //!< true if a background thread is writing the pending checkpoint
+	pthread_t checkpointWriter;
+	uint64_t staticStateHash;             //!< cached result of computeStaticStateHash, 0 if not computed yet
+
+	//! arrays of a CPU runtime that did not fit into its arena, released together with the arena
+	std::vector<void*> runtimeArenaSpill[MAX_NET_PER_SNN];
+
+	//! bytes handed out by allocateRuntimeArray_CPU per CPU runtime and array name (see getMemoryReport)
+	std::map<std::string, size_t> runtimeArrayBytes[MAX_NET_PER_SNN];
+	//! bytes handed out by allocateManagerArray per array name (see getMemoryReport)
+	std::map<std::string, size_t> managerArrayBytes;
+	size_t setupTempBytes;  //!< bytes held by connectionLists[] before they are turned into runtime data
+	size_t peakSetupRssBytes; //!< peak RSS of the process at the end of setupNetwork
+	SetupReport setupReport_;   //!< time spent in each stage of setupNetwork (see getSetupReport)
+
 	//! Buffer to store spikes
 	SpikeBuffer* spikeBuf;
 
+	// spike files
+	SpikeFileWriter* spikeFileWriter; //!< writes the spike files of all SpikeMonitors on an I/O thread, NULL if unused
+	int spikeFileBufferSizeKB_;       //!< size of the buffer of each spike file
+	bool spikeFileFlushEverySecond_;  //!< whether spike files are handed to the I/O thread every second (else: when full)
+	SpikeFileFormat spikeFileFormat_; //!< format of spike files opened from now on
+	int spikeFileChunkLengthMs_;      //!< time covered by a chunk of a chunked spike file
+	ConnectFileFormat connectFileFormat_; //!< format of connection files opened from now on
+
 	bool sim_with_conductances; //!< flag to inform whether we run in COBA mode (true) or CUBA mode (false)
 	bool sim_with_NMDA_rise;    //!< a flag to inform whether to compute NMDA rise time
 	bool sim_with_GABAb_rise;   //!< a flag to inform whether to compute GABAb rise time
@@ -1131,6 +1384,23 @@ private:
 	float prevExecutionTime;
 	float executionTime;
 
+	//! profiler counters (see snn_profiler.h), all times in ns
+	unsigned long long profRunTimeNs_;                                          //!< time spent in runNetwork
+	long long profNumSteps_;                                                    //!< number of simulated ms
+	unsigned long long profPhaseTimeNs_[NUM_PROFILER_PHASES];                   //!< time per phase (manager)
+	long long profPhaseCalls_[NUM_PROFILER_PHASES];                             //!< number of calls per phase
+	ProfilerPartitionTimes profPartitionTimeNs_[MAX_NET_PER_SNN];              //!< time per partition and phase
+	bool hwCountersRequested_;                                                  //!< set by setHardwareCounters
+	HardwareCounters* hwCounters_;                                              //!< NULL unless opened successfully
+	long long profPhaseHwCounts_[NUM_PROFILER_PHASES][NUM_HW_COUNTERS];         //!< hardware events per phase
+	SimTracer* tracer_;                                                         //!< NULL unless setTraceFile was called
+	long long traceNumOverwritten_;                                             //!< overwritten events reported so far
+
+	//! hot-path event counters of every partition, reduced into eventCountsTotal_ at the end of every second
+	EventCounterCell eventCounters_[MAX_NET_PER_SNN];
+	EventCounts eventCountsTotal_[MAX_NET_PER_SNN];   //!< events of all completed seconds
+	EventCounts eventCountsLastSec_[MAX_NET_PER_SNN]; //!< events of the last completed second
+
 	FILE*	fpInf_; //!< fp of where to write all simulation output (status info) if not in silent mode
 	FILE*	fpErr_; //!< fp of where to write all errors if not in silent mode
 	FILE*	fpDeb_; //!< fp of where to write all debug info if not in silent mode
@@ -1180,16 +1450,28 @@ private:
 		int maxNumPostSynNet;
 		int maxNumPreSynNet;
 		int maxNumNPerGroup;
+		int maxNumNeuronMonSlots;
+		int maxNumNeuronMonStreamFloats;
 		int glbNumN;
 		int glbNumNReg;
 	} ManagerRuntimeDataSize;
 
 	ManagerRuntimeDataSize managerRTDSize;
 
+	//! allocates an array of the manager runtime data and records its size (see getMemoryReport)
+	template<typename T> T* allocateManagerArray(size_t length, const char* name) {
+		managerArrayBytes[name] += sizeof(T) * length;
+		return new T[length];
+	}
+
+	//! lists the arrays (and their sizes) that allocateManagerSpikeTables and allocateManagerRuntimeData allocate
+	void listManagerArrays(const ManagerRuntimeDataSize& size, int maxDelay, int numKernelWt,
+		std::vector<MemoryUsage>& arrays);
+
 	// runtime configurations
 	NetworkConfigRT networkConfigs[MAX_NET_PER_SNN]; //!< the network configs used on GPU(s);
 	GroupConfigRT	groupConfigs[MAX_NET_PER_SNN][MAX_GRP_PER_SNN];
-	ConnectConfigRT connectConfigs[MAX_NET_PER_SNN][MAX_CONN_PER_SNN]; //!< for future use
+	ConnectConfigRT connectConfigs[MAX_NET_PER_SNN][MAX_CONN_PER_SNN]; //!< indexed by global connId, only the shared-kernel geometry is in use
 
 	// weight update parameter
 	int wtANDwtChangeUpdateInterval_;
@@ -71,7 +71,7 @@ enum MemType {
 };
 
 //! connection types, used internally (externally it's a string)
-enum conType_t { CONN_RANDOM, CONN_ONE_TO_ONE, CONN_FULL, CONN_FULL_NO_DIRECT, CONN_GAUSSIAN, CONN_USER_DEFINED, CONN_UNKNOWN};
+enum conType_t { CONN_RANDOM, CONN_ONE_TO_ONE, CONN_FULL, CONN_FULL_NO_DIRECT, CONN_GAUSSIAN, CONN_USER_DEFINED, CONN_SHARED_KERNEL, CONN_UNKNOWN};
 
 //! the state of spiking neural network, used with in kernel.
 enum SNNState {
@@ -132,6 +132,8 @@ typedef struct ConnectConfig_s {
 	ConnectionGeneratorCore* conn;
 	conType_t                type;
 	float                    connProbability; //!< connection probability
+	int                      kernelOffset; //!< offset of the shared kernel in SNN::sharedKernelTable, -1 if none
+	int                      kernelGridMapOffset; //!< offset of the pre-to-post grid maps in SNN::sharedKernelGridMap, -1 if none
 	short int                connId; //!< connectID of the element in the linked list
 	int                      numberOfConnections; // ToDo: move to ConnectConfigMD
 } ConnectConfig;
@@ -161,6 +163,14 @@ typedef struct ConnectConfigMD_s {
 typedef struct ConnectConfigRT_s {
 	float* mulSynFast; //!< factor to be applied to either gAMPA or gGABAa
 	float* mulSynSlow; //!< factor to be applied to either gNMDA or gGABAb
+
+	// shared-kernel connection: a synapse whose pre-neuron is offset by (dX,dY,dZ) post-grid units from its post-neuron
+	// uses kernelWt[kernelCenter + dZ*kernelStrideZ + dY*kernelStrideY + dX] \sa getSharedKernelIdx
+	int kernelOffset;  //!< offset of the kernel in RuntimeData::kernelWt, -1 if the synapses own their weights
+	int kernelCenter;  //!< index of the kernel center in RuntimeData::kernelWt
+	int kernelStrideY; //!< kernel stride along y (x is contiguous)
+	int kernelStrideZ; //!< kernel stride along z
+	int kernelGridMapX, kernelGridMapY, kernelGridMapZ; //!< offsets of the pre-to-post grid maps in SNN::sharedKernelGridMap
 } ConnectConfigRT;
 
 typedef struct compConnectionInfo_s {
@@ -399,6 +409,15 @@ typedef struct GroupConfigRT_s {
 	bool         hasExternalConnect;//!< published by GroupConfigMD \sa GroupConfigMD
 	int          Noffset;           //!< the offset of spike generator (poisson) neurons [0, numNPois), published by GroupConfigMD \sa GroupConfigMD
 	int8_t       MaxDelay;          //!< published by GroupConfigMD \sa GroupConfigMD
+	int          neuronMonitorSlot; //!< slot of the group in nVBuffer, nUBuffer, nIBuffer, -1 if the group has no NeuronMonitor
+	int          neuronMonitorStreamOffset; //!< offset of the group in nStreamBuffer, -1 if the group has no sampling NeuronMonitor
+	int          neuronMonitorStreamFirstN; //!< first sampled neuron (0-indexed within the group)
+	int          neuronMonitorStreamRangeN; //!< number of neurons from neuronMonitorStreamFirstN on that have an entry in nStreamSlot
+	int          neuronMonitorStreamSlotOffset; //!< offset of the group in nStreamSlot
+	int          neuronMonitorStreamNumN;   //!< number of sampled neurons, i.e. the width of a sample in nStreamBuffer
+	int          neuronMonitorStreamStride; //!< sampling interval (ms) of a sampling NeuronMonitor
+	int          neuronMonitorStreamWindow; //!< number of samples nStreamBuffer can hold for the group before it wraps around
+	bool         hasGroupMonitor;   //!< true if the group state is logged to grpDABuffer for a GroupMonitor
 
 	float        STP_A;             //!< published by GroupConfig \sa GroupConfig
 	float        STP_U;             //!< published by GroupConfig \sa GroupConfig
@@ -505,6 +524,10 @@ typedef struct RuntimeData_s {
 	MemType memType;
 	bool allocated; //!< true if all data has been allocated
 
+	char* arena;      //!< single aligned region holding all arrays of a CPU runtime (NULL for GPU runtimes)
+	size_t arenaSize; //!< size of the arena in bytes
+	size_t arenaUsed; //!< number of bytes already handed out from the arena
+
 	/* Tsodyks & Markram (1998), where the short-term dynamics of synapses is characterized by three parameters:
 	   U (which roughly models the release probability of a synaptic vesicle for the first spike in a train of spikes),
 	   maxDelay_ (time constant for recovery from depression), and F (time constant for recovery from facilitation). */
@@ -529,6 +552,12 @@ typedef struct RuntimeData_s {
 	short int* connIdsPreIdx; //!< connectId, per synapse, presynaptic cumulative indexing
 	short int* grpIds;
 
+	// shared-kernel (weight-sharing) connections, only allocated if numKernelWt > 0
+	// the synapses of these connections do not use wt, their kernel entry follows from the pre/post Grid3D offset
+	float* kernelWt;       //!< weights of all shared kernels, signed like wt
+	float* kernelWtChange; //!< accumulated weight change of each kernel weight
+	float* kernelMaxWt;    //!< maximum weight of each kernel weight, signed like maxSynWt
+
 	/*!
 	 * \brief 10 bit syn id, 22 bit neuron id, ordered based on delay
 	 *
@@ -583,6 +612,8 @@ typedef struct RuntimeData_s {
 	float* nVBuffer;
 	float* nUBuffer;
 	float* nIBuffer;
+	float* nStreamBuffer; //!< ring buffer of sampled (v, u, I) records of sampling NeuronMonitors
+	int* nStreamSlot;     //!< index of a neuron within the samples of its sampling NeuronMonitor, -1 if it is not sampled
 
 	unsigned int* spikeGenBits;
 #ifndef __NO_CUDA__
@@ -590,6 +621,12 @@ typedef struct RuntimeData_s {
 #endif
 } RuntimeData;
 
+//! a runtime array that is part of the dynamic state of a network, as stored in a checkpoint
+typedef struct CheckpointArray_s {
+	void* data;  //!< pointer to the first element
+	size_t size; //!< size of the array in bytes
+} CheckpointArray;
+
 typedef struct GlobalNetworkConfig_s {
 	GlobalNetworkConfig_s() : numN(0), numNReg(0), numNPois(0),
 							  numNExcReg(0), numNInhReg(0), numNExcPois(0), numNInhPois(0),
@@ -655,6 +692,7 @@ typedef struct NetworkConfigRT_s  {
 	int numGroups;        //!< number of local groups in this local network
 	int numGroupsAssigned; //!< number of groups assigned to this local network
 	int numConnections;   //!< number of local connections in this local network
+	int numKernelWt;      //!< total number of shared-kernel weights, 0 if there is no shared-kernel connection
 	//int numAssignedConnections; //!< number of connections assigned to this local network
 
 	// configurations for execution features
@@ -670,6 +708,9 @@ typedef struct NetworkConfigRT_s  {
 	// please note that spike monitor and connection monitor don't need this flag because no extra buffer is required
 	// for neuron monitor, the kernel allocates extra buffers to store v, u, i values of each monitored neuron
 	bool sim_with_nm; // simulation with neuron monitor
+	int numNeuronMonSlots; //!< number of groups with a NeuronMonitor, each one owns a slot in nVBuffer, nUBuffer, nIBuffer
+	int numNeuronMonStreamFloats; //!< size of nStreamBuffer, which holds the ring buffers of all sampling NeuronMonitors
+	int numNeuronMonStreamSlots;  //!< size of nStreamSlot
 
 	// stdp, da-stdp configurations
 	float stdpScaleFactor;
@@ -728,4 +769,24 @@ typedef struct ThreadStruct_s {
 	int GtoLOffset;
 } ThreadStruct;
 
+/*!
+ * \brief wall-clock time (ns) a partition spent in each profiler phase
+ *
+ * A row is only written by the thread that runs its partition. Rows are aligned to (and thus sized in multiples of)
+ * a cache line so that partitions running in parallel do not share one.
+ */
+typedef struct CACHE_LINE_ALIGNED ProfilerPartitionTimes_s {
+	unsigned long long timeNs[NUM_PROFILER_PHASES];
+} ProfilerPartitionTimes;
+
+/*!
+ * \brief hot-path event counters of a partition
+ *
+ * A cell is only written by the thread that runs its partition (or by the manager thread in between). Cells are
+ * aligned to (and thus sized in multiples of) a cache line so that partitions running in parallel do not share one.
+ */
+typedef struct CACHE_LINE_ALIGNED EventCounterCell_s {
+	EventCounts counts;
+} EventCounterCell;
+
 #endif
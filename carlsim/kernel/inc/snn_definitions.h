@@ -140,6 +140,30 @@
 
 #define NUM_CPU_CORES sysconf(_SC_NPROCESSORS_ONLN)
 
+#define RUNTIME_ARENA_ALIGNMENT 64 // every CPU runtime array starts on its own cache line
+
+// counters that the worker threads of different partitions write in parallel are kept on separate cache lines
+#define CACHE_LINE_SIZE 64
+#if defined(_MSC_VER)
+	#define CACHE_LINE_ALIGNED __declspec(align(CACHE_LINE_SIZE))
+#else
+	#define CACHE_LINE_ALIGNED __attribute__((aligned(CACHE_LINE_SIZE)))
+#endif
+#define RUNTIME_ARENA_HUGEPAGE (2 * 1024 * 1024) // arenas of at least this size are aligned for transparent huge pages
+
+#define NETWORK_IMAGE_SIGNATURE 0x434E494D // "CNIM", identifies network image files (see SNN::setNetworkImage)
+#define NETWORK_IMAGE_VERSION 1
+
+#define SPIKE_FILE_BUFFER_SIZE_KB 256 // default size of the buffer of a spike file (see SNN::setSpikeFileBuffering)
+#define SPIKE_FILE_SIGNATURE 206661989 // identifies spike files (see SpikeFileReader)
+#define SPIKE_FILE_VERSION_FLAT 0.2f // (time, neuron ID) pairs of ints
+#define SPIKE_FILE_VERSION_CHUNKED 0.3f // compressed chunks with a trailing chunk index
+#define SPIKE_FILE_INDEX_SIGNATURE 0x58444E49 // "INDX", ends the chunk index of a chunked spike file
+#define SPIKE_FILE_CHUNK_LENGTH_MS 1000 // default time covered by a chunk (see SNN::setSpikeFileFormat)
+
+#define CHECKPOINT_SIGNATURE 0x434B5043 // "CPKC", identifies checkpoint files (see SNN::saveCheckpoint)
+#define CHECKPOINT_VERSION 1
+
 #define GPU_RUNTIME_BASE 0
 
 #define COND_INTEGRATION_SCALE	2
@@ -162,6 +186,7 @@
 #define MAX_NEURON_MON_BUFFER_SIZE 52428800 // about 50 MB. size is in bytes. (???)
 #define LONG_NEURON_MON_DURATION 100000       // about 100 seconds
 #define MAX_NEURON_MON_GRP_SZIE 128
+#define NEURON_MON_STREAM_BUFFER_SIZE 4194304 // about 4 MB. size is in bytes. Max ring buffer size of a sampling NeuronMonitor.
 
 // This flag is used when having a common poisson generator for both CPU and GPU simulation
 // We basically use the CPU poisson generator. Evaluate if there is any firing due to the
@@ -0,0 +1,127 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+#ifndef _SNN_PROFILER_H_
+#define _SNN_PROFILER_H_
+
+#if defined(WIN32) || defined(WIN64)
+	#include <windows.h>	// QueryPerformanceCounter
+#else
+	#include <time.h>		// clock_gettime
+#endif
+#include <stddef.h>			// NULL
+
+#include <hardware_counters.h>
+
+
+/*!
+ * \brief returns a monotonic wall-clock time stamp (ns)
+ *
+ * On Linux, clock_gettime(CLOCK_MONOTONIC) is served from the vDSO and takes a few tens of ns, which is cheap enough
+ * to be called a few dozen times per simulated ms.
+ */
+inline unsigned long long getProfilerTimeNs() {
+#if defined(WIN32) || defined(WIN64)
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (unsigned long long)(count.QuadPart * (1e9 / freq.QuadPart));
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+/*!
+ * \brief Adds the wall-clock time spent in a scope to a profiler counter (and counts the calls, if given)
+ *
+ * The profiler counters of SNN are only ever written by one thread at a time (the manager thread for the phases,
+ * the worker thread of a partition for its own counters), so no synchronization is needed. If CARLsim is compiled
+ * with __NO_PROFILING__ (cmake -DCARLSIM_NO_PROFILING=ON), this class is empty and all instrumentation compiles
+ * away.
+ *
+ * If hardware counters are given (see HardwareCounters), their deltas over the scope are added to hwCounts as well.
+ * The counters are read outside of the timed region so that the read syscalls do not show up in the phase times.
+ */
+class ProfilerScope {
+public:
+#ifndef __NO_PROFILING__
+	ProfilerScope(unsigned long long& timeNs, long long* numCalls=NULL, HardwareCounters* hw=NULL,
+		long long* hwCounts=NULL) : timeNs_(timeNs), hw_(hwCounts != NULL ? hw : NULL), hwCounts_(hwCounts) {
+		if (numCalls != NULL)
+			(*numCalls)++;
+		if (hw_ != NULL && !hw_->read(hwStart_))
+			hw_ = NULL;
+		startNs_ = getProfilerTimeNs();
+	}
+	~ProfilerScope() {
+		timeNs_ += getProfilerTimeNs() - startNs_;
+		long long hwEnd[NUM_HW_COUNTERS];
+		if (hw_ != NULL && hw_->read(hwEnd)) {
+			for (int i = 0; i < NUM_HW_COUNTERS; i++)
+				hwCounts_[i] += hwEnd[i] - hwStart_[i];
+		}
+	}
+
+private:
+	// no copies
+	ProfilerScope(const ProfilerScope&);
+	ProfilerScope& operator=(const ProfilerScope&);
+
+	unsigned long long& timeNs_;
+	unsigned long long startNs_;
+	HardwareCounters* hw_;
+	long long* hwCounts_;
+	long long hwStart_[NUM_HW_COUNTERS];
+#else
+	ProfilerScope(unsigned long long&, long long* numCalls=NULL, HardwareCounters* hw=NULL, long long* hwCounts=NULL) {}
+#endif
+};
+
+#endif
@@ -0,0 +1,201 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#ifndef _SNN_TRACER_H_
+#define _SNN_TRACER_H_
+
+#include <snn_profiler.h> // getProfilerTimeNs
+
+#include <stdio.h>        // FILE
+#include <string>
+#include <vector>
+
+
+/*!
+ * \brief Records the phases of sampled simulation steps per thread and writes them as Chrome trace events
+ *
+ * Every thread that records events (the manager thread and the worker thread of every CPU partition) owns a ring
+ * buffer of its own, so recording needs neither locks nor atomics. If a ring buffer is full, its oldest events are
+ * overwritten. SimTracer::dump appends the events of all ring buffers to the trace file (JSON array of complete
+ * events, "ph":"X") and empties them. It must only be called while no worker thread is running. The file can be
+ * opened in chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Only every n-th simulation step is recorded (see SimTracer::beginStep), plus every step that finishes a second of
+ * simulation time, so that the monitor flushes at the second boundary always show up in the trace.
+ *
+ * \since v4.0
+ */
+class SimTracer {
+public:
+	/*!
+	 * \brief SimTracer constructor
+	 *
+	 * \param[in] fp trace file; the tracer writes the opening bracket now and closes the file in its destructor
+	 * \param[in] numThreads number of ring buffers (thread IDs 0 .. numThreads-1)
+	 * \param[in] sampleIntervalMs record every sampleIntervalMs-th simulation step
+	 * \param[in] maxEventsPerThread capacity of every ring buffer
+	 */
+	SimTracer(FILE* fp, int numThreads, int sampleIntervalMs, int maxEventsPerThread);
+
+	//! terminates the JSON array and closes the trace file
+	~SimTracer();
+
+	//! names the thread in the trace viewer
+	void setThreadName(int thread, const std::string& name);
+
+	/*!
+	 * \brief Decides whether the following simulation step is recorded
+	 *
+	 * \param[in] simTime simulation time (ms) at the beginning of the step
+	 * \param[in] finishesSecond whether the step finishes a second of simulation time
+	 */
+	void beginStep(int simTime, bool finishesSecond) {
+		simTime_ = simTime;
+		isSampling_ = finishesSecond || simTime % sampleIntervalMs_ == 0;
+	}
+
+	//! records all events from now on (e.g., the monitor updates at the end of runNetwork)
+	void sampleAll() { isSampling_ = true; }
+
+	//! returns whether events are currently recorded
+	bool isSampling() { return isSampling_; }
+
+	//! records an event (nameId is a ::ProfilerPhase) of a thread; only the owner thread may call this
+	void record(int thread, int nameId, unsigned long long startNs, unsigned long long endNs) {
+		TraceRing& ring = *rings_[thread];
+		TraceEvent& ev = ring.events[ring.next];
+		ev.nameId = nameId;
+		ev.simTime = simTime_;
+		ev.startNs = startNs;
+		ev.durNs = endNs - startNs;
+		if (++ring.next == ring.events.size())
+			ring.next = 0;
+		if (ring.count < ring.events.size())
+			ring.count++;
+		else
+			ring.numOverwritten++;
+	}
+
+	/*!
+	 * \brief Appends all recorded events to the trace file and empties the ring buffers
+	 *
+	 * \returns false if the trace file could not be written
+	 */
+	bool dump();
+
+	//! returns the number of events that were overwritten because a ring buffer was full
+	long long getNumOverwritten();
+
+private:
+	// no copies
+	SimTracer(const SimTracer&);
+	SimTracer& operator=(const SimTracer&);
+
+	struct TraceEvent {
+		int nameId;
+		int simTime;
+		unsigned long long startNs;
+		unsigned long long durNs;
+	};
+
+	//! ring buffer of one thread, padded to its own cache line
+	struct TraceRing {
+		std::vector<TraceEvent> events;
+		size_t next;
+		size_t count;
+		long long numOverwritten;
+		char padding[64];
+	};
+
+	void writeEvent(const char* event);
+
+	FILE* fp_;
+	std::vector<TraceRing*> rings_;
+	std::vector<std::string> threadNames_;
+	std::vector<bool> threadNameWritten_;
+	int sampleIntervalMs_;
+	int simTime_;
+	bool isSampling_;
+	bool isFirstEvent_;
+	unsigned long long originNs_;
+};
+
+/*!
+ * \brief Records the time spent in a scope as an event of a SimTracer (if it is sampling the current step)
+ *
+ * If CARLsim is compiled with __NO_PROFILING__, this class is empty.
+ */
+class TraceScope {
+public:
+#ifndef __NO_PROFILING__
+	TraceScope(SimTracer* tracer, int thread, int nameId) : tracer_(NULL), thread_(thread), nameId_(nameId),
+		startNs_(0) {
+		if (tracer != NULL && tracer->isSampling()) {
+			tracer_ = tracer;
+			startNs_ = getProfilerTimeNs();
+		}
+	}
+	~TraceScope() {
+		if (tracer_ != NULL)
+			tracer_->record(thread_, nameId_, startNs_, getProfilerTimeNs());
+	}
+
+private:
+	// no copies
+	TraceScope(const TraceScope&);
+	TraceScope& operator=(const TraceScope&);
+
+	SimTracer* tracer_;
+	int thread_;
+	int nameId_;
+	unsigned long long startNs_;
+#else
+	TraceScope(SimTracer*, int, int) {}
+#endif
+};
+
+#endif
@@ -0,0 +1,136 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+#ifndef _SPIKE_FILE_WRITER_H_
+#define _SPIKE_FILE_WRITER_H_
+
+
+#include <stdio.h>  // FILE
+#include <stdlib.h> // size_t
+
+
+/*!
+ * \brief Asynchronous writer for spike files
+ *
+ * This class takes the spike file I/O off the simulation thread.
+ * Every spike file is registered as a stream with SpikeFileWriter::open. Spikes are appended to a large buffer per
+ * stream with SpikeFileWriter::append. Full buffers are handed to a dedicated I/O thread, which writes consecutive
+ * buffers of the same file with a single writev call.
+ * A stream either writes (time, neuron ID) pairs of ints (spike file version 0.2), or encodes the spikes in
+ * compressed chunks that are indexed when the stream is closed (version 0.3, see SpikeFileReader for the layout).
+ *
+ * \since v4.0
+ */
+class SpikeFileWriter {
+public:
+	/*!
+	 * \brief SpikeFileWriter Constructor
+	 *
+	 * The I/O thread is only started when the first stream is opened.
+	 * \param[in] bufferSize size of the buffer of each stream (in bytes)
+	 */
+	SpikeFileWriter(size_t bufferSize);
+
+	/*!
+	 * \brief SpikeFileWriter Destructor
+	 *
+	 * The destructor writes all pending buffers and stops the I/O thread. It does not close any files.
+	 */
+	~SpikeFileWriter();
+
+	/*!
+	 * \brief Registers a spike file as a stream
+	 *
+	 * Everything that was written to the file with stdio so far (e.g., the file header) is flushed. From now on, the
+	 * file must only be written through this stream until SpikeFileWriter::close is called.
+	 * \param[in] fid file pointer of the spike file
+	 * \param[in] chunkLengthMs time covered by a chunk (ms), or 0 to write (time, neuron ID) pairs
+	 * \returns the ID of the new stream
+	 */
+	int open(FILE* fid, int chunkLengthMs=0);
+
+	/*!
+	 * \brief Writes the remaining spikes of a stream and unregisters it
+	 *
+	 * Returns once all spikes of the stream are written. A chunked stream ends with the chunk index.
+	 * The caller is responsible for closing the file.
+	 * \returns false if a write error occurred on any stream since the last check
+	 */
+	bool close(int streamId);
+
+	//! appends a spike (time in ms, neuron ID within its group) to the buffer of a stream
+	void append(int streamId, int time, int neurId);
+
+	/*!
+	 * \brief Appends a block of raw bytes to the buffer of an unchunked stream
+	 *
+	 * This allows other binary files (e.g., group data files and the neuron state files of sampling NeuronMonitors)
+	 * to be written by the same I/O thread.
+	 */
+	void appendBlock(int streamId, const void* data, size_t size);
+
+	//! hands the partially filled buffer of a stream to the I/O thread, ending the current chunk of a chunked stream
+	void flush(int streamId);
+
+	/*!
+	 * \brief Hands the partially filled buffers of all streams to the I/O thread
+	 *
+	 * \param[in] wait whether to return only once everything has been written to the files
+	 * \returns false if a write error occurred on any stream since the last check
+	 */
+	bool flushAll(bool wait);
+
+private:
+	// This class provides a pImpl for the CARLsim User API.
+	// \see https://marcmutz.wordpress.com/translated-articles/pimp-my-pimpl/
+	class Impl;
+	Impl* _impl;
+};
+
+
+#endif
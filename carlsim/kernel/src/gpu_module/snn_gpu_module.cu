@@ -644,12 +644,26 @@ __global__ 	void kernel_findFiring (int simTimeMs, int simTime) {
 					needToWrite = true;
 				}
 
-				// log v, u value if any active neuron monitor is presented
-				if (networkConfigGPU.sim_with_nm && lNId - groupConfigsGPU[lGrpId].lStartN < MAX_NEURON_MON_GRP_SZIE) {
-					int idxBase = networkConfigGPU.numGroups * MAX_NEURON_MON_GRP_SZIE * simTimeMs + lGrpId * MAX_NEURON_MON_GRP_SZIE;
+				// log v, u value if the group has an active neuron monitor
+				if (groupConfigsGPU[lGrpId].neuronMonitorSlot >= 0 && lNId - groupConfigsGPU[lGrpId].lStartN < MAX_NEURON_MON_GRP_SZIE) {
+					int idxBase = (groupConfigsGPU[lGrpId].neuronMonitorSlot * 1000 + simTimeMs) * MAX_NEURON_MON_GRP_SZIE;
 					runtimeDataGPU.nVBuffer[idxBase + lNId - groupConfigsGPU[lGrpId].lStartN] = runtimeDataGPU.voltage[lNId];
 					runtimeDataGPU.nUBuffer[idxBase + lNId - groupConfigsGPU[lGrpId].lStartN] = runtimeDataGPU.recovery[lNId];
 				}
+
+				// log v, u value every stride ms if the group has a sampling neuron monitor
+				if (groupConfigsGPU[lGrpId].neuronMonitorStreamOffset >= 0 && simTime % groupConfigsGPU[lGrpId].neuronMonitorStreamStride == 0) {
+					int nId = lNId - groupConfigsGPU[lGrpId].lStartN - groupConfigsGPU[lGrpId].neuronMonitorStreamFirstN;
+					int slot = (nId >= 0 && nId < groupConfigsGPU[lGrpId].neuronMonitorStreamRangeN)
+						? runtimeDataGPU.nStreamSlot[groupConfigsGPU[lGrpId].neuronMonitorStreamSlotOffset + nId] : -1;
+					if (slot >= 0) {
+						int numN = groupConfigsGPU[lGrpId].neuronMonitorStreamNumN;
+						int idxBase = groupConfigsGPU[lGrpId].neuronMonitorStreamOffset
+							+ (simTime / groupConfigsGPU[lGrpId].neuronMonitorStreamStride) % groupConfigsGPU[lGrpId].neuronMonitorStreamWindow * 3 * numN;
+						runtimeDataGPU.nStreamBuffer[idxBase + slot] = runtimeDataGPU.voltage[lNId];
+						runtimeDataGPU.nStreamBuffer[idxBase + numN + slot] = runtimeDataGPU.recovery[lNId];
+					}
+				}
 			}
 		}
 
@@ -912,7 +926,7 @@ __device__ float getCompCurrent_GPU(int grpId, int neurId, float const0 = 0.0f,
 * \param[in] nid The neuron id to be updated
 * \param[in] grpId The group id of the neuron
 */
-__device__ void updateNeuronState(int nid, int grpId, int simTimeMs, bool lastIteration) {
+__device__ void updateNeuronState(int nid, int grpId, int simTimeMs, int simTime, bool lastIteration) {
 	float v = runtimeDataGPU.voltage[nid];
 	float v_next = runtimeDataGPU.nextVoltage[nid];
 	float u = runtimeDataGPU.recovery[nid];
@@ -1127,11 +1141,24 @@ __device__ void updateNeuronState(int nid, int grpId, int simTimeMs, bool lastIt
 			runtimeDataGPU.current[nid] = 0.0f;
 		}
 
-		// log i value if any active neuron monitor is presented
-		if (networkConfigGPU.sim_with_nm && nid - groupConfigsGPU[grpId].lStartN < MAX_NEURON_MON_GRP_SZIE) {
-			int idxBase = networkConfigGPU.numGroups * MAX_NEURON_MON_GRP_SZIE * simTimeMs + grpId * MAX_NEURON_MON_GRP_SZIE;
+		// log i value if the group has an active neuron monitor
+		if (groupConfigsGPU[grpId].neuronMonitorSlot >= 0 && nid - groupConfigsGPU[grpId].lStartN < MAX_NEURON_MON_GRP_SZIE) {
+			int idxBase = (groupConfigsGPU[grpId].neuronMonitorSlot * 1000 + simTimeMs) * MAX_NEURON_MON_GRP_SZIE;
 			runtimeDataGPU.nIBuffer[idxBase + nid - groupConfigsGPU[grpId].lStartN] = totalCurrent;
 		}
+
+		// log i value every stride ms if the group has a sampling neuron monitor
+		if (groupConfigsGPU[grpId].neuronMonitorStreamOffset >= 0 && simTime % groupConfigsGPU[grpId].neuronMonitorStreamStride == 0) {
+			int nId = nid - groupConfigsGPU[grpId].lStartN - groupConfigsGPU[grpId].neuronMonitorStreamFirstN;
+			int slot = (nId >= 0 && nId < groupConfigsGPU[grpId].neuronMonitorStreamRangeN)
+				? runtimeDataGPU.nStreamSlot[groupConfigsGPU[grpId].neuronMonitorStreamSlotOffset + nId] : -1;
+			if (slot >= 0) {
+				int numN = groupConfigsGPU[grpId].neuronMonitorStreamNumN;
+				int idxBase = groupConfigsGPU[grpId].neuronMonitorStreamOffset
+					+ (simTime / groupConfigsGPU[grpId].neuronMonitorStreamStride) % groupConfigsGPU[grpId].neuronMonitorStreamWindow * 3 * numN;
+				runtimeDataGPU.nStreamBuffer[idxBase + 2 * numN + slot] = totalCurrent;
+			}
+		}
 	}
 
 	runtimeDataGPU.nextVoltage[nid] = v_next;
@@ -1150,7 +1177,7 @@ __device__ void updateNeuronState(int nid, int grpId, int simTimeMs, bool lastIt
  *             current, extCurrent, Izh_a, Izh_b
  * glb access:
  */
-__global__ void kernel_neuronStateUpdate(int simTimeMs, bool lastIteration) {
+__global__ void kernel_neuronStateUpdate(int simTimeMs, int simTime, bool lastIteration) {
 	const int totBuffers = loadBufferCount;
 
 	// update neuron state
@@ -1168,7 +1195,7 @@ __global__ void kernel_neuronStateUpdate(int simTimeMs, bool lastIteration) {
 			if (IS_REGULAR_NEURON(nid, networkConfigGPU.numNReg, networkConfigGPU.numNPois)) {
 				// P7
 				// update neuron state here....
-				updateNeuronState(nid, grpId, simTimeMs, lastIteration);
+				updateNeuronState(nid, grpId, simTimeMs, simTime, lastIteration);
 
 				// P8
 				if (groupConfigsGPU[grpId].WithHomeostasis)
@@ -1198,7 +1225,8 @@ __global__ void kernel_groupStateUpdate(int simTime) {
 		if ((groupConfigsGPU[grpIdx].WithESTDPtype == DA_MOD || groupConfigsGPU[grpIdx].WithISTDPtype == DA_MOD) && runtimeDataGPU.grpDA[grpIdx] > groupConfigsGPU[grpIdx].baseDP) {
 			runtimeDataGPU.grpDA[grpIdx] *= groupConfigsGPU[grpIdx].decayDP;
 		}
-		runtimeDataGPU.grpDABuffer[grpIdx * 1000 + simTime] = runtimeDataGPU.grpDA[grpIdx]; // log dopamine concentration
+		if (groupConfigsGPU[grpIdx].hasGroupMonitor)
+			runtimeDataGPU.grpDABuffer[grpIdx * 1000 + simTime] = runtimeDataGPU.grpDA[grpIdx]; // log dopamine concentration
 	}
 }
 
@@ -2233,6 +2261,9 @@ void SNN::copyNeuronState(int netId, int lGrpId, RuntimeData* dest, cudaMemcpyKi
 	if (networkConfigs[netId].sim_with_nm)
 		copyNeuronStateBuffer(netId, lGrpId, dest, &managerRuntimeData, cudaMemcpyHostToDevice, allocateMem);
 
+	if (networkConfigs[netId].numNeuronMonStreamFloats > 0)
+		copyNeuronStreamBuffer(netId, lGrpId, dest, &managerRuntimeData, cudaMemcpyHostToDevice, allocateMem);
+
 	if (sim_with_homeostasis) {
 		//Included to enable homeostasis in GPU_MODE.
 		// Avg. Firing...
@@ -2961,6 +2992,11 @@ void SNN::deleteRuntimeData_GPU(int netId) {
 		CUDA_CHECK_ERRORS(cudaFree(runtimeData[netId].nIBuffer));
 	}
 
+	if (networkConfigs[netId].numNeuronMonStreamFloats > 0) {
+		CUDA_CHECK_ERRORS(cudaFree(runtimeData[netId].nStreamBuffer));
+		CUDA_CHECK_ERRORS(cudaFree(runtimeData[netId].nStreamSlot));
+	}
+
 	CUDA_CHECK_ERRORS( cudaFree(runtimeData[netId].grpIds) );
 
 	CUDA_CHECK_ERRORS( cudaFree(runtimeData[netId].Izh_a) );
@@ -3066,7 +3102,7 @@ void SNN::globalStateUpdate_N_GPU(int netId) {
 		if (j == networkConfigs[netId].simNumStepsPerMs)
 			lastIteration = true;
 		// update all neuron state (i.e., voltage and recovery), including homeostasis
-		kernel_neuronStateUpdate << <NUM_BLOCKS, NUM_THREADS >> > (simTimeMs, lastIteration);
+		kernel_neuronStateUpdate << <NUM_BLOCKS, NUM_THREADS >> > (simTimeMs, simTime, lastIteration);
 		CUDA_GET_LAST_ERROR("Kernel execution failed");
 
 		// the above kernel should end with a syncthread statement to be on the safe side
@@ -3457,14 +3493,17 @@ void SNN::copyNeuronStateBuffer(int netId, int lGrpId, RuntimeData* dest, Runtim
 
 	int ptrPos, length;
 	
+	// the buffers only hold groups with a NeuronMonitor, the 1 second record of each group is contiguous
 	if (lGrpId == ALL) {
 		ptrPos = 0;
-		length = networkConfigs[netId].numGroups * MAX_NEURON_MON_GRP_SZIE * 1000;
+		length = networkConfigs[netId].numNeuronMonSlots * MAX_NEURON_MON_GRP_SZIE * 1000;
 	} else {
-		ptrPos = lGrpId * MAX_NEURON_MON_GRP_SZIE * 1000;
+		if (groupConfigs[netId][lGrpId].neuronMonitorSlot < 0)
+			return;
+		ptrPos = groupConfigs[netId][lGrpId].neuronMonitorSlot * MAX_NEURON_MON_GRP_SZIE * 1000;
 		length = MAX_NEURON_MON_GRP_SZIE * 1000;
 	}
-	assert(length <= networkConfigs[netId].numGroups * MAX_NEURON_MON_GRP_SZIE * 1000);
+	assert(length <= networkConfigs[netId].numNeuronMonSlots * MAX_NEURON_MON_GRP_SZIE * 1000);
 	assert(length > 0);
 	
 	// neuron information
@@ -3481,6 +3520,56 @@ void SNN::copyNeuronStateBuffer(int netId, int lGrpId, RuntimeData* dest, Runtim
 	CUDA_CHECK_ERRORS(cudaMemcpy(&dest->nIBuffer[ptrPos], &src->nIBuffer[ptrPos], sizeof(float) * length, kind));
 }
 
+/*!
+* \brief This function fetch the ring buffer of sampling neuron monitors in the local network specified by netId
+*
+* This function:
+* (allocate and) copy nStreamBuffer
+* allocate and fill nStreamSlot (which is static and only lives on the device)
+*
+* This funcion is called by copyNeuronState() and fetchNeuronStreamBuffer()
+*
+* \param[in] netId the id of a local network, which is the same as the device (GPU) id
+* \param[in] lGrpId the local group id in a local network, which specifiy the group(s) to be copied
+* \param[in] dest pointer to runtime data desitnation
+* \param[in] src pointer to runtime data source
+* \param[in] kind the direction of copy
+* \param[in] allocateMem a flag indicates whether allocating memory space before copying
+*
+* \sa copyNeuronState fetchNeuronStreamBuffer
+* \since v4.0
+*/
+void SNN::copyNeuronStreamBuffer(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, cudaMemcpyKind kind, bool allocateMem) {
+	checkAndSetGPUDevice(netId);
+	checkDestSrcPtrs(dest, src, kind, allocateMem, lGrpId, 0); // check that the destination pointer is properly allocated..
+
+	int ptrPos, length;
+
+	// the ring buffer of each sampling neuron monitor is contiguous
+	if (lGrpId == ALL) {
+		ptrPos = 0;
+		length = networkConfigs[netId].numNeuronMonStreamFloats;
+	} else {
+		if (groupConfigs[netId][lGrpId].neuronMonitorStreamOffset < 0)
+			return;
+		ptrPos = groupConfigs[netId][lGrpId].neuronMonitorStreamOffset;
+		length = 3 * groupConfigs[netId][lGrpId].neuronMonitorStreamNumN * groupConfigs[netId][lGrpId].neuronMonitorStreamWindow;
+	}
+	assert(ptrPos + length <= networkConfigs[netId].numNeuronMonStreamFloats);
+	assert(length > 0);
+
+	assert(src->nStreamBuffer != NULL);
+	if (allocateMem) {
+		CUDA_CHECK_ERRORS(cudaMalloc((void**)&dest->nStreamBuffer, sizeof(float) * length));
+
+		std::vector<int> slots(networkConfigs[netId].numNeuronMonStreamSlots);
+		fillNeuronStreamSlots(netId, &slots[0]);
+		CUDA_CHECK_ERRORS(cudaMalloc((void**)&dest->nStreamSlot, sizeof(int) * slots.size()));
+		CUDA_CHECK_ERRORS(cudaMemcpy(dest->nStreamSlot, &slots[0], sizeof(int) * slots.size(), cudaMemcpyHostToDevice));
+	}
+	CUDA_CHECK_ERRORS(cudaMemcpy(&dest->nStreamBuffer[ptrPos], &src->nStreamBuffer[ptrPos], sizeof(float) * length, kind));
+}
+
 void SNN::copyTimeTable(int netId, cudaMemcpyKind kind) {
 	assert(netId < CPU_RUNTIME_BASE);
 	checkAndSetGPUDevice(netId);
@@ -0,0 +1,146 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include <hardware_counters.h>
+
+#include <string.h>  // memset, strerror
+#if defined(__linux__)
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+
+HardwareCounters::HardwareCounters() : isOpen_(false) {
+	for (int i = 0; i < NUM_HW_COUNTERS; i++)
+		fd_[i] = -1;
+}
+
+HardwareCounters::~HardwareCounters() {
+	close();
+}
+
+bool HardwareCounters::open() {
+	close();
+
+#if defined(__linux__)
+	// perf event config of every HardwareCounter
+	static const unsigned long long config[NUM_HW_COUNTERS] = {
+		PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+	};
+
+	// the first counter leads a group, so that all counters are scheduled onto the PMU together and a single read
+	// returns a consistent set of values
+	for (int i = 0; i < NUM_HW_COUNTERS; i++) {
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = config[i];
+		attr.inherit = 1;        // count the worker threads created by this thread
+		attr.exclude_kernel = 1; // allowed with perf_event_paranoid <= 2
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		// pid 0, cpu -1: the calling thread on any CPU
+		fd_[i] = syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fd_[0], 0);
+		if (fd_[i] < 0) {
+			errorMessage_ = std::string("perf_event_open(") + hardwareCounter_string[i] + ") failed: "
+				+ strerror(errno);
+			close();
+			return false;
+		}
+	}
+
+	isOpen_ = true;
+	return true;
+#else
+	errorMessage_ = "hardware counters are only supported on Linux";
+	return false;
+#endif
+}
+
+void HardwareCounters::close() {
+#if defined(__linux__)
+	// members first, the group leader last
+	for (int i = NUM_HW_COUNTERS - 1; i >= 0; i--) {
+		if (fd_[i] >= 0)
+			::close(fd_[i]);
+		fd_[i] = -1;
+	}
+#endif
+	isOpen_ = false;
+}
+
+bool HardwareCounters::read(long long values[NUM_HW_COUNTERS]) {
+	for (int i = 0; i < NUM_HW_COUNTERS; i++)
+		values[i] = 0;
+	if (!isOpen_)
+		return false;
+
+#if defined(__linux__)
+	// PERF_FORMAT_GROUP layout: number of counters, time enabled, time running, one value per counter
+	unsigned long long buf[3 + NUM_HW_COUNTERS];
+	ssize_t bytes = ::read(fd_[0], buf, sizeof(buf));
+	if (bytes != (ssize_t)sizeof(buf) || buf[0] != NUM_HW_COUNTERS)
+		return false;
+
+	// scale up if the group had to share the PMU with other events (multiplexing)
+	unsigned long long timeEnabled = buf[1], timeRunning = buf[2];
+	for (int i = 0; i < NUM_HW_COUNTERS; i++) {
+		if (timeRunning > 0 && timeRunning < timeEnabled)
+			values[i] = (long long)((double)buf[3 + i] * timeEnabled / timeRunning);
+		else
+			values[i] = (long long)buf[3 + i];
+	}
+	return true;
+#else
+	return false;
+#endif
+}
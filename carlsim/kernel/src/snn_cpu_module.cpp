@@ -50,12 +50,21 @@
 
 #include <spike_buffer.h>
 
+#include <cstdlib> // posix_memalign, free
+#if defined(WIN32) || defined(WIN64)
+	#include <malloc.h> // _aligned_malloc, _aligned_free
+#else
+	#include <sys/mman.h> // madvise
+#endif
+
 // spikeGeneratorUpdate_CPU on CPUs
 #if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
 	void SNN::spikeGeneratorUpdate_CPU(int netId) {
 #else // POSIX
 	void* SNN::spikeGeneratorUpdate_CPU(int netId) {
 #endif
+	ProfilerScope profScope(profPartitionTimeNs_[netId].timeNs[PROFILER_SPIKE_GENERATOR]);
+	TraceScope traceScope(tracer_, netId + 1, PROFILER_SPIKE_GENERATOR);
 	assert(runtimeData[netId].allocated);
 	assert(runtimeData[netId].memType == CPU_MEM);
 
@@ -65,6 +74,7 @@
 		// set CPU_MODE Random Gen, store random number to g(c)puRandNums
 		runtimeData[netId].randNum[poisN] = drand48();
 	}
+	eventCounters_[netId].counts.poissonDraws += networkConfigs[netId].numNPois;
 
 	// Use spike generators (user-defined callback function)
 	if (networkConfigs[netId].numNSpikeGen > 0) {
@@ -96,6 +106,8 @@
 #else // POSIX
 	void* SNN::updateTimingTable_CPU(int netId) {
 #endif
+	ProfilerScope profScope(profPartitionTimeNs_[netId].timeNs[PROFILER_TIMING_TABLE]);
+	TraceScope traceScope(tracer_, netId + 1, PROFILER_TIMING_TABLE);
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	runtimeData[netId].timeTableD2[simTimeMs + networkConfigs[netId].maxDelay + 1] = runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2;
@@ -285,6 +297,8 @@
 #else // POSIX
 	void* SNN::clearExtFiringTable_CPU(int netId) {
 #endif
+	ProfilerScope profScope(profPartitionTimeNs_[netId].timeNs[PROFILER_CLEAR_EXT_FIRING]);
+	TraceScope traceScope(tracer_, netId + 1, PROFILER_CLEAR_EXT_FIRING);
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	memset(runtimeData[netId].extFiringTableEndIdxD1, 0, sizeof(int) * networkConfigs[netId].numGroups);
@@ -360,10 +374,13 @@ void SNN::copyExtFiringTable(int netId) {
 #else // POSIX
 	void* SNN::doCurrentUpdateD1_CPU(int netId) {
 #endif
+	ProfilerScope profScope(profPartitionTimeNs_[netId].timeNs[PROFILER_CURRENT_UPDATE]);
+	TraceScope traceScope(tracer_, netId + 1, PROFILER_CURRENT_UPDATE);
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	int k     = runtimeData[netId].timeTableD1[simTimeMs + networkConfigs[netId].maxDelay + 1] - 1;
 	int k_end = runtimeData[netId].timeTableD1[simTimeMs + networkConfigs[netId].maxDelay];
+	long long numSynEvents = 0; // kept in a register, added to the event counters once
 
 	while((k >= k_end) && (k >= 0)) {
 		int lNId = runtimeData[netId].firingTableD1[k];
@@ -383,12 +400,15 @@ void SNN::copyExtFiringTable(int netId) {
 			int synId = GET_CONN_SYN_ID(postInfo);
 			assert(synId < (runtimeData[netId].Npre[postNId]));
 
-			if (postNId < networkConfigs[netId].numN) // test if post-neuron is a local neuron
+			if (postNId < networkConfigs[netId].numN) { // test if post-neuron is a local neuron
 				generatePostSynapticSpike(lNId /* preNId */, postNId, synId, 0, netId);
+				numSynEvents++;
+			}
 		}
 
 		k = k - 1;
 	}
+	eventCounters_[netId].counts.synEvents += numSynEvents;
 }
 
 #if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
@@ -408,12 +428,15 @@ void SNN::copyExtFiringTable(int netId) {
 #else // POSIX
 	void* SNN::doCurrentUpdateD2_CPU(int netId) {
 #endif
+	ProfilerScope profScope(profPartitionTimeNs_[netId].timeNs[PROFILER_CURRENT_UPDATE]);
+	TraceScope traceScope(tracer_, netId + 1, PROFILER_CURRENT_UPDATE);
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	if (networkConfigs[netId].maxDelay > 1) {
 		int k = runtimeData[netId].timeTableD2[simTimeMs + 1 + networkConfigs[netId].maxDelay] - 1;
 		int k_end = runtimeData[netId].timeTableD2[simTimeMs + 1];
 		int t_pos = simTimeMs;
+		long long numSynEvents = 0; // kept in a register, added to the event counters once
 
 		while ((k >= k_end) && (k >= 0)) {
 			// get the neuron id from the index k
@@ -447,12 +470,15 @@ void SNN::copyExtFiringTable(int netId) {
 				int synId = GET_CONN_SYN_ID(postInfo);
 				assert(synId < (runtimeData[netId].Npre[postNId]));
 
-				if (postNId < networkConfigs[netId].numN) // test if post-neuron is a local neuron
+				if (postNId < networkConfigs[netId].numN) { // test if post-neuron is a local neuron
 					generatePostSynapticSpike(lNId /* preNId */, postNId, synId, tD, netId);
+					numSynEvents++;
+				}
 			}
 
 			k = k - 1;
 		}
+		eventCounters_[netId].counts.synEvents += numSynEvents;
 	}
 }
 
@@ -471,6 +497,8 @@ void SNN::copyExtFiringTable(int netId) {
 #else // POSIX
 	void* SNN::doSTPUpdateAndDecayCond_CPU(int netId) {
 #endif
+	ProfilerScope profScope(profPartitionTimeNs_[netId].timeNs[PROFILER_STP_DECAY]);
+	TraceScope traceScope(tracer_, netId + 1, PROFILER_STP_DECAY);
 	assert(runtimeData[netId].memType == CPU_MEM);
 	// ToDo: This can be further optimized using multiple threads allocated on mulitple CPU cores
 	//decay the STP variables before adding new spikes.
@@ -520,7 +548,10 @@ void SNN::copyExtFiringTable(int netId) {
 #else // POSIX
 	void* SNN::findFiring_CPU(int netId) {
 #endif
+	ProfilerScope profScope(profPartitionTimeNs_[netId].timeNs[PROFILER_FIND_FIRING]);
+	TraceScope traceScope(tracer_, netId + 1, PROFILER_FIND_FIRING);
 	assert(runtimeData[netId].memType == CPU_MEM);
+	long long numDropped = 0;
 	// ToDo: This can be further optimized using multiple threads allocated on mulitple CPU cores
 	for(int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
 		for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++) {
@@ -542,11 +573,27 @@ void SNN::copyExtFiringTable(int netId) {
 					needToWrite = true;
 				}
 
-				// log v, u value if any active neuron monitor is presented
-				if (networkConfigs[netId].sim_with_nm && lNId - groupConfigs[netId][lGrpId].lStartN < MAX_NEURON_MON_GRP_SZIE) {
-					int idxBase = networkConfigs[netId].numGroups * MAX_NEURON_MON_GRP_SZIE * simTimeMs + lGrpId * MAX_NEURON_MON_GRP_SZIE;
-					runtimeData[netId].nVBuffer[idxBase + lNId - groupConfigs[netId][lGrpId].lStartN] = runtimeData[netId].voltage[lNId];
-					runtimeData[netId].nUBuffer[idxBase + lNId - groupConfigs[netId][lGrpId].lStartN] = runtimeData[netId].recovery[lNId];
+				// log v, u value if the group has an active neuron monitor
+				// the buffer is indexed by the (creation-order) neuron ID within the group
+				if (groupConfigs[netId][lGrpId].neuronMonitorSlot >= 0 && restoreLNId(netId, lNId) - groupConfigs[netId][lGrpId].lStartN < MAX_NEURON_MON_GRP_SZIE) {
+					int idxBase = (groupConfigs[netId][lGrpId].neuronMonitorSlot * 1000 + simTimeMs) * MAX_NEURON_MON_GRP_SZIE;
+					int nId = restoreLNId(netId, lNId) - groupConfigs[netId][lGrpId].lStartN;
+					runtimeData[netId].nVBuffer[idxBase + nId] = runtimeData[netId].voltage[lNId];
+					runtimeData[netId].nUBuffer[idxBase + nId] = runtimeData[netId].recovery[lNId];
+				}
+
+				// log v, u value every stride ms if the group has a sampling neuron monitor
+				if (groupConfigs[netId][lGrpId].neuronMonitorStreamOffset >= 0 && simTime % groupConfigs[netId][lGrpId].neuronMonitorStreamStride == 0) {
+					int nId = restoreLNId(netId, lNId) - groupConfigs[netId][lGrpId].lStartN - groupConfigs[netId][lGrpId].neuronMonitorStreamFirstN;
+					int slot = (nId >= 0 && nId < groupConfigs[netId][lGrpId].neuronMonitorStreamRangeN)
+						? runtimeData[netId].nStreamSlot[groupConfigs[netId][lGrpId].neuronMonitorStreamSlotOffset + nId] : -1;
+					if (slot >= 0) {
+						int numN = groupConfigs[netId][lGrpId].neuronMonitorStreamNumN;
+						int idxBase = groupConfigs[netId][lGrpId].neuronMonitorStreamOffset
+							+ (simTime / groupConfigs[netId][lGrpId].neuronMonitorStreamStride) % groupConfigs[netId][lGrpId].neuronMonitorStreamWindow * 3 * numN;
+						runtimeData[netId].nStreamBuffer[idxBase + slot] = runtimeData[netId].voltage[lNId];
+						runtimeData[netId].nStreamBuffer[idxBase + numN + slot] = runtimeData[netId].recovery[lNId];
+					}
 				}
 			}
 
@@ -569,8 +616,10 @@ void SNN::copyExtFiringTable(int netId) {
 					}
 				}
 
-				if (fireId == -1) // no space availabe in firing table, drop the spike
+				if (fireId == -1) { // no space availabe in firing table, drop the spike
+					numDropped++;
 					continue;
+				}
 
 				// update firing table: firingTableD1(W), firingTableD2(W)
 				if (groupConfigs[netId][lGrpId].MaxDelay == 1) {
@@ -584,10 +633,10 @@ void SNN::copyExtFiringTable(int netId) {
 					int extFireId = -1;
 					if (groupConfigs[netId][lGrpId].MaxDelay == 1) {
 						extFireId = runtimeData[netId].extFiringTableEndIdxD1[lGrpId]++;
-						runtimeData[netId].extFiringTableD1[lGrpId][extFireId] = lNId + groupConfigs[netId][lGrpId].LtoGOffset;
+						runtimeData[netId].extFiringTableD1[lGrpId][extFireId] = restoreLNId(netId, lNId) + groupConfigs[netId][lGrpId].LtoGOffset;
 					} else { // MaxDelay > 1
 						extFireId = runtimeData[netId].extFiringTableEndIdxD2[lGrpId]++;
-						runtimeData[netId].extFiringTableD2[lGrpId][extFireId] = lNId + groupConfigs[netId][lGrpId].LtoGOffset;
+						runtimeData[netId].extFiringTableD2[lGrpId][extFireId] = restoreLNId(netId, lNId) + groupConfigs[netId][lGrpId].LtoGOffset;
 					}
 					assert(extFireId != -1);
 				}
@@ -610,6 +659,7 @@ void SNN::copyExtFiringTable(int netId) {
 			}
 		}
 	}
+	eventCounters_[netId].counts.spikesDropped += numDropped;
 }
 
 #if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
@@ -625,11 +675,13 @@ void SNN::copyExtFiringTable(int netId) {
 
 void SNN::updateLTP(int lNId, int lGrpId, int netId) {
 	unsigned int pos_ij = runtimeData[netId].cumulativePre[lNId]; // the index of pre-synaptic neuron
+	long long numEvals = 0;
 	for(int j = 0; j < runtimeData[netId].Npre_plastic[lNId]; pos_ij++, j++) {
 		int stdp_tDiff = (simTime - runtimeData[netId].synSpikeTime[pos_ij]);
 		assert(!((stdp_tDiff < 0) && (runtimeData[netId].synSpikeTime[pos_ij] != MAX_SIMULATION_TIME)));
 
 		if (stdp_tDiff > 0) {
+			numEvals++;
 			// check this is an excitatory or inhibitory synapse
 			if (groupConfigs[netId][lGrpId].WithESTDP && runtimeData[netId].maxSynWt[pos_ij] >= 0) { // excitatory synapse
 				// Handle E-STDP curve
@@ -674,6 +726,7 @@ void SNN::updateLTP(int lNId, int lGrpId, int netId) {
 			}
 		}
 	}
+	eventCounters_[netId].counts.ltpEvals += numEvals;
 }
 
 void SNN::firingUpdateSTP(int lNId, int lGrpId, int netId) {
@@ -748,6 +801,10 @@ void SNN::generatePostSynapticSpike(int preNId, int postNId, int synId, int tD,
 	// for each presynaptic spike, postsynaptic (synaptic) current is going to increase by some amplitude (change)
 	// generally speaking, this amplitude is the weight; but it can be modulated by STP
 	float change = runtimeData[netId].wt[pos];
+	if (networkConfigs[netId].numKernelWt > 0 && connectConfigs[netId][mulIndex].kernelOffset >= 0) {
+		// weight-sharing synapse: the kernel entry follows from the grid offset of pre relative to post
+		change = runtimeData[netId].kernelWt[getSharedKernelIdx(netId, mulIndex, preNId, postNId)];
+	}
 
 	// P2
 	if (groupConfigs[netId][pre_grpId].WithSTP) {
@@ -813,6 +870,7 @@ void SNN::generatePostSynapticSpike(int preNId, int postNId, int synId, int tD,
 		int stdp_tDiff = (simTime - runtimeData[netId].lastSpikeTime[postNId]);
 
 		if (stdp_tDiff >= 0) {
+			eventCounters_[netId].counts.ltdEvals++;
 			if (groupConfigs[netId][post_grpId].WithISTDP && ((pre_type & TARGET_GABAa) || (pre_type & TARGET_GABAb))) { // inhibitory syanpse
 				// Handle I-STDP curve
 				switch (groupConfigs[netId][post_grpId].WithISTDPcurve) {
@@ -901,6 +959,8 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 #else // POSIX
 	void*  SNN::globalStateUpdate_CPU(int netId) {
 #endif
+	ProfilerScope profScope(profPartitionTimeNs_[netId].timeNs[PROFILER_STATE_UPDATE]);
+	TraceScope traceScope(tracer_, netId + 1, PROFILER_STATE_UPDATE);
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	float timeStep = networkConfigs[netId].timeStep;
@@ -1144,10 +1204,23 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 					if (groupConfigs[netId][lGrpId].WithHomeostasis)
 						runtimeData[netId].avgFiring[lNId] *= groupConfigs[netId][lGrpId].avgTimeScale_decay;
 
-					// log i value if any active neuron monitor is presented
-					if (networkConfigs[netId].sim_with_nm && lNId - groupConfigs[netId][lGrpId].lStartN < MAX_NEURON_MON_GRP_SZIE) {
-						int idxBase = networkConfigs[netId].numGroups * MAX_NEURON_MON_GRP_SZIE * simTimeMs + lGrpId * MAX_NEURON_MON_GRP_SZIE;
-						runtimeData[netId].nIBuffer[idxBase + lNId - groupConfigs[netId][lGrpId].lStartN] = totalCurrent;
+					// log i value if the group has an active neuron monitor
+					if (groupConfigs[netId][lGrpId].neuronMonitorSlot >= 0 && restoreLNId(netId, lNId) - groupConfigs[netId][lGrpId].lStartN < MAX_NEURON_MON_GRP_SZIE) {
+						int idxBase = (groupConfigs[netId][lGrpId].neuronMonitorSlot * 1000 + simTimeMs) * MAX_NEURON_MON_GRP_SZIE;
+						runtimeData[netId].nIBuffer[idxBase + restoreLNId(netId, lNId) - groupConfigs[netId][lGrpId].lStartN] = totalCurrent;
+					}
+
+					// log i value every stride ms if the group has a sampling neuron monitor
+					if (groupConfigs[netId][lGrpId].neuronMonitorStreamOffset >= 0 && simTime % groupConfigs[netId][lGrpId].neuronMonitorStreamStride == 0) {
+						int nId = restoreLNId(netId, lNId) - groupConfigs[netId][lGrpId].lStartN - groupConfigs[netId][lGrpId].neuronMonitorStreamFirstN;
+						int slot = (nId >= 0 && nId < groupConfigs[netId][lGrpId].neuronMonitorStreamRangeN)
+							? runtimeData[netId].nStreamSlot[groupConfigs[netId][lGrpId].neuronMonitorStreamSlotOffset + nId] : -1;
+						if (slot >= 0) {
+							int numN = groupConfigs[netId][lGrpId].neuronMonitorStreamNumN;
+							int idxBase = groupConfigs[netId][lGrpId].neuronMonitorStreamOffset
+								+ (simTime / groupConfigs[netId][lGrpId].neuronMonitorStreamStride) % groupConfigs[netId][lGrpId].neuronMonitorStreamWindow * 3 * numN;
+							runtimeData[netId].nStreamBuffer[idxBase + 2 * numN + slot] = totalCurrent;
+						}
 					}
 				}
 			} // end StartN...EndN
@@ -1160,7 +1233,8 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 				if ((groupConfigs[netId][lGrpId].WithESTDPtype == DA_MOD || groupConfigs[netId][lGrpId].WithISTDP == DA_MOD) && runtimeData[netId].grpDA[lGrpId] > groupConfigs[netId][lGrpId].baseDP) {
 					runtimeData[netId].grpDA[lGrpId] *= groupConfigs[netId][lGrpId].decayDP;
 				}
-				runtimeData[netId].grpDABuffer[lGrpId * 1000 + simTimeMs] = runtimeData[netId].grpDA[lGrpId];
+				if (groupConfigs[netId][lGrpId].hasGroupMonitor)
+					runtimeData[netId].grpDABuffer[lGrpId * 1000 + simTimeMs] = runtimeData[netId].grpDA[lGrpId];
 			}
 		} // end numGroups
 
@@ -1188,6 +1262,8 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 #else // POSIX
 	void* SNN::updateWeights_CPU(int netId) {
 #endif
+	ProfilerScope profScope(profPartitionTimeNs_[netId].timeNs[PROFILER_UPDATE_WEIGHTS]);
+	TraceScope traceScope(tracer_, netId + 1, PROFILER_UPDATE_WEIGHTS);
 	// at this point we have already checked for sim_in_testing and sim_with_fixedwts
 	assert(sim_in_testing==false);
 	assert(sim_with_fixedwts==false);
@@ -1218,6 +1294,18 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 				//	if (i==groupConfigs[0][g].StartN)
 				//		KERNEL_DEBUG("%1.2f %1.2f \t", wt[offset+j]*10, wtChange[offset+j]*10);
 				float effectiveWtChange = stdpScaleFactor_ * runtimeData[netId].wtChange[offset + j];
+
+				// weight-sharing synapse: accumulate the change into its kernel entry, which is updated below
+				if (networkConfigs[netId].numKernelWt > 0 && connectConfigs[netId][runtimeData[netId].connIdsPreIdx[offset + j]].kernelOffset >= 0) {
+					int kIdx = getSharedKernelIdx(netId, runtimeData[netId].connIdsPreIdx[offset + j],
+						GET_CONN_NEURON_ID(runtimeData[netId].preSynapticIds[offset + j]), lNId);
+					STDPType stdpType = (runtimeData[netId].kernelMaxWt[kIdx] >= 0) ? groupConfigs[netId][lGrpId].WithESTDPtype : groupConfigs[netId][lGrpId].WithISTDPtype;
+					if (stdpType == DA_MOD)
+						effectiveWtChange *= runtimeData[netId].grpDA[lGrpId];
+					runtimeData[netId].kernelWtChange[kIdx] += effectiveWtChange;
+					runtimeData[netId].wtChange[offset + j] *= wtChangeDecay_;
+					continue;
+				}
 				//				if (wtChange[offset+j])
 				//					printf("connId=%d, wtChange[%d]=%f\n",connIdsPreIdx[offset+j],offset+j,wtChange[offset+j]);
 
@@ -1289,6 +1377,26 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 			}
 		}
 	}
+
+	// apply the accumulated changes to the shared kernels
+	if (networkConfigs[netId].numKernelWt > 0) {
+		for (int k = 0; k < networkConfigs[netId].numKernelWt; k++) {
+			runtimeData[netId].kernelWt[k] += runtimeData[netId].kernelWtChange[k];
+			runtimeData[netId].kernelWtChange[k] = 0.0f;
+
+			if (runtimeData[netId].kernelMaxWt[k] >= 0) {
+				if (runtimeData[netId].kernelWt[k] >= runtimeData[netId].kernelMaxWt[k])
+					runtimeData[netId].kernelWt[k] = runtimeData[netId].kernelMaxWt[k];
+				if (runtimeData[netId].kernelWt[k] < 0)
+					runtimeData[netId].kernelWt[k] = 0.0;
+			} else {
+				if (runtimeData[netId].kernelWt[k] <= runtimeData[netId].kernelMaxWt[k])
+					runtimeData[netId].kernelWt[k] = runtimeData[netId].kernelMaxWt[k];
+				if (runtimeData[netId].kernelWt[k] > 0)
+					runtimeData[netId].kernelWt[k] = 0.0;
+			}
+		}
+	}
 }
 
 #if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
@@ -1310,6 +1418,8 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 #else // POSIX
 	void* SNN::shiftSpikeTables_CPU(int netId) {
 #endif
+	ProfilerScope profScope(profPartitionTimeNs_[netId].timeNs[PROFILER_SHIFT_SPIKE_TABLES]);
+	TraceScope traceScope(tracer_, netId + 1, PROFILER_SHIFT_SPIKE_TABLES);
 	assert(runtimeData[netId].memType == CPU_MEM);
 	// Read the neuron ids that fired in the last glbNetworkConfig.maxDelay seconds
 	// and put it to the beginning of the firing table...
@@ -1345,10 +1455,426 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 	}
 #endif
 
+// number of bytes an array of length elements occupies in a runtime arena
+static size_t runtimeArenaBytes(size_t length, size_t elemSize) {
+	size_t bytes = (length > 0 ? length : 1) * elemSize;
+	return (bytes + RUNTIME_ARENA_ALIGNMENT - 1) / RUNTIME_ARENA_ALIGNMENT * RUNTIME_ARENA_ALIGNMENT;
+}
+
+static void* allocateAligned(size_t alignment, size_t bytes) {
+#if defined(WIN32) || defined(WIN64)
+	return _aligned_malloc(bytes, alignment);
+#else
+	void* ptr = NULL;
+	if (posix_memalign(&ptr, alignment, bytes) != 0)
+		return NULL;
+	return ptr;
+#endif
+}
+
+static void freeAligned(void* ptr) {
+#if defined(WIN32) || defined(WIN64)
+	_aligned_free(ptr);
+#else
+	free(ptr);
+#endif
+}
+
+// appends an array of length elements to a list of runtime arrays
+static void addRuntimeArray(std::vector<MemoryUsage>& arrays, const std::string& partition, const char* name,
+	size_t length, size_t elemSize) {
+	arrays.push_back(MemoryUsage(partition, name, length * elemSize));
+}
+
+/*!
+ * \brief this function lists all runtime arrays of a CPU runtime with their sizes
+ *
+ * The list mirrors the allocations done by the copy* functions when they are called by allocateSNN_CPU(). It is used
+ * to size the runtime arena, and by estimateMemory() to predict the footprint of a network that is not set up yet.
+ *
+ * \param[in] config the local network config of the CPU runtime
+ * \param[in] extFiringGroupSizes number of neurons of every group with external connections
+ * \param[in] withFixedWts whether the network has no plastic synapses
+ * \param[in] partition name of the partition (see MemoryUsage)
+ * \param[out] arrays the list to append the arrays to
+ *
+ * \sa computeRuntimeArenaSize_CPU
+ * \since v4.0
+ */
+void SNN::listRuntimeArrays_CPU(const NetworkConfigRT& config, const std::vector<int>& extFiringGroupSizes,
+	bool withFixedWts, const std::string& partition, std::vector<MemoryUsage>& arrays) {
+	std::vector<MemoryUsage>& a = arrays;
+	const std::string& p = partition;
+
+	addRuntimeArray(a, p, "randNum", config.numNPois, sizeof(float));
+
+	// copyPreConnectionInfo, copyPostConnectionInfo
+	addRuntimeArray(a, p, "Npre", config.numNAssigned, sizeof(unsigned short));
+	if (!withFixedWts) {
+		addRuntimeArray(a, p, "Npre_plastic", config.numNAssigned, sizeof(unsigned short));
+		addRuntimeArray(a, p, "Npre_plasticInv", config.numNAssigned, sizeof(float));
+	}
+	addRuntimeArray(a, p, "cumulativePre", config.numNAssigned, sizeof(unsigned int));
+	addRuntimeArray(a, p, "preSynapticIds", config.numPreSynNet, sizeof(SynInfo));
+	addRuntimeArray(a, p, "Npost", config.numNAssigned, sizeof(unsigned short));
+	addRuntimeArray(a, p, "cumulativePost", config.numNAssigned, sizeof(unsigned int));
+	addRuntimeArray(a, p, "postSynapticIds", config.numPostSynNet, sizeof(SynInfo));
+	addRuntimeArray(a, p, "postDelayInfo", config.numNAssigned * (config.maxDelay + 1), sizeof(DelayInfo));
+
+	// copySynapseState
+	addRuntimeArray(a, p, "wt", config.numPreSynNet, sizeof(float));
+	if (!withFixedWts) {
+		addRuntimeArray(a, p, "wtChange", config.numPreSynNet, sizeof(float));
+		addRuntimeArray(a, p, "maxSynWt", config.numPreSynNet, sizeof(float));
+	}
+	if (config.numKernelWt > 0) {
+		addRuntimeArray(a, p, "kernelWt", config.numKernelWt, sizeof(float));
+		addRuntimeArray(a, p, "kernelWtChange", config.numKernelWt, sizeof(float));
+		addRuntimeArray(a, p, "kernelMaxWt", config.numKernelWt, sizeof(float));
+	}
+
+	// copyNeuronState, copyNeuronParameters, copyExternalCurrent, copyConductance*, copyNeuronStateBuffer
+	if (config.numNReg > 0) {
+		const char* stateNames[] = {"voltage", "nextVoltage", "recovery", "current", "extCurrent", "Izh_a", "Izh_b",
+			"Izh_c", "Izh_d", "Izh_C", "Izh_k", "Izh_vr", "Izh_vt", "Izh_vpeak", "lif_vTh", "lif_vReset", "lif_gain",
+			"lif_bias"};
+		for (int i = 0; i < sizeof(stateNames) / sizeof(stateNames[0]); i++)
+			addRuntimeArray(a, p, stateNames[i], config.numNReg, sizeof(float));
+		if (sim_with_conductances) {
+			addRuntimeArray(a, p, "gAMPA", config.numNReg, sizeof(float));
+			addRuntimeArray(a, p, "gGABAa", config.numNReg, sizeof(float));
+			if (isSimulationWithNMDARise()) {
+				addRuntimeArray(a, p, "gNMDA_r", config.numNReg, sizeof(float));
+				addRuntimeArray(a, p, "gNMDA_d", config.numNReg, sizeof(float));
+			} else {
+				addRuntimeArray(a, p, "gNMDA", config.numNReg, sizeof(float));
+			}
+			if (isSimulationWithGABAbRise()) {
+				addRuntimeArray(a, p, "gGABAb_r", config.numNReg, sizeof(float));
+				addRuntimeArray(a, p, "gGABAb_d", config.numNReg, sizeof(float));
+			} else {
+				addRuntimeArray(a, p, "gGABAb", config.numNReg, sizeof(float));
+			}
+		}
+		if (sim_with_homeostasis) {
+			addRuntimeArray(a, p, "avgFiring", config.numNReg, sizeof(float));
+			addRuntimeArray(a, p, "baseFiring", config.numNReg, sizeof(float));
+			addRuntimeArray(a, p, "baseFiringInv", config.numNReg, sizeof(float));
+		}
+		addRuntimeArray(a, p, "lif_tau_m", config.numNReg, sizeof(int));
+		addRuntimeArray(a, p, "lif_tau_ref", config.numNReg, sizeof(int));
+		addRuntimeArray(a, p, "lif_tau_ref_c", config.numNReg, sizeof(int));
+		addRuntimeArray(a, p, "curSpike", config.numNReg, sizeof(bool));
+		if (config.sim_with_nm) {
+			addRuntimeArray(a, p, "nVBuffer", config.numNeuronMonSlots * MAX_NEURON_MON_GRP_SZIE * 1000, sizeof(float));
+			addRuntimeArray(a, p, "nUBuffer", config.numNeuronMonSlots * MAX_NEURON_MON_GRP_SZIE * 1000, sizeof(float));
+			addRuntimeArray(a, p, "nIBuffer", config.numNeuronMonSlots * MAX_NEURON_MON_GRP_SZIE * 1000, sizeof(float));
+		}
+		if (config.numNeuronMonStreamFloats > 0) {
+			addRuntimeArray(a, p, "nStreamBuffer", config.numNeuronMonStreamFloats, sizeof(float));
+			addRuntimeArray(a, p, "nStreamSlot", config.numNeuronMonStreamSlots, sizeof(int));
+		}
+	}
+
+	// copySTPState
+	if (sim_with_stp) {
+		addRuntimeArray(a, p, "stpu", config.numN * (config.maxDelay + 1), sizeof(float));
+		addRuntimeArray(a, p, "stpx", config.numN * (config.maxDelay + 1), sizeof(float));
+	}
+
+	// copyGroupState
+	const char* grpNames[] = {"grpDA", "grp5HT", "grpACh", "grpNE"};
+	const char* grpBufferNames[] = {"grpDABuffer", "grp5HTBuffer", "grpAChBuffer", "grpNEBuffer"};
+	for (int i = 0; i < 4; i++)
+		addRuntimeArray(a, p, grpNames[i], config.numGroups, sizeof(float));
+	for (int i = 0; i < 4; i++)
+		addRuntimeArray(a, p, grpBufferNames[i], 1000 * config.numGroups, sizeof(float));
+
+	// copyAuxiliaryData
+	int I_setLength = ceil(((config.maxNumPreSynN) / 32.0f));
+	addRuntimeArray(a, p, "spikeGenBits", config.numNSpikeGen / 32 + 1, sizeof(unsigned int));
+	addRuntimeArray(a, p, "poissonFireRate", config.numNPois, sizeof(float));
+	addRuntimeArray(a, p, "I_set", config.numNReg * I_setLength, sizeof(int));
+	addRuntimeArray(a, p, "synSpikeTime", config.numPreSynNet, sizeof(int));
+	addRuntimeArray(a, p, "lastSpikeTime", config.numNAssigned, sizeof(int));
+	addRuntimeArray(a, p, "nSpikeCnt", config.numN, sizeof(int));
+	addRuntimeArray(a, p, "grpIds", config.numNAssigned, sizeof(short int));
+	addRuntimeArray(a, p, "connIdsPreIdx", config.numPreSynNet, sizeof(short int));
+	addRuntimeArray(a, p, "timeTableD1", TIMING_COUNT, sizeof(unsigned int));
+	addRuntimeArray(a, p, "timeTableD2", TIMING_COUNT, sizeof(unsigned int));
+	addRuntimeArray(a, p, "firingTableD1", config.maxSpikesD1, sizeof(int));
+	addRuntimeArray(a, p, "firingTableD2", config.maxSpikesD2, sizeof(int));
+	addRuntimeArray(a, p, "extFiringTableD1", config.numGroups, sizeof(int*));
+	addRuntimeArray(a, p, "extFiringTableD2", config.numGroups, sizeof(int*));
+	for (size_t i = 0; i < extFiringGroupSizes.size(); i++) {
+		addRuntimeArray(a, p, "extFiringTableD1", extFiringGroupSizes[i] * NEURON_MAX_FIRING_RATE, sizeof(int));
+		addRuntimeArray(a, p, "extFiringTableD2", extFiringGroupSizes[i] * NEURON_MAX_FIRING_RATE, sizeof(int));
+	}
+	addRuntimeArray(a, p, "extFiringTableEndIdxD1", config.numGroups, sizeof(int));
+	addRuntimeArray(a, p, "extFiringTableEndIdxD2", config.numGroups, sizeof(int));
+}
+
+/*!
+ * \brief this function computes the size of the arena that holds all runtime arrays of a CPU runtime
+ *
+ * Each array listed by listRuntimeArrays_CPU() is padded to RUNTIME_ARENA_ALIGNMENT bytes. Underestimating is not
+ * fatal, arrays that do not fit are allocated separately by carveRuntimeArena_CPU().
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ *
+ * \sa allocateRuntimeArena_CPU
+ * \since v4.0
+ */
+size_t SNN::computeRuntimeArenaSize_CPU(int netId) {
+	std::vector<int> extFiringGroupSizes;
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++)
+		if (groupConfigs[netId][lGrpId].hasExternalConnect)
+			extFiringGroupSizes.push_back(groupConfigs[netId][lGrpId].numN);
+
+	std::vector<MemoryUsage> arrays;
+	listRuntimeArrays_CPU(networkConfigs[netId], extFiringGroupSizes, sim_with_fixedwts, "", arrays);
+
+	size_t size = 0;
+	for (size_t i = 0; i < arrays.size(); i++)
+		size += runtimeArenaBytes(arrays[i].bytes, 1);
+
+	return size;
+}
+
+/*!
+ * \brief this function allocates the arena that holds all runtime arrays of a CPU runtime
+ *
+ * The arena is a single RUNTIME_ARENA_ALIGNMENT-aligned region. Large arenas are aligned to RUNTIME_ARENA_HUGEPAGE
+ * and advised to use transparent huge pages (Linux only). The pages are first touched by a thread pinned to the
+ * same core as the worker threads of this runtime, so that they are placed on the memory node of that core.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ *
+ * \sa allocateSNN_CPU freeRuntimeArena_CPU
+ * \since v4.0
+ */
+void SNN::allocateRuntimeArena_CPU(int netId) {
+	assert(runtimeData[netId].arena == NULL);
+	assert(runtimeArenaSpill[netId].empty());
+
+	size_t size = computeRuntimeArenaSize_CPU(netId);
+	size_t alignment = RUNTIME_ARENA_ALIGNMENT;
+	if (size >= RUNTIME_ARENA_HUGEPAGE) {
+		alignment = RUNTIME_ARENA_HUGEPAGE;
+		size = (size + RUNTIME_ARENA_HUGEPAGE - 1) / RUNTIME_ARENA_HUGEPAGE * RUNTIME_ARENA_HUGEPAGE;
+	}
+
+	runtimeData[netId].arena = static_cast<char*>(allocateAligned(alignment, size));
+	if (runtimeData[netId].arena == NULL) {
+		KERNEL_ERROR("Failed to allocate %.2f MB of runtime data for CPU runtime %d", (float)size / (1024 * 1024), netId);
+		exitSimulation(1);
+	}
+	runtimeData[netId].arenaSize = size;
+	runtimeData[netId].arenaUsed = 0;
+
+#if defined(MADV_HUGEPAGE)
+	if (alignment == RUNTIME_ARENA_HUGEPAGE)
+		madvise(runtimeData[netId].arena, size, MADV_HUGEPAGE);
+#endif
+
+#if defined(WIN32) || defined(WIN64) || defined(__APPLE__)
+	memset(runtimeData[netId].arena, 0, size);
+#else // Linux or MAC
+	// place the first-touch thread like the worker threads of this runtime in the runNetwork() phases
+	pthread_t thread;
+	pthread_attr_t attr;
+	ThreadStruct args;
+	pthread_attr_init(&attr);
+	setThreadAffinity_CPU(netId, &attr);
+
+	args.snn_pointer = this;
+	args.netId = netId;
+	args.lGrpId = 0;
+	args.startIdx = 0;
+	args.endIdx = 0;
+	args.GtoLOffset = 0;
+
+	pthread_create(&thread, &attr, &SNN::helperTouchRuntimeArena_CPU, (void*)&args);
+	pthread_attr_destroy(&attr);
+	pthread_join(thread, NULL);
+#endif
+
+	KERNEL_DEBUG("CPU runtime %d: allocated %.2f MB runtime arena", netId, (float)size / (1024 * 1024));
+}
+
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
+	// Static multithreading subroutine method - first touch of the runtime arena
+	void* SNN::helperTouchRuntimeArena_CPU(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		RuntimeData* rtd = &((SNN *)args->snn_pointer)->runtimeData[args->netId];
+		memset(rtd->arena, 0, rtd->arenaSize);
+		pthread_exit(0);
+	}
+
+	// restricts a thread of CPU runtime netId to the cores assigned by assignCPUAffinity()
+	void SNN::setThreadAffinity_CPU(int netId, pthread_attr_t* attr) {
+		assert(!runtimeCores[netId].empty());
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		for (size_t i = 0; i < runtimeCores[netId].size(); i++)
+			CPU_SET(runtimeCores[netId][i], &cpus);
+		pthread_attr_setaffinity_np(attr, sizeof(cpu_set_t), &cpus);
+	}
+#endif
+
+/*!
+ * \brief this function hands out the next bytes of the arena of a CPU runtime
+ *
+ * Every array starts on a RUNTIME_ARENA_ALIGNMENT boundary. Should the arena be exhausted, the array is allocated
+ * separately and released together with the arena.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ * \param[in] bytes the number of bytes to hand out
+ *
+ * \sa allocateRuntimeArray_CPU
+ * \since v4.0
+ */
+void* SNN::carveRuntimeArena_CPU(int netId, size_t bytes) {
+	RuntimeData* rtd = &runtimeData[netId];
+	assert(rtd->memType == CPU_MEM && rtd->arena != NULL);
+
+	size_t padded = runtimeArenaBytes(bytes, 1);
+	if (rtd->arenaUsed + padded <= rtd->arenaSize) {
+		void* ptr = rtd->arena + rtd->arenaUsed;
+		rtd->arenaUsed += padded;
+		return ptr;
+	}
+
+	KERNEL_DEBUG("CPU runtime %d: runtime arena exhausted, allocating %lu bytes separately", netId, (unsigned long)bytes);
+	void* ptr = allocateAligned(RUNTIME_ARENA_ALIGNMENT, padded);
+	if (ptr == NULL) {
+		KERNEL_ERROR("Failed to allocate %lu bytes of runtime data for CPU runtime %d", (unsigned long)bytes, netId);
+		exitSimulation(1);
+	}
+	memset(ptr, 0, padded);
+	runtimeArenaSpill[netId].push_back(ptr);
+	return ptr;
+}
+
+//! releases the arena of a CPU runtime and all arrays that did not fit into it
+void SNN::freeRuntimeArena_CPU(int netId) {
+	for (size_t i = 0; i < runtimeArenaSpill[netId].size(); i++)
+		freeAligned(runtimeArenaSpill[netId][i]);
+	runtimeArenaSpill[netId].clear();
+
+	if (runtimeData[netId].arena != NULL)
+		freeAligned(runtimeData[netId].arena);
+	runtimeData[netId].arena = NULL;
+	runtimeData[netId].arenaSize = 0;
+	runtimeData[netId].arenaUsed = 0;
+	runtimeArrayBytes[netId].clear();
+}
+
+// appends an array of a CPU runtime to a checkpoint, arrays that were not allocated are skipped
+static void addCheckpointArray(std::vector<CheckpointArray>& arrays, void* data, size_t length, size_t elemSize) {
+	if (data == NULL || length == 0)
+		return;
+
+	CheckpointArray array;
+	array.data = data;
+	array.size = length * elemSize;
+	arrays.push_back(array);
+}
+
+/*!
+ * \brief this function lists the arrays of a CPU runtime that change while the network is running
+ *
+ * The connectivity (synapse IDs, delays, and neuron parameters) is not part of the list, because it does not change
+ * during runNetwork. The order of the list only depends on the network configuration, so that a checkpoint can be
+ * restored into any network that was set up from the same configuration.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ * \param[out] arrays the arrays in the order in which they are stored in a checkpoint
+ *
+ * \sa saveCheckpoint loadCheckpoint
+ * \since v4.0
+ */
+void SNN::collectCheckpointArrays_CPU(int netId, std::vector<CheckpointArray>& arrays) {
+	const NetworkConfigRT& config = networkConfigs[netId];
+	RuntimeData& rtd = runtimeData[netId];
+	int numDelayBufs = config.numN * (config.maxDelay + 1);
+	int numNeuronMonBufs = config.numNeuronMonSlots * MAX_NEURON_MON_GRP_SZIE * 1000;
+
+	arrays.clear();
+
+	// neuron state
+	addCheckpointArray(arrays, rtd.voltage, config.numNReg, sizeof(float));
+	addCheckpointArray(arrays, rtd.nextVoltage, config.numNReg, sizeof(float));
+	addCheckpointArray(arrays, rtd.recovery, config.numNReg, sizeof(float));
+	addCheckpointArray(arrays, rtd.current, config.numNReg, sizeof(float));
+	addCheckpointArray(arrays, rtd.extCurrent, config.numNReg, sizeof(float));
+	addCheckpointArray(arrays, rtd.lif_tau_ref_c, config.numNReg, sizeof(int));
+	addCheckpointArray(arrays, rtd.curSpike, config.numNReg, sizeof(bool));
+	addCheckpointArray(arrays, rtd.I_set, config.numNReg * config.I_setLength, sizeof(int));
+	addCheckpointArray(arrays, rtd.avgFiring, config.numNReg, sizeof(float));
+	addCheckpointArray(arrays, rtd.baseFiring, config.numNReg, sizeof(float));
+
+	// conductances
+	addCheckpointArray(arrays, rtd.gAMPA, config.numNReg, sizeof(float));
+	addCheckpointArray(arrays, rtd.gNMDA, config.numNReg, sizeof(float));
+	addCheckpointArray(arrays, rtd.gNMDA_r, config.numNReg, sizeof(float));
+	addCheckpointArray(arrays, rtd.gNMDA_d, config.numNReg, sizeof(float));
+	addCheckpointArray(arrays, rtd.gGABAa, config.numNReg, sizeof(float));
+	addCheckpointArray(arrays, rtd.gGABAb, config.numNReg, sizeof(float));
+	addCheckpointArray(arrays, rtd.gGABAb_r, config.numNReg, sizeof(float));
+	addCheckpointArray(arrays, rtd.gGABAb_d, config.numNReg, sizeof(float));
+
+	// short-term plasticity history
+	addCheckpointArray(arrays, rtd.stpu, numDelayBufs, sizeof(float));
+	addCheckpointArray(arrays, rtd.stpx, numDelayBufs, sizeof(float));
+
+	// synapse state
+	addCheckpointArray(arrays, rtd.wt, config.numPreSynNet, sizeof(float));
+	addCheckpointArray(arrays, rtd.wtChange, config.numPreSynNet, sizeof(float));
+	addCheckpointArray(arrays, rtd.maxSynWt, config.numPreSynNet, sizeof(float));
+	addCheckpointArray(arrays, rtd.synSpikeTime, config.numPreSynNet, sizeof(int));
+	addCheckpointArray(arrays, rtd.kernelWt, config.numKernelWt, sizeof(float));
+	addCheckpointArray(arrays, rtd.kernelWtChange, config.numKernelWt, sizeof(float));
+	addCheckpointArray(arrays, rtd.lastSpikeTime, config.numNAssigned, sizeof(int));
+	addCheckpointArray(arrays, rtd.nSpikeCnt, config.numN, sizeof(int));
+	addCheckpointArray(arrays, rtd.poissonFireRate, config.numNPois, sizeof(float));
+
+	// firing tables
+	addCheckpointArray(arrays, rtd.timeTableD1, TIMING_COUNT, sizeof(unsigned int));
+	addCheckpointArray(arrays, rtd.timeTableD2, TIMING_COUNT, sizeof(unsigned int));
+	addCheckpointArray(arrays, rtd.firingTableD1, config.maxSpikesD1, sizeof(int));
+	addCheckpointArray(arrays, rtd.firingTableD2, config.maxSpikesD2, sizeof(int));
+	addCheckpointArray(arrays, rtd.extFiringTableEndIdxD1, config.numGroups, sizeof(int));
+	addCheckpointArray(arrays, rtd.extFiringTableEndIdxD2, config.numGroups, sizeof(int));
+	for (int lGrpId = 0; lGrpId < config.numGroups; lGrpId++) {
+		if (groupConfigs[netId][lGrpId].hasExternalConnect) {
+			addCheckpointArray(arrays, rtd.extFiringTableD1[lGrpId], groupConfigs[netId][lGrpId].numN * NEURON_MAX_FIRING_RATE, sizeof(int));
+			addCheckpointArray(arrays, rtd.extFiringTableD2[lGrpId], groupConfigs[netId][lGrpId].numN * NEURON_MAX_FIRING_RATE, sizeof(int));
+		}
+	}
+
+	// neuromodulators and the monitor buffers of the current second
+	addCheckpointArray(arrays, rtd.grpDA, config.numGroups, sizeof(float));
+	addCheckpointArray(arrays, rtd.grp5HT, config.numGroups, sizeof(float));
+	addCheckpointArray(arrays, rtd.grpACh, config.numGroups, sizeof(float));
+	addCheckpointArray(arrays, rtd.grpNE, config.numGroups, sizeof(float));
+	addCheckpointArray(arrays, rtd.grpDABuffer, 1000 * config.numGroups, sizeof(float));
+	addCheckpointArray(arrays, rtd.grp5HTBuffer, 1000 * config.numGroups, sizeof(float));
+	addCheckpointArray(arrays, rtd.grpAChBuffer, 1000 * config.numGroups, sizeof(float));
+	addCheckpointArray(arrays, rtd.grpNEBuffer, 1000 * config.numGroups, sizeof(float));
+	addCheckpointArray(arrays, rtd.nVBuffer, numNeuronMonBufs, sizeof(float));
+	addCheckpointArray(arrays, rtd.nUBuffer, numNeuronMonBufs, sizeof(float));
+	addCheckpointArray(arrays, rtd.nIBuffer, numNeuronMonBufs, sizeof(float));
+	addCheckpointArray(arrays, rtd.nStreamBuffer, config.numNeuronMonStreamFloats, sizeof(float));
+}
+
 void SNN::allocateSNN_CPU(int netId) {
 	// setup memory type of CPU runtime data
 	runtimeData[netId].memType = CPU_MEM;
 
+	// all runtime arrays below are carved out of a single aligned region
+	allocateRuntimeArena_CPU(netId);
+
 	// display some memory management info
 	//size_t avail, total, previous;
 	//float toMB = std::pow(1024.0f, 2);
@@ -1358,7 +1884,7 @@ void SNN::allocateSNN_CPU(int netId) {
 	//previous=avail;
 
 	// allocate SNN::runtimeData[0].randNum for random number generators
-	runtimeData[netId].randNum = new float[networkConfigs[netId].numNPois];
+	runtimeData[netId].randNum = allocateRuntimeArray_CPU<float>(netId, networkConfigs[netId].numNPois, "randNum");
 	//KERNEL_INFO("Random Gen:\t\t%2.3f MB\t%2.3f MB\t%2.3f MB",(float)(previous-avail)/toMB, (float)((total-avail)/toMB),(float)(avail/toMB));
 	//previous=avail;
 
@@ -1484,14 +2010,14 @@ void SNN::copyPreConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runtim
 
 	// connection synaptic lengths and cumulative lengths...
 	if(allocateMem) 
-		dest->Npre = new unsigned short[networkConfigs[netId].numNAssigned];
+		dest->Npre = allocateRuntimeArray_CPU<unsigned short>(netId, networkConfigs[netId].numNAssigned, "Npre");
 	memcpy(&dest->Npre[posN], &src->Npre[posN], sizeof(short) * lengthN);
 
 	// we don't need these data structures if the network doesn't have any plastic synapses at all
 	if (!sim_with_fixedwts) {
 		// presyn excitatory connections
 		if(allocateMem)
-			dest->Npre_plastic = new unsigned short[networkConfigs[netId].numNAssigned];
+			dest->Npre_plastic = allocateRuntimeArray_CPU<unsigned short>(netId, networkConfigs[netId].numNAssigned, "Npre_plastic");
 		memcpy(&dest->Npre_plastic[posN], &src->Npre_plastic[posN], sizeof(short) * lengthN);
 
 		// Npre_plasticInv is only used on GPUs, only allocate and copy it during initialization
@@ -1501,7 +2027,7 @@ void SNN::copyPreConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runtim
 			for (int i = 0; i < networkConfigs[netId].numNAssigned; i++)
 				Npre_plasticInv[i] = 1.0f / managerRuntimeData.Npre_plastic[i];
 
-			dest->Npre_plasticInv = new float[networkConfigs[netId].numNAssigned];
+			dest->Npre_plasticInv = allocateRuntimeArray_CPU<float>(netId, networkConfigs[netId].numNAssigned, "Npre_plasticInv");
 			memcpy(dest->Npre_plasticInv, Npre_plasticInv, sizeof(float) * networkConfigs[netId].numNAssigned);
 
 			delete[] Npre_plasticInv;
@@ -1510,7 +2036,7 @@ void SNN::copyPreConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runtim
 
 	// beginning position for the pre-synaptic information
 	if(allocateMem)
-		dest->cumulativePre = new unsigned int[networkConfigs[netId].numNAssigned];
+		dest->cumulativePre = allocateRuntimeArray_CPU<unsigned int>(netId, networkConfigs[netId].numNAssigned, "cumulativePre");
 	memcpy(&dest->cumulativePre[posN], &src->cumulativePre[posN], sizeof(int) * lengthN);
 
 	// Npre, cumulativePre has been copied to destination
@@ -1526,7 +2052,7 @@ void SNN::copyPreConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runtim
 	}
 
 	if(allocateMem)
-		dest->preSynapticIds = new SynInfo[networkConfigs[netId].numPreSynNet];
+		dest->preSynapticIds = allocateRuntimeArray_CPU<SynInfo>(netId, networkConfigs[netId].numPreSynNet, "preSynapticIds");
 	memcpy(&dest->preSynapticIds[posSyn], &src->preSynapticIds[posSyn], sizeof(SynInfo) * lengthSyn);
 }
 
@@ -1559,12 +2085,12 @@ void SNN::copyPostConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runti
 
 	// number of postsynaptic connections
 	if(allocateMem)
-		dest->Npost = new unsigned short[networkConfigs[netId].numNAssigned];
+		dest->Npost = allocateRuntimeArray_CPU<unsigned short>(netId, networkConfigs[netId].numNAssigned, "Npost");
 	memcpy(&dest->Npost[posN], &src->Npost[posN], sizeof(short) * lengthN);
 
 	// beginning position for the post-synaptic information
 	if(allocateMem)
-		dest->cumulativePost = new unsigned int[networkConfigs[netId].numNAssigned];
+		dest->cumulativePost = allocateRuntimeArray_CPU<unsigned int>(netId, networkConfigs[netId].numNAssigned, "cumulativePost");
 	memcpy(&dest->cumulativePost[posN], &src->cumulativePost[posN], sizeof(int) * lengthN);
 
 
@@ -1582,12 +2108,12 @@ void SNN::copyPostConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runti
 
 	// actual post synaptic connection information...
 	if(allocateMem)
-		dest->postSynapticIds = new SynInfo[networkConfigs[netId].numPostSynNet];
+		dest->postSynapticIds = allocateRuntimeArray_CPU<SynInfo>(netId, networkConfigs[netId].numPostSynNet, "postSynapticIds");
 	memcpy(&dest->postSynapticIds[posSyn], &src->postSynapticIds[posSyn], sizeof(SynInfo) * lengthSyn);
 
 	// static specific mapping and actual post-synaptic delay metric
 	if(allocateMem)
-		dest->postDelayInfo = new DelayInfo[networkConfigs[netId].numNAssigned * (glbNetworkConfig.maxDelay + 1)];
+		dest->postDelayInfo = allocateRuntimeArray_CPU<DelayInfo>(netId, networkConfigs[netId].numNAssigned * (glbNetworkConfig.maxDelay + 1), "postDelayInfo");
 	memcpy(&dest->postDelayInfo[posN * (glbNetworkConfig.maxDelay + 1)], &src->postDelayInfo[posN * (glbNetworkConfig.maxDelay + 1)], sizeof(DelayInfo) * lengthN * (glbNetworkConfig.maxDelay + 1));
 }
 
@@ -1611,7 +2137,7 @@ void SNN::copySynapseState(int netId, RuntimeData* dest, RuntimeData* src, bool
 
 	// synaptic information based
 	if(allocateMem)
-		dest->wt = new float[networkConfigs[netId].numPreSynNet];
+		dest->wt = allocateRuntimeArray_CPU<float>(netId, networkConfigs[netId].numPreSynNet, "wt");
 	memcpy(dest->wt, src->wt, sizeof(float) * networkConfigs[netId].numPreSynNet);
 
 	// we don't need these data structures if the network doesn't have any plastic synapses at all
@@ -1620,14 +2146,26 @@ void SNN::copySynapseState(int netId, RuntimeData* dest, RuntimeData* src, bool
 	if (!sim_with_fixedwts) {
 		// synaptic weight derivative
 		if(allocateMem)
-			dest->wtChange = new float[networkConfigs[netId].numPreSynNet];
+			dest->wtChange = allocateRuntimeArray_CPU<float>(netId, networkConfigs[netId].numPreSynNet, "wtChange");
 		memcpy(dest->wtChange, src->wtChange, sizeof(float) * networkConfigs[netId].numPreSynNet);
 
 		// synaptic weight maximum value
 		if(allocateMem)
-			dest->maxSynWt = new float[networkConfigs[netId].numPreSynNet];
+			dest->maxSynWt = allocateRuntimeArray_CPU<float>(netId, networkConfigs[netId].numPreSynNet, "maxSynWt");
 		memcpy(dest->maxSynWt, src->maxSynWt, sizeof(float) * networkConfigs[netId].numPreSynNet);
 	}
+
+	// shared-kernel connections: the kernels themselves
+	if (networkConfigs[netId].numKernelWt > 0) {
+		if(allocateMem) {
+			dest->kernelWt = allocateRuntimeArray_CPU<float>(netId, networkConfigs[netId].numKernelWt, "kernelWt");
+			dest->kernelWtChange = allocateRuntimeArray_CPU<float>(netId, networkConfigs[netId].numKernelWt, "kernelWtChange");
+			dest->kernelMaxWt = allocateRuntimeArray_CPU<float>(netId, networkConfigs[netId].numKernelWt, "kernelMaxWt");
+		}
+		memcpy(dest->kernelWt, src->kernelWt, sizeof(float) * networkConfigs[netId].numKernelWt);
+		memcpy(dest->kernelWtChange, src->kernelWtChange, sizeof(float) * networkConfigs[netId].numKernelWt);
+		memcpy(dest->kernelMaxWt, src->kernelMaxWt, sizeof(float) * networkConfigs[netId].numKernelWt);
+	}
 }
 
 /*!
@@ -1667,21 +2205,21 @@ void SNN::copyNeuronState(int netId, int lGrpId, RuntimeData* dest, bool allocat
 		return;
 
 	if(allocateMem)
-		dest->recovery = new float[length];
+		dest->recovery = allocateRuntimeArray_CPU<float>(netId, length, "recovery");
 	memcpy(&dest->recovery[ptrPos], &managerRuntimeData.recovery[ptrPos], sizeof(float) * length);
 
 	if(allocateMem)
-		dest->voltage = new float[length];
+		dest->voltage = allocateRuntimeArray_CPU<float>(netId, length, "voltage");
 	memcpy(&dest->voltage[ptrPos], &managerRuntimeData.voltage[ptrPos], sizeof(float) * length);
 
 	if (allocateMem)
 
-		dest->nextVoltage = new float[length];
+		dest->nextVoltage = allocateRuntimeArray_CPU<float>(netId, length, "nextVoltage");
 	memcpy(&dest->nextVoltage[ptrPos], &managerRuntimeData.nextVoltage[ptrPos], sizeof(float) * length);
 
 	//neuron input current...
 	if(allocateMem)
-		dest->current = new float[length];
+		dest->current = allocateRuntimeArray_CPU<float>(netId, length, "current");
 	memcpy(&dest->current[ptrPos], &managerRuntimeData.current[ptrPos], sizeof(float) * length);
 
 	if (sim_with_conductances) {
@@ -1697,7 +2235,7 @@ void SNN::copyNeuronState(int netId, int lGrpId, RuntimeData* dest, bool allocat
 	copyExternalCurrent(netId, lGrpId, dest, allocateMem);
 
 	if (allocateMem)
-		dest->curSpike = new bool[length];
+		dest->curSpike = allocateRuntimeArray_CPU<bool>(netId, length, "curSpike");
 	memcpy(&dest->curSpike[ptrPos], &managerRuntimeData.curSpike[ptrPos], sizeof(bool) * length);
 
 	copyNeuronParameters(netId, lGrpId, dest, allocateMem);
@@ -1705,11 +2243,14 @@ void SNN::copyNeuronState(int netId, int lGrpId, RuntimeData* dest, bool allocat
 	if (networkConfigs[netId].sim_with_nm)
 		copyNeuronStateBuffer(netId, lGrpId, dest, &managerRuntimeData, allocateMem);
 
+	if (networkConfigs[netId].numNeuronMonStreamFloats > 0)
+		copyNeuronStreamBuffer(netId, lGrpId, dest, &managerRuntimeData, allocateMem);
+
 	if (sim_with_homeostasis) {
 		//Included to enable homeostasis in CPU_MODE.
 		// Avg. Firing...
 		if(allocateMem)
-			dest->avgFiring = new float[length];
+			dest->avgFiring = allocateRuntimeArray_CPU<float>(netId, length, "avgFiring");
 		memcpy(&dest->avgFiring[ptrPos], &managerRuntimeData.avgFiring[ptrPos], sizeof(float) * length);
 	}
 }
@@ -1750,7 +2291,7 @@ void SNN::copyConductanceAMPA(int netId, int lGrpId, RuntimeData* dest, RuntimeD
 	//conductance information
 	assert(src->gAMPA  != NULL);
 	if(allocateMem)
-		dest->gAMPA = new float[length];
+		dest->gAMPA = allocateRuntimeArray_CPU<float>(netId, length, "gAMPA");
 	memcpy(&dest->gAMPA[ptrPos + destOffset], &src->gAMPA[ptrPos], sizeof(float) * length);
 }
 
@@ -1790,17 +2331,17 @@ void SNN::copyConductanceNMDA(int netId, int lGrpId, RuntimeData* dest, RuntimeD
 	if (isSimulationWithNMDARise()) {
 		assert(src->gNMDA_r != NULL);
 		if(allocateMem)
-			dest->gNMDA_r = new float[length];
+			dest->gNMDA_r = allocateRuntimeArray_CPU<float>(netId, length, "gNMDA_r");
 		memcpy(&dest->gNMDA_r[ptrPos], &src->gNMDA_r[ptrPos], sizeof(float) * length);
 
 		assert(src->gNMDA_d != NULL);
 		if(allocateMem)
-			dest->gNMDA_d = new float[length];
+			dest->gNMDA_d = allocateRuntimeArray_CPU<float>(netId, length, "gNMDA_d");
 		memcpy(&dest->gNMDA_d[ptrPos], &src->gNMDA_d[ptrPos], sizeof(float) * length);
 	} else {
 		assert(src->gNMDA != NULL);
 		if(allocateMem)
-			dest->gNMDA = new float[length];
+			dest->gNMDA = allocateRuntimeArray_CPU<float>(netId, length, "gNMDA");
 		memcpy(&dest->gNMDA[ptrPos + destOffset], &src->gNMDA[ptrPos], sizeof(float) * length);
 	}
 }
@@ -1840,7 +2381,7 @@ void SNN::copyConductanceGABAa(int netId, int lGrpId, RuntimeData* dest, Runtime
 
 	assert(src->gGABAa != NULL);
 	if(allocateMem)
-		dest->gGABAa = new float[length];
+		dest->gGABAa = allocateRuntimeArray_CPU<float>(netId, length, "gGABAa");
 	memcpy(&dest->gGABAa[ptrPos + destOffset], &src->gGABAa[ptrPos], sizeof(float) * length);
 }
 
@@ -1880,17 +2421,17 @@ void SNN::copyConductanceGABAb(int netId, int lGrpId, RuntimeData* dest, Runtime
 	if (isSimulationWithGABAbRise()) {
 		assert(src->gGABAb_r != NULL);
 		if(allocateMem)
-			dest->gGABAb_r = new float[length];
+			dest->gGABAb_r = allocateRuntimeArray_CPU<float>(netId, length, "gGABAb_r");
 		memcpy(&dest->gGABAb_r[ptrPos], &src->gGABAb_r[ptrPos], sizeof(float) * length);
 
 		assert(src->gGABAb_d != NULL);
 		if(allocateMem)
-			dest->gGABAb_d = new float[length];
+			dest->gGABAb_d = allocateRuntimeArray_CPU<float>(netId, length, "gGABAb_d");
 		memcpy(&dest->gGABAb_d[ptrPos], &src->gGABAb_d[ptrPos], sizeof(float) * length);
 	} else {
 		assert(src->gGABAb != NULL);
 		if(allocateMem)
-			dest->gGABAb = new float[length];
+			dest->gGABAb = allocateRuntimeArray_CPU<float>(netId, length, "gGABAb");
 		memcpy(&dest->gGABAb[ptrPos + destOffset], &src->gGABAb[ptrPos], sizeof(float) * length);
 	}
 }
@@ -1915,31 +2456,78 @@ void SNN::copyConductanceGABAb(int netId, int lGrpId, RuntimeData* dest, Runtime
 void SNN::copyNeuronStateBuffer(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, bool allocateMem) {
 	int ptrPos, length;
 
+	// the buffers only hold groups with a NeuronMonitor, the 1 second record of each group is contiguous
 	if (lGrpId == ALL) {
 		ptrPos = 0;
-		length = networkConfigs[netId].numGroups * MAX_NEURON_MON_GRP_SZIE * 1000;
+		length = networkConfigs[netId].numNeuronMonSlots * MAX_NEURON_MON_GRP_SZIE * 1000;
 	}
 	else {
-		ptrPos = lGrpId * MAX_NEURON_MON_GRP_SZIE * 1000;
+		if (groupConfigs[netId][lGrpId].neuronMonitorSlot < 0)
+			return;
+		ptrPos = groupConfigs[netId][lGrpId].neuronMonitorSlot * MAX_NEURON_MON_GRP_SZIE * 1000;
 		length = MAX_NEURON_MON_GRP_SZIE * 1000;
 	}
-	assert(length <= networkConfigs[netId].numGroups * MAX_NEURON_MON_GRP_SZIE * 1000);
+	assert(length <= networkConfigs[netId].numNeuronMonSlots * MAX_NEURON_MON_GRP_SZIE * 1000);
 	assert(length > 0);
 
 	// neuron information
 	assert(src->nVBuffer != NULL);
-	if (allocateMem) dest->nVBuffer = new float[length];
+	if (allocateMem) dest->nVBuffer = allocateRuntimeArray_CPU<float>(netId, length, "nVBuffer");
 	memcpy(&dest->nVBuffer[ptrPos], &src->nVBuffer[ptrPos], sizeof(float) * length);
 
 	assert(src->nUBuffer != NULL);
-	if (allocateMem) dest->nUBuffer = new float[length];
+	if (allocateMem) dest->nUBuffer = allocateRuntimeArray_CPU<float>(netId, length, "nUBuffer");
 	memcpy(&dest->nUBuffer[ptrPos], &src->nUBuffer[ptrPos], sizeof(float) * length);
 
 	assert(src->nIBuffer != NULL);
-	if (allocateMem) dest->nIBuffer = new float[length];
+	if (allocateMem) dest->nIBuffer = allocateRuntimeArray_CPU<float>(netId, length, "nIBuffer");
 	memcpy(&dest->nIBuffer[ptrPos], &src->nIBuffer[ptrPos], sizeof(float) * length);
 }
 
+/*!
+* \brief This function fetch the ring buffer of sampling neuron monitors in the local network specified by netId
+*
+* This function:
+* (allocate and) copy nStreamBuffer
+* allocate and fill nStreamSlot (which is static and only lives in the runtime)
+*
+* This funcion is called by copyNeuronState() and fetchNeuronStreamBuffer()
+*
+* \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+* \param[in] lGrpId the local group id in a local network, which specifiy the group(s) to be copied
+* \param[in] dest pointer to runtime data desitnation
+* \param[in] src pointer to runtime data source
+* \param[in] allocateMem a flag indicates whether allocating memory space before copying
+*
+* \sa copyNeuronState fetchNeuronStreamBuffer
+* \since v4.0
+*/
+void SNN::copyNeuronStreamBuffer(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, bool allocateMem) {
+	int ptrPos, length;
+
+	// the ring buffer of each sampling neuron monitor is contiguous
+	if (lGrpId == ALL) {
+		ptrPos = 0;
+		length = networkConfigs[netId].numNeuronMonStreamFloats;
+	}
+	else {
+		if (groupConfigs[netId][lGrpId].neuronMonitorStreamOffset < 0)
+			return;
+		ptrPos = groupConfigs[netId][lGrpId].neuronMonitorStreamOffset;
+		length = 3 * groupConfigs[netId][lGrpId].neuronMonitorStreamNumN * groupConfigs[netId][lGrpId].neuronMonitorStreamWindow;
+	}
+	assert(ptrPos + length <= networkConfigs[netId].numNeuronMonStreamFloats);
+	assert(length > 0);
+
+	assert(src->nStreamBuffer != NULL);
+	if (allocateMem) {
+		dest->nStreamBuffer = allocateRuntimeArray_CPU<float>(netId, length, "nStreamBuffer");
+		dest->nStreamSlot = allocateRuntimeArray_CPU<int>(netId, networkConfigs[netId].numNeuronMonStreamSlots, "nStreamSlot");
+		fillNeuronStreamSlots(netId, dest->nStreamSlot);
+	}
+	memcpy(&dest->nStreamBuffer[ptrPos], &src->nStreamBuffer[ptrPos], sizeof(float) * length);
+}
+
 /*!
  * \brief this function allocates memory sapce and copies external current to it
  *
@@ -1973,7 +2561,7 @@ void SNN::copyExternalCurrent(int netId, int lGrpId, RuntimeData* dest, bool all
 	KERNEL_DEBUG("copyExternalCurrent: lGrpId=%d, ptrPos=%d, length=%d, allocate=%s", lGrpId, posN, lengthN, allocateMem?"y":"n");
 
 	if(allocateMem)
-		dest->extCurrent = new float[lengthN];
+		dest->extCurrent = allocateRuntimeArray_CPU<float>(netId, lengthN, "extCurrent");
 	memcpy(&(dest->extCurrent[posN]), &(managerRuntimeData.extCurrent[posN]), sizeof(float) * lengthN);
 }
 
@@ -2029,68 +2617,68 @@ void SNN::copyNeuronParameters(int netId, int lGrpId, RuntimeData* dest, bool al
 	}
 
 	if(allocateMem)
-		dest->Izh_a = new float[length];
+		dest->Izh_a = allocateRuntimeArray_CPU<float>(netId, length, "Izh_a");
 	memcpy(&dest->Izh_a[ptrPos], &(managerRuntimeData.Izh_a[ptrPos]), sizeof(float) * length);
 
 	if(allocateMem)
-		dest->Izh_b = new float[length];
+		dest->Izh_b = allocateRuntimeArray_CPU<float>(netId, length, "Izh_b");
 	memcpy(&dest->Izh_b[ptrPos], &(managerRuntimeData.Izh_b[ptrPos]), sizeof(float) * length);
 
 	if(allocateMem)
-		dest->Izh_c = new float[length];
+		dest->Izh_c = allocateRuntimeArray_CPU<float>(netId, length, "Izh_c");
 	memcpy(&dest->Izh_c[ptrPos], &(managerRuntimeData.Izh_c[ptrPos]), sizeof(float) * length);
 
 	if(allocateMem)
-		dest->Izh_d = new float[length];
+		dest->Izh_d = allocateRuntimeArray_CPU<float>(netId, length, "Izh_d");
 	memcpy(&dest->Izh_d[ptrPos], &(managerRuntimeData.Izh_d[ptrPos]), sizeof(float) * length);
 
 	if (allocateMem)
-		dest->Izh_C = new float[length];
+		dest->Izh_C = allocateRuntimeArray_CPU<float>(netId, length, "Izh_C");
 	memcpy(&dest->Izh_C[ptrPos], &(managerRuntimeData.Izh_C[ptrPos]), sizeof(float) * length);
 
 	if (allocateMem)
-		dest->Izh_k = new float[length];
+		dest->Izh_k = allocateRuntimeArray_CPU<float>(netId, length, "Izh_k");
 	memcpy(&dest->Izh_k[ptrPos], &(managerRuntimeData.Izh_k[ptrPos]), sizeof(float) * length);
 
 	if (allocateMem)
-		dest->Izh_vr = new float[length];
+		dest->Izh_vr = allocateRuntimeArray_CPU<float>(netId, length, "Izh_vr");
 	memcpy(&dest->Izh_vr[ptrPos], &(managerRuntimeData.Izh_vr[ptrPos]), sizeof(float) * length);
 
 	if (allocateMem)
-		dest->Izh_vt = new float[length];
+		dest->Izh_vt = allocateRuntimeArray_CPU<float>(netId, length, "Izh_vt");
 	memcpy(&dest->Izh_vt[ptrPos], &(managerRuntimeData.Izh_vt[ptrPos]), sizeof(float) * length);
 
 	if (allocateMem)
-		dest->Izh_vpeak = new float[length];
+		dest->Izh_vpeak = allocateRuntimeArray_CPU<float>(netId, length, "Izh_vpeak");
 	memcpy(&dest->Izh_vpeak[ptrPos], &(managerRuntimeData.Izh_vpeak[ptrPos]), sizeof(float) * length);
 
 	//LIF neuron
 	if(allocateMem)
-		dest->lif_tau_m = new int[length];
+		dest->lif_tau_m = allocateRuntimeArray_CPU<int>(netId, length, "lif_tau_m");
 	memcpy(&dest->lif_tau_m[ptrPos], &(managerRuntimeData.lif_tau_m[ptrPos]), sizeof(int) * length);
 
 	if(allocateMem)
-		dest->lif_tau_ref = new int[length];
+		dest->lif_tau_ref = allocateRuntimeArray_CPU<int>(netId, length, "lif_tau_ref");
 	memcpy(&dest->lif_tau_ref[ptrPos], &(managerRuntimeData.lif_tau_ref[ptrPos]), sizeof(int) * length);
 
 	if(allocateMem)
-		dest->lif_tau_ref_c = new int[length];
+		dest->lif_tau_ref_c = allocateRuntimeArray_CPU<int>(netId, length, "lif_tau_ref_c");
 	memcpy(&dest->lif_tau_ref_c[ptrPos], &(managerRuntimeData.lif_tau_ref_c[ptrPos]), sizeof(int) * length);
 
 	if(allocateMem)
-		dest->lif_vTh = new float[length];
+		dest->lif_vTh = allocateRuntimeArray_CPU<float>(netId, length, "lif_vTh");
 	memcpy(&dest->lif_vTh[ptrPos], &(managerRuntimeData.lif_vTh[ptrPos]), sizeof(float) * length);
 
 	if(allocateMem)
-		dest->lif_vReset = new float[length];
+		dest->lif_vReset = allocateRuntimeArray_CPU<float>(netId, length, "lif_vReset");
 	memcpy(&dest->lif_vReset[ptrPos], &(managerRuntimeData.lif_vReset[ptrPos]), sizeof(float) * length);
 
 	if(allocateMem)
-		dest->lif_gain = new float[length];
+		dest->lif_gain = allocateRuntimeArray_CPU<float>(netId, length, "lif_gain");
 	memcpy(&dest->lif_gain[ptrPos], &(managerRuntimeData.lif_gain[ptrPos]), sizeof(float) * length);
 
 	if(allocateMem)
-		dest->lif_bias = new float[length];
+		dest->lif_bias = allocateRuntimeArray_CPU<float>(netId, length, "lif_bias");
 	memcpy(&dest->lif_bias[ptrPos], &(managerRuntimeData.lif_bias[ptrPos]), sizeof(float) * length);
 
 	// pre-compute baseFiringInv for fast computation on CPU cores
@@ -2104,11 +2692,11 @@ void SNN::copyNeuronParameters(int netId, int lGrpId, RuntimeData* dest, bool al
 		}
 
 		if(allocateMem)
-			dest->baseFiringInv = new float[length];
+			dest->baseFiringInv = allocateRuntimeArray_CPU<float>(netId, length, "baseFiringInv");
 		memcpy(&dest->baseFiringInv[ptrPos], baseFiringInv, sizeof(float) * length);
 
 		if(allocateMem)
-			dest->baseFiring = new float[length];
+			dest->baseFiring = allocateRuntimeArray_CPU<float>(netId, length, "baseFiring");
 		memcpy(&dest->baseFiring[ptrPos], managerRuntimeData.baseFiring, sizeof(float) * length);
 
 		delete [] baseFiringInv;
@@ -2145,11 +2733,11 @@ void SNN::copySTPState(int netId, int lGrpId, RuntimeData* dest, RuntimeData* sr
 	assert(src->stpu != NULL); assert(src->stpx != NULL);
 
 	if(allocateMem)
-		dest->stpu = new float[networkConfigs[netId].numN * (networkConfigs[netId].maxDelay + 1)];
+		dest->stpu = allocateRuntimeArray_CPU<float>(netId, networkConfigs[netId].numN * (networkConfigs[netId].maxDelay + 1), "stpu");
 	memcpy(dest->stpu, src->stpu, sizeof(float) * networkConfigs[netId].numN * (networkConfigs[netId].maxDelay + 1));
 
 	if(allocateMem)
-		dest->stpx = new float[networkConfigs[netId].numN * (networkConfigs[netId].maxDelay + 1)];
+		dest->stpx = allocateRuntimeArray_CPU<float>(netId, networkConfigs[netId].numN * (networkConfigs[netId].maxDelay + 1), "stpx");
 	memcpy(dest->stpx, src->stpx, sizeof(float) * networkConfigs[netId].numN * (networkConfigs[netId].maxDelay + 1));
 }
 
@@ -2174,10 +2762,10 @@ void SNN::copySTPState(int netId, int lGrpId, RuntimeData* dest, RuntimeData* sr
 void SNN::copyGroupState(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, bool allocateMem) {
 	if (allocateMem) {
 		assert(dest->memType == CPU_MEM && !dest->allocated);
-		dest->grpDA = new float[networkConfigs[netId].numGroups]; 
-		dest->grp5HT = new float[networkConfigs[netId].numGroups]; 
-		dest->grpACh = new float[networkConfigs[netId].numGroups]; 
-		dest->grpNE = new float[networkConfigs[netId].numGroups];
+		dest->grpDA = allocateRuntimeArray_CPU<float>(netId, networkConfigs[netId].numGroups, "grpDA"); 
+		dest->grp5HT = allocateRuntimeArray_CPU<float>(netId, networkConfigs[netId].numGroups, "grp5HT"); 
+		dest->grpACh = allocateRuntimeArray_CPU<float>(netId, networkConfigs[netId].numGroups, "grpACh"); 
+		dest->grpNE = allocateRuntimeArray_CPU<float>(netId, networkConfigs[netId].numGroups, "grpNE");
 	}
 	memcpy(dest->grpDA, src->grpDA, sizeof(float) * networkConfigs[netId].numGroups);
 	memcpy(dest->grp5HT, src->grp5HT, sizeof(float) * networkConfigs[netId].numGroups);
@@ -2187,10 +2775,10 @@ void SNN::copyGroupState(int netId, int lGrpId, RuntimeData* dest, RuntimeData*
 	if (lGrpId == ALL) {
 		if (allocateMem) {
 			assert(dest->memType == CPU_MEM && !dest->allocated);
-			dest->grpDABuffer = new float[1000 * networkConfigs[netId].numGroups]; 
-			dest->grp5HTBuffer = new float[1000 * networkConfigs[netId].numGroups]; 
-			dest->grpAChBuffer = new float[1000 * networkConfigs[netId].numGroups]; 
-			dest->grpNEBuffer = new float[1000 * networkConfigs[netId].numGroups];
+			dest->grpDABuffer = allocateRuntimeArray_CPU<float>(netId, 1000 * networkConfigs[netId].numGroups, "grpDABuffer"); 
+			dest->grp5HTBuffer = allocateRuntimeArray_CPU<float>(netId, 1000 * networkConfigs[netId].numGroups, "grp5HTBuffer"); 
+			dest->grpAChBuffer = allocateRuntimeArray_CPU<float>(netId, 1000 * networkConfigs[netId].numGroups, "grpAChBuffer"); 
+			dest->grpNEBuffer = allocateRuntimeArray_CPU<float>(netId, 1000 * networkConfigs[netId].numGroups, "grpNEBuffer");
 		}
 		memcpy(dest->grpDABuffer, src->grpDABuffer, sizeof(float) * 1000 * networkConfigs[netId].numGroups);
 		memcpy(dest->grp5HTBuffer, src->grp5HTBuffer, sizeof(float) * 1000 * networkConfigs[netId].numGroups);
@@ -2229,33 +2817,33 @@ void SNN::copyAuxiliaryData(int netId, int lGrpId, RuntimeData* dest, bool alloc
 	assert(networkConfigs[netId].numN > 0);
 
 	if(allocateMem)
-		dest->spikeGenBits = new unsigned int[networkConfigs[netId].numNSpikeGen / 32 + 1];
+		dest->spikeGenBits = allocateRuntimeArray_CPU<unsigned int>(netId, networkConfigs[netId].numNSpikeGen / 32 + 1, "spikeGenBits");
 	memset(dest->spikeGenBits, 0, sizeof(int) * (networkConfigs[netId].numNSpikeGen / 32 + 1));
 
 	// allocate the poisson neuron poissonFireRate
 	if(allocateMem)
-		dest->poissonFireRate = new float[networkConfigs[netId].numNPois];
+		dest->poissonFireRate = allocateRuntimeArray_CPU<float>(netId, networkConfigs[netId].numNPois, "poissonFireRate");
 	memset(dest->poissonFireRate, 0, sizeof(float) * networkConfigs[netId].numNPois);
 
 	// synaptic auxiliary data
 	// I_set: a bit vector indicates which synapse got a spike
 	if(allocateMem) {
 		networkConfigs[netId].I_setLength = ceil(((networkConfigs[netId].maxNumPreSynN) / 32.0f));
-		dest->I_set = new int[networkConfigs[netId].numNReg * networkConfigs[netId].I_setLength];
+		dest->I_set = allocateRuntimeArray_CPU<int>(netId, networkConfigs[netId].numNReg * networkConfigs[netId].I_setLength, "I_set");
 	}
 	assert(networkConfigs[netId].maxNumPreSynN >= 0);
 	memset(dest->I_set, 0, sizeof(int) * networkConfigs[netId].numNReg * networkConfigs[netId].I_setLength);
 
 	// synSpikeTime: an array indicates the last time when a synapse got a spike
 	if(allocateMem)
-		dest->synSpikeTime = new int[networkConfigs[netId].numPreSynNet];
+		dest->synSpikeTime = allocateRuntimeArray_CPU<int>(netId, networkConfigs[netId].numPreSynNet, "synSpikeTime");
 	memcpy(dest->synSpikeTime, managerRuntimeData.synSpikeTime, sizeof(int) * networkConfigs[netId].numPreSynNet);
 
 	// neural auxiliary data
 	// lastSpikeTime: an array indicates the last time of a neuron emitting a spike
 	// neuron firing time
 	if(allocateMem)
-		dest->lastSpikeTime = new int[networkConfigs[netId].numNAssigned];
+		dest->lastSpikeTime = allocateRuntimeArray_CPU<int>(netId, networkConfigs[netId].numNAssigned, "lastSpikeTime");
 	memcpy(dest->lastSpikeTime, managerRuntimeData.lastSpikeTime, sizeof(int) * networkConfigs[netId].numNAssigned);
 
 	// auxiliary data for recording spike count of each neuron
@@ -2263,12 +2851,12 @@ void SNN::copyAuxiliaryData(int netId, int lGrpId, RuntimeData* dest, bool alloc
 
 	// quick lookup array for local group ids
 	if(allocateMem)
-		dest->grpIds = new short int[networkConfigs[netId].numNAssigned];
+		dest->grpIds = allocateRuntimeArray_CPU<short int>(netId, networkConfigs[netId].numNAssigned, "grpIds");
 	memcpy(dest->grpIds, managerRuntimeData.grpIds, sizeof(short int) * networkConfigs[netId].numNAssigned);
 
 	// quick lookup array for conn ids
 	if(allocateMem)
-		dest->connIdsPreIdx = new short int[networkConfigs[netId].numPreSynNet];
+		dest->connIdsPreIdx = allocateRuntimeArray_CPU<short int>(netId, networkConfigs[netId].numPreSynNet, "connIdsPreIdx");
 	memcpy(dest->connIdsPreIdx, managerRuntimeData.connIdsPreIdx, sizeof(short int) * networkConfigs[netId].numPreSynNet);
 
 	// reset variable related to spike count
@@ -2294,11 +2882,11 @@ void SNN::copyAuxiliaryData(int netId, int lGrpId, RuntimeData* dest, bool alloc
 	}
 
 	if (allocateMem)
-		dest->timeTableD1 = new unsigned int[TIMING_COUNT];
+		dest->timeTableD1 = allocateRuntimeArray_CPU<unsigned int>(netId, TIMING_COUNT, "timeTableD1");
 	memset(dest->timeTableD1, 0, sizeof(int) * TIMING_COUNT);
 
 	if (allocateMem)
-		dest->timeTableD2 = new unsigned int[TIMING_COUNT];
+		dest->timeTableD2 = allocateRuntimeArray_CPU<unsigned int>(netId, TIMING_COUNT, "timeTableD2");
 	memset(dest->timeTableD2, 0, sizeof(int) * TIMING_COUNT);
 
 	// firing table
@@ -2309,23 +2897,23 @@ void SNN::copyAuxiliaryData(int netId, int lGrpId, RuntimeData* dest, bool alloc
 
 	// allocate 1ms firing table
 	if (allocateMem)
-		dest->firingTableD1 = new int[networkConfigs[netId].maxSpikesD1];
+		dest->firingTableD1 = allocateRuntimeArray_CPU<int>(netId, networkConfigs[netId].maxSpikesD1, "firingTableD1");
 	if (networkConfigs[netId].maxSpikesD1 > 0)
 		memcpy(dest->firingTableD1, managerRuntimeData.firingTableD1, sizeof(int) * networkConfigs[netId].maxSpikesD1);
 
 	// allocate 2+ms firing table
 	if(allocateMem)
-		dest->firingTableD2 = new int[networkConfigs[netId].maxSpikesD2];
+		dest->firingTableD2 = allocateRuntimeArray_CPU<int>(netId, networkConfigs[netId].maxSpikesD2, "firingTableD2");
 	if (networkConfigs[netId].maxSpikesD2 > 0)
 		memcpy(dest->firingTableD2, managerRuntimeData.firingTableD2, sizeof(int) * networkConfigs[netId].maxSpikesD2);
 
 	// allocate external 1ms firing table
 	if (allocateMem) {
-		dest->extFiringTableD1 = new int*[networkConfigs[netId].numGroups];
+		dest->extFiringTableD1 = allocateRuntimeArray_CPU<int*>(netId, networkConfigs[netId].numGroups, "extFiringTableD1");
 		memset(dest->extFiringTableD1, 0 /* NULL */, sizeof(int*) * networkConfigs[netId].numGroups);
 		for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
 			if (groupConfigs[netId][lGrpId].hasExternalConnect) {
-				dest->extFiringTableD1[lGrpId] = new int[groupConfigs[netId][lGrpId].numN * NEURON_MAX_FIRING_RATE];
+				dest->extFiringTableD1[lGrpId] = allocateRuntimeArray_CPU<int>(netId, groupConfigs[netId][lGrpId].numN * NEURON_MAX_FIRING_RATE, "extFiringTableD1");
 				memset(dest->extFiringTableD1[lGrpId], 0, sizeof(int) * groupConfigs[netId][lGrpId].numN * NEURON_MAX_FIRING_RATE);
 			}
 		}
@@ -2333,11 +2921,11 @@ void SNN::copyAuxiliaryData(int netId, int lGrpId, RuntimeData* dest, bool alloc
 
 	// allocate external 2+ms firing table
 	if (allocateMem) {
-		dest->extFiringTableD2 = new int*[networkConfigs[netId].numGroups];
+		dest->extFiringTableD2 = allocateRuntimeArray_CPU<int*>(netId, networkConfigs[netId].numGroups, "extFiringTableD2");
 		memset(dest->extFiringTableD2, 0 /* NULL */, sizeof(int*) * networkConfigs[netId].numGroups);
 		for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
 			if (groupConfigs[netId][lGrpId].hasExternalConnect) {
-				dest->extFiringTableD2[lGrpId] = new int[groupConfigs[netId][lGrpId].numN * NEURON_MAX_FIRING_RATE];
+				dest->extFiringTableD2[lGrpId] = allocateRuntimeArray_CPU<int>(netId, groupConfigs[netId][lGrpId].numN * NEURON_MAX_FIRING_RATE, "extFiringTableD2");
 				memset(dest->extFiringTableD2[lGrpId], 0, sizeof(int) * groupConfigs[netId][lGrpId].numN * NEURON_MAX_FIRING_RATE);
 			}
 		}
@@ -2345,13 +2933,13 @@ void SNN::copyAuxiliaryData(int netId, int lGrpId, RuntimeData* dest, bool alloc
 
 	// allocate external 1ms firing table index
 	if (allocateMem)
-		dest->extFiringTableEndIdxD1 = new int[networkConfigs[netId].numGroups];
+		dest->extFiringTableEndIdxD1 = allocateRuntimeArray_CPU<int>(netId, networkConfigs[netId].numGroups, "extFiringTableEndIdxD1");
 	memset(dest->extFiringTableEndIdxD1, 0, sizeof(int) * networkConfigs[netId].numGroups);
 
 
 	// allocate external 2+ms firing table index
 	if (allocateMem)
-		dest->extFiringTableEndIdxD2 = new int[networkConfigs[netId].numGroups];
+		dest->extFiringTableEndIdxD2 = allocateRuntimeArray_CPU<int>(netId, networkConfigs[netId].numGroups, "extFiringTableEndIdxD2");
 	memset(dest->extFiringTableEndIdxD2, 0, sizeof(int) * networkConfigs[netId].numGroups);
 }
 
@@ -2387,7 +2975,7 @@ void SNN::copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, Runtime
 
 	// spike count information
 	if(allocateMem)
-		dest->nSpikeCnt = new int[lengthN];
+		dest->nSpikeCnt = allocateRuntimeArray_CPU<int>(netId, lengthN, "nSpikeCnt");
 	memcpy(&dest->nSpikeCnt[posN + destOffset], &src->nSpikeCnt[posN], sizeof(int) * lengthN);
 }
 
@@ -2397,6 +2985,8 @@ void SNN::copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, Runtime
 #else // POSIX
 	void* SNN::assignPoissonFiringRate_CPU(int netId) {
 #endif
+	ProfilerScope profScope(profPartitionTimeNs_[netId].timeNs[PROFILER_SPIKE_GENERATOR]);
+	TraceScope traceScope(tracer_, netId + 1, PROFILER_SPIKE_GENERATOR);
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
@@ -2527,121 +3117,8 @@ void SNN::copySpikeTables(int netId) {
 	void* SNN::deleteRuntimeData_CPU(int netId) {
 #endif
 	assert(runtimeData[netId].memType == CPU_MEM);
-	// free all pointers
-	delete [] runtimeData[netId].voltage;
-	delete [] runtimeData[netId].nextVoltage;
-	delete [] runtimeData[netId].recovery;
-	delete [] runtimeData[netId].current;
-	delete [] runtimeData[netId].extCurrent;
-	delete [] runtimeData[netId].curSpike;
-	delete [] runtimeData[netId].Npre;
-	delete [] runtimeData[netId].Npre_plastic;
-	delete [] runtimeData[netId].Npre_plasticInv;
-	delete [] runtimeData[netId].Npost;
-	delete [] runtimeData[netId].cumulativePost;
-	delete [] runtimeData[netId].cumulativePre;
-	delete [] runtimeData[netId].synSpikeTime;
-	delete [] runtimeData[netId].wt;
-	delete [] runtimeData[netId].wtChange;
-	delete [] runtimeData[netId].maxSynWt;
-	delete [] runtimeData[netId].nSpikeCnt;
-	delete [] runtimeData[netId].avgFiring;
-	delete [] runtimeData[netId].baseFiring;
-	delete [] runtimeData[netId].baseFiringInv;
-
-	delete [] runtimeData[netId].grpDA;
-	delete [] runtimeData[netId].grp5HT;
-	delete [] runtimeData[netId].grpACh;
-	delete [] runtimeData[netId].grpNE;
-
-	delete [] runtimeData[netId].grpDABuffer;
-	delete [] runtimeData[netId].grp5HTBuffer;
-	delete [] runtimeData[netId].grpAChBuffer;
-	delete [] runtimeData[netId].grpNEBuffer;
-
-	if (networkConfigs[netId].sim_with_nm) {
-		delete[] runtimeData[netId].nVBuffer;
-		delete[] runtimeData[netId].nUBuffer;
-		delete[] runtimeData[netId].nIBuffer;
-	}
-
-	delete [] runtimeData[netId].grpIds;
-
-	delete [] runtimeData[netId].Izh_a;
-	delete [] runtimeData[netId].Izh_b;
-	delete [] runtimeData[netId].Izh_c;
-	delete [] runtimeData[netId].Izh_d;
-	delete [] runtimeData[netId].Izh_C;
-	delete [] runtimeData[netId].Izh_k;
-	delete [] runtimeData[netId].Izh_vr;
-	delete [] runtimeData[netId].Izh_vt;
-	delete [] runtimeData[netId].Izh_vpeak;
-
-	delete [] runtimeData[netId].lif_tau_m;
-	delete [] runtimeData[netId].lif_tau_ref;
-	delete [] runtimeData[netId].lif_tau_ref_c;
-	delete [] runtimeData[netId].lif_vTh;
-	delete [] runtimeData[netId].lif_vReset;
-	delete [] runtimeData[netId].lif_gain;
-	delete [] runtimeData[netId].lif_bias;
-
-	delete [] runtimeData[netId].gAMPA;
-	if (sim_with_NMDA_rise) {
-		delete [] runtimeData[netId].gNMDA_r;
-		delete [] runtimeData[netId].gNMDA_d;
-	}
-	else {
-		delete [] runtimeData[netId].gNMDA;
-	}
-	delete [] runtimeData[netId].gGABAa;
-	if (sim_with_GABAb_rise) {
-		delete [] runtimeData[netId].gGABAb_r;
-		delete [] runtimeData[netId].gGABAb_d;
-	}
-	else {
-		delete [] runtimeData[netId].gGABAb;
-	}
-
-	delete [] runtimeData[netId].stpu;
-	delete [] runtimeData[netId].stpx;
-
-	delete [] runtimeData[netId].connIdsPreIdx;
-
-	delete [] runtimeData[netId].postDelayInfo;
-	delete [] runtimeData[netId].postSynapticIds;
-	delete [] runtimeData[netId].preSynapticIds;
-	delete [] runtimeData[netId].I_set;
-	delete [] runtimeData[netId].poissonFireRate;
-	delete [] runtimeData[netId].lastSpikeTime;
-	delete [] runtimeData[netId].spikeGenBits;
-
-	delete [] runtimeData[netId].timeTableD1;
-	delete [] runtimeData[netId].timeTableD2;
-
-	delete [] runtimeData[netId].firingTableD2;
-	delete [] runtimeData[netId].firingTableD1;
-
-	int** tempPtrs;
-	tempPtrs = new int*[networkConfigs[netId].numGroups];
-
-	// fetch device memory address stored in extFiringTableD2
-	memcpy(tempPtrs, runtimeData[netId].extFiringTableD2, sizeof(int*) * networkConfigs[netId].numGroups);
-	for (int i = 0; i < networkConfigs[netId].numGroups; i++)
-		delete [] tempPtrs[i];
-	delete [] runtimeData[netId].extFiringTableD2;
-
-	// fetch device memory address stored in extFiringTableD1
-	memcpy(tempPtrs, runtimeData[netId].extFiringTableD1, sizeof(int*) * networkConfigs[netId].numGroups);
-	for (int i = 0; i < networkConfigs[netId].numGroups; i++)
-		delete [] tempPtrs[i];
-	delete [] runtimeData[netId].extFiringTableD1;
-
-	delete [] tempPtrs;
-
-	delete [] runtimeData[netId].extFiringTableEndIdxD2;
-	delete [] runtimeData[netId].extFiringTableEndIdxD1;
-
-	if (runtimeData[netId].randNum != NULL) delete [] runtimeData[netId].randNum;
+	// all runtime arrays live in the runtime arena
+	freeRuntimeArena_CPU(netId);
 	runtimeData[netId].randNum = NULL;
 }
 
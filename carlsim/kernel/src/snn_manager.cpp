@@ -49,6 +49,9 @@
 #include <snn.h>
 #include <sstream>
 #include <algorithm>
+#include <set>
+#include <new> // std::bad_alloc
+#include <cstdlib> // posix_memalign, free
 
 #include <connection_monitor.h>
 #include <connection_monitor_core.h>
@@ -60,13 +63,187 @@
 #include <neuron_monitor_core.h>
 
 #include <spike_buffer.h>
+#include <spike_file_writer.h>
 #include <error_code.h>
 
+#if defined(WIN32) || defined(WIN64)
+#include <malloc.h> // _aligned_malloc, _aligned_free
+#else
+#include <sys/mman.h> // mmap of network images
+#include <sys/resource.h> // peak RSS
+#endif
+
 // \FIXME what are the following for? why were they all the way at the bottom of this file?
 
 #define COMPACTION_ALIGNMENT_PRE  16
 #define COMPACTION_ALIGNMENT_POST 0
 
+// memory held by one element of a std::list<ConnectionInfo> (the element plus the two links of its node)
+#define CONNECTION_LIST_NODE_BYTES (sizeof(ConnectionInfo) + 2 * sizeof(void*))
+
+// peak resident set size of the process in bytes, 0 if the operating system does not report it
+static size_t getPeakRssBytes() {
+#if defined(WIN32) || defined(WIN64)
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#if defined(__APPLE__)
+	return (size_t)usage.ru_maxrss; // bytes
+#else
+	return (size_t)usage.ru_maxrss * 1024; // kilobytes
+#endif
+#endif
+}
+
+// adds the wall-clock time of a setup stage to a SetupReport, and records the peak RSS at its end
+class SetupStageScope {
+public:
+	SetupStageScope(SetupReport& report, SetupStage stage) : report_(report), stage_(stage),
+		startNs_(getProfilerTimeNs()) {}
+	~SetupStageScope() {
+		report_.stageTimeMs[stage_] += (getProfilerTimeNs() - startNs_) * 1e-6;
+		report_.stageCalls[stage_]++;
+		report_.stagePeakRssBytes[stage_] = getPeakRssBytes();
+	}
+
+private:
+	SetupReport& report_;
+	SetupStage stage_;
+	unsigned long long startNs_;
+};
+
+// returns the setup stage that generates the synapses of a connection type
+static SetupStage getConnectStage(conType_t type) {
+	switch (type) {
+	case CONN_RANDOM:         return SETUP_CONNECT_RANDOM;
+	case CONN_FULL:
+	case CONN_FULL_NO_DIRECT: return SETUP_CONNECT_FULL;
+	case CONN_GAUSSIAN:       return SETUP_CONNECT_GAUSSIAN;
+	case CONN_ONE_TO_ONE:     return SETUP_CONNECT_ONE_TO_ONE;
+	case CONN_USER_DEFINED:   return SETUP_CONNECT_USER_DEFINED;
+	default:                  return SETUP_CONNECT_SHARED_KERNEL;
+	}
+}
+
+// appends an array of length elements to a list of arrays
+static void addMemoryUsage(std::vector<MemoryUsage>& arrays, const std::string& partition, const char* name,
+	size_t length, size_t elemSize) {
+	arrays.push_back(MemoryUsage(partition, name, length * elemSize));
+}
+
+// returns the name of a partition as used by PerformanceReport and MemoryReport
+static std::string getPartitionName(int netId) {
+	char name[20];
+	if (netId < CPU_RUNTIME_BASE)
+		sprintf(name, "GPU %d", netId - GPU_RUNTIME_BASE);
+	else
+		sprintf(name, "CPU %d", netId - CPU_RUNTIME_BASE);
+	return name;
+}
+
+// 64-bit FNV-1a, used to decide whether a network image was written for the current configuration
+static void hashNetworkConfigBytes(uint64_t& hash, const void* data, size_t size) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+}
+
+template<typename T> static void hashNetworkConfigValue(uint64_t& hash, const T& value) {
+	hashNetworkConfigBytes(hash, &value, sizeof(T));
+}
+
+// appends length elements to a network image, returns false on a write error
+template<typename T> static bool writeNetworkImageArray(FILE* fid, const T* data, size_t length) {
+	return length == 0 || fwrite(data, sizeof(T), length, fid) == length;
+}
+
+// copies length elements from a mapped network image and advances the cursor, returns false if the image ends early
+template<typename T> static bool readNetworkImageArray(const char*& cursor, const char* end, T* data, size_t length) {
+	if ((size_t)(end - cursor) < sizeof(T) * length)
+		return false;
+	memcpy(data, cursor, sizeof(T) * length);
+	cursor += sizeof(T) * length;
+	return true;
+}
+
+// header of the connectivity section of a local network in a network image
+struct NetworkImageNetHeader {
+	int netId;
+	int numNAssigned;
+	int numPreSynNet;
+	int numPostSynNet;
+	int maxNumPreSynN;
+	int maxNumPostSynN;
+	int maxDelay;
+	int numKernelWt;
+};
+
+// the state of drand48, stored in network images and checkpoints so that a restored network continues with the same
+// random sequence (e.g., for neuron parameters and Poisson spikes) as the original one
+static void getRandState(unsigned short state[3]) {
+#if defined(WIN32) || defined(WIN64)
+	state[0] = state[1] = state[2] = 0; // drand48 is emulated with rand(), whose state cannot be read
+#else
+	unsigned short dummy[3] = {0, 0, 0};
+	unsigned short* prev = seed48(dummy);
+	state[0] = prev[0]; state[1] = prev[1]; state[2] = prev[2];
+	seed48(state);
+#endif
+}
+
+static void setRandState(unsigned short state[3]) {
+#if !defined(WIN32) && !defined(WIN64)
+	seed48(state);
+#endif
+}
+
+// header of a checkpoint file, followed by one CheckpointNetHeader and the state arrays of each local network
+struct CheckpointHeader {
+	int signature;
+	int version;
+	uint64_t configHash;      //!< SNN::computeNetworkConfigHash
+	uint64_t staticStateHash; //!< SNN::computeStaticStateHash
+	int simTime;
+	int simTimeMs;
+	int simTimeSec;
+	int simTimeRunStart;
+	int simTimeRunStop;
+	int simTimeLastRunSummary;
+	int wtANDwtChangeUpdateIntervalCnt;
+	float stdpScaleFactor;
+	unsigned short randState[3];
+	int numNets;
+};
+
+#define CHECKPOINT_NUM_SPIKE_COUNTERS 12
+
+struct CheckpointNetHeader {
+	int netId;
+	int numArrays;
+	uint64_t numBytes; //!< total size of the state arrays that follow
+	unsigned int spikeCounters[CHECKPOINT_NUM_SPIKE_COUNTERS];
+};
+
+// the spike counters of a runtime, in the order in which they are stored in a checkpoint
+static void getCheckpointSpikeCounters(RuntimeData& rtd, unsigned int* counters[CHECKPOINT_NUM_SPIKE_COUNTERS]) {
+	counters[0] = &rtd.spikeCountSec;
+	counters[1] = &rtd.spikeCountD1Sec;
+	counters[2] = &rtd.spikeCountD2Sec;
+	counters[3] = &rtd.spikeCountExtRxD1Sec;
+	counters[4] = &rtd.spikeCountExtRxD2Sec;
+	counters[5] = &rtd.spikeCount;
+	counters[6] = &rtd.spikeCountD1;
+	counters[7] = &rtd.spikeCountD2;
+	counters[8] = &rtd.nPoissonSpikes;
+	counters[9] = &rtd.spikeCountLastSecLeftD2;
+	counters[10] = &rtd.spikeCountExtRxD2;
+	counters[11] = &rtd.spikeCountExtRxD1;
+}
+
 /// **************************************************************************************************************** ///
 /// CONSTRUCTOR / DESTRUCTOR
 /// **************************************************************************************************************** ///
@@ -87,6 +264,27 @@ SNN::~SNN() {
 		deleteObjects();
 }
 
+void* SNN::operator new(size_t size) {
+	void* ptr = NULL;
+#if defined(WIN32) || defined(WIN64)
+	ptr = _aligned_malloc(size, CACHE_LINE_SIZE);
+#else
+	if (posix_memalign(&ptr, CACHE_LINE_SIZE, size) != 0)
+		ptr = NULL;
+#endif
+	if (ptr == NULL)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void SNN::operator delete(void* ptr) {
+#if defined(WIN32) || defined(WIN64)
+	_aligned_free(ptr);
+#else
+	free(ptr);
+#endif
+}
+
 /// ************************************************************************************************************ ///
 /// PUBLIC METHODS: SETTING UP A SIMULATION
 /// ************************************************************************************************************ ///
@@ -137,6 +335,8 @@ short int SNN::connect(int grpId1, int grpId2, const std::string& _type, float i
 	connConfig.connectionMonitorId = -1;
 	connConfig.connId = -1;
 	connConfig.conn = NULL;
+	connConfig.kernelOffset = -1;
+	connConfig.kernelGridMapOffset = -1;
 	connConfig.numberOfConnections = 0;
 
 	if ( _type.find("random") != std::string::npos) {
@@ -195,10 +395,72 @@ short int SNN::connect(int grpId1, int grpId2, ConnectionGeneratorCore* conn, fl
 	connConfig.connProp = SET_CONN_PRESENT(1) | SET_FIXED_PLASTIC(synWtType);
 	connConfig.type = CONN_USER_DEFINED;
 	connConfig.conn = conn;
+	connConfig.kernelOffset = -1;
+	connConfig.kernelGridMapOffset = -1;
+	connConfig.connectionMonitorId = -1;
+	connConfig.connId = -1;
+	connConfig.numberOfConnections = 0;
+
+	// assign a connection id
+	assert(connConfig.connId == -1);
+	connConfig.connId = numConnections;
+
+	// store the configuration of a connection
+	connectConfigMap[numConnections] = connConfig; // connConfig.connId == numConnections
+
+	assert(numConnections < MAX_CONN_PER_SNN);	// make sure we don't overflow connId
+	numConnections++;
+
+	return (numConnections - 1);
+}
+
+// make weight-sharing connections from grpId1 to grpId2, all synapses share the weights of a single kernel
+short int SNN::connect(int grpId1, int grpId2, const Grid3D& kernelSize, const std::vector<float>& kernel, float maxWt,
+						uint8_t minDelay, uint8_t maxDelay, float _mulSynFast, float _mulSynSlow, bool synWtType) {
+	assert(grpId1 < numGroups);
+	assert(grpId2 < numGroups);
+	assert(minDelay <= maxDelay);
+	assert(!isPoissonGroup(grpId2));
+	assert(kernelSize.numX % 2 == 1 && kernelSize.numY % 2 == 1 && kernelSize.numZ % 2 == 1);
+	assert(kernel.size() == kernelSize.N);
+
+	// initialize the configuration of a connection
+	ConnectConfig connConfig;
+
+	connConfig.grpSrc   = grpId1;
+	connConfig.grpDest  = grpId2;
+	connConfig.initWt   = *std::max_element(kernel.begin(), kernel.end());
+	connConfig.maxWt    = maxWt;
+	connConfig.maxDelay = maxDelay;
+	connConfig.minDelay = minDelay;
+	// the receptive field is given by the kernel extent: offsets in [-rad,rad] along each dimension
+	connConfig.connRadius = RadiusRF((kernelSize.numX - 1) / 2, (kernelSize.numY - 1) / 2, (kernelSize.numZ - 1) / 2);
+	connConfig.mulSynFast = _mulSynFast;
+	connConfig.mulSynSlow = _mulSynSlow;
+	connConfig.connProp = SET_CONN_PRESENT(1) | SET_FIXED_PLASTIC(synWtType);
+	connConfig.connProbability = 1.0f;
+	connConfig.type = CONN_SHARED_KERNEL;
+	connConfig.conn = NULL;
 	connConfig.connectionMonitorId = -1;
 	connConfig.connId = -1;
 	connConfig.numberOfConnections = 0;
 
+	// store the kernel once, synapses find their entry from the grid offset of pre and post
+	connConfig.kernelOffset = sharedKernelTable.size();
+	sharedKernelTable.insert(sharedKernelTable.end(), kernel.begin(), kernel.end());
+
+	// map every pre-grid coordinate to the post-grid coordinate whose cell contains it (identity for equal grids),
+	// so that the offset of pre relative to post is measured in post-grid units
+	Grid3D gridPre = getGroupGrid3D(grpId1);
+	Grid3D gridPost = getGroupGrid3D(grpId2);
+	int numPre[3] = { gridPre.numX, gridPre.numY, gridPre.numZ };
+	int numPost[3] = { gridPost.numX, gridPost.numY, gridPost.numZ };
+	connConfig.kernelGridMapOffset = sharedKernelGridMap.size();
+	for (int d = 0; d < 3; d++) {
+		for (int i = 0; i < numPre[d]; i++)
+			sharedKernelGridMap.push_back(((2 * i + 1) * numPost[d]) / (2 * numPre[d]));
+	}
+
 	// assign a connection id
 	assert(connConfig.connId == -1);
 	connConfig.connId = numConnections;
@@ -500,6 +762,46 @@ void SNN::setIntegrationMethod(integrationMethod_t method, int numStepsPerMs) {
 	glbNetworkConfig.timeStep = 1.0f / numStepsPerMs;
 }
 
+void SNN::setNeuronOrdering(NeuronOrdering ordering) {
+	assert(ordering != UNKNOWN_ORDERING);
+	neuronOrdering_ = ordering;
+}
+
+void SNN::setNetworkImage(const std::string& fileName) {
+	assert(!fileName.empty());
+	networkImageFileName_ = fileName;
+}
+
+void SNN::setSpikeFileBuffering(int bufferSizeKB, bool flushEverySecond) {
+	assert(bufferSizeKB > 0);
+
+	// the buffer size is fixed once the first spike file is opened
+	if (spikeFileWriter != NULL && bufferSizeKB != spikeFileBufferSizeKB_) {
+		KERNEL_WARN("setSpikeFileBuffering: The buffer size of spike files can only be changed before the first spike "
+			"file is opened. Keeping %d KB.", spikeFileBufferSizeKB_);
+	} else {
+		spikeFileBufferSizeKB_ = bufferSizeKB;
+	}
+	spikeFileFlushEverySecond_ = flushEverySecond;
+}
+
+void SNN::setSpikeFileFormat(SpikeFileFormat format, int chunkLengthMs) {
+	assert(chunkLengthMs > 0);
+	spikeFileFormat_ = format;
+	spikeFileChunkLengthMs_ = chunkLengthMs;
+}
+
+void SNN::setCPUAffinityPolicy(CPUAffinityPolicy policy) {
+	assert(policy != UNKNOWN_AFFINITY_POLICY);
+	cpuAffinityPolicy_ = policy;
+}
+
+void SNN::setCPUAffinity(int partition, const std::vector<int>& cores) {
+	assert(partition >= 0 && CPU_RUNTIME_BASE + partition < MAX_NET_PER_SNN);
+	assert(!cores.empty());
+	cpuAffinityUser_[CPU_RUNTIME_BASE + partition] = cores;
+}
+
 // set Izhikevich parameters for group
 void SNN::setNeuronParameters(int gGrpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd,
 								float izh_c, float izh_c_sd, float izh_d, float izh_d_sd)
@@ -770,6 +1072,7 @@ void SNN::setWeightAndWeightChangeUpdate(UpdateInterval wtANDwtChangeUpdateInter
 // of all variable for carrying out the simulation..
 // this code is run only one time during network initialization
 void SNN::setupNetwork() {
+	unsigned long long startNs = getProfilerTimeNs();
 	switch (snnState) {
 	case CONFIG_SNN:
 		compileSNN();
@@ -777,6 +1080,8 @@ void SNN::setupNetwork() {
 		partitionSNN();
 	case PARTITIONED_SNN:
 		generateRuntimeSNN();
+		peakSetupRssBytes = getPeakRssBytes();
+		setupReport_.setupTimeMs += (getProfilerTimeNs() - startNs) * 1e-6;
 		break;
 	case EXECUTABLE_SNN:
 		break;
@@ -833,11 +1138,27 @@ int SNN::runNetwork(int _nsec, int _nmsec, bool printRunSummary) {
 	CUDA_START_TIMER(timer);
 #endif
 
+	// hardware counters are attached to the calling thread (and the workers it creates), so open them here
+	if (hwCountersRequested_ && hwCounters_ == NULL) {
+		hwCounters_ = new HardwareCounters();
+		if (!hwCounters_->open()) {
+			KERNEL_WARN("Hardware counters are not available: %s", hwCounters_->getErrorMessage().c_str());
+			delete hwCounters_;
+			hwCounters_ = NULL;
+			hwCountersRequested_ = false;
+		}
+	}
+
+	unsigned long long runStartNs = getProfilerTimeNs();
+
 	//KERNEL_INFO("Reached the advSimStep loop!");
 
 	// if nsec=0, simTimeMs=10, we need to run the simulator for 10 timeStep;
 	// if nsec=1, simTimeMs=10, we need to run the simulator for 1*1000+10, time Step;
 	for(int i = 0; i < runDurationMs; i++) {
+		if (tracer_ != NULL)
+			tracer_->beginStep(simTime, simTimeMs == 999);
+
 		advSimStep();
 		//KERNEL_INFO("Executed an advSimStep!");
 
@@ -867,9 +1188,16 @@ int SNN::runNetwork(int _nsec, int _nmsec, bool printRunSummary) {
 			}
 			
 			shiftSpikeTables();
+			reduceEventCounters();
 		}
 
-		fetchNeuronSpikeCount(ALL);
+		// sampling neuron monitors must be drained before their ring buffers wrap around
+		if (numNeuronMonitor)
+			updateNeuronMonitorStreams(false);
+
+		// periodic checkpoint at the step boundary
+		if (checkpointIntervalMs_ > 0 && simTime % checkpointIntervalMs_ == 0)
+			saveCheckpoint(checkpointFileName_, false);
 	}
 
 	//KERNEL_INFO("Updated monitors!");
@@ -893,15 +1221,33 @@ int SNN::runNetwork(int _nsec, int _nmsec, bool printRunSummary) {
 	}
 
 	// call updateSpike(Group)Monitor again to fetch all the left-over spikes and group status (neuromodulator)
+	if (tracer_ != NULL)
+		tracer_->sampleAll();
 	updateSpikeMonitor();
 	updateGroupMonitor();
+	if (numNeuronMonitor)
+		updateNeuronMonitorStreams(true);
+
+	// spike and sampled neuron state files are complete at the end of every run
+	if (spikeFileWriter != NULL && !spikeFileWriter->flushAll(true)) {
+		KERNEL_ERROR("runNetwork: Could not write spike files");
+		exitSimulation(1);
+	}
+
+	if (tracer_ != NULL)
+		dumpTrace();
 
 	// keep track of simulation time...
+	unsigned long long runTimeNs = getProfilerTimeNs() - runStartNs;
+	profRunTimeNs_ += runTimeNs;
+	profNumSteps_ += runDurationMs;
 #ifndef __NO_CUDA__
 	CUDA_STOP_TIMER(timer);
 	lastExecutionTime = CUDA_GET_TIMER_VALUE(timer);
-	cumExecutionTime += lastExecutionTime;
+#else
+	lastExecutionTime = runTimeNs * 1e-6f;
 #endif
+	cumExecutionTime += lastExecutionTime;
 	return 0;
 }
 
@@ -915,6 +1261,11 @@ int SNN::runNetwork(int _nsec, int _nmsec, bool printRunSummary) {
 void SNN::biasWeights(short int connId, float bias, bool updateWeightRange) {
 	assert(connId>=0 && connId<numConnections);
 
+	if (connectConfigMap[connId].type == CONN_SHARED_KERNEL) {
+		KERNEL_ERROR("biasWeights cannot modify individual synapses of shared-kernel connection %d", connId);
+		exitSimulation(1);
+	}
+
 	int netId = groupConfigMDMap[connectConfigMap[connId].grpDest].netId;
 	int lGrpId = groupConfigMDMap[connectConfigMap[connId].grpDest].lGrpId;
 
@@ -1006,6 +1357,11 @@ void SNN::scaleWeights(short int connId, float scale, bool updateWeightRange) {
 	assert(connId>=0 && connId<numConnections);
 	assert(scale>=0.0f);
 
+	if (connectConfigMap[connId].type == CONN_SHARED_KERNEL) {
+		KERNEL_ERROR("scaleWeights cannot modify individual synapses of shared-kernel connection %d", connId);
+		exitSimulation(1);
+	}
+
 	int netId = groupConfigMDMap[connectConfigMap[connId].grpDest].netId;
 	int lGrpId = groupConfigMDMap[connectConfigMap[connId].grpDest].lGrpId;
 
@@ -1113,6 +1469,13 @@ GroupMonitor* SNN::setGroupMonitor(int gGrpId, FILE* fid) {
 	// also inform the group that it is being monitored...
 	groupConfigMDMap[gGrpId].groupMonitorId = numGroupMonitor;
 
+	// the monitor may be set after the runtime has been generated, start logging the group state from now on
+	if (snnState == EXECUTABLE_SNN) {
+		groupConfigs[netId][lGrpId].hasGroupMonitor = true;
+		if (netId < CPU_RUNTIME_BASE)
+			copyGroupConfigs(netId);
+	}
+
 	numGroupMonitor++;
 	KERNEL_INFO("GroupMonitor set for group %d (%s)", gGrpId, groupConfigMap[gGrpId].grpName.c_str());
 
@@ -1222,8 +1585,9 @@ NeuronMonitor* SNN::setNeuronMonitor(int gGrpId, FILE* fid) {
 	int lGrpId = groupConfigMDMap[gGrpId].lGrpId;
 	int netId = groupConfigMDMap[gGrpId].netId;
 
-	if (getGroupNumNeurons(gGrpId) > 128) {
-		KERNEL_WARN("Due to limited memory space, only the first 128 neurons can be monitored by NeuronMonitor");
+	if (getGroupNumNeurons(gGrpId) > MAX_NEURON_MON_GRP_SZIE) {
+		KERNEL_WARN("Due to limited memory space, only the first %d neurons can be monitored by NeuronMonitor "
+			"(use setNeuronMonitorSampling to stream more neurons to file)", MAX_NEURON_MON_GRP_SZIE);
 	}
 
 	// check whether group already has a SpikeMonitor
@@ -1264,6 +1628,21 @@ NeuronMonitor* SNN::setNeuronMonitor(int gGrpId, FILE* fid) {
 	}
 }
 
+void SNN::setNeuronMonitorSampling(int gGrpId, const std::vector<int>& neurIds, int strideMs) {
+	assert(groupConfigMDMap[gGrpId].neuronMonitorId >= 0);
+	assert(strideMs > 0);
+
+	NeuronMonitorCore* nrnMonCoreObj = getNeuronMonitorCore(gGrpId);
+	if (nrnMonCoreObj->getNeuronFileId() == NULL) {
+		KERNEL_ERROR("setNeuronMonitorSampling(grpId=%d): the NeuronMonitor of the group must write to a file", gGrpId);
+		exitSimulation(1);
+	}
+
+	nrnMonCoreObj->setSampling(neurIds, strideMs);
+	KERNEL_INFO("NeuronMonitor of group %d (%s) samples %d neurons every %d ms", gGrpId,
+		groupConfigMap[gGrpId].grpName.c_str(), (int)nrnMonCoreObj->getSampledNeurIds().size(), strideMs);
+}
+
 // FIXME: distinguish the function call at CONFIG_STATE and RUN_STATE, where groupConfigs[0][] might not be available
 // or groupConfigMap is not sync with groupConfigs[0][]
 // assigns spike rate to group
@@ -1287,6 +1666,11 @@ void SNN::setWeight(short int connId, int neurIdPre, int neurIdPost, float weigh
 	assert(connId>=0 && connId<getNumConnections());
 	assert(weight>=0.0f);
 
+	if (connectConfigMap[connId].type == CONN_SHARED_KERNEL) {
+		KERNEL_ERROR("setWeight cannot modify individual synapses of shared-kernel connection %d", connId);
+		exitSimulation(1);
+	}
+
 	assert(neurIdPre >= 0  && neurIdPre < getGroupNumNeurons(connectConfigMap[connId].grpSrc));
 	assert(neurIdPost >= 0 && neurIdPost < getGroupNumNeurons(connectConfigMap[connId].grpDest));
 
@@ -1325,8 +1709,8 @@ void SNN::setWeight(short int connId, int neurIdPre, int neurIdPost, float weigh
 	}
 
 	// find real ID of pre- and post-neuron
-	int neurIdPreReal = groupConfigs[netId][prelGrpId].lStartN + neurIdPre;
-	int neurIdPostReal = groupConfigs[netId][postlGrpId].lStartN + neurIdPost;
+	int neurIdPreReal = renumberLNId(netId, groupConfigs[netId][prelGrpId].lStartN + neurIdPre);
+	int neurIdPostReal = renumberLNId(netId, groupConfigs[netId][postlGrpId].lStartN + neurIdPost);
 
 	// iterate over all presynaptic synapses until right one is found
 	bool synapseFound = false;
@@ -1374,6 +1758,39 @@ void SNN::setWeight(short int connId, int neurIdPre, int neurIdPost, float weigh
 	}
 }
 
+void SNN::setHardwareCounters(bool enable) {
+#ifdef __NO_PROFILING__
+	if (enable)
+		KERNEL_WARN("setHardwareCounters: CARLsim was compiled without profiling, hardware counters are not available.");
+#else
+	hwCountersRequested_ = enable;
+	if (!enable && hwCounters_ != NULL) {
+		// keep the counts measured so far, but stop measuring
+		delete hwCounters_;
+		hwCounters_ = NULL;
+	}
+#endif
+}
+
+void SNN::setTraceFile(FILE* fp, int sampleIntervalMs, int maxEventsPerThread) {
+	assert(fp != NULL);
+	assert(sampleIntervalMs > 0);
+	assert(maxEventsPerThread > 0);
+
+#ifdef __NO_PROFILING__
+	KERNEL_WARN("setTraceFile: CARLsim was compiled without profiling, no trace will be recorded.");
+	fclose(fp);
+#else
+	if (tracer_ != NULL)
+		delete tracer_;
+
+	// thread 0 is the manager thread, thread netId+1 is the worker of a CPU partition
+	tracer_ = new SimTracer(fp, MAX_NET_PER_SNN + 1, sampleIntervalMs, maxEventsPerThread);
+	traceNumOverwritten_ = 0;
+	tracer_->setThreadName(0, "manager");
+#endif
+}
+
 void SNN::setExternalCurrent(int grpId, const std::vector<float>& current) {
 	assert(grpId >= 0); assert(grpId < numGroups);
 	assert(!isPoissonGroup(grpId));
@@ -1391,7 +1808,7 @@ void SNN::setExternalCurrent(int grpId, const std::vector<float>& current) {
 
 	// store external current in array
 	for (int lNId = groupConfigs[netId][lGrpId].lStartN, j = 0; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++, j++) {
-		managerRuntimeData.extCurrent[lNId] = current[j];
+		managerRuntimeData.extCurrent[renumberLNId(netId, lNId)] = current[j];
 	}
 
 	// copy to GPU if necessary
@@ -1418,7 +1835,7 @@ void SNN::saveSimulation(FILE* fid, bool saveSynapseInfo) {
 	if (!fwrite(&tmpInt,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
 
 	//// write version number
-	tmpFloat = 0.2f;
+	tmpFloat = 0.3f;
 	if (!fwrite(&tmpFloat,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
 
 	//// write simulation time so far (in seconds)
@@ -1434,11 +1851,9 @@ void SNN::saveSimulation(FILE* fid, bool saveSynapseInfo) {
 
 	//// write network info
 	if (!fwrite(&glbNetworkConfig.numN,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	int dummyInt = 0;
-	//if (!fwrite(&numPreSynNet,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	if (!fwrite(&dummyInt,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//if (!fwrite(&numPostSynNet,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	if (!fwrite(&dummyInt,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
+	int numSynNet = glbNetworkConfig.numSynNet;
+	if (!fwrite(&numSynNet,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
+	if (!fwrite(&numSynNet,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
 	if (!fwrite(&numGroups,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
 	
 	//// write group info
@@ -1455,60 +1870,271 @@ void SNN::saveSimulation(FILE* fid, bool saveSynapseInfo) {
 		if (!fwrite(name,1,100,fid)) KERNEL_ERROR("saveSimulation fwrite error");
 	}
 
-	//// +++++ Fetch WEIGHT DATA (GPU Mode only) ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
-	//if (simMode_ == GPU_MODE)
-	//	copyWeightState(&managerRuntimeData, &runtimeData[0], cudaMemcpyDeviceToHost, false);
 	//// +++++ WRITE SYNAPSE INFO +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 
-	//// \FIXME: replace with faster version
-	//if (saveSynapseInfo) {
-	//	for (int i = 0; i < numN; i++) {
-	//		unsigned int offset = managerRuntimeData.cumulativePost[i];
-
-	//		unsigned int count = 0;
-	//		for (int t=0;t<maxDelay_;t++) {
-	//			DelayInfo dPar = managerRuntimeData.postDelayInfo[i*(maxDelay_+1)+t];
-
-	//			for(int idx_d=dPar.delay_index_start; idx_d<(dPar.delay_index_start+dPar.delay_length); idx_d++)
-	//				count++;
-	//		}
-
-	//		if (!fwrite(&count,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-
-	//		for (int t=0;t<maxDelay_;t++) {
-	//			DelayInfo dPar = managerRuntimeData.postDelayInfo[i*(maxDelay_+1)+t];
-
-	//			for(int idx_d=dPar.delay_index_start; idx_d<(dPar.delay_index_start+dPar.delay_length); idx_d++) {
-	//				// get synaptic info...
-	//				SynInfo post_info = managerRuntimeData.postSynapticIds[offset + idx_d];
-
-	//				// get neuron id
-	//				//int p_i = (post_info&POST_SYN_NEURON_MASK);
-	//				unsigned int p_i = GET_CONN_NEURON_ID(post_info);
-	//				assert(p_i<numN);
-
-	//				// get syn id
-	//				unsigned int s_i = GET_CONN_SYN_ID(post_info);
-	//				//>>POST_SYN_NEURON_BITS)&POST_SYN_CONN_MASK;
-	//				assert(s_i<(managerRuntimeData.Npre[p_i]));
-
-	//				// get the cumulative position for quick access...
-	//				unsigned int pos_i = managerRuntimeData.cumulativePre[p_i] + s_i;
-
-	//				uint8_t delay = t+1;
-	//				uint8_t plastic = s_i < managerRuntimeData.Npre_plastic[p_i]; // plastic or fixed.
-
-	//				if (!fwrite(&i,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&p_i,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&(managerRuntimeData.wt[pos_i]),sizeof(float),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&(managerRuntimeData.maxSynWt[pos_i]),sizeof(float),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&delay,sizeof(uint8_t),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&plastic,sizeof(uint8_t),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&(managerRuntimeData.connIdsPreIdx[pos_i]),sizeof(short int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//			}
-	//		}
-	//	}
-	//}
+	//// write the number of partitions with synapse info, followed by one section per partition
+	int numPartitions = 0;
+	if (saveSynapseInfo) {
+		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++)
+			if (!groupPartitionLists[netId].empty())
+				numPartitions++;
+	}
+	if (!fwrite(&numPartitions,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
+
+	if (saveSynapseInfo) {
+		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++)
+			if (!groupPartitionLists[netId].empty())
+				saveSimulationSynapses(fid, netId);
+	}
+}
+
+void SNN::saveSimulationSynapses(FILE* fid, int netId) {
+	// bring the connectivity and weights of the partition to the manager
+	fetchPreConnectionInfo(netId);
+	fetchPostConnectionInfo(netId);
+	fetchSynapseState(netId);
+	fetchConnIdsLookupArray(netId);
+	fetchGrpIdsLookupArray(netId);
+
+	int numNAssigned = networkConfigs[netId].numNAssigned;
+	int numPreSynNet = networkConfigs[netId].numPreSynNet;
+
+	// delays are stored per pre-synaptic neuron, look up the delay of every synapse in pre-synaptic order
+	std::vector<uint8_t> preSynDelay(numPreSynNet, 0);
+	for (int lNIdPre = 0; lNIdPre < numNAssigned; lNIdPre++) {
+		unsigned int offset = managerRuntimeData.cumulativePost[lNIdPre];
+		for (int t = 0; t < glbNetworkConfig.maxDelay; t++) {
+			DelayInfo dPar = managerRuntimeData.postDelayInfo[lNIdPre * (glbNetworkConfig.maxDelay + 1) + t];
+			for (int idx_d = dPar.delay_index_start; idx_d < (dPar.delay_index_start + dPar.delay_length); idx_d++) {
+				SynInfo postSynInfo = managerRuntimeData.postSynapticIds[offset + idx_d];
+				int lNIdPost = GET_CONN_NEURON_ID(postSynInfo);
+				preSynDelay[managerRuntimeData.cumulativePre[lNIdPost] + GET_CONN_SYN_ID(postSynInfo)] = t + 1;
+			}
+		}
+	}
+
+	// count the synapses of every connection, so that the synapses of a connection are stored contiguously
+	// note: a synapse is saved by the partition of its post-synaptic neuron, external connections are saved once
+	// note: shared-kernel connections are regenerated on load, only their kernels are saved
+	std::vector<int> connSynOffset(numConnections + 1, 0);
+	for (int lNId = 0; lNId < numNAssigned; lNId++) {
+		if (groupConfigs[netId][managerRuntimeData.grpIds[lNId]].netId != netId)
+			continue;
+		for (unsigned int pos = managerRuntimeData.cumulativePre[lNId]; pos < managerRuntimeData.cumulativePre[lNId] + managerRuntimeData.Npre[lNId]; pos++) {
+			short int connId = managerRuntimeData.connIdsPreIdx[pos];
+			if (connectConfigMap[connId].type != CONN_SHARED_KERNEL)
+				connSynOffset[connId + 1]++;
+		}
+	}
+
+	std::vector<int> connIds, connNumSyn;
+	for (int connId = 0; connId < numConnections; connId++) {
+		if (connSynOffset[connId + 1] > 0) {
+			connIds.push_back(connId);
+			connNumSyn.push_back(connSynOffset[connId + 1]);
+		}
+		connSynOffset[connId + 1] += connSynOffset[connId];
+	}
+	int numSyn = connSynOffset[numConnections];
+	int numConns = connIds.size();
+
+	// gather the synapses in global (creation-order) neuron IDs, grouped by connection
+	std::vector<int> preIds(numSyn), postIds(numSyn);
+	std::vector<float> wts(numSyn), maxWts(numSyn);
+	std::vector<uint8_t> delays(numSyn), plastic(numSyn);
+	for (int lNId = 0; lNId < numNAssigned; lNId++) {
+		int lGrpIdPost = managerRuntimeData.grpIds[lNId];
+		if (groupConfigs[netId][lGrpIdPost].netId != netId)
+			continue;
+		for (unsigned int pos = managerRuntimeData.cumulativePre[lNId]; pos < managerRuntimeData.cumulativePre[lNId] + managerRuntimeData.Npre[lNId]; pos++) {
+			short int connId = managerRuntimeData.connIdsPreIdx[pos];
+			if (connectConfigMap[connId].type == CONN_SHARED_KERNEL)
+				continue;
+
+			int lNIdPre = GET_CONN_NEURON_ID(managerRuntimeData.preSynapticIds[pos]);
+			int lGrpIdPre = managerRuntimeData.grpIds[lNIdPre];
+			int idx = connSynOffset[connId]++;
+			preIds[idx] = restoreLNId(netId, lNIdPre) + groupConfigs[netId][lGrpIdPre].LtoGOffset;
+			postIds[idx] = restoreLNId(netId, lNId) + groupConfigs[netId][lGrpIdPost].LtoGOffset;
+			wts[idx] = managerRuntimeData.wt[pos];
+			// maxSynWt is only kept at runtime if the network has plastic synapses
+			if (sim_with_fixedwts)
+				maxWts[idx] = isExcitatoryGroup(connectConfigMap[connId].grpSrc) ? fabs(connectConfigMap[connId].maxWt) : -1.0f * fabs(connectConfigMap[connId].maxWt);
+			else
+				maxWts[idx] = managerRuntimeData.maxSynWt[pos];
+			delays[idx] = preSynDelay[pos];
+			plastic[idx] = (pos - managerRuntimeData.cumulativePre[lNId] < managerRuntimeData.Npre_plastic[lNId]) ? 1 : 0; // plastic synapses come first
+		}
+	}
+
+	// write the section as contiguous arrays
+	int numKernelWt = networkConfigs[netId].numKernelWt;
+	bool isWritten = fwrite(&netId, sizeof(int), 1, fid) == 1
+		&& fwrite(&numSyn, sizeof(int), 1, fid) == 1
+		&& fwrite(&numConns, sizeof(int), 1, fid) == 1
+		&& (numConns == 0 || fwrite(&connIds[0], sizeof(int), numConns, fid) == numConns)
+		&& (numConns == 0 || fwrite(&connNumSyn[0], sizeof(int), numConns, fid) == numConns)
+		&& (numSyn == 0 || fwrite(&preIds[0], sizeof(int), numSyn, fid) == numSyn)
+		&& (numSyn == 0 || fwrite(&postIds[0], sizeof(int), numSyn, fid) == numSyn)
+		&& (numSyn == 0 || fwrite(&wts[0], sizeof(float), numSyn, fid) == numSyn)
+		&& (numSyn == 0 || fwrite(&maxWts[0], sizeof(float), numSyn, fid) == numSyn)
+		&& (numSyn == 0 || fwrite(&delays[0], sizeof(uint8_t), numSyn, fid) == numSyn)
+		&& (numSyn == 0 || fwrite(&plastic[0], sizeof(uint8_t), numSyn, fid) == numSyn)
+		&& fwrite(&numKernelWt, sizeof(int), 1, fid) == 1
+		&& (numKernelWt == 0 || fwrite(managerRuntimeData.kernelWt, sizeof(float), numKernelWt, fid) == numKernelWt);
+	if (!isWritten) KERNEL_ERROR("saveSimulation fwrite error");
+}
+
+void SNN::saveCheckpoint(const std::string& fileName, bool blocking) {
+	assert(snnState == EXECUTABLE_SNN);
+
+	for (int netId = 0; netId < CPU_RUNTIME_BASE; netId++) {
+		if (!groupPartitionLists[netId].empty()) {
+			KERNEL_ERROR("saveCheckpoint: Checkpoints are only supported for networks that run on CPU cores");
+			exitSimulation(1);
+		}
+	}
+
+	// fill the snapshot buffer that is not being written, so that the copy overlaps with the previous write
+	int nextBufferId = 1 - checkpointBufferId;
+	takeCheckpointSnapshot(checkpointBuffer[nextBufferId]);
+
+	joinCheckpointWriter();
+	checkpointBufferId = nextBufferId;
+	checkpointWriteFileName = fileName;
+
+#if defined(WIN32) || defined(WIN64)
+	blocking = true;
+#endif
+	if (blocking) {
+		writeCheckpointBuffer();
+	} else {
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		if (pthread_create(&checkpointWriter, &attr, &SNN::helperWriteCheckpoint, (void*)this) == 0) {
+			checkpointWriterActive = true;
+		} else {
+			writeCheckpointBuffer();
+		}
+		pthread_attr_destroy(&attr);
+	}
+}
+
+void SNN::loadCheckpoint(const std::string& fileName) {
+	assert(snnState == EXECUTABLE_SNN);
+
+	// the checkpoint might be the one that is still being written
+	joinCheckpointWriter();
+
+	FILE* fid = fopen(fileName.c_str(), "rb");
+	if (fid == NULL) {
+		KERNEL_ERROR("loadCheckpoint: Could not open checkpoint file %s", fileName.c_str());
+		exitSimulation(1);
+	}
+
+	// read the whole file at once
+	fseek(fid, 0, SEEK_END);
+	long fileSize = ftell(fid);
+	fseek(fid, 0, SEEK_SET);
+	std::vector<char> buffer(fileSize > 0 ? fileSize : 1);
+	bool readErr = fileSize < (long)sizeof(CheckpointHeader) || fread(&buffer[0], 1, fileSize, fid) != (size_t)fileSize;
+	fclose(fid);
+	if (readErr) {
+		KERNEL_ERROR("loadCheckpoint: Could not read checkpoint file %s", fileName.c_str());
+		exitSimulation(1);
+	}
+
+	const char* cursor = &buffer[0];
+	const char* end = cursor + fileSize;
+	CheckpointHeader header;
+	memcpy(&header, cursor, sizeof(CheckpointHeader));
+	cursor += sizeof(CheckpointHeader);
+
+	if (header.signature != CHECKPOINT_SIGNATURE || header.version != CHECKPOINT_VERSION) {
+		KERNEL_ERROR("loadCheckpoint: %s is not a checkpoint file of version %d", fileName.c_str(), CHECKPOINT_VERSION);
+		exitSimulation(1);
+	}
+	if (header.configHash != computeNetworkConfigHash() || header.staticStateHash != computeStaticStateHash()) {
+		KERNEL_ERROR("loadCheckpoint: Checkpoint %s was taken from a different network (use the same configuration "
+			"and random seed, or restore the connectivity with setNetworkImage or loadSimulation)", fileName.c_str());
+		exitSimulation(1);
+	}
+
+	int numNets = 0;
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++)
+		if (!groupPartitionLists[netId].empty())
+			numNets++;
+	readErr = header.numNets != numNets;
+
+	std::vector<CheckpointArray> arrays;
+	for (int n = 0; n < header.numNets && !readErr; n++) {
+		CheckpointNetHeader netHeader;
+		readErr = (size_t)(end - cursor) < sizeof(CheckpointNetHeader);
+		if (readErr)
+			break;
+		memcpy(&netHeader, cursor, sizeof(CheckpointNetHeader));
+		cursor += sizeof(CheckpointNetHeader);
+
+		int netId = netHeader.netId;
+		readErr = netId < CPU_RUNTIME_BASE || netId >= MAX_NET_PER_SNN || groupPartitionLists[netId].empty();
+		if (readErr)
+			break;
+
+		collectCheckpointArrays_CPU(netId, arrays);
+		uint64_t numBytes = 0;
+		for (size_t i = 0; i < arrays.size(); i++)
+			numBytes += arrays[i].size;
+		readErr = netHeader.numArrays != (int)arrays.size() || netHeader.numBytes != numBytes
+			|| (uint64_t)(end - cursor) < numBytes;
+		if (readErr)
+			break;
+
+		for (size_t i = 0; i < arrays.size(); i++) {
+			memcpy(arrays[i].data, cursor, arrays[i].size);
+			cursor += arrays[i].size;
+		}
+
+		unsigned int* counters[CHECKPOINT_NUM_SPIKE_COUNTERS];
+		getCheckpointSpikeCounters(runtimeData[netId], counters);
+		for (int i = 0; i < CHECKPOINT_NUM_SPIKE_COUNTERS; i++)
+			*counters[i] = netHeader.spikeCounters[i];
+	}
+
+	if (readErr || cursor != end) {
+		KERNEL_ERROR("loadCheckpoint: Checkpoint %s does not match the partitioning of the network", fileName.c_str());
+		exitSimulation(1);
+	}
+
+	simTime = header.simTime;
+	simTimeMs = header.simTimeMs;
+	simTimeSec = header.simTimeSec;
+	simTimeRunStart = header.simTimeRunStart;
+	simTimeRunStop = header.simTimeRunStop;
+	simTimeLastRunSummary = header.simTimeLastRunSummary;
+	wtANDwtChangeUpdateIntervalCnt_ = header.wtANDwtChangeUpdateIntervalCnt;
+	stdpScaleFactor_ = header.stdpScaleFactor;
+	setRandState(header.randState);
+
+	// spikes of spike generators are scheduled again from their last spike time by the next runNetwork
+	resetPropogationBuffer();
+
+	// monitors observe the network from the restored time on
+	simTimeLastUpdSpkMon_ = simTime;
+	for (int i = 0; i < numSpikeMonitor; i++)
+		spikeMonCoreList[i]->setLastUpdated(simTime);
+	for (int i = 0; i < numGroupMonitor; i++)
+		groupMonCoreList[i]->setLastUpdated(simTime);
+	for (int i = 0; i < numNeuronMonitor; i++)
+		neuronMonCoreList[i]->setLastUpdated(simTime);
+
+	KERNEL_INFO("Restored the network state at t=%d ms from checkpoint %s", simTime, fileName.c_str());
+}
+
+void SNN::setCheckpointInterval(int intervalMs, const std::string& fileName) {
+	assert(intervalMs >= 0);
+
+	checkpointIntervalMs_ = intervalMs;
+	checkpointFileName_ = fileName;
 }
 
 // writes population weights from gIDpre to gIDpost to file fname in binary
@@ -1652,7 +2278,7 @@ std::vector<float> SNN::getConductanceAMPA(int gGrpId) {
 
 	std::vector<float> gAMPAvec;
 	for (int gNId = groupConfigMDMap[gGrpId].gStartN; gNId <= groupConfigMDMap[gGrpId].gEndN; gNId++) {
-		gAMPAvec.push_back(managerRuntimeData.gAMPA[gNId]);
+		gAMPAvec.push_back(managerRuntimeData.gAMPA[renumberGNId(gGrpId, gNId)]);
 	}
 	return gAMPAvec;
 }
@@ -1667,11 +2293,11 @@ std::vector<float> SNN::getConductanceNMDA(int gGrpId) {
 	if (isSimulationWithNMDARise()) {
 		// need to construct conductance from rise and decay parts
 		for (int gNId = groupConfigMDMap[gGrpId].gStartN; gNId <= groupConfigMDMap[gGrpId].gEndN; gNId++) {
-			gNMDAvec.push_back(managerRuntimeData.gNMDA_d[gNId] - managerRuntimeData.gNMDA_r[gNId]);
+			gNMDAvec.push_back(managerRuntimeData.gNMDA_d[renumberGNId(gGrpId, gNId)] - managerRuntimeData.gNMDA_r[renumberGNId(gGrpId, gNId)]);
 		}
 	} else {
 		for (int gNId = groupConfigMDMap[gGrpId].gStartN; gNId <= groupConfigMDMap[gGrpId].gEndN; gNId++) {
-			gNMDAvec.push_back(managerRuntimeData.gNMDA[gNId]);
+			gNMDAvec.push_back(managerRuntimeData.gNMDA[renumberGNId(gGrpId, gNId)]);
 		}
 	}
 	return gNMDAvec;
@@ -1685,7 +2311,7 @@ std::vector<float> SNN::getConductanceGABAa(int gGrpId) {
 
 	std::vector<float> gGABAaVec;
 	for (int gNId = groupConfigMDMap[gGrpId].gStartN; gNId <= groupConfigMDMap[gGrpId].gEndN; gNId++) {
-		gGABAaVec.push_back(managerRuntimeData.gGABAa[gNId]);
+		gGABAaVec.push_back(managerRuntimeData.gGABAa[renumberGNId(gGrpId, gNId)]);
 	}
 	return gGABAaVec;
 }
@@ -1700,11 +2326,11 @@ std::vector<float> SNN::getConductanceGABAb(int gGrpId) {
 	if (isSimulationWithGABAbRise()) {
 		// need to construct conductance from rise and decay parts
 		for (int gNId = groupConfigMDMap[gGrpId].gStartN; gNId <= groupConfigMDMap[gGrpId].gEndN; gNId++) {
-			gGABAbVec.push_back(managerRuntimeData.gGABAb_d[gNId] - managerRuntimeData.gGABAb_r[gNId]);
+			gGABAbVec.push_back(managerRuntimeData.gGABAb_d[renumberGNId(gGrpId, gNId)] - managerRuntimeData.gGABAb_r[renumberGNId(gGrpId, gNId)]);
 		}
 	} else {
 		for (int gNId = groupConfigMDMap[gGrpId].gStartN; gNId <= groupConfigMDMap[gGrpId].gEndN; gNId++) {
-			gGABAbVec.push_back(managerRuntimeData.gGABAb[gNId]);
+			gGABAbVec.push_back(managerRuntimeData.gGABAb[renumberGNId(gGrpId, gNId)]);
 		}
 	}
 	return gGABAbVec;
@@ -1739,7 +2365,7 @@ uint8_t* SNN::getDelays(int gGrpIdPre, int gGrpIdPost, int& numPreN, int& numPos
 
 	fetchPostConnectionInfo(netIdPost);
 
-	for (int lNIdPre = groupConfigs[netIdPost][lGrpIdPre].lStartN; lNIdPre < groupConfigs[netIdPost][lGrpIdPre].lEndN; lNIdPre++) {
+	for (int lNIdPre = groupConfigs[netIdPost][lGrpIdPre].lStartN; lNIdPre <= groupConfigs[netIdPost][lGrpIdPre].lEndN; lNIdPre++) {
 		unsigned int offset = managerRuntimeData.cumulativePost[lNIdPre];
 
 		for (int t = 0; t < glbNetworkConfig.maxDelay; t++) {
@@ -1754,7 +2380,8 @@ uint8_t* SNN::getDelays(int gGrpIdPre, int gGrpIdPost, int& numPreN, int& numPos
 				assert(lNIdPost < glbNetworkConfig.numN);
 
 				if (lNIdPost >= groupConfigs[netIdPost][lGrpIdPost].lStartN && lNIdPost <= groupConfigs[netIdPost][lGrpIdPost].lEndN) {
-					delays[(lNIdPre - groupConfigs[netIdPost][lGrpIdPre].lStartN) + numPreN * (lNIdPost - groupConfigs[netIdPost][lGrpIdPost].lStartN)] = t + 1;
+					delays[(restoreLNId(netIdPost, lNIdPre) - groupConfigs[netIdPost][lGrpIdPre].lStartN)
+						+ numPreN * (restoreLNId(netIdPost, lNIdPost) - groupConfigs[netIdPost][lGrpIdPost].lStartN)] = t + 1;
 				}
 			}
 		}
@@ -1832,32 +2459,296 @@ GroupNeuromodulatorInfo SNN::getGroupNeuromodulatorInfo(int gGrpId) {
 	return gInfo;
 }
 
-Point3D SNN::getNeuronLocation3D(int gNId) {
-	int gGrpId = -1;
-	assert(gNId >= 0 && gNId < glbNetworkConfig.numN);
-	
-	// search for global group id
-	for (std::map<int, GroupConfigMD>::iterator grpIt = groupConfigMDMap.begin(); grpIt != groupConfigMDMap.end(); grpIt++) {
-		if (gNId >= grpIt->second.gStartN && gNId <= grpIt->second.gEndN)
-			gGrpId = grpIt->second.gGrpId;
+PerformanceReport SNN::getPerformanceReport() {
+	PerformanceReport report;
+	report.numSteps = profNumSteps_;
+	report.runTimeMs = profRunTimeNs_ * 1e-6;
+
+#ifndef __NO_PROFILING__
+	report.enabled = true;
+	for (int i = 0; i < NUM_PROFILER_PHASES; i++) {
+		report.phaseTimeMs[i] = profPhaseTimeNs_[i] * 1e-6;
+		report.phaseCalls[i] = profPhaseCalls_[i];
+		for (int j = 0; j < NUM_HW_COUNTERS; j++)
+			report.phaseHwCounts[i][j] = profPhaseHwCounts_[i][j];
+
+		// counters might have been disabled after they were measured
+		report.hwCountersEnabled = report.hwCountersEnabled || profPhaseHwCounts_[i][HW_INSTRUCTIONS] > 0;
 	}
+	report.hwCountersEnabled = report.hwCountersEnabled || hwCounters_ != NULL;
+#endif
 
-	// adjust neurId for neuron ID of first neuron in the group
-	int neurId = gNId - groupConfigMDMap[gGrpId].gStartN;
+	// only CPU partitions measure their own work
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (groupPartitionLists[netId].empty())
+			continue;
 
-	return getNeuronLocation3D(gGrpId, neurId);
-}
+		report.partitionNames.push_back(getPartitionName(netId));
 
-Point3D SNN::getNeuronLocation3D(int gGrpId, int relNeurId) {
-	Grid3D grid = groupConfigMap[gGrpId].grid;
-	assert(gGrpId >= 0 && gGrpId < numGroups);
-	assert(relNeurId >= 0 && relNeurId < getGroupNumNeurons(gGrpId));
+		std::vector<double> timeMs(NUM_PROFILER_PHASES);
+		for (int i = 0; i < NUM_PROFILER_PHASES; i++)
+			timeMs[i] = profPartitionTimeNs_[netId].timeNs[i] * 1e-6;
+		report.partitionTimeMs.push_back(timeMs);
 
-	int intX = relNeurId % grid.numX;
-	int intY = (relNeurId / grid.numX) % grid.numY;
-	int intZ = relNeurId / (grid.numX * grid.numY);
+		// the events of the current (incomplete) second have not been reduced yet
+		EventCounts events = eventCountsTotal_[netId];
+		events += eventCounters_[netId].counts;
+		report.partitionEvents.push_back(events);
+		report.partitionEventsLastSec.push_back(eventCountsLastSec_[netId]);
+		report.events += events;
+	}
 
-	// get coordinates center around origin
+	return report;
+}
+
+SetupReport SNN::getSetupReport() {
+	SetupReport report = setupReport_;
+	report.peakRssBytes = peakSetupRssBytes;
+	return report;
+}
+
+MemoryReport SNN::getMemoryReport() {
+	MemoryReport report;
+
+	// every array handed out by allocateManagerArray
+	if (managerRuntimeData.allocated) {
+		for (std::map<std::string, size_t>::iterator it = managerArrayBytes.begin(); it != managerArrayBytes.end(); it++)
+			report.arrays.push_back(MemoryUsage("manager", it->first, it->second));
+	}
+
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		if (groupPartitionLists[netId].empty() || !runtimeData[netId].allocated)
+			continue;
+
+		std::string partition = getPartitionName(netId);
+		if (netId >= CPU_RUNTIME_BASE) {
+			// every array handed out by allocateRuntimeArray_CPU, and what is left of the arena
+			for (std::map<std::string, size_t>::iterator it = runtimeArrayBytes[netId].begin();
+				it != runtimeArrayBytes[netId].end(); it++)
+				report.arrays.push_back(MemoryUsage(partition, it->first, it->second));
+			report.arrays.push_back(MemoryUsage(partition, "arena (unused)",
+				runtimeData[netId].arenaSize - runtimeData[netId].arenaUsed));
+		} else {
+			// device memory is not tracked, the GPU runtime allocates the same arrays as a CPU runtime
+			std::vector<int> extFiringGroupSizes;
+			for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++)
+				if (groupConfigs[netId][lGrpId].hasExternalConnect)
+					extFiringGroupSizes.push_back(groupConfigs[netId][lGrpId].numN);
+			listRuntimeArrays_CPU(networkConfigs[netId], extFiringGroupSizes, sim_with_fixedwts, partition,
+				report.arrays);
+		}
+	}
+
+	for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+		const GroupConfigMD& grpConfigMD = groupConfigMDMap[gGrpId];
+		const std::string& grpName = groupConfigMap[gGrpId].grpName;
+		if (grpConfigMD.spikeMonitorId >= 0)
+			report.arrays.push_back(MemoryUsage("monitors", "SpikeMonitor(" + grpName + ")",
+				spikeMonCoreList[grpConfigMD.spikeMonitorId]->getMemoryUsage()));
+		if (grpConfigMD.groupMonitorId >= 0)
+			report.arrays.push_back(MemoryUsage("monitors", "GroupMonitor(" + grpName + ")",
+				groupMonCoreList[grpConfigMD.groupMonitorId]->getMemoryUsage()));
+		if (grpConfigMD.neuronMonitorId >= 0)
+			report.arrays.push_back(MemoryUsage("monitors", "NeuronMonitor(" + grpName + ")",
+				neuronMonCoreList[grpConfigMD.neuronMonitorId]->getMemoryUsage()));
+	}
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		if (connIt->second.connectionMonitorId >= 0)
+			report.arrays.push_back(MemoryUsage("monitors", "ConnectionMonitor(" + groupConfigMap[connIt->second.grpSrc].grpName
+				+ "," + groupConfigMap[connIt->second.grpDest].grpName + ")",
+				connMonCoreList[connIt->second.connectionMonitorId]->getMemoryUsage()));
+	}
+
+	if (setupTempBytes > 0)
+		report.arrays.push_back(MemoryUsage("setup", "connectionLists", setupTempBytes));
+	report.peakRssBytes = peakSetupRssBytes;
+
+	return report;
+}
+
+/*!
+ * \brief this function estimates the memory report of the network before it is set up
+ *
+ * Groups are assigned to partitions like partitionSNN() does. The number of synapses of a connection is its expected
+ * value (random connections) or an upper bound (connections restricted by a receptive field, user-defined
+ * connections). From these, the local network configs and the manager runtime data size are derived like
+ * generateRuntimeNetworkConfigs() does, and their arrays are listed. Nothing is allocated and the state of the
+ * network does not change. Monitors are not known before setupNetwork and are not part of the estimate.
+ *
+ * \since v4.0
+ */
+MemoryReport SNN::estimateMemory() {
+	MemoryReport report;
+	report.isEstimate = true;
+
+	// the partition of every group
+	std::map<int, int> grpNetId;
+	for (std::map<int, GroupConfig>::iterator grpIt = groupConfigMap.begin(); grpIt != groupConfigMap.end(); grpIt++) {
+		int netId = grpIt->second.preferredNetId;
+		if (netId == ANY)
+			netId = (preferredSimMode_ == GPU_MODE) ? GPU_RUNTIME_BASE : CPU_RUNTIME_BASE;
+		grpNetId[grpIt->first] = netId;
+	}
+
+	// the number of synapses of every connection, the fan-in of every group, and the longest outgoing delays
+	std::map<int, double> connNumSyn;
+	std::map<int, double> grpFanIn;
+	std::map<int, int> grpMaxOutgoingDelay;
+	int maxDelay = 1;
+	bool withFixedWts = true;
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		const ConnectConfig& connConfig = connIt->second;
+		double numPre = groupConfigMap[connConfig.grpSrc].numN;
+		double numPost = groupConfigMap[connConfig.grpDest].numN;
+		double numSyn;
+		switch (connConfig.type) {
+		case CONN_ONE_TO_ONE:
+			numSyn = numPre;
+			break;
+		case CONN_FULL_NO_DIRECT:
+			numSyn = numPre * numPost - (connConfig.grpSrc == connConfig.grpDest ? numPre : 0.0);
+			break;
+		case CONN_RANDOM:
+		case CONN_GAUSSIAN:
+			numSyn = numPre * numPost * connConfig.connProbability;
+			break;
+		case CONN_SHARED_KERNEL: {
+			// at most one synapse per kernel element and post-synaptic neuron
+			const RadiusRF& rad = connConfig.connRadius;
+			double kernelN = (2.0 * rad.radX + 1.0) * (2.0 * rad.radY + 1.0) * (2.0 * rad.radZ + 1.0);
+			numSyn = numPost * std::min(numPre, kernelN);
+			break;
+		}
+		default: // CONN_FULL, CONN_USER_DEFINED
+			numSyn = numPre * numPost;
+			break;
+		}
+
+		connNumSyn[connIt->first] = numSyn;
+		grpFanIn[connConfig.grpDest] += numSyn / numPost;
+		grpMaxOutgoingDelay[connConfig.grpSrc] = std::max(grpMaxOutgoingDelay[connConfig.grpSrc], (int)connConfig.maxDelay);
+		maxDelay = std::max(maxDelay, (int)connConfig.maxDelay);
+		if (GET_FIXED_PLASTIC(connConfig.connProp) == SYN_PLASTIC)
+			withFixedWts = false;
+	}
+
+	ManagerRuntimeDataSize size;
+	memset(&size, 0, sizeof(ManagerRuntimeDataSize));
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		// the groups assigned to the partition: its local groups and the groups connected to them
+		std::set<int> assignedGrps;
+		for (std::map<int, int>::iterator it = grpNetId.begin(); it != grpNetId.end(); it++)
+			if (it->second == netId)
+				assignedGrps.insert(it->first);
+		if (assignedGrps.empty())
+			continue;
+
+		NetworkConfigRT config;
+		memset(&config, 0, sizeof(NetworkConfigRT));
+		config.maxDelay = maxDelay;
+		config.numConnections = connectConfigMap.size();
+		config.numKernelWt = sharedKernelTable.size();
+
+		std::set<int> extFiringGrps;
+		double numSyn = 0.0;
+		for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+			int grpSrc = connIt->second.grpSrc;
+			int grpDest = connIt->second.grpDest;
+			if (grpNetId[grpSrc] != netId && grpNetId[grpDest] != netId)
+				continue;
+
+			// synapses of a connection between two partitions are held by both of them
+			numSyn += connNumSyn[connIt->first];
+			if (grpNetId[grpSrc] == netId && grpNetId[grpDest] != netId)
+				extFiringGrps.insert(grpSrc);
+			assignedGrps.insert(grpSrc);
+			assignedGrps.insert(grpDest);
+		}
+		config.numPreSynNet = (int)ceil(numSyn);
+		config.numPostSynNet = config.numPreSynNet;
+
+		std::vector<int> extFiringGroupSizes;
+		for (std::set<int>::iterator it = assignedGrps.begin(); it != assignedGrps.end(); it++) {
+			const GroupConfig& grpConfig = groupConfigMap[*it];
+			config.numNAssigned += grpConfig.numN;
+			if (grpMaxOutgoingDelay[*it] <= 1)
+				config.maxSpikesD1 += grpConfig.numN * NEURON_MAX_FIRING_RATE;
+			else
+				config.maxSpikesD2 += grpConfig.numN * NEURON_MAX_FIRING_RATE;
+			size.maxNumNPerGroup = std::max(size.maxNumNPerGroup, grpConfig.numN);
+			if (grpNetId[*it] != netId)
+				continue;
+
+			config.numGroups++;
+			config.numN += grpConfig.numN;
+			if (grpConfig.type & POISSON_NEURON)
+				config.numNPois += grpConfig.numN;
+			else
+				config.numNReg += grpConfig.numN;
+			if (grpConfig.isSpikeGenerator && grpConfig.spikeGenFunc != NULL)
+				config.numNSpikeGen += grpConfig.numN;
+			config.maxNumPreSynN = std::max(config.maxNumPreSynN, (int)ceil(grpFanIn[*it]));
+			if (extFiringGrps.count(*it))
+				extFiringGroupSizes.push_back(grpConfig.numN);
+		}
+
+		listRuntimeArrays_CPU(config, extFiringGroupSizes, withFixedWts, getPartitionName(netId), report.arrays);
+
+		// the manager runtime data is sufficient to hold the data of any partition
+		size.maxNumN = std::max(size.maxNumN, config.numN);
+		size.maxNumNReg = std::max(size.maxNumNReg, config.numNReg);
+		size.maxNumNAssigned = std::max(size.maxNumNAssigned, config.numNAssigned);
+		size.maxNumNSpikeGen = std::max(size.maxNumNSpikeGen, config.numNSpikeGen);
+		size.maxNumGroups = std::max(size.maxNumGroups, config.numGroups);
+		size.maxNumConnections = std::max(size.maxNumConnections, config.numConnections);
+		size.maxMaxSpikeD1 = std::max(size.maxMaxSpikeD1, config.maxSpikesD1);
+		size.maxMaxSpikeD2 = std::max(size.maxMaxSpikeD2, config.maxSpikesD2);
+		size.maxNumPreSynNet = std::max(size.maxNumPreSynNet, config.numPreSynNet);
+		size.maxNumPostSynNet = std::max(size.maxNumPostSynNet, config.numPostSynNet);
+		size.glbNumN += config.numN;
+		size.glbNumNReg += config.numNReg;
+	}
+
+	std::vector<MemoryUsage> managerArrays;
+	listManagerArrays(size, maxDelay, sharedKernelTable.size(), managerArrays);
+	report.arrays.insert(report.arrays.begin(), managerArrays.begin(), managerArrays.end());
+
+	// every synapse is held by connectionLists[] once for every partition it belongs to
+	double numSynListed = 0.0;
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++)
+		numSynListed += connNumSyn[connIt->first] * (grpNetId[connIt->second.grpSrc] == grpNetId[connIt->second.grpDest] ? 1 : 2);
+	if (numSynListed > 0.0)
+		report.arrays.push_back(MemoryUsage("setup", "connectionLists", (size_t)ceil(numSynListed) * CONNECTION_LIST_NODE_BYTES));
+
+	return report;
+}
+
+Point3D SNN::getNeuronLocation3D(int gNId) {
+	int gGrpId = -1;
+	assert(gNId >= 0 && gNId < glbNetworkConfig.numN);
+	
+	// search for global group id
+	for (std::map<int, GroupConfigMD>::iterator grpIt = groupConfigMDMap.begin(); grpIt != groupConfigMDMap.end(); grpIt++) {
+		if (gNId >= grpIt->second.gStartN && gNId <= grpIt->second.gEndN)
+			gGrpId = grpIt->second.gGrpId;
+	}
+
+	// adjust neurId for neuron ID of first neuron in the group
+	int neurId = gNId - groupConfigMDMap[gGrpId].gStartN;
+
+	return getNeuronLocation3D(gGrpId, neurId);
+}
+
+Point3D SNN::getNeuronLocation3D(int gGrpId, int relNeurId) {
+	Grid3D grid = groupConfigMap[gGrpId].grid;
+	assert(gGrpId >= 0 && gGrpId < numGroups);
+	assert(relNeurId >= 0 && relNeurId < getGroupNumNeurons(gGrpId));
+
+	int intX = relNeurId % grid.numX;
+	int intY = (relNeurId / grid.numX) % grid.numY;
+	int intZ = relNeurId / (grid.numX * grid.numY);
+
+	// get coordinates center around origin
 	double coordX = grid.distX * intX + grid.offsetX;
 	double coordY = grid.distY * intY + grid.offsetY;
 	double coordZ = grid.distZ * intZ + grid.offsetZ;
@@ -1896,6 +2787,12 @@ SpikeMonitorCore* SNN::getSpikeMonitorCore(int gGrpId) {
 	}
 }
 
+SpikeFileWriter* SNN::getSpikeFileWriter() {
+	if (spikeFileWriter == NULL)
+		spikeFileWriter = new SpikeFileWriter(spikeFileBufferSizeKB_ * 1024);
+	return spikeFileWriter;
+}
+
 // returns pointer to existing NeuronMonitor object, NULL else
 NeuronMonitor* SNN::getNeuronMonitor(int gGrpId) {
 	assert(gGrpId >= 0 && gGrpId < getNumGroups());
@@ -2048,6 +2945,24 @@ void SNN::SNNinit() {
 	cumExecutionTime = 0.0;
 	executionTime = 0.0;
 
+	profRunTimeNs_ = 0;
+	profNumSteps_ = 0;
+	memset(profPhaseTimeNs_, 0, sizeof(profPhaseTimeNs_));
+	memset(profPhaseCalls_, 0, sizeof(profPhaseCalls_));
+	memset(profPartitionTimeNs_, 0, sizeof(profPartitionTimeNs_));
+	hwCountersRequested_ = false;
+	hwCounters_ = NULL;
+	tracer_ = NULL;
+	traceNumOverwritten_ = 0;
+	memset(profPhaseHwCounts_, 0, sizeof(profPhaseHwCounts_));
+	setupTempBytes = 0;
+	peakSetupRssBytes = 0;
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		eventCounters_[netId].counts = EventCounts();
+		eventCountsTotal_[netId] = EventCounts();
+		eventCountsLastSec_[netId] = EventCounts();
+	}
+
 	spikeRateUpdated = false;
 	numSpikeMonitor = 0;
 	numNeuronMonitor = 0;
@@ -2080,9 +2995,34 @@ void SNN::SNNinit() {
 	// default integration method: Forward-Euler with 0.5ms integration step
 	setIntegrationMethod(FORWARD_EULER, 2);
 
+	// default neuron layout: creation order
+	neuronOrdering_ = CREATION_ORDER;
+
+	// default thread placement: one core per CPU partition
+	cpuAffinityPolicy_ = CORE_PER_PARTITION;
+
+	// no network image by default
+	networkImageFileName_ = "";
+	networkImageFid = NULL;
+	networkImage = NULL;
+	networkImageSize = 0;
+	memset(networkImageNetOffset, 0, sizeof(size_t) * MAX_NET_PER_SNN);
+
+	// no checkpoints by default
+	checkpointIntervalMs_ = 0;
+	checkpointFileName_ = "";
+	checkpointBufferId = 0;
+	checkpointWriteFileName = "";
+	checkpointWriterActive = false;
+	staticStateHash = 0;
+
 	mulSynFast = NULL;
 	mulSynSlow = NULL;
 
+	// runtimes are counted in partitionSNN, but the network can be deleted before that
+	numGPUs = 0;
+	numCores = 0;
+
 	// reset all monitors, don't deallocate (false)
 	resetMonitors(false);
 
@@ -2093,6 +3033,14 @@ void SNN::SNNinit() {
 	// initialize spike buffer
 	spikeBuf = new SpikeBuffer(0, MAX_TIME_SLICE);
 
+	// the spike file writer is created by the first SpikeMonitor that writes to a file
+	spikeFileWriter = NULL;
+	spikeFileBufferSizeKB_ = SPIKE_FILE_BUFFER_SIZE_KB;
+	spikeFileFlushEverySecond_ = false;
+	spikeFileFormat_ = SPIKE_FILE_FLAT;
+	spikeFileChunkLengthMs_ = SPIKE_FILE_CHUNK_LENGTH_MS;
+	connectFileFormat_ = CONNECT_FILE_DENSE;
+
 	memset(networkConfigs, 0, sizeof(NetworkConfigRT) * MAX_NET_PER_SNN);
 	
 	// reset all runtime data
@@ -2147,9 +3095,12 @@ void SNN::advSimStep() {
 }
 
 void SNN::doSTPUpdateAndDecayCond() {
+	ProfilerScope profScope(profPhaseTimeNs_[PROFILER_STP_DECAY], &profPhaseCalls_[PROFILER_STP_DECAY],
+		hwCounters_, profPhaseHwCounts_[PROFILER_STP_DECAY]);
+	TraceScope traceScope(tracer_, 0, PROFILER_STP_DECAY);
+
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
 		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
 		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
 		int threadCount = 0;
 	#endif
@@ -2165,9 +3116,7 @@ void SNN::doSTPUpdateAndDecayCond() {
 				#else // Linux or MAC
 					pthread_attr_t attr;
 					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+					setThreadAffinity_CPU(netId, &attr);
 
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
@@ -2193,11 +3142,14 @@ void SNN::doSTPUpdateAndDecayCond() {
 }
 
 void SNN::spikeGeneratorUpdate() {
+	ProfilerScope profScope(profPhaseTimeNs_[PROFILER_SPIKE_GENERATOR], &profPhaseCalls_[PROFILER_SPIKE_GENERATOR],
+		hwCounters_, profPhaseHwCounts_[PROFILER_SPIKE_GENERATOR]);
+	TraceScope traceScope(tracer_, 0, PROFILER_SPIKE_GENERATOR);
+
 	// If poisson rate has been updated, assign new poisson rate
 	if (spikeRateUpdated) {
 		#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
 			pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-			cpu_set_t cpus;	
 			ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
 			int threadCount = 0;
 		#endif
@@ -2212,9 +3164,7 @@ void SNN::spikeGeneratorUpdate() {
 					#else // Linux or MAC
 						pthread_attr_t attr;
 						pthread_attr_init(&attr);
-						CPU_ZERO(&cpus);
-						CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-						pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+						setThreadAffinity_CPU(netId, &attr);
 
 						argsThreadRoutine[threadCount].snn_pointer = this;
 						argsThreadRoutine[threadCount].netId = netId;
@@ -2246,7 +3196,6 @@ void SNN::spikeGeneratorUpdate() {
 
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
 		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
 		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
 		int threadCount = 0;
 	#endif
@@ -2261,9 +3210,7 @@ void SNN::spikeGeneratorUpdate() {
 				#else // Linux or MAC
 					pthread_attr_t attr;
 					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+					setThreadAffinity_CPU(netId, &attr);
 
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
@@ -2292,9 +3239,12 @@ void SNN::spikeGeneratorUpdate() {
 }
 
 void SNN::findFiring() {
+	ProfilerScope profScope(profPhaseTimeNs_[PROFILER_FIND_FIRING], &profPhaseCalls_[PROFILER_FIND_FIRING],
+		hwCounters_, profPhaseHwCounts_[PROFILER_FIND_FIRING]);
+	TraceScope traceScope(tracer_, 0, PROFILER_FIND_FIRING);
+
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
 		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
 		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
 		int threadCount = 0;
 	#endif
@@ -2309,9 +3259,7 @@ void SNN::findFiring() {
 				#else // Linux or MAC
 					pthread_attr_t attr;
 					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+					setThreadAffinity_CPU(netId, &attr);
 
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
@@ -2337,9 +3285,12 @@ void SNN::findFiring() {
 }
 
 void SNN::doCurrentUpdate() {
+	ProfilerScope profScope(profPhaseTimeNs_[PROFILER_CURRENT_UPDATE], &profPhaseCalls_[PROFILER_CURRENT_UPDATE],
+		hwCounters_, profPhaseHwCounts_[PROFILER_CURRENT_UPDATE]);
+	TraceScope traceScope(tracer_, 0, PROFILER_CURRENT_UPDATE);
+
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
 		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
 		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
 		int threadCount = 0;
 	#endif
@@ -2354,9 +3305,7 @@ void SNN::doCurrentUpdate() {
 				#else // Linux or MAC
 					pthread_attr_t attr;
 					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+					setThreadAffinity_CPU(netId, &attr);
 
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
@@ -2391,9 +3340,7 @@ void SNN::doCurrentUpdate() {
 				#else // Linux or MAC
 					pthread_attr_t attr;
 					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+					setThreadAffinity_CPU(netId, &attr);
 
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
@@ -2419,9 +3366,12 @@ void SNN::doCurrentUpdate() {
 }
 
 void SNN::updateTimingTable() {
+	ProfilerScope profScope(profPhaseTimeNs_[PROFILER_TIMING_TABLE], &profPhaseCalls_[PROFILER_TIMING_TABLE],
+		hwCounters_, profPhaseHwCounts_[PROFILER_TIMING_TABLE]);
+	TraceScope traceScope(tracer_, 0, PROFILER_TIMING_TABLE);
+
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
 		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
 		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
 		int threadCount = 0;
 	#endif
@@ -2436,9 +3386,7 @@ void SNN::updateTimingTable() {
 				#else // Linux or MAC
 					pthread_attr_t attr;
 					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+					setThreadAffinity_CPU(netId, &attr);
 
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
@@ -2463,9 +3411,12 @@ void SNN::updateTimingTable() {
 }
 
 void SNN::globalStateUpdate() {
+	ProfilerScope profScope(profPhaseTimeNs_[PROFILER_STATE_UPDATE], &profPhaseCalls_[PROFILER_STATE_UPDATE],
+		hwCounters_, profPhaseHwCounts_[PROFILER_STATE_UPDATE]);
+	TraceScope traceScope(tracer_, 0, PROFILER_STATE_UPDATE);
+
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
 		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
 		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
 		int threadCount = 0;
 	#endif
@@ -2480,9 +3431,7 @@ void SNN::globalStateUpdate() {
 				#else // Linux or MAC
 					pthread_attr_t attr;
 					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+					setThreadAffinity_CPU(netId, &attr);
 
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
@@ -2522,9 +3471,12 @@ void SNN::globalStateUpdate() {
 }
 
 void SNN::clearExtFiringTable() {
+	ProfilerScope profScope(profPhaseTimeNs_[PROFILER_CLEAR_EXT_FIRING], &profPhaseCalls_[PROFILER_CLEAR_EXT_FIRING],
+		hwCounters_, profPhaseHwCounts_[PROFILER_CLEAR_EXT_FIRING]);
+	TraceScope traceScope(tracer_, 0, PROFILER_CLEAR_EXT_FIRING);
+
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
 		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
 		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
 		int threadCount = 0;
 	#endif
@@ -2539,9 +3491,7 @@ void SNN::clearExtFiringTable() {
 				#else // Linux or MAC
 					pthread_attr_t attr;
 					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+					setThreadAffinity_CPU(netId, &attr);
 
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
@@ -2567,9 +3517,12 @@ void SNN::clearExtFiringTable() {
 }
 
 void SNN::updateWeights() {
+	ProfilerScope profScope(profPhaseTimeNs_[PROFILER_UPDATE_WEIGHTS], &profPhaseCalls_[PROFILER_UPDATE_WEIGHTS],
+		hwCounters_, profPhaseHwCounts_[PROFILER_UPDATE_WEIGHTS]);
+	TraceScope traceScope(tracer_, 0, PROFILER_UPDATE_WEIGHTS);
+
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
 		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
 		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
 		int threadCount = 0;
 	#endif
@@ -2584,9 +3537,7 @@ void SNN::updateWeights() {
 				#else // Linux or MAC
 					pthread_attr_t attr;
 					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+					setThreadAffinity_CPU(netId, &attr);
 
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
@@ -2621,9 +3572,11 @@ void SNN::updateNetworkConfig(int netId) {
 }
 
 void SNN::shiftSpikeTables() {
+	ProfilerScope profScope(profPhaseTimeNs_[PROFILER_SHIFT_SPIKE_TABLES], &profPhaseCalls_[PROFILER_SHIFT_SPIKE_TABLES],
+		hwCounters_, profPhaseHwCounts_[PROFILER_SHIFT_SPIKE_TABLES]);
+	TraceScope traceScope(tracer_, 0, PROFILER_SHIFT_SPIKE_TABLES);
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
 		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
 		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
 		int threadCount = 0;
 	#endif
@@ -2638,9 +3591,7 @@ void SNN::shiftSpikeTables() {
 				#else // Linux or MAC
 					pthread_attr_t attr;
 					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+					setThreadAffinity_CPU(netId, &attr);
 
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
@@ -2673,6 +3624,7 @@ void SNN::shiftSpikeTables() {
 }
 
 void SNN::allocateSNN(int netId) {
+	SetupStageScope stageScope(setupReport_, SETUP_ALLOCATE);
 	assert(netId > ANY && netId < MAX_NET_PER_SNN);
 	
 	if (netId < CPU_RUNTIME_BASE)
@@ -2694,29 +3646,29 @@ void SNN::allocateManagerRuntimeData() {
 	managerRuntimeData.spikeCountExtRxD1 = 0;
 	managerRuntimeData.spikeCountExtRxD2 = 0;
 
-	managerRuntimeData.voltage    = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.nextVoltage = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.recovery   = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.Izh_a      = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.Izh_b      = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.Izh_c      = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.Izh_d      = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.Izh_C	  = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.Izh_k	  = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.Izh_vr	  = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.Izh_vt	  = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.Izh_vpeak  = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.lif_tau_m      = new int[managerRTDSize.maxNumNReg];
-	managerRuntimeData.lif_tau_ref      = new int[managerRTDSize.maxNumNReg];
-	managerRuntimeData.lif_tau_ref_c      = new int[managerRTDSize.maxNumNReg];
-	managerRuntimeData.lif_vTh      = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.lif_vReset      = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.lif_gain      = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.lif_bias      = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.current    = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.extCurrent = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.totalCurrent = new float[managerRTDSize.maxNumNReg];
-	managerRuntimeData.curSpike   = new bool[managerRTDSize.maxNumNReg];
+	managerRuntimeData.voltage    = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "voltage");
+	managerRuntimeData.nextVoltage = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "nextVoltage");
+	managerRuntimeData.recovery   = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "recovery");
+	managerRuntimeData.Izh_a      = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "Izh_a");
+	managerRuntimeData.Izh_b      = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "Izh_b");
+	managerRuntimeData.Izh_c      = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "Izh_c");
+	managerRuntimeData.Izh_d      = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "Izh_d");
+	managerRuntimeData.Izh_C	  = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "Izh_C");
+	managerRuntimeData.Izh_k	  = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "Izh_k");
+	managerRuntimeData.Izh_vr	  = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "Izh_vr");
+	managerRuntimeData.Izh_vt	  = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "Izh_vt");
+	managerRuntimeData.Izh_vpeak  = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "Izh_vpeak");
+	managerRuntimeData.lif_tau_m      = allocateManagerArray<int>(managerRTDSize.maxNumNReg, "lif_tau_m");
+	managerRuntimeData.lif_tau_ref      = allocateManagerArray<int>(managerRTDSize.maxNumNReg, "lif_tau_ref");
+	managerRuntimeData.lif_tau_ref_c      = allocateManagerArray<int>(managerRTDSize.maxNumNReg, "lif_tau_ref_c");
+	managerRuntimeData.lif_vTh      = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "lif_vTh");
+	managerRuntimeData.lif_vReset      = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "lif_vReset");
+	managerRuntimeData.lif_gain      = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "lif_gain");
+	managerRuntimeData.lif_bias      = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "lif_bias");
+	managerRuntimeData.current    = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "current");
+	managerRuntimeData.extCurrent = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "extCurrent");
+	managerRuntimeData.totalCurrent = allocateManagerArray<float>(managerRTDSize.maxNumNReg, "totalCurrent");
+	managerRuntimeData.curSpike   = allocateManagerArray<bool>(managerRTDSize.maxNumNReg, "curSpike");
 	memset(managerRuntimeData.voltage, 0, sizeof(float) * managerRTDSize.maxNumNReg);
 	memset(managerRuntimeData.nextVoltage, 0, sizeof(float) * managerRTDSize.maxNumNReg);
 	memset(managerRuntimeData.recovery, 0, sizeof(float) * managerRTDSize.maxNumNReg);
@@ -2741,117 +3693,221 @@ void SNN::allocateManagerRuntimeData() {
 	memset(managerRuntimeData.totalCurrent, 0, sizeof(float) * managerRTDSize.maxNumNReg);
 	memset(managerRuntimeData.curSpike, 0, sizeof(bool) * managerRTDSize.maxNumNReg);
 
-	managerRuntimeData.nVBuffer = new float[MAX_NEURON_MON_GRP_SZIE * 1000 * managerRTDSize.maxNumGroups]; // 1 second v buffer
-	managerRuntimeData.nUBuffer = new float[MAX_NEURON_MON_GRP_SZIE * 1000 * managerRTDSize.maxNumGroups];
-	managerRuntimeData.nIBuffer = new float[MAX_NEURON_MON_GRP_SZIE * 1000 * managerRTDSize.maxNumGroups];
-	memset(managerRuntimeData.nVBuffer, 0, sizeof(float) * MAX_NEURON_MON_GRP_SZIE * 1000 * managerRTDSize.maxNumGroups);
-	memset(managerRuntimeData.nUBuffer, 0, sizeof(float) * MAX_NEURON_MON_GRP_SZIE * 1000 * managerRTDSize.maxNumGroups);
-	memset(managerRuntimeData.nIBuffer, 0, sizeof(float) * MAX_NEURON_MON_GRP_SZIE * 1000 * managerRTDSize.maxNumGroups);
-
-	managerRuntimeData.gAMPA  = new float[managerRTDSize.glbNumNReg]; // sufficient to hold all regular neurons in the global network
-	managerRuntimeData.gNMDA_r = new float[managerRTDSize.glbNumNReg]; // sufficient to hold all regular neurons in the global network
-	managerRuntimeData.gNMDA_d = new float[managerRTDSize.glbNumNReg]; // sufficient to hold all regular neurons in the global network
-	managerRuntimeData.gNMDA = new float[managerRTDSize.glbNumNReg]; // sufficient to hold all regular neurons in the global network
+	// 1 second v, u, I buffers, one slot per group with a NeuronMonitor
+	managerRuntimeData.nVBuffer = allocateManagerArray<float>(MAX_NEURON_MON_GRP_SZIE * 1000 * managerRTDSize.maxNumNeuronMonSlots, "nVBuffer");
+	managerRuntimeData.nUBuffer = allocateManagerArray<float>(MAX_NEURON_MON_GRP_SZIE * 1000 * managerRTDSize.maxNumNeuronMonSlots, "nUBuffer");
+	managerRuntimeData.nIBuffer = allocateManagerArray<float>(MAX_NEURON_MON_GRP_SZIE * 1000 * managerRTDSize.maxNumNeuronMonSlots, "nIBuffer");
+	memset(managerRuntimeData.nVBuffer, 0, sizeof(float) * MAX_NEURON_MON_GRP_SZIE * 1000 * managerRTDSize.maxNumNeuronMonSlots);
+	memset(managerRuntimeData.nUBuffer, 0, sizeof(float) * MAX_NEURON_MON_GRP_SZIE * 1000 * managerRTDSize.maxNumNeuronMonSlots);
+	memset(managerRuntimeData.nIBuffer, 0, sizeof(float) * MAX_NEURON_MON_GRP_SZIE * 1000 * managerRTDSize.maxNumNeuronMonSlots);
+	managerRuntimeData.nStreamBuffer = allocateManagerArray<float>(managerRTDSize.maxNumNeuronMonStreamFloats, "nStreamBuffer");
+	memset(managerRuntimeData.nStreamBuffer, 0, sizeof(float) * managerRTDSize.maxNumNeuronMonStreamFloats);
+
+	managerRuntimeData.gAMPA  = allocateManagerArray<float>(managerRTDSize.glbNumNReg, "gAMPA"); // sufficient to hold all regular neurons in the global network
+	managerRuntimeData.gNMDA_r = allocateManagerArray<float>(managerRTDSize.glbNumNReg, "gNMDA_r"); // sufficient to hold all regular neurons in the global network
+	managerRuntimeData.gNMDA_d = allocateManagerArray<float>(managerRTDSize.glbNumNReg, "gNMDA_d"); // sufficient to hold all regular neurons in the global network
+	managerRuntimeData.gNMDA = allocateManagerArray<float>(managerRTDSize.glbNumNReg, "gNMDA"); // sufficient to hold all regular neurons in the global network
 	memset(managerRuntimeData.gAMPA, 0, sizeof(float) * managerRTDSize.glbNumNReg);
 	memset(managerRuntimeData.gNMDA_r, 0, sizeof(float) * managerRTDSize.glbNumNReg);
 	memset(managerRuntimeData.gNMDA_d, 0, sizeof(float) * managerRTDSize.glbNumNReg);
 	memset(managerRuntimeData.gNMDA, 0, sizeof(float) * managerRTDSize.glbNumNReg);
 
-	managerRuntimeData.gGABAa = new float[managerRTDSize.glbNumNReg]; // sufficient to hold all regular neurons in the global network
-	managerRuntimeData.gGABAb_r = new float[managerRTDSize.glbNumNReg]; // sufficient to hold all regular neurons in the global network
-	managerRuntimeData.gGABAb_d = new float[managerRTDSize.glbNumNReg]; // sufficient to hold all regular neurons in the global network
-	managerRuntimeData.gGABAb = new float[managerRTDSize.glbNumNReg]; // sufficient to hold all regular neurons in the global network
+	managerRuntimeData.gGABAa = allocateManagerArray<float>(managerRTDSize.glbNumNReg, "gGABAa"); // sufficient to hold all regular neurons in the global network
+	managerRuntimeData.gGABAb_r = allocateManagerArray<float>(managerRTDSize.glbNumNReg, "gGABAb_r"); // sufficient to hold all regular neurons in the global network
+	managerRuntimeData.gGABAb_d = allocateManagerArray<float>(managerRTDSize.glbNumNReg, "gGABAb_d"); // sufficient to hold all regular neurons in the global network
+	managerRuntimeData.gGABAb = allocateManagerArray<float>(managerRTDSize.glbNumNReg, "gGABAb"); // sufficient to hold all regular neurons in the global network
 	memset(managerRuntimeData.gGABAa, 0, sizeof(float) * managerRTDSize.glbNumNReg);
 	memset(managerRuntimeData.gGABAb_r, 0, sizeof(float) * managerRTDSize.glbNumNReg);
 	memset(managerRuntimeData.gGABAb_d, 0, sizeof(float) * managerRTDSize.glbNumNReg);
 	memset(managerRuntimeData.gGABAb, 0, sizeof(float) * managerRTDSize.glbNumNReg);
 	
 	// allocate neuromodulators and their assistive buffers
-	managerRuntimeData.grpDA  = new float[managerRTDSize.maxNumGroups];
-	managerRuntimeData.grp5HT = new float[managerRTDSize.maxNumGroups];
-	managerRuntimeData.grpACh = new float[managerRTDSize.maxNumGroups];
-	managerRuntimeData.grpNE  = new float[managerRTDSize.maxNumGroups];
+	managerRuntimeData.grpDA  = allocateManagerArray<float>(managerRTDSize.maxNumGroups, "grpDA");
+	managerRuntimeData.grp5HT = allocateManagerArray<float>(managerRTDSize.maxNumGroups, "grp5HT");
+	managerRuntimeData.grpACh = allocateManagerArray<float>(managerRTDSize.maxNumGroups, "grpACh");
+	managerRuntimeData.grpNE  = allocateManagerArray<float>(managerRTDSize.maxNumGroups, "grpNE");
 	memset(managerRuntimeData.grpDA, 0, sizeof(float) * managerRTDSize.maxNumGroups);
 	memset(managerRuntimeData.grp5HT, 0, sizeof(float) * managerRTDSize.maxNumGroups);
 	memset(managerRuntimeData.grpACh, 0, sizeof(float) * managerRTDSize.maxNumGroups);
 	memset(managerRuntimeData.grpNE, 0, sizeof(float) * managerRTDSize.maxNumGroups);
 
 
-	managerRuntimeData.grpDABuffer  = new float[managerRTDSize.maxNumGroups * 1000]; // 1 second DA buffer
-	managerRuntimeData.grp5HTBuffer = new float[managerRTDSize.maxNumGroups * 1000];
-	managerRuntimeData.grpAChBuffer = new float[managerRTDSize.maxNumGroups * 1000];
-	managerRuntimeData.grpNEBuffer  = new float[managerRTDSize.maxNumGroups * 1000];
+	managerRuntimeData.grpDABuffer  = allocateManagerArray<float>(managerRTDSize.maxNumGroups * 1000, "grpDABuffer"); // 1 second DA buffer
+	managerRuntimeData.grp5HTBuffer = allocateManagerArray<float>(managerRTDSize.maxNumGroups * 1000, "grp5HTBuffer");
+	managerRuntimeData.grpAChBuffer = allocateManagerArray<float>(managerRTDSize.maxNumGroups * 1000, "grpAChBuffer");
+	managerRuntimeData.grpNEBuffer  = allocateManagerArray<float>(managerRTDSize.maxNumGroups * 1000, "grpNEBuffer");
 	memset(managerRuntimeData.grpDABuffer, 0, managerRTDSize.maxNumGroups * sizeof(float) * 1000);
 	memset(managerRuntimeData.grp5HTBuffer, 0, managerRTDSize.maxNumGroups * sizeof(float) * 1000);
 	memset(managerRuntimeData.grpAChBuffer, 0, managerRTDSize.maxNumGroups * sizeof(float) * 1000);
 	memset(managerRuntimeData.grpNEBuffer, 0, managerRTDSize.maxNumGroups * sizeof(float) * 1000);
 
-	managerRuntimeData.lastSpikeTime = new int[managerRTDSize.maxNumNAssigned];
+	managerRuntimeData.lastSpikeTime = allocateManagerArray<int>(managerRTDSize.maxNumNAssigned, "lastSpikeTime");
 	memset(managerRuntimeData.lastSpikeTime, 0, sizeof(int) * managerRTDSize.maxNumNAssigned);
 	
-	managerRuntimeData.nSpikeCnt = new int[managerRTDSize.glbNumN];
+	managerRuntimeData.nSpikeCnt = allocateManagerArray<int>(managerRTDSize.glbNumN, "nSpikeCnt");
 	memset(managerRuntimeData.nSpikeCnt, 0, sizeof(int) * managerRTDSize.glbNumN); // sufficient to hold all neurons in the global network
 
 	//! homeostasis variables
-	managerRuntimeData.avgFiring  = new float[managerRTDSize.maxNumN];
-	managerRuntimeData.baseFiring = new float[managerRTDSize.maxNumN];
+	managerRuntimeData.avgFiring  = allocateManagerArray<float>(managerRTDSize.maxNumN, "avgFiring");
+	managerRuntimeData.baseFiring = allocateManagerArray<float>(managerRTDSize.maxNumN, "baseFiring");
 	memset(managerRuntimeData.avgFiring, 0, sizeof(float) * managerRTDSize.maxNumN);
 	memset(managerRuntimeData.baseFiring, 0, sizeof(float) * managerRTDSize.maxNumN);
 
 	// STP can be applied to spike generators, too -> numN
 	// \TODO: The size of these data structures could be reduced to the max synaptic delay of all
 	// connections with STP. That number might not be the same as maxDelay_.
-	managerRuntimeData.stpu = new float[managerRTDSize.maxNumN * (glbNetworkConfig.maxDelay + 1)];
-	managerRuntimeData.stpx = new float[managerRTDSize.maxNumN * (glbNetworkConfig.maxDelay + 1)];
+	managerRuntimeData.stpu = allocateManagerArray<float>(managerRTDSize.maxNumN * (glbNetworkConfig.maxDelay + 1), "stpu");
+	managerRuntimeData.stpx = allocateManagerArray<float>(managerRTDSize.maxNumN * (glbNetworkConfig.maxDelay + 1), "stpx");
 	memset(managerRuntimeData.stpu, 0, sizeof(float) * managerRTDSize.maxNumN * (glbNetworkConfig.maxDelay + 1));
 	memset(managerRuntimeData.stpx, 0, sizeof(float) * managerRTDSize.maxNumN * (glbNetworkConfig.maxDelay + 1));
 
-	managerRuntimeData.Npre           = new unsigned short[managerRTDSize.maxNumNAssigned];
-	managerRuntimeData.Npre_plastic   = new unsigned short[managerRTDSize.maxNumNAssigned];
-	managerRuntimeData.Npost          = new unsigned short[managerRTDSize.maxNumNAssigned];
-	managerRuntimeData.cumulativePost = new unsigned int[managerRTDSize.maxNumNAssigned];
-	managerRuntimeData.cumulativePre  = new unsigned int[managerRTDSize.maxNumNAssigned];
+	managerRuntimeData.Npre           = allocateManagerArray<unsigned short>(managerRTDSize.maxNumNAssigned, "Npre");
+	managerRuntimeData.Npre_plastic   = allocateManagerArray<unsigned short>(managerRTDSize.maxNumNAssigned, "Npre_plastic");
+	managerRuntimeData.Npost          = allocateManagerArray<unsigned short>(managerRTDSize.maxNumNAssigned, "Npost");
+	managerRuntimeData.cumulativePost = allocateManagerArray<unsigned int>(managerRTDSize.maxNumNAssigned, "cumulativePost");
+	managerRuntimeData.cumulativePre  = allocateManagerArray<unsigned int>(managerRTDSize.maxNumNAssigned, "cumulativePre");
 	memset(managerRuntimeData.Npre, 0, sizeof(short) * managerRTDSize.maxNumNAssigned);
 	memset(managerRuntimeData.Npre_plastic, 0, sizeof(short) * managerRTDSize.maxNumNAssigned);
 	memset(managerRuntimeData.Npost, 0, sizeof(short) * managerRTDSize.maxNumNAssigned);
 	memset(managerRuntimeData.cumulativePost, 0, sizeof(int) * managerRTDSize.maxNumNAssigned);
 	memset(managerRuntimeData.cumulativePre, 0, sizeof(int) * managerRTDSize.maxNumNAssigned);
 
-	managerRuntimeData.postSynapticIds = new SynInfo[managerRTDSize.maxNumPostSynNet];
-	managerRuntimeData.postDelayInfo   = new DelayInfo[managerRTDSize.maxNumNAssigned * (glbNetworkConfig.maxDelay + 1)];	//!< Possible delay values are 0....maxDelay_ (inclusive of maxDelay_)
+	managerRuntimeData.postSynapticIds = allocateManagerArray<SynInfo>(managerRTDSize.maxNumPostSynNet, "postSynapticIds");
+	managerRuntimeData.postDelayInfo   = allocateManagerArray<DelayInfo>(managerRTDSize.maxNumNAssigned * (glbNetworkConfig.maxDelay + 1), "postDelayInfo");	//!< Possible delay values are 0....maxDelay_ (inclusive of maxDelay_)
 	memset(managerRuntimeData.postSynapticIds, 0, sizeof(SynInfo) * managerRTDSize.maxNumPostSynNet);
 	memset(managerRuntimeData.postDelayInfo, 0, sizeof(DelayInfo) * managerRTDSize.maxNumNAssigned * (glbNetworkConfig.maxDelay + 1));
 
-	managerRuntimeData.preSynapticIds	= new SynInfo[managerRTDSize.maxNumPreSynNet];
+	managerRuntimeData.preSynapticIds	= allocateManagerArray<SynInfo>(managerRTDSize.maxNumPreSynNet, "preSynapticIds");
 	memset(managerRuntimeData.preSynapticIds, 0, sizeof(SynInfo) * managerRTDSize.maxNumPreSynNet);
 
-	managerRuntimeData.wt           = new float[managerRTDSize.maxNumPreSynNet];
-	managerRuntimeData.wtChange     = new float[managerRTDSize.maxNumPreSynNet];
-	managerRuntimeData.maxSynWt     = new float[managerRTDSize.maxNumPreSynNet];
-	managerRuntimeData.synSpikeTime = new int[managerRTDSize.maxNumPreSynNet];
+	managerRuntimeData.wt           = allocateManagerArray<float>(managerRTDSize.maxNumPreSynNet, "wt");
+	managerRuntimeData.wtChange     = allocateManagerArray<float>(managerRTDSize.maxNumPreSynNet, "wtChange");
+	managerRuntimeData.maxSynWt     = allocateManagerArray<float>(managerRTDSize.maxNumPreSynNet, "maxSynWt");
+	managerRuntimeData.synSpikeTime = allocateManagerArray<int>(managerRTDSize.maxNumPreSynNet, "synSpikeTime");
 	memset(managerRuntimeData.wt, 0, sizeof(float) * managerRTDSize.maxNumPreSynNet);
 	memset(managerRuntimeData.wtChange, 0, sizeof(float) * managerRTDSize.maxNumPreSynNet);
 	memset(managerRuntimeData.maxSynWt, 0, sizeof(float) * managerRTDSize.maxNumPreSynNet);
 	memset(managerRuntimeData.synSpikeTime, 0, sizeof(int) * managerRTDSize.maxNumPreSynNet);
 
-	mulSynFast = new float[managerRTDSize.maxNumConnections];
-	mulSynSlow = new float[managerRTDSize.maxNumConnections];
+	mulSynFast = allocateManagerArray<float>(managerRTDSize.maxNumConnections, "mulSynFast");
+	mulSynSlow = allocateManagerArray<float>(managerRTDSize.maxNumConnections, "mulSynSlow");
 	memset(mulSynFast, 0, sizeof(float) * managerRTDSize.maxNumConnections);
 	memset(mulSynSlow, 0, sizeof(float) * managerRTDSize.maxNumConnections);
 
-	managerRuntimeData.connIdsPreIdx	= new short int[managerRTDSize.maxNumPreSynNet];
+	managerRuntimeData.connIdsPreIdx	= allocateManagerArray<short int>(managerRTDSize.maxNumPreSynNet, "connIdsPreIdx");
 	memset(managerRuntimeData.connIdsPreIdx, 0, sizeof(short int) * managerRTDSize.maxNumPreSynNet);
 
-	managerRuntimeData.grpIds = new short int[managerRTDSize.maxNumNAssigned];
+	managerRuntimeData.grpIds = allocateManagerArray<short int>(managerRTDSize.maxNumNAssigned, "grpIds");
 	memset(managerRuntimeData.grpIds, 0, sizeof(short int) * managerRTDSize.maxNumNAssigned);
 
-	managerRuntimeData.spikeGenBits = new unsigned int[managerRTDSize.maxNumNSpikeGen / 32 + 1];
+	// shared-kernel connections: one copy of every kernel
+	if (!sharedKernelTable.empty()) {
+		managerRuntimeData.kernelWt       = allocateManagerArray<float>(sharedKernelTable.size(), "kernelWt");
+		managerRuntimeData.kernelWtChange = allocateManagerArray<float>(sharedKernelTable.size(), "kernelWtChange");
+		managerRuntimeData.kernelMaxWt    = allocateManagerArray<float>(sharedKernelTable.size(), "kernelMaxWt");
+		memset(managerRuntimeData.kernelWt, 0, sizeof(float) * sharedKernelTable.size());
+		memset(managerRuntimeData.kernelWtChange, 0, sizeof(float) * sharedKernelTable.size());
+		memset(managerRuntimeData.kernelMaxWt, 0, sizeof(float) * sharedKernelTable.size());
+	}
+
+	managerRuntimeData.spikeGenBits = allocateManagerArray<unsigned int>(managerRTDSize.maxNumNSpikeGen / 32 + 1, "spikeGenBits");
 
 	// Confirm allocation of SNN runtime data in main memory
 	managerRuntimeData.allocated = true;
 	managerRuntimeData.memType = CPU_MEM;
 }
 
+/*!
+ * \brief this function lists all arrays of the manager runtime data with their sizes
+ *
+ * The list mirrors allocateManagerSpikeTables() and allocateManagerRuntimeData() and is used by estimateMemory() with
+ * an estimate of managerRTDSize. getMemoryReport() reports the sizes recorded by allocateManagerArray() instead, so
+ * Core.memoryReport catches any array that is missing here.
+ *
+ * \param[in] size the size of the manager runtime data
+ * \param[in] maxDelay the maximum axonal delay of the network
+ * \param[in] numKernelWt the number of shared-kernel weights
+ * \param[out] arrays the list to append the arrays to
+ *
+ * \since v4.0
+ */
+void SNN::listManagerArrays(const ManagerRuntimeDataSize& size, int maxDelay, int numKernelWt,
+	std::vector<MemoryUsage>& arrays) {
+	std::vector<MemoryUsage>& a = arrays;
+	const std::string p = "manager";
+
+	// allocateManagerSpikeTables
+	addMemoryUsage(a, p, "firingTableD2", size.maxMaxSpikeD2, sizeof(int));
+	addMemoryUsage(a, p, "firingTableD1", size.maxMaxSpikeD1, sizeof(int));
+	addMemoryUsage(a, p, "extFiringTableEndIdxD2", size.maxNumGroups, sizeof(int));
+	addMemoryUsage(a, p, "extFiringTableEndIdxD1", size.maxNumGroups, sizeof(int));
+	addMemoryUsage(a, p, "extFiringTableD2", size.maxNumGroups, sizeof(int*));
+	addMemoryUsage(a, p, "extFiringTableD1", size.maxNumGroups, sizeof(int*));
+	addMemoryUsage(a, p, "timeTableD2", TIMING_COUNT, sizeof(unsigned int));
+	addMemoryUsage(a, p, "timeTableD1", TIMING_COUNT, sizeof(unsigned int));
+
+	// allocateManagerRuntimeData
+	const char* stateNames[] = {"voltage", "nextVoltage", "recovery", "Izh_a", "Izh_b", "Izh_c", "Izh_d", "Izh_C",
+		"Izh_k", "Izh_vr", "Izh_vt", "Izh_vpeak", "lif_vTh", "lif_vReset", "lif_gain", "lif_bias", "current",
+		"extCurrent", "totalCurrent"};
+	for (int i = 0; i < sizeof(stateNames) / sizeof(stateNames[0]); i++)
+		addMemoryUsage(a, p, stateNames[i], size.maxNumNReg, sizeof(float));
+	addMemoryUsage(a, p, "lif_tau_m", size.maxNumNReg, sizeof(int));
+	addMemoryUsage(a, p, "lif_tau_ref", size.maxNumNReg, sizeof(int));
+	addMemoryUsage(a, p, "lif_tau_ref_c", size.maxNumNReg, sizeof(int));
+	addMemoryUsage(a, p, "curSpike", size.maxNumNReg, sizeof(bool));
+
+	addMemoryUsage(a, p, "nVBuffer", MAX_NEURON_MON_GRP_SZIE * 1000 * size.maxNumNeuronMonSlots, sizeof(float));
+	addMemoryUsage(a, p, "nUBuffer", MAX_NEURON_MON_GRP_SZIE * 1000 * size.maxNumNeuronMonSlots, sizeof(float));
+	addMemoryUsage(a, p, "nIBuffer", MAX_NEURON_MON_GRP_SZIE * 1000 * size.maxNumNeuronMonSlots, sizeof(float));
+	addMemoryUsage(a, p, "nStreamBuffer", size.maxNumNeuronMonStreamFloats, sizeof(float));
+
+	const char* conductanceNames[] = {"gAMPA", "gNMDA_r", "gNMDA_d", "gNMDA", "gGABAa", "gGABAb_r", "gGABAb_d",
+		"gGABAb"};
+	for (int i = 0; i < sizeof(conductanceNames) / sizeof(conductanceNames[0]); i++)
+		addMemoryUsage(a, p, conductanceNames[i], size.glbNumNReg, sizeof(float));
+
+	const char* grpNames[] = {"grpDA", "grp5HT", "grpACh", "grpNE"};
+	const char* grpBufferNames[] = {"grpDABuffer", "grp5HTBuffer", "grpAChBuffer", "grpNEBuffer"};
+	for (int i = 0; i < 4; i++)
+		addMemoryUsage(a, p, grpNames[i], size.maxNumGroups, sizeof(float));
+	for (int i = 0; i < 4; i++)
+		addMemoryUsage(a, p, grpBufferNames[i], size.maxNumGroups * 1000, sizeof(float));
+
+	addMemoryUsage(a, p, "lastSpikeTime", size.maxNumNAssigned, sizeof(int));
+	addMemoryUsage(a, p, "nSpikeCnt", size.glbNumN, sizeof(int));
+	addMemoryUsage(a, p, "avgFiring", size.maxNumN, sizeof(float));
+	addMemoryUsage(a, p, "baseFiring", size.maxNumN, sizeof(float));
+	addMemoryUsage(a, p, "stpu", size.maxNumN * (maxDelay + 1), sizeof(float));
+	addMemoryUsage(a, p, "stpx", size.maxNumN * (maxDelay + 1), sizeof(float));
+
+	addMemoryUsage(a, p, "Npre", size.maxNumNAssigned, sizeof(unsigned short));
+	addMemoryUsage(a, p, "Npre_plastic", size.maxNumNAssigned, sizeof(unsigned short));
+	addMemoryUsage(a, p, "Npost", size.maxNumNAssigned, sizeof(unsigned short));
+	addMemoryUsage(a, p, "cumulativePost", size.maxNumNAssigned, sizeof(unsigned int));
+	addMemoryUsage(a, p, "cumulativePre", size.maxNumNAssigned, sizeof(unsigned int));
+	addMemoryUsage(a, p, "postSynapticIds", size.maxNumPostSynNet, sizeof(SynInfo));
+	addMemoryUsage(a, p, "postDelayInfo", size.maxNumNAssigned * (maxDelay + 1), sizeof(DelayInfo));
+	addMemoryUsage(a, p, "preSynapticIds", size.maxNumPreSynNet, sizeof(SynInfo));
+
+	addMemoryUsage(a, p, "wt", size.maxNumPreSynNet, sizeof(float));
+	addMemoryUsage(a, p, "wtChange", size.maxNumPreSynNet, sizeof(float));
+	addMemoryUsage(a, p, "maxSynWt", size.maxNumPreSynNet, sizeof(float));
+	addMemoryUsage(a, p, "synSpikeTime", size.maxNumPreSynNet, sizeof(int));
+	addMemoryUsage(a, p, "mulSynFast", size.maxNumConnections, sizeof(float));
+	addMemoryUsage(a, p, "mulSynSlow", size.maxNumConnections, sizeof(float));
+	addMemoryUsage(a, p, "connIdsPreIdx", size.maxNumPreSynNet, sizeof(short int));
+	addMemoryUsage(a, p, "grpIds", size.maxNumNAssigned, sizeof(short int));
+
+	if (numKernelWt > 0) {
+		addMemoryUsage(a, p, "kernelWt", numKernelWt, sizeof(float));
+		addMemoryUsage(a, p, "kernelWtChange", numKernelWt, sizeof(float));
+		addMemoryUsage(a, p, "kernelMaxWt", numKernelWt, sizeof(float));
+	}
+
+	addMemoryUsage(a, p, "spikeGenBits", size.maxNumNSpikeGen / 32 + 1, sizeof(unsigned int));
+}
+
 int SNN::assignGroup(int gGrpId, int availableNeuronId) {
 	int newAvailableNeuronId;
 	assert(groupConfigMDMap[gGrpId].gStartN == -1); // The group has not yet been assigned
@@ -2929,6 +3985,15 @@ void SNN::generateRuntimeGroupConfigs() {
 			groupConfigs[netId][lGrpId].hasExternalConnect = grpIt->hasExternalConnect;
 			groupConfigs[netId][lGrpId].Noffset = grpIt->Noffset; // Note: Noffset is not valid at this time
 			groupConfigs[netId][lGrpId].MaxDelay = grpIt->maxOutgoingDelay;
+			groupConfigs[netId][lGrpId].neuronMonitorSlot = -1; // assigned in generateRuntimeNetworkConfigs()
+			groupConfigs[netId][lGrpId].neuronMonitorStreamOffset = -1; // assigned in generateRuntimeNetworkConfigs()
+			groupConfigs[netId][lGrpId].neuronMonitorStreamFirstN = 0;
+			groupConfigs[netId][lGrpId].neuronMonitorStreamRangeN = 0;
+			groupConfigs[netId][lGrpId].neuronMonitorStreamSlotOffset = 0;
+			groupConfigs[netId][lGrpId].neuronMonitorStreamNumN = 0;
+			groupConfigs[netId][lGrpId].neuronMonitorStreamStride = 1;
+			groupConfigs[netId][lGrpId].neuronMonitorStreamWindow = 0;
+			groupConfigs[netId][lGrpId].hasGroupMonitor = grpIt->netId == netId && groupConfigMDMap[gGrpId].groupMonitorId >= 0;
 			groupConfigs[netId][lGrpId].STP_A = groupConfigMap[gGrpId].stpConfig.STP_A;
 			groupConfigs[netId][lGrpId].STP_U = groupConfigMap[gGrpId].stpConfig.STP_U;
 			groupConfigs[netId][lGrpId].STP_tau_u_inv = groupConfigMap[gGrpId].stpConfig.STP_tau_u_inv; 
@@ -3036,12 +4101,37 @@ void SNN::generateRuntimeNetworkConfigs() {
 			networkConfigs[netId].sim_with_stp = sim_with_stp;
 			networkConfigs[netId].sim_in_testing = sim_in_testing;
 
-			// search for active neuron monitor
-			networkConfigs[netId].sim_with_nm = false;
+			// search for active neuron monitors, only monitored groups get a slot in the neuron state buffers
+			// sampling neuron monitors instead get a ring buffer in nStreamBuffer, which holds the sampled neurons only
+			// and as many samples as fit into NEURON_MON_STREAM_BUFFER_SIZE (at most 1 second worth). nStreamSlot
+			// maps the range of sampled neurons to their index within a sample
+			networkConfigs[netId].numNeuronMonSlots = 0;
+			networkConfigs[netId].numNeuronMonStreamFloats = 0;
+			networkConfigs[netId].numNeuronMonStreamSlots = 0;
 			for (std::list<GroupConfigMD>::iterator grpIt = groupPartitionLists[netId].begin(); grpIt != groupPartitionLists[netId].end(); grpIt++) {
-				if (grpIt->netId == netId && grpIt->neuronMonitorId >= 0)
-					networkConfigs[netId].sim_with_nm = true;
+				if (grpIt->netId != netId || grpIt->neuronMonitorId < 0)
+					continue;
+
+				NeuronMonitorCore* nrnMonObj = neuronMonCoreList[grpIt->neuronMonitorId];
+				GroupConfigRT& grpConfig = groupConfigs[netId][grpIt->lGrpId];
+				if (nrnMonObj->isSampling()) {
+					const std::vector<int>& neurIds = nrnMonObj->getSampledNeurIds();
+					assert(!neurIds.empty()); // sorted in ascending order
+					grpConfig.neuronMonitorStreamFirstN = neurIds.front();
+					grpConfig.neuronMonitorStreamRangeN = neurIds.back() - neurIds.front() + 1;
+					grpConfig.neuronMonitorStreamSlotOffset = networkConfigs[netId].numNeuronMonStreamSlots;
+					networkConfigs[netId].numNeuronMonStreamSlots += grpConfig.neuronMonitorStreamRangeN;
+					grpConfig.neuronMonitorStreamNumN = neurIds.size();
+					grpConfig.neuronMonitorStreamStride = nrnMonObj->getSamplingStride();
+					grpConfig.neuronMonitorStreamWindow = std::max(1, std::min(1000,
+						(int)(NEURON_MON_STREAM_BUFFER_SIZE / (3 * sizeof(float) * grpConfig.neuronMonitorStreamNumN))));
+					grpConfig.neuronMonitorStreamOffset = networkConfigs[netId].numNeuronMonStreamFloats;
+					networkConfigs[netId].numNeuronMonStreamFloats += 3 * grpConfig.neuronMonitorStreamNumN * grpConfig.neuronMonitorStreamWindow;
+				} else {
+					grpConfig.neuronMonitorSlot = networkConfigs[netId].numNeuronMonSlots++;
+				}
 			}
+			networkConfigs[netId].sim_with_nm = networkConfigs[netId].numNeuronMonSlots > 0;
 
 			// stdp, da-stdp configurations
 			networkConfigs[netId].stdpScaleFactor = stdpScaleFactor_;
@@ -3079,10 +4169,18 @@ void SNN::generateRuntimeNetworkConfigs() {
 			//networkConfigs[netId].numAssignedConnections = localConnectLists[netId].size() + externalConnectLists[netId].size();
 			//networkConfigs[netId].numConnections = localConnectLists[netId].size() + externalConnectLists[netId].size();
 			networkConfigs[netId].numConnections = connectConfigMap.size();// temporarily solution: copy all connection info to each GPU
+			networkConfigs[netId].numKernelWt = sharedKernelTable.size(); // every partition holds a copy of all kernels
 
 			// find the maximum number of pre- and post-connections among neurons
 			// SNN::maxNumPreSynN and SNN::maxNumPostSynN are updated
-			findMaxNumSynapsesNeurons(netId, networkConfigs[netId].maxNumPostSynN, networkConfigs[netId].maxNumPreSynN);
+			if (networkImage != NULL) {
+				NetworkImageNetHeader header;
+				memcpy(&header, networkImage + networkImageNetOffset[netId], sizeof(NetworkImageNetHeader));
+				networkConfigs[netId].maxNumPostSynN = header.maxNumPostSynN;
+				networkConfigs[netId].maxNumPreSynN = header.maxNumPreSynN;
+			} else {
+				findMaxNumSynapsesNeurons(netId, networkConfigs[netId].maxNumPostSynN, networkConfigs[netId].maxNumPreSynN);
+			}
 
 			// find the maximum number of spikes in D1 (i.e., maxDelay == 1) and D2 (i.e., maxDelay >= 2) sets
 			findMaxSpikesD1D2(netId, networkConfigs[netId].maxSpikesD1, networkConfigs[netId].maxSpikesD2);
@@ -3110,6 +4208,8 @@ void SNN::generateRuntimeNetworkConfigs() {
 			
 			// find the maximum number of numGroups and numConnections among local networks
 			if (networkConfigs[netId].numGroups > managerRTDSize.maxNumGroups) managerRTDSize.maxNumGroups = networkConfigs[netId].numGroups;
+			if (networkConfigs[netId].numNeuronMonSlots > managerRTDSize.maxNumNeuronMonSlots) managerRTDSize.maxNumNeuronMonSlots = networkConfigs[netId].numNeuronMonSlots;
+			if (networkConfigs[netId].numNeuronMonStreamFloats > managerRTDSize.maxNumNeuronMonStreamFloats) managerRTDSize.maxNumNeuronMonStreamFloats = networkConfigs[netId].numNeuronMonStreamFloats;
 			if (networkConfigs[netId].numConnections > managerRTDSize.maxNumConnections) managerRTDSize.maxNumConnections = networkConfigs[netId].numConnections;
 			
 			// find the maximum number of neurons in a group among local networks
@@ -3132,6 +4232,104 @@ void SNN::generateRuntimeNetworkConfigs() {
 	}
 }
 
+// Hilbert index of grid point (x,y,z) in a cube of side 2^bits
+// after J. Skilling (2004), "Programming the Hilbert curve", AIP Conf. Proc. 707
+unsigned long long hilbertIndex3D(unsigned int x, unsigned int y, unsigned int z, int bits) {
+	unsigned int X[3] = {x, y, z};
+	unsigned int M = 1U << (bits - 1);
+	unsigned int P, Q, t;
+
+	// inverse undo excess work
+	for (Q = M; Q > 1; Q >>= 1) {
+		P = Q - 1;
+		for (int i = 0; i < 3; i++) {
+			if (X[i] & Q) {
+				X[0] ^= P; // invert
+			} else { // exchange
+				t = (X[0] ^ X[i]) & P;
+				X[0] ^= t;
+				X[i] ^= t;
+			}
+		}
+	}
+
+	// Gray encode
+	for (int i = 1; i < 3; i++)
+		X[i] ^= X[i - 1];
+	t = 0;
+	for (Q = M; Q > 1; Q >>= 1)
+		if (X[2] & Q)
+			t ^= Q - 1;
+	for (int i = 0; i < 3; i++)
+		X[i] ^= t;
+
+	// interleave the transposed bits, most significant first
+	unsigned long long h = 0;
+	for (int b = bits - 1; b >= 0; b--)
+		for (int i = 0; i < 3; i++)
+			h = (h << 1) | ((X[i] >> b) & 1);
+
+	return h;
+}
+
+void SNN::generateNeuronOrder(int netId) {
+	neuronRenumber[netId].clear();
+	neuronRenumberInv[netId].clear();
+
+	if (neuronOrdering_ == CREATION_ORDER)
+		return;
+
+	// the renumbered IDs are only understood by the CPU runtime
+	if (netId < CPU_RUNTIME_BASE) {
+		KERNEL_WARN("Neuron ordering \"%s\" is not supported on GPU %d, neurons are kept in creation order",
+			neuronOrdering_string[neuronOrdering_], netId);
+		return;
+	}
+
+	// start from the identity, external neurons are never renumbered
+	neuronRenumber[netId].resize(networkConfigs[netId].numNAssigned);
+	neuronRenumberInv[netId].resize(networkConfigs[netId].numNAssigned);
+	for (int lNId = 0; lNId < networkConfigs[netId].numNAssigned; lNId++)
+		neuronRenumber[netId][lNId] = neuronRenumberInv[netId][lNId] = lNId;
+
+	int numGrpRenumbered = 0;
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroupsAssigned; lGrpId++) {
+		// poisson groups (rates, spike generators) and compartmental groups (neighbors are matched by ID) keep their order
+		if (groupConfigs[netId][lGrpId].netId != netId || (groupConfigs[netId][lGrpId].Type & POISSON_NEURON)
+			|| groupConfigs[netId][lGrpId].withCompartments)
+			continue;
+
+		Grid3D grid = groupConfigMap[groupConfigs[netId][lGrpId].gGrpId].grid;
+		int bits = 1;
+		while ((1 << bits) < std::max(grid.numX, std::max(grid.numY, grid.numZ)))
+			bits++;
+
+		// sort neurons by their position on the Hilbert curve
+		std::vector<std::pair<unsigned long long, int> > order;
+		for (int nId = 0; nId < groupConfigs[netId][lGrpId].numN; nId++) {
+			int x = nId % grid.numX;
+			int y = (nId / grid.numX) % grid.numY;
+			int z = nId / (grid.numX * grid.numY);
+			order.push_back(std::make_pair(hilbertIndex3D(x, y, z, bits), nId));
+		}
+		std::sort(order.begin(), order.end());
+
+		int lStartN = groupConfigs[netId][lGrpId].lStartN;
+		for (int k = 0; k < order.size(); k++) {
+			neuronRenumber[netId][lStartN + order[k].second] = lStartN + k;
+			neuronRenumberInv[netId][lStartN + k] = lStartN + order[k].second;
+		}
+		numGrpRenumbered++;
+	}
+
+	KERNEL_INFO("Renumbered the neurons of %d group(s) in %s", numGrpRenumbered, neuronOrdering_string[neuronOrdering_]);
+}
+
+int SNN::renumberGNId(int gGrpId, int gNId) {
+	int netId = groupConfigMDMap[gGrpId].netId;
+	return renumberLNId(netId, gNId + groupConfigMDMap[gGrpId].GtoLOffset) + groupConfigMDMap[gGrpId].LtoGOffset;
+}
+
 bool compareSrcNeuron(const ConnectionInfo& first, const ConnectionInfo& second) {
 	return (first.nSrc + first.srcGLoffset < second.nSrc + second.srcGLoffset);
 }
@@ -3142,6 +4340,7 @@ bool compareDelay(const ConnectionInfo& first, const ConnectionInfo& second) {
 
 // Note: ConnectInfo stored in connectionList use global ids
 void SNN::generateConnectionRuntime(int netId) {
+	SetupStageScope stageScope(setupReport_, SETUP_CONNECTION_RUNTIME);
 	std::map<int, int> GLoffset; // global nId to local nId offset
 	std::map<int, int> GLgrpId; // global grpId to local grpId offset
 
@@ -3150,6 +4349,16 @@ void SNN::generateConnectionRuntime(int netId) {
 		GLoffset[grpIt->gGrpId] = grpIt->GtoLOffset;
 		GLgrpId[grpIt->gGrpId] = grpIt->lGrpId;
 	}
+
+	// move the synapses to the renumbered neurons, the connectivity below is built on renumbered local IDs
+	if (!neuronRenumber[netId].empty()) {
+		for (std::list<ConnectionInfo>::iterator connIt = connectionLists[netId].begin(); connIt != connectionLists[netId].end(); connIt++) {
+			connIt->nSrc = renumberLNId(netId, connIt->nSrc + GLoffset[connIt->grpSrc]) - GLoffset[connIt->grpSrc];
+			connIt->nDest = renumberLNId(netId, connIt->nDest + GLoffset[connIt->grpDest]) - GLoffset[connIt->grpDest];
+		}
+	}
+	generateSharedKernelGridPos(netId);
+
 	// FIXME: connId is global connId, use connectConfigs[netId][local connId] instead,
 	// FIXME; but note connectConfigs[netId][] are NOT complete, lack of exeternal incoming connections
 	// generate mulSynFast, mulSynSlow in connection-centric array
@@ -3157,6 +4366,30 @@ void SNN::generateConnectionRuntime(int netId) {
 		// store scaling factors for synaptic currents in connection-centric array
 		mulSynFast[connIt->second.connId] = connIt->second.mulSynFast;
 		mulSynSlow[connIt->second.connId] = connIt->second.mulSynSlow;
+		generateSharedKernelConfig(netId, connIt->second);
+
+		// init kernelWt, kernelMaxWt of shared-kernel connections, signed according to the pre-group
+		if (connIt->second.type == CONN_SHARED_KERNEL) {
+			int kernelSize = (2 * connIt->second.connRadius.radX + 1) * (2 * connIt->second.connRadius.radY + 1) * (2 * connIt->second.connRadius.radZ + 1);
+			float sign = isExcitatoryGroup(connIt->second.grpSrc) ? 1.0f : -1.0f;
+			for (int k = connIt->second.kernelOffset; k < connIt->second.kernelOffset + kernelSize; k++) {
+				managerRuntimeData.kernelWt[k] = sign * fabs(sharedKernelTable[k]);
+				managerRuntimeData.kernelMaxWt[k] = sign * fabs(connIt->second.maxWt);
+				managerRuntimeData.kernelWtChange[k] = 0.0f;
+			}
+		}
+	}
+
+	// restore the kernels saved with saveSimulation
+	if (networkConfigs[netId].numKernelWt > 0 && loadedKernelWt[netId].size() == networkConfigs[netId].numKernelWt) {
+		memcpy(managerRuntimeData.kernelWt, &loadedKernelWt[netId][0], sizeof(float) * networkConfigs[netId].numKernelWt);
+		loadedKernelWt[netId].clear();
+	}
+
+	// the connectivity below has been cached in a network image
+	if (networkImage != NULL) {
+		loadNetworkImageConnections(netId);
+		return;
 	}
 
 	// parse ConnectionInfo stored in connectionLists[0]
@@ -3469,6 +4702,7 @@ void SNN::collectGlobalNetworkConfigP() {
 // after all the initalization. Its time to create the synaptic weights, weight change and also
 // time of firing these are the mostly costly arrays so dense packing is essential to minimize wastage of space
 void SNN::compileSNN() {
+	SetupStageScope stageScope(setupReport_, SETUP_COMPILE);
 	KERNEL_DEBUG("Beginning compilation of the network....");
 
 	// compile (update) group and connection configs according to their mutual information
@@ -3553,9 +4787,18 @@ void SNN::compileGroupConfig() {
 }
 
 void SNN::connectNetwork() {
+	SetupStageScope stageScope(setupReport_, SETUP_CONNECT);
+
 	// this parse generates local connections
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		for (std::list<ConnectConfig>::iterator connIt = localConnectLists[netId].begin(); connIt != localConnectLists[netId].end(); connIt++) {
+			// synapses loaded from a saveSimulation file replace the generated ones
+			if (loadedSynRange.count(connIt->connId) > 0) {
+				connectLoaded(netId, connIt, false);
+				continue;
+			}
+
+			SetupStageScope connStageScope(setupReport_, getConnectStage(connIt->type));
 			switch(connIt->type) {
 				case CONN_RANDOM:
 					connectRandom(netId, connIt, false);
@@ -3575,16 +4818,27 @@ void SNN::connectNetwork() {
 				case CONN_USER_DEFINED:
 					connectUserDefined(netId, connIt, false);
 					break;
+				case CONN_SHARED_KERNEL:
+					connectSharedKernel(netId, connIt, false);
+					break;
 				default:
 					KERNEL_ERROR("Invalid connection type( should be 'random', 'full', 'full-no-direct', or 'one-to-one')");
 					exitSimulation(-1);
 			}
+			setupReport_.stageSynapses[getConnectStage(connIt->type)] += connIt->numberOfConnections;
 		}
 	}
 
 	// this parse generates external connections
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		for (std::list<ConnectConfig>::iterator connIt = externalConnectLists[netId].begin(); connIt != externalConnectLists[netId].end(); connIt++) {
+			// synapses loaded from a saveSimulation file replace the generated ones
+			if (loadedSynRange.count(connIt->connId) > 0) {
+				connectLoaded(netId, connIt, true);
+				continue;
+			}
+
+			SetupStageScope connStageScope(setupReport_, getConnectStage(connIt->type));
 			switch(connIt->type) {
 				case CONN_RANDOM:
 					connectRandom(netId, connIt, true);
@@ -3604,10 +4858,14 @@ void SNN::connectNetwork() {
 				case CONN_USER_DEFINED:
 					connectUserDefined(netId, connIt, true);
 					break;
+				case CONN_SHARED_KERNEL:
+					connectSharedKernel(netId, connIt, true);
+					break;
 				default:
 					KERNEL_ERROR("Invalid connection type( should be 'random', 'full', 'full-no-direct', or 'one-to-one')");
 					exitSimulation(-1);
 			}
+			setupReport_.stageSynapses[getConnectStage(connIt->type)] += connIt->numberOfConnections;
 		}
 	}
 }
@@ -3728,6 +4986,72 @@ void SNN::connectFull(int netId, std::list<ConnectConfig>::iterator connIt, bool
 	}
 }
 
+// restore the synapses of a connection that were read by loadSimulation_internal
+void SNN::connectLoaded(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
+	int grpSrc = connIt->grpSrc;
+	int grpDest = connIt->grpDest;
+	int externalNetId = -1;
+
+	if (isExternal) {
+		externalNetId = groupConfigMDMap[grpDest].netId;
+		assert(netId != externalNetId);
+	}
+
+	int first = loadedSynRange[connIt->connId].first;
+	int numSyn = loadedSynRange[connIt->connId].second;
+	uint8_t plastic = GET_FIXED_PLASTIC(connIt->connProp) == SYN_PLASTIC ? 1 : 0;
+	for (int i = first; i < first + numSyn; i++) {
+		int gPreN = loadedSynPreIds[i];
+		int gPostN = loadedSynPostIds[i];
+		if (gPreN < groupConfigMDMap[grpSrc].gStartN || gPreN > groupConfigMDMap[grpSrc].gEndN
+			|| gPostN < groupConfigMDMap[grpDest].gStartN || gPostN > groupConfigMDMap[grpDest].gEndN) {
+			KERNEL_ERROR("loadSimulation: Synapse %d->%d in file does not belong to connection %d", gPreN, gPostN, connIt->connId);
+			exitSimulation(-1);
+		}
+		if (loadedSynDelay[i] < connIt->minDelay || loadedSynDelay[i] > connIt->maxDelay) {
+			KERNEL_ERROR("loadSimulation: Delay in file (%d) is outside the delay range of connection %d",
+				(int)loadedSynDelay[i], connIt->connId);
+			exitSimulation(-1);
+		}
+		if (loadedSynPlastic[i] != plastic) {
+			KERNEL_ERROR("loadSimulation: Connection %d is %s in file but %s in simulation", connIt->connId,
+				loadedSynPlastic[i] ? "plastic" : "fixed", plastic ? "plastic" : "fixed");
+			exitSimulation(-1);
+		}
+
+		connectNeurons(netId, grpSrc, grpDest, gPreN, gPostN, connIt->connId, loadedSynWt[i], loadedSynMaxWt[i],
+			loadedSynDelay[i], externalNetId);
+		connIt->numberOfConnections++;
+	}
+
+	std::list<GroupConfigMD>::iterator grpIt;
+	GroupConfigMD targetGrp;
+
+	// update numPostSynapses and numPreSynapses of groups in the local network
+	targetGrp.gGrpId = grpSrc; // the other fields does not matter
+	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
+	assert(grpIt != groupPartitionLists[netId].end());
+	grpIt->numPostSynapses += connIt->numberOfConnections;
+
+	targetGrp.gGrpId = grpDest; // the other fields does not matter
+	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
+	assert(grpIt != groupPartitionLists[netId].end());
+	grpIt->numPreSynapses += connIt->numberOfConnections;
+
+	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
+	if (isExternal) {
+		targetGrp.gGrpId = grpSrc; // the other fields does not matter
+		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
+		assert(grpIt != groupPartitionLists[externalNetId].end());
+		grpIt->numPostSynapses += connIt->numberOfConnections;
+
+		targetGrp.gGrpId = grpDest; // the other fields does not matter
+		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
+		assert(grpIt != groupPartitionLists[externalNetId].end());
+		grpIt->numPreSynapses += connIt->numberOfConnections;
+	}
+}
+
 void SNN::connectGaussian(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
 	// in case pre and post have different Grid3D sizes: scale pre to the grid size of post
 	int grpSrc = connIt->grpSrc;
@@ -3976,58 +5300,200 @@ void SNN::connectUserDefined(int netId, std::list<ConnectConfig>::iterator connI
 	}
 }
 
-//// make 'C' full connections from grpSrc to grpDest
-//void SNN::connectFull(short int connId) {
-//	int grpSrc = connectConfigMap[connId].grpSrc;
-//	int grpDest = connectConfigMap[connId].grpDest;
-//	bool noDirect = (connectConfigMap[connId].type == CONN_FULL_NO_DIRECT);
-//
-//	// rebuild struct for easier handling
-//	RadiusRF radius(connectConfigMap[connId].radX, connectConfigMap[connId].radY, connectConfigMap[connId].radZ);
-//
-//	for(int i = groupConfigMap[grpSrc].StartN; i <= groupConfigMap[grpSrc].EndN; i++)  {
-//		Point3D loc_i = getNeuronLocation3D(i); // 3D coordinates of i
-//		for(int j = groupConfigMap[grpDest].StartN; j <= groupConfigMap[grpDest].EndN; j++) { // j: the temp neuron id
-//			// if flag is set, don't connect direct connections
-//			if((noDirect) && (i - groupConfigMap[grpSrc].StartN) == (j - groupConfigMap[grpDest].StartN))
-//				continue;
-//
-//			// check whether pre-neuron location is in RF of post-neuron
-//			Point3D loc_j = getNeuronLocation3D(j); // 3D coordinates of j
-//			if (!isPoint3DinRF(radius, loc_i, loc_j))
-//				continue;
-//
-//			//uint8_t dVal = info->minDelay + (int)(0.5 + (drand48() * (info->maxDelay - info->minDelay)));
-//			uint8_t dVal = connectConfigMap[connId].minDelay + rand() % (connectConfigMap[connId].maxDelay - connectConfigMap[connId].minDelay + 1);
-//			assert((dVal >= connectConfigMap[connId].minDelay) && (dVal <= connectConfigMap[connId].maxDelay));
-//			float synWt = generateWeight(connectConfigMap[connId].connProp, connectConfigMap[connId].initWt, connectConfigMap[connId].maxWt, i, grpSrc);
-//
-//			setConnection(grpSrc, grpDest, i, j, synWt, connectConfigMap[connId].maxWt, dVal, connectConfigMap[connId].connProp, connId);// info->connId);
-//			connectConfigMap[connId].numberOfConnections++;
-//		}
-//	}
-//
-//	groupInfo[grpSrc].sumPostConn += connectConfigMap[connId].numberOfConnections;
-//	groupInfo[grpDest].sumPreConn += connectConfigMap[connId].numberOfConnections;
-//}
+// weight-sharing connections: every post-neuron applies the same kernel, indexed by its offset to the pre-neuron
+void SNN::connectSharedKernel(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
+	int grpSrc = connIt->grpSrc;
+	int grpDest = connIt->grpDest;
+	int externalNetId = -1;
 
-//void SNN::connectGaussian(short int connId) {
-//	// rebuild struct for easier handling
-//	// adjust with sqrt(2) in order to make the Gaussian kernel depend on 2*sigma^2
-//	RadiusRF radius(connectConfigMap[connId].radX, connectConfigMap[connId].radY, connectConfigMap[connId].radZ);
-//
-//	// in case pre and post have different Grid3D sizes: scale pre to the grid size of post
-//	int grpSrc = connectConfigMap[connId].grpSrc;
-//	int grpDest = connectConfigMap[connId].grpDest;
-//	Grid3D grid_i = getGroupGrid3D(grpSrc);
-//	Grid3D grid_j = getGroupGrid3D(grpDest);
-//	Point3D scalePre = Point3D(grid_j.numX, grid_j.numY, grid_j.numZ) / Point3D(grid_i.numX, grid_i.numY, grid_i.numZ);
-//
-//	for(int i = groupConfigMap[grpSrc].StartN; i <= groupConfigMap[grpSrc].EndN; i++)  {
-//		Point3D loc_i = getNeuronLocation3D(i)*scalePre; // i: adjusted 3D coordinates
-//
-//		for(int j = groupConfigMap[grpDest].StartN; j <= groupConfigMap[grpDest].EndN; j++) { // j: the temp neuron id
-//			// check whether pre-neuron location is in RF of post-neuron
+	if (isExternal) {
+		externalNetId = groupConfigMDMap[grpDest].netId;
+		assert(netId != externalNetId);
+	}
+
+	// synaptic weights are looked up from the kernel during spike delivery, which is implemented in the CPU backend
+	if (groupConfigMDMap[grpDest].netId < CPU_RUNTIME_BASE) {
+		KERNEL_ERROR("Shared-kernel connection %d requires group %s(%d) to run on a CPU partition", connIt->connId,
+			groupConfigMap[grpDest].grpName.c_str(), grpDest);
+		exitSimulation(-1);
+	}
+
+	Grid3D gridPre = getGroupGrid3D(grpSrc);
+	Grid3D gridPost = getGroupGrid3D(grpDest);
+	int numPre[3] = { gridPre.numX, gridPre.numY, gridPre.numZ };
+	int numPost[3] = { gridPost.numX, gridPost.numY, gridPost.numZ };
+	int radX = connIt->connRadius.radX;
+	int radY = connIt->connRadius.radY;
+	int radZ = connIt->connRadius.radZ;
+	int kernelNumX = 2 * radX + 1;
+	int kernelNumY = 2 * radY + 1;
+
+	// invert the pre-to-post grid maps: pre coordinates [preBegin[d][v], preBegin[d][v+1]) map to post coordinate v
+	std::vector<int> preBegin[3];
+	const int* gridMap = &sharedKernelGridMap[connIt->kernelGridMapOffset];
+	for (int d = 0; d < 3; d++) {
+		preBegin[d].assign(numPost[d] + 1, 0);
+		for (int i = 0; i < numPre[d]; i++)
+			preBegin[d][gridMap[i] + 1]++;
+		for (int v = 0; v < numPost[d]; v++)
+			preBegin[d][v + 1] += preBegin[d][v];
+		gridMap += numPre[d];
+	}
+
+	// only visit the kernel footprint of every post-neuron
+	for (int j = 0; j < gridPost.N; j++) {
+		int postX = j % numPost[0];
+		int postY = (j / numPost[0]) % numPost[1];
+		int postZ = j / (numPost[0] * numPost[1]);
+
+		for (int dZ = -radZ; dZ <= radZ; dZ++) {
+			if (postZ + dZ < 0 || postZ + dZ >= numPost[2])
+				continue;
+			for (int dY = -radY; dY <= radY; dY++) {
+				if (postY + dY < 0 || postY + dY >= numPost[1])
+					continue;
+				for (int dX = -radX; dX <= radX; dX++) {
+					if (postX + dX < 0 || postX + dX >= numPost[0])
+						continue;
+
+					int kernelIdx = connIt->kernelOffset + ((dZ + radZ) * kernelNumY + (dY + radY)) * kernelNumX + (dX + radX);
+					if (sharedKernelTable[kernelIdx] == 0.0f)
+						continue;
+
+					for (int iZ = preBegin[2][postZ + dZ]; iZ < preBegin[2][postZ + dZ + 1]; iZ++) {
+						for (int iY = preBegin[1][postY + dY]; iY < preBegin[1][postY + dY + 1]; iY++) {
+							for (int iX = preBegin[0][postX + dX]; iX < preBegin[0][postX + dX + 1]; iX++) {
+								int i = groupConfigMDMap[grpSrc].gStartN + (iZ * numPre[1] + iY) * numPre[0] + iX;
+								uint8_t delay = connIt->minDelay + rand() % (connIt->maxDelay - connIt->minDelay + 1);
+								assert((delay >= connIt->minDelay) && (delay <= connIt->maxDelay));
+
+								// the synapse does not own a weight, it is read from kernelWt
+								connectNeurons(netId, grpSrc, grpDest, i, groupConfigMDMap[grpDest].gStartN + j, connIt->connId,
+									0.0f, connIt->maxWt, delay, externalNetId);
+								connIt->numberOfConnections++;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	std::list<GroupConfigMD>::iterator grpIt;
+	GroupConfigMD targetGrp;
+
+	// update numPostSynapses and numPreSynapses of groups in the local network
+	targetGrp.gGrpId = grpSrc; // the other fields does not matter
+	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
+	assert(grpIt != groupPartitionLists[netId].end());
+	grpIt->numPostSynapses += connIt->numberOfConnections;
+
+	targetGrp.gGrpId = grpDest; // the other fields does not matter
+	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
+	assert(grpIt != groupPartitionLists[netId].end());
+	grpIt->numPreSynapses += connIt->numberOfConnections;
+
+	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
+	if (isExternal) {
+		targetGrp.gGrpId = grpSrc; // the other fields does not matter
+		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
+		assert(grpIt != groupPartitionLists[externalNetId].end());
+		grpIt->numPostSynapses += connIt->numberOfConnections;
+
+		targetGrp.gGrpId = grpDest; // the other fields does not matter
+		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
+		assert(grpIt != groupPartitionLists[externalNetId].end());
+		grpIt->numPreSynapses += connIt->numberOfConnections;
+	}
+}
+
+// fills the kernel geometry of a shared-kernel connection in connectConfigs[netId], see getSharedKernelIdx
+void SNN::generateSharedKernelConfig(int netId, const ConnectConfig& connConfig) {
+	ConnectConfigRT& kernelConfig = connectConfigs[netId][connConfig.connId];
+	kernelConfig.kernelOffset = connConfig.kernelOffset;
+	if (connConfig.type != CONN_SHARED_KERNEL)
+		return;
+
+	Grid3D gridPre = getGroupGrid3D(connConfig.grpSrc);
+	kernelConfig.kernelStrideY = 2 * connConfig.connRadius.radX + 1;
+	kernelConfig.kernelStrideZ = kernelConfig.kernelStrideY * (2 * connConfig.connRadius.radY + 1);
+	kernelConfig.kernelCenter = connConfig.kernelOffset + connConfig.connRadius.radZ * kernelConfig.kernelStrideZ
+		+ connConfig.connRadius.radY * kernelConfig.kernelStrideY + connConfig.connRadius.radX;
+	kernelConfig.kernelGridMapX = connConfig.kernelGridMapOffset;
+	kernelConfig.kernelGridMapY = kernelConfig.kernelGridMapX + gridPre.numX;
+	kernelConfig.kernelGridMapZ = kernelConfig.kernelGridMapY + gridPre.numY;
+}
+
+// stores the grid coordinates of all local neurons, from which getSharedKernelIdx derives the offset of pre to post
+void SNN::generateSharedKernelGridPos(int netId) {
+	sharedKernelGridPos[netId].clear();
+	if (networkConfigs[netId].numKernelWt == 0)
+		return;
+
+	sharedKernelGridPos[netId].resize(3 * networkConfigs[netId].numNAssigned, 0);
+	for (std::list<GroupConfigMD>::iterator grpIt = groupPartitionLists[netId].begin(); grpIt != groupPartitionLists[netId].end(); grpIt++) {
+		Grid3D grid = getGroupGrid3D(grpIt->gGrpId);
+		for (int relNId = 0; relNId <= grpIt->lEndN - grpIt->lStartN; relNId++) {
+			int lNId = renumberLNId(netId, grpIt->lStartN + relNId);
+			sharedKernelGridPos[netId][3 * lNId] = relNId % grid.numX;
+			sharedKernelGridPos[netId][3 * lNId + 1] = (relNId / grid.numX) % grid.numY;
+			sharedKernelGridPos[netId][3 * lNId + 2] = relNId / (grid.numX * grid.numY);
+		}
+	}
+}
+
+//// make 'C' full connections from grpSrc to grpDest
+//void SNN::connectFull(short int connId) {
+//	int grpSrc = connectConfigMap[connId].grpSrc;
+//	int grpDest = connectConfigMap[connId].grpDest;
+//	bool noDirect = (connectConfigMap[connId].type == CONN_FULL_NO_DIRECT);
+//
+//	// rebuild struct for easier handling
+//	RadiusRF radius(connectConfigMap[connId].radX, connectConfigMap[connId].radY, connectConfigMap[connId].radZ);
+//
+//	for(int i = groupConfigMap[grpSrc].StartN; i <= groupConfigMap[grpSrc].EndN; i++)  {
+//		Point3D loc_i = getNeuronLocation3D(i); // 3D coordinates of i
+//		for(int j = groupConfigMap[grpDest].StartN; j <= groupConfigMap[grpDest].EndN; j++) { // j: the temp neuron id
+//			// if flag is set, don't connect direct connections
+//			if((noDirect) && (i - groupConfigMap[grpSrc].StartN) == (j - groupConfigMap[grpDest].StartN))
+//				continue;
+//
+//			// check whether pre-neuron location is in RF of post-neuron
+//			Point3D loc_j = getNeuronLocation3D(j); // 3D coordinates of j
+//			if (!isPoint3DinRF(radius, loc_i, loc_j))
+//				continue;
+//
+//			//uint8_t dVal = info->minDelay + (int)(0.5 + (drand48() * (info->maxDelay - info->minDelay)));
+//			uint8_t dVal = connectConfigMap[connId].minDelay + rand() % (connectConfigMap[connId].maxDelay - connectConfigMap[connId].minDelay + 1);
+//			assert((dVal >= connectConfigMap[connId].minDelay) && (dVal <= connectConfigMap[connId].maxDelay));
+//			float synWt = generateWeight(connectConfigMap[connId].connProp, connectConfigMap[connId].initWt, connectConfigMap[connId].maxWt, i, grpSrc);
+//
+//			setConnection(grpSrc, grpDest, i, j, synWt, connectConfigMap[connId].maxWt, dVal, connectConfigMap[connId].connProp, connId);// info->connId);
+//			connectConfigMap[connId].numberOfConnections++;
+//		}
+//	}
+//
+//	groupInfo[grpSrc].sumPostConn += connectConfigMap[connId].numberOfConnections;
+//	groupInfo[grpDest].sumPreConn += connectConfigMap[connId].numberOfConnections;
+//}
+
+//void SNN::connectGaussian(short int connId) {
+//	// rebuild struct for easier handling
+//	// adjust with sqrt(2) in order to make the Gaussian kernel depend on 2*sigma^2
+//	RadiusRF radius(connectConfigMap[connId].radX, connectConfigMap[connId].radY, connectConfigMap[connId].radZ);
+//
+//	// in case pre and post have different Grid3D sizes: scale pre to the grid size of post
+//	int grpSrc = connectConfigMap[connId].grpSrc;
+//	int grpDest = connectConfigMap[connId].grpDest;
+//	Grid3D grid_i = getGroupGrid3D(grpSrc);
+//	Grid3D grid_j = getGroupGrid3D(grpDest);
+//	Point3D scalePre = Point3D(grid_j.numX, grid_j.numY, grid_j.numZ) / Point3D(grid_i.numX, grid_i.numY, grid_i.numZ);
+//
+//	for(int i = groupConfigMap[grpSrc].StartN; i <= groupConfigMap[grpSrc].EndN; i++)  {
+//		Point3D loc_i = getNeuronLocation3D(i)*scalePre; // i: adjusted 3D coordinates
+//
+//		for(int j = groupConfigMap[grpDest].StartN; j <= groupConfigMap[grpDest].EndN; j++) { // j: the temp neuron id
+//			// check whether pre-neuron location is in RF of post-neuron
 //			Point3D loc_j = getNeuronLocation3D(j); // 3D coordinates of j
 //
 //			// make sure point is in RF
@@ -4157,7 +5623,6 @@ void SNN::deleteRuntimeData() {
 
 	#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
 		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
 		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
 		int threadCount = 0;
 	#endif
@@ -4172,9 +5637,7 @@ void SNN::deleteRuntimeData() {
 				#else // Linux or MAC
 					pthread_attr_t attr;
 					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+					setThreadAffinity_CPU(netId, &attr);
 
 					argsThreadRoutine[threadCount].snn_pointer = this;
 					argsThreadRoutine[threadCount].netId = netId;
@@ -4210,9 +5673,26 @@ void SNN::deleteObjects() {
 
 	printSimSummary();
 
+	// a checkpoint might still be written in the background
+	joinCheckpointWriter();
+
+	if (hwCounters_ != NULL)
+		delete hwCounters_;
+	hwCounters_ = NULL;
+
+	// closes the trace file
+	if (tracer_ != NULL)
+		delete tracer_;
+	tracer_ = NULL;
+
 	// deallocate objects
 	resetMonitors(true);
 	resetConnectionConfigs(true);
+
+	// all spike files (and sampled neuron state files) have been closed by their monitors
+	if (spikeFileWriter != NULL)
+		delete spikeFileWriter;
+	spikeFileWriter = NULL;
 	
 	// delete manager runtime data
 	deleteManagerRuntimeData();
@@ -4381,6 +5861,10 @@ void SNN::fetchNeuronSpikeCount (int gGrpId) {
 			fetchNeuronSpikeCount(gGrpId);
 		}
 	} else {
+		// spike counts are fetched on query (e.g., printStatus), ALL recurses into this branch
+		ProfilerScope profScope(profPhaseTimeNs_[PROFILER_SPIKE_COUNT], &profPhaseCalls_[PROFILER_SPIKE_COUNT]);
+		TraceScope traceScope(tracer_, 0, PROFILER_SPIKE_COUNT);
+
 		int netId = groupConfigMDMap[gGrpId].netId;
 		int lGrpId = groupConfigMDMap[gGrpId].lGrpId;
 		int LtoGOffset = groupConfigMDMap[gGrpId].LtoGOffset;
@@ -4576,6 +6060,35 @@ void SNN::fetchNeuronStateBuffer(int netId, int lGrpId) {
 		copyNeuronStateBuffer(netId, lGrpId, &managerRuntimeData, &runtimeData[netId], false);
 }
 
+/*!
+ * \brief fills the slot map of the sampling NeuronMonitors of a local network
+ *
+ * slots[neuronMonitorStreamSlotOffset + i] is the index of neuron neuronMonitorStreamFirstN + i of a group within the
+ * samples of its NeuronMonitor, or -1 if the neuron is not sampled. The map is static, so the backends only need to
+ * fill it once when nStreamBuffer is allocated.
+ */
+void SNN::fillNeuronStreamSlots(int netId, int* slots) {
+	for (int i = 0; i < networkConfigs[netId].numNeuronMonStreamSlots; i++)
+		slots[i] = -1;
+
+	for (std::list<GroupConfigMD>::iterator grpIt = groupPartitionLists[netId].begin(); grpIt != groupPartitionLists[netId].end(); grpIt++) {
+		GroupConfigRT& grpConfig = groupConfigs[netId][grpIt->lGrpId];
+		if (grpIt->netId != netId || grpConfig.neuronMonitorStreamOffset < 0)
+			continue;
+
+		const std::vector<int>& neurIds = neuronMonCoreList[grpIt->neuronMonitorId]->getSampledNeurIds();
+		for (int i = 0; i < neurIds.size(); i++)
+			slots[grpConfig.neuronMonitorStreamSlotOffset + neurIds[i] - grpConfig.neuronMonitorStreamFirstN] = i;
+	}
+}
+
+void SNN::fetchNeuronStreamBuffer(int netId, int lGrpId) {
+	if (netId < CPU_RUNTIME_BASE)
+		copyNeuronStreamBuffer(netId, lGrpId, &managerRuntimeData, &runtimeData[netId], cudaMemcpyDeviceToHost, false);
+	else
+		copyNeuronStreamBuffer(netId, lGrpId, &managerRuntimeData, &runtimeData[netId], false);
+}
+
 void SNN::fetchExtFiringTable(int netId) {
 	assert(netId < MAX_NET_PER_SNN);
 	
@@ -4641,6 +6154,10 @@ void SNN::convertExtSpikesD1(int netId, int startIdx, int endIdx, int GtoLOffset
 }
 
 void SNN::routeSpikes() {
+	ProfilerScope profScope(profPhaseTimeNs_[PROFILER_ROUTE_SPIKES], &profPhaseCalls_[PROFILER_ROUTE_SPIKES],
+		hwCounters_, profPhaseHwCounts_[PROFILER_ROUTE_SPIKES]);
+	TraceScope traceScope(tracer_, 0, PROFILER_ROUTE_SPIKES);
+
 	int firingTableIdxD2, firingTableIdxD1;
 	int GtoLOffset;
 
@@ -4658,7 +6175,6 @@ void SNN::routeSpikes() {
 
 		#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
 			pthread_t threads[(2 * networkConfigs[srcNetId].numGroups) + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-			cpu_set_t cpus;	
 			ThreadStruct argsThreadRoutine[(2 * networkConfigs[srcNetId].numGroups) + 1]; // same as above, +1 array size
 			int threadCount = 0;
 		#endif
@@ -4679,6 +6195,7 @@ void SNN::routeSpikes() {
 					transferSpikes(runtimeData[destNetId].firingTableD2 + firingTableIdxD2, destNetId,
 						managerRuntimeData.extFiringTableD2[lGrpId], srcNetId,
 						sizeof(int) * managerRuntimeData.extFiringTableEndIdxD2[lGrpId]);
+					eventCounters_[destNetId].counts.extSpikesRouted += managerRuntimeData.extFiringTableEndIdxD2[lGrpId];
 
 					if (destNetId < CPU_RUNTIME_BASE){
 						convertExtSpikesD2_GPU(destNetId, firingTableIdxD2,
@@ -4693,9 +6210,7 @@ void SNN::routeSpikes() {
 							#else // Linux or MAC
 								pthread_attr_t attr;
 								pthread_attr_init(&attr);
-								CPU_ZERO(&cpus);
-								CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-								pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+								setThreadAffinity_CPU(destNetId, &attr);
 
 								argsThreadRoutine[threadCount].snn_pointer = this;
 								argsThreadRoutine[threadCount].netId = destNetId;
@@ -4729,6 +6244,7 @@ void SNN::routeSpikes() {
 					transferSpikes(runtimeData[destNetId].firingTableD1 + firingTableIdxD1, destNetId,
 						managerRuntimeData.extFiringTableD1[lGrpId], srcNetId,
 						sizeof(int) * managerRuntimeData.extFiringTableEndIdxD1[lGrpId]);
+					eventCounters_[destNetId].counts.extSpikesRouted += managerRuntimeData.extFiringTableEndIdxD1[lGrpId];
 					if (destNetId < CPU_RUNTIME_BASE){
 						convertExtSpikesD1_GPU(destNetId, firingTableIdxD1,
 							firingTableIdxD1 + managerRuntimeData.extFiringTableEndIdxD1[lGrpId],
@@ -4742,9 +6258,7 @@ void SNN::routeSpikes() {
 							#else // Linux or MAC
 								pthread_attr_t attr;
 								pthread_attr_init(&attr);
-								CPU_ZERO(&cpus);
-								CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-								pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+								setThreadAffinity_CPU(destNetId, &attr);
 
 								argsThreadRoutine[threadCount].snn_pointer = this;
 								argsThreadRoutine[threadCount].netId = destNetId;
@@ -5014,6 +6528,7 @@ double SNN::getRFDist3D(const RadiusRF& radius, const Point3D& pre, const Point3
 }
 
 void SNN::partitionSNN() {
+	SetupStageScope stageScope(setupReport_, SETUP_PARTITION);
 	int numAssignedNeurons[MAX_NET_PER_SNN] = {0};
 
 	// get number of available GPU card(s) in the present machine
@@ -5158,7 +6673,20 @@ void SNN::partitionSNN() {
 	// generation connections among groups according to group and connect configs
 	// update ConnectConfig::numberOfConnections
 	// update GroupConfig::numPostSynapses, GroupConfig::numPreSynapses
-	connectNetwork();
+	// (restored from the network image instead, if there is a matching one)
+	// (synapses saved with saveSimulation take precedence over both)
+	if (loadSimFID != NULL) {
+		loadSimulation_internal();
+		connectNetwork();
+	} else if (!loadNetworkImage()) {
+		connectNetwork();
+	}
+
+	// the loaded synapses have been moved to connectionLists[]
+	loadedSynPreIds.clear(); loadedSynPostIds.clear();
+	loadedSynWt.clear(); loadedSynMaxWt.clear();
+	loadedSynDelay.clear(); loadedSynPlastic.clear();
+	loadedSynRange.clear();
 
 	collectGlobalNetworkConfigP();
 
@@ -5187,235 +6715,685 @@ void SNN::partitionSNN() {
 	snnState = PARTITIONED_SNN;
 }
 
-int SNN::loadSimulation_internal(bool onlyPlastic) {
-	//// TSC: so that we can restore the file position later...
-	//// MB: not sure why though...
-	//long file_position = ftell(loadSimFID);
-	//
-	//int tmpInt;
-	//float tmpFloat;
+void SNN::loadSimulation_internal() {
+	int tmpInt;
+	float tmpFloat;
+	bool readErr = false; // keep track of reading errors
 
-	//bool readErr = false; // keep track of reading errors
-	//size_t result;
+	// ------- read header ----------------
 
+	fseek(loadSimFID, 0, SEEK_SET);
 
-	//// ------- read header ----------------
+	// read file signature
+	readErr |= fread(&tmpInt, sizeof(int), 1, loadSimFID) != 1;
+	if (tmpInt != 294338571) {
+		KERNEL_ERROR("loadSimulation: Unknown file signature. This does not seem to be a "
+			"simulation file created with CARLsim::saveSimulation.");
+		exitSimulation(-1);
+	}
 
-	//fseek(loadSimFID, 0, SEEK_SET);
+	// read file version number
+	readErr |= fread(&tmpFloat, sizeof(float), 1, loadSimFID) != 1;
+	if (tmpFloat < 0.25f || tmpFloat > 0.35f) {
+		KERNEL_ERROR("loadSimulation: Unsupported version number (%f)", tmpFloat);
+		exitSimulation(-1);
+	}
 
-	//// read file signature
-	//result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (tmpInt != 294338571) {
-	//	KERNEL_ERROR("loadSimulation: Unknown file signature. This does not seem to be a "
-	//		"simulation file created with CARLsim::saveSimulation.");
-	//	exitSimulation(-1);
-	//}
+	// read simulation time and execution time
+	readErr |= fread(&tmpFloat, sizeof(float), 1, loadSimFID) != 1;
+	readErr |= fread(&tmpFloat, sizeof(float), 1, loadSimFID) != 1;
 
-	//// read file version number
-	//result = fread(&tmpFloat, sizeof(float), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (tmpFloat > 0.2f) {
-	//	KERNEL_ERROR("loadSimulation: Unsupported version number (%f)",tmpFloat);
-	//	exitSimulation(-1);
-	//}
+	// read number of neurons
+	readErr |= fread(&tmpInt, sizeof(int), 1, loadSimFID) != 1;
+	if (tmpInt != glbNetworkConfig.numN) {
+		KERNEL_ERROR("loadSimulation: Number of neurons in file (%d) and simulation (%d) don't match.",
+			tmpInt, glbNetworkConfig.numN);
+		exitSimulation(-1);
+	}
 
-	//// read simulation time
-	//result = fread(&tmpFloat, sizeof(float), 1, loadSimFID);
-	//readErr |= (result!=1);
-
-	//// read execution time
-	//result = fread(&tmpFloat, sizeof(float), 1, loadSimFID);
-	//readErr |= (result!=1);
-
-	//// read number of neurons
-	//result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (tmpInt != numN) {
-	//	KERNEL_ERROR("loadSimulation: Number of neurons in file (%d) and simulation (%d) don't match.",
-	//		tmpInt, numN);
-	//	exitSimulation(-1);
-	//}
+	// read number of pre- and post-synapses (informative only, the network may be partitioned differently)
+	readErr |= fread(&tmpInt, sizeof(int), 1, loadSimFID) != 1;
+	readErr |= fread(&tmpInt, sizeof(int), 1, loadSimFID) != 1;
 
-	//// read number of pre-synapses
-	//result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (numPreSynNet != tmpInt) {
-	//	KERNEL_ERROR("loadSimulation: numPreSynNet in file (%d) and simulation (%d) don't match.",
-	//		tmpInt, numPreSynNet);
-	//	exitSimulation(-1);
-	//}
+	// read number of groups
+	readErr |= fread(&tmpInt, sizeof(int), 1, loadSimFID) != 1;
+	if (tmpInt != numGroups) {
+		KERNEL_ERROR("loadSimulation: Number of groups in file (%d) and simulation (%d) don't match.",
+			tmpInt, numGroups);
+		exitSimulation(-1);
+	}
 
-	//// read number of post-synapses
-	//result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (numPostSynNet != tmpInt) {
-	//	KERNEL_ERROR("loadSimulation: numPostSynNet in file (%d) and simulation (%d) don't match.",
-	//		tmpInt, numPostSynNet);
-	//	exitSimulation(-1);
-	//}
+	// throw reading error instead of proceeding
+	if (readErr) {
+		KERNEL_ERROR("loadSimulation: Error while reading file header");
+		exitSimulation(-1);
+	}
 
-	//// read number of groups
-	//result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (tmpInt != numGroups) {
-	//	KERNEL_ERROR("loadSimulation: Number of groups in file (%d) and simulation (%d) don't match.",
-	//		tmpInt, numGroups);
-	//	exitSimulation(-1);
-	//}
+	// ------- read group information ----------------
 
-	//// throw reading error instead of proceeding
-	//if (readErr) {
-	//	fprintf(stderr,"loadSimulation: Error while reading file header");
-	//	exitSimulation(-1);
-	//}
+	for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+		int startN, endN, grid[3];
+		char name[100];
+		readErr |= fread(&startN, sizeof(int), 1, loadSimFID) != 1;
+		readErr |= fread(&endN, sizeof(int), 1, loadSimFID) != 1;
+		readErr |= fread(grid, sizeof(int), 3, loadSimFID) != 3;
+		readErr |= fread(name, sizeof(char), 100, loadSimFID) != 100;
+		name[99] = '\0';
+
+		if (startN != groupConfigMDMap[gGrpId].gStartN || endN != groupConfigMDMap[gGrpId].gEndN) {
+			KERNEL_ERROR("loadSimulation: Neuron IDs [%d,%d] in file and [%d,%d] in simulation for group %d don't match.",
+				startN, endN, groupConfigMDMap[gGrpId].gStartN, groupConfigMDMap[gGrpId].gEndN, gGrpId);
+			exitSimulation(-1);
+		}
 
+		if (groupConfigMap[gGrpId].grpName.compare(0, 99, name) != 0) {
+			KERNEL_ERROR("loadSimulation: Group names in file (%s) and simulation (%s) don't match.", name,
+				groupConfigMap[gGrpId].grpName.c_str());
+			exitSimulation(-1);
+		}
+	}
 
-	//// ------- read group information ----------------
+	if (readErr) {
+		KERNEL_ERROR("loadSimulation: Error while reading group info");
+		exitSimulation(-1);
+	}
 
-	//for (int g=0; g<numGroups; g++) {
-	//	// read StartN
-	//	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-	//	if (tmpInt != groupConfigs[0][g].StartN) {
-	//		KERNEL_ERROR("loadSimulation: StartN in file (%d) and grpInfo (%d) for group %d don't match.",
-	//			tmpInt, groupConfigs[0][g].StartN, g);
-	//		exitSimulation(-1);
-	//	}
+	// ------- read synapse information ----------------
 
-	//	// read EndN
-	//	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-	//	if (tmpInt != groupConfigs[0][g].EndN) {
-	//		KERNEL_ERROR("loadSimulation: EndN in file (%d) and grpInfo (%d) for group %d don't match.",
-	//			tmpInt, groupConfigs[0][g].EndN, g);
-	//		exitSimulation(-1);
-	//	}
+	// files saved without synapse info end here (or contain zero partitions)
+	int numPartitions = 0;
+	if (fread(&numPartitions, sizeof(int), 1, loadSimFID) != 1 || numPartitions == 0) {
+		KERNEL_WARN("loadSimulation: File does not contain synapse info, the connectivity will be generated");
+		return;
+	}
 
-	//	// read SizeX
-	//	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-
-	//	// read SizeY
-	//	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-
-	//	// read SizeZ
-	//	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-
-	//	// read group name
-	//	char name[100];
-	//	result = fread(name, sizeof(char), 100, loadSimFID);
-	//	readErr |= (result!=100);
-	//	if (strcmp(name,groupInfo[g].Name.c_str()) != 0) {
-	//		KERNEL_ERROR("loadSimulation: Group names in file (%s) and grpInfo (%s) don't match.", name,
-	//			groupInfo[g].Name.c_str());
-	//		exitSimulation(-1);
-	//	}
-	//}
+	for (int p = 0; p < numPartitions; p++) {
+		int netId, numSyn, numConns, numKernelWt;
+		readErr |= fread(&netId, sizeof(int), 1, loadSimFID) != 1;
+		readErr |= fread(&numSyn, sizeof(int), 1, loadSimFID) != 1;
+		readErr |= fread(&numConns, sizeof(int), 1, loadSimFID) != 1;
+		if (readErr || netId < 0 || netId >= MAX_NET_PER_SNN || numSyn < 0 || numConns < 0 || numConns > numConnections) {
+			KERNEL_ERROR("loadSimulation: Error while reading synapse info");
+			exitSimulation(-1);
+		}
 
-	//if (readErr) {
-	//	KERNEL_ERROR("loadSimulation: Error while reading group info");
-	//	exitSimulation(-1);
-	//}
+		std::vector<int> connIds(numConns), connNumSyn(numConns);
+		if (numConns > 0) {
+			readErr |= fread(&connIds[0], sizeof(int), numConns, loadSimFID) != numConns;
+			readErr |= fread(&connNumSyn[0], sizeof(int), numConns, loadSimFID) != numConns;
+		}
 
+		// the synapses of all partitions are appended to the same arrays
+		int first = loadedSynPreIds.size();
+		loadedSynPreIds.resize(first + numSyn);
+		loadedSynPostIds.resize(first + numSyn);
+		loadedSynWt.resize(first + numSyn);
+		loadedSynMaxWt.resize(first + numSyn);
+		loadedSynDelay.resize(first + numSyn);
+		loadedSynPlastic.resize(first + numSyn);
+		if (numSyn > 0) {
+			readErr |= fread(&loadedSynPreIds[first], sizeof(int), numSyn, loadSimFID) != numSyn;
+			readErr |= fread(&loadedSynPostIds[first], sizeof(int), numSyn, loadSimFID) != numSyn;
+			readErr |= fread(&loadedSynWt[first], sizeof(float), numSyn, loadSimFID) != numSyn;
+			readErr |= fread(&loadedSynMaxWt[first], sizeof(float), numSyn, loadSimFID) != numSyn;
+			readErr |= fread(&loadedSynDelay[first], sizeof(uint8_t), numSyn, loadSimFID) != numSyn;
+			readErr |= fread(&loadedSynPlastic[first], sizeof(uint8_t), numSyn, loadSimFID) != numSyn;
+		}
 
-	//// ------- read synapse information ----------------
-
-	//for (int i = 0; i < numN; i++) {
-	//	int nrSynapses = 0;
-
-	//	// read number of synapses
-	//	result = fread(&nrSynapses, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-
-	//	for (int j=0; j<nrSynapses; j++) {
-	//		int nIDpre;
-	//		int nIDpost;
-	//		float weight, maxWeight;
-	//		uint8_t delay;
-	//		uint8_t plastic;
-	//		short int connId;
-
-	//		// read nIDpre
-	//		result = fread(&nIDpre, sizeof(int), 1, loadSimFID);
-	//		readErr |= (result!=1);
-	//		if (nIDpre != i) {
-	//			KERNEL_ERROR("loadSimulation: nIDpre in file (%u) and simulation (%u) don't match.", nIDpre, i);
-	//			exitSimulation(-1);
-	//		}
-
-	//		// read nIDpost
-	//		result = fread(&nIDpost, sizeof(int), 1, loadSimFID);
-	//		readErr |= (result!=1);
-	//		if (nIDpost >= numN) {
-	//			KERNEL_ERROR("loadSimulation: nIDpre in file (%u) is larger than in simulation (%u).", nIDpost, numN);
-	//			exitSimulation(-1);
-	//		}
-
-	//		// read weight
-	//		result = fread(&weight, sizeof(float), 1, loadSimFID);
-	//		readErr |= (result!=1);
-
-	//		short int gIDpre = managerRuntimeData.grpIds[nIDpre];
-	//		if (IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type) && (weight>0)
-	//				|| !IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type) && (weight<0)) {
-	//			KERNEL_ERROR("loadSimulation: Sign of weight value (%s) does not match neuron type (%s)",
-	//				((weight>=0.0f)?"plus":"minus"), 
-	//				(IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type)?"inhibitory":"excitatory"));
-	//			exitSimulation(-1);
-	//		}
-
-	//		// read max weight
-	//		result = fread(&maxWeight, sizeof(float), 1, loadSimFID);
-	//		readErr |= (result!=1);
-	//		if (IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type) && (maxWeight>=0)
-	//				|| !IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type) && (maxWeight<=0)) {
-	//			KERNEL_ERROR("loadSimulation: Sign of maxWeight value (%s) does not match neuron type (%s)",
-	//				((maxWeight>=0.0f)?"plus":"minus"), 
-	//				(IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type)?"inhibitory":"excitatory"));
-	//			exitSimulation(-1);
-	//		}
-
-	//		// read delay
-	//		result = fread(&delay, sizeof(uint8_t), 1, loadSimFID);
-	//		readErr |= (result!=1);
-	//		if (delay > MAX_SYN_DELAY) {
-	//			KERNEL_ERROR("loadSimulation: delay in file (%d) is larger than MAX_SYN_DELAY (%d)",
-	//				(int)delay, (int)MAX_SYN_DELAY);
-	//			exitSimulation(-1);
-	//		}
-
-	//		assert(!isnan(weight));
-	//		// read plastic/fixed
-	//		result = fread(&plastic, sizeof(uint8_t), 1, loadSimFID);
-	//		readErr |= (result!=1);
-
-	//		// read connection ID
-	//		result = fread(&connId, sizeof(short int), 1, loadSimFID);
-	//		readErr |= (result!=1);
-
-	//		if ((plastic && onlyPlastic) || (!plastic && !onlyPlastic)) {
-	//			int gIDpost = managerRuntimeData.grpIds[nIDpost];
-	//			int connProp = SET_FIXED_PLASTIC(plastic?SYN_PLASTIC:SYN_FIXED);
-
-	//			//setConnection(gIDpre, gIDpost, nIDpre, nIDpost, weight, maxWeight, delay, connProp, connId);
-	//			groupInfo[gIDpre].sumPostConn++;
-	//			groupInfo[gIDpost].sumPreConn++;
-
-	//			if (delay > groupConfigs[0][gIDpre].MaxDelay)
-	//				groupConfigs[0][gIDpre].MaxDelay = delay;
-	//		}
-	//	}
-	//}
+		readErr |= fread(&numKernelWt, sizeof(int), 1, loadSimFID) != 1;
+		if (!readErr && numKernelWt > 0) {
+			loadedKernelWt[netId].resize(numKernelWt);
+			readErr |= fread(&loadedKernelWt[netId][0], sizeof(float), numKernelWt, loadSimFID) != numKernelWt;
+		}
+
+		if (readErr) {
+			KERNEL_ERROR("loadSimulation: Error while reading synapse info");
+			exitSimulation(-1);
+		}
 
-	//fseek(loadSimFID,file_position,SEEK_SET);
+		for (int i = 0; i < numConns; i++) {
+			if (connIds[i] < 0 || connIds[i] >= numConnections || loadedSynRange.count(connIds[i]) > 0) {
+				KERNEL_ERROR("loadSimulation: Invalid connection ID (%d) in file", connIds[i]);
+				exitSimulation(-1);
+			}
+			loadedSynRange[connIds[i]] = std::make_pair(first, connNumSyn[i]);
+			first += connNumSyn[i];
+		}
+	}
 
-	return 0;
+	KERNEL_INFO("Loaded %d synapses of %d connections from file", (int)loadedSynPreIds.size(), (int)loadedSynRange.size());
+}
+
+uint64_t SNN::computeNetworkConfigHash() {
+	uint64_t hash = 14695981039346656037ULL;
+
+	int version = NETWORK_IMAGE_VERSION;
+	hashNetworkConfigValue(hash, version);
+	hashNetworkConfigValue(hash, randSeed_);
+	hashNetworkConfigValue(hash, preferredSimMode_);
+	hashNetworkConfigValue(hash, neuronOrdering_);
+	hashNetworkConfigValue(hash, glbNetworkConfig.maxDelay);
+
+	// groups: everything that decides the partitioning, the neuron IDs, and the 3D locations
+	for (std::map<int, GroupConfig>::iterator grpIt = groupConfigMap.begin(); grpIt != groupConfigMap.end(); grpIt++) {
+		hashNetworkConfigValue(hash, grpIt->first);
+		hashNetworkConfigBytes(hash, grpIt->second.grpName.c_str(), grpIt->second.grpName.size());
+		hashNetworkConfigValue(hash, grpIt->second.preferredNetId);
+		hashNetworkConfigValue(hash, grpIt->second.type);
+		hashNetworkConfigValue(hash, grpIt->second.numN);
+		hashNetworkConfigValue(hash, grpIt->second.isSpikeGenerator);
+		const Grid3D& grid = grpIt->second.grid;
+		hashNetworkConfigValue(hash, grid.numX); hashNetworkConfigValue(hash, grid.numY); hashNetworkConfigValue(hash, grid.numZ);
+		hashNetworkConfigValue(hash, grid.distX); hashNetworkConfigValue(hash, grid.distY); hashNetworkConfigValue(hash, grid.distZ);
+		hashNetworkConfigValue(hash, grid.offsetX); hashNetworkConfigValue(hash, grid.offsetY); hashNetworkConfigValue(hash, grid.offsetZ);
+	}
+
+	// connections: everything that decides which synapses exist and their initial weights and delays
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		hashNetworkConfigValue(hash, connIt->second.connId);
+		hashNetworkConfigValue(hash, connIt->second.grpSrc);
+		hashNetworkConfigValue(hash, connIt->second.grpDest);
+		hashNetworkConfigValue(hash, connIt->second.type);
+		hashNetworkConfigValue(hash, connIt->second.connProp);
+		hashNetworkConfigValue(hash, connIt->second.minDelay);
+		hashNetworkConfigValue(hash, connIt->second.maxDelay);
+		hashNetworkConfigValue(hash, connIt->second.kernelOffset);
+		if (connIt->second.type != CONN_USER_DEFINED) { // user-defined connections leave these fields unset
+			hashNetworkConfigValue(hash, connIt->second.initWt);
+			hashNetworkConfigValue(hash, connIt->second.maxWt);
+			hashNetworkConfigValue(hash, connIt->second.connProbability);
+			hashNetworkConfigValue(hash, connIt->second.connRadius.radX);
+			hashNetworkConfigValue(hash, connIt->second.connRadius.radY);
+			hashNetworkConfigValue(hash, connIt->second.connRadius.radZ);
+		}
+	}
+
+	if (!sharedKernelTable.empty())
+		hashNetworkConfigBytes(hash, &sharedKernelTable[0], sizeof(float) * sharedKernelTable.size());
+
+	return hash;
+}
+
+bool SNN::loadNetworkImage() {
+	if (networkImageFileName_.empty())
+		return false;
+
+	FILE* fid = fopen(networkImageFileName_.c_str(), "rb");
+	if (fid == NULL) {
+		KERNEL_INFO("No network image found at %s, it will be written after setup", networkImageFileName_.c_str());
+		return false;
+	}
+
+	int signature = 0, version = 0;
+	uint64_t hash = 0;
+	bool isValid = fread(&signature, sizeof(int), 1, fid) == 1 && signature == NETWORK_IMAGE_SIGNATURE
+		&& fread(&version, sizeof(int), 1, fid) == 1 && version == NETWORK_IMAGE_VERSION
+		&& fread(&hash, sizeof(uint64_t), 1, fid) == 1 && hash == computeNetworkConfigHash();
+	if (!isValid) {
+		KERNEL_INFO("Network image %s does not match the network configuration, it will be rewritten after setup",
+			networkImageFileName_.c_str());
+		fclose(fid);
+		return false;
+	}
+
+	fseek(fid, 0, SEEK_END);
+	networkImageSize = (size_t)ftell(fid);
+#if defined(WIN32) || defined(WIN64)
+	networkImage = new char[networkImageSize];
+	rewind(fid);
+	if (fread(networkImage, 1, networkImageSize, fid) != networkImageSize) {
+		KERNEL_ERROR("Could not read network image %s", networkImageFileName_.c_str());
+		exitSimulation(-1);
+	}
+#else
+	void* mapping = mmap(NULL, networkImageSize, PROT_READ, MAP_PRIVATE, fileno(fid), 0);
+	if (mapping == MAP_FAILED) {
+		KERNEL_WARN("Could not map network image %s, the network will be rebuilt", networkImageFileName_.c_str());
+		fclose(fid);
+		return false;
+	}
+	madvise(mapping, networkImageSize, MADV_WILLNEED);
+	networkImage = (char*)mapping;
+#endif
+	fclose(fid); // the mapping stays valid
+
+	const char* cursor = networkImage + 2 * sizeof(int) + sizeof(uint64_t);
+	const char* end = networkImage + networkImageSize;
+
+	unsigned short randState[3];
+	bool isComplete = readNetworkImageArray(cursor, end, randState, 3);
+
+	// partition section: restore what connectNetwork would have counted
+	for (int netId = 0; netId < MAX_NET_PER_SNN && isComplete; netId++) {
+		if (groupPartitionLists[netId].empty())
+			continue;
+
+		int storedNetId, numGrps, numConns;
+		isComplete = readNetworkImageArray(cursor, end, &storedNetId, 1) && storedNetId == netId
+			&& readNetworkImageArray(cursor, end, &numGrps, 1) && numGrps == groupPartitionLists[netId].size();
+		for (std::list<GroupConfigMD>::iterator grpIt = groupPartitionLists[netId].begin(); grpIt != groupPartitionLists[netId].end() && isComplete; grpIt++) {
+			int gGrpId;
+			isComplete = readNetworkImageArray(cursor, end, &gGrpId, 1) && gGrpId == grpIt->gGrpId
+				&& readNetworkImageArray(cursor, end, &grpIt->numPreSynapses, 1)
+				&& readNetworkImageArray(cursor, end, &grpIt->numPostSynapses, 1);
+		}
+
+		isComplete = isComplete && readNetworkImageArray(cursor, end, &numConns, 1)
+			&& numConns == localConnectLists[netId].size() + externalConnectLists[netId].size();
+		for (int external = 0; external < 2 && isComplete; external++) {
+			std::list<ConnectConfig>& connectList = external ? externalConnectLists[netId] : localConnectLists[netId];
+			for (std::list<ConnectConfig>::iterator connIt = connectList.begin(); connIt != connectList.end() && isComplete; connIt++) {
+				short int connId;
+				isComplete = readNetworkImageArray(cursor, end, &connId, 1) && connId == connIt->connId
+					&& readNetworkImageArray(cursor, end, &connIt->numberOfConnections, 1);
+			}
+		}
+	}
+
+	// connectivity sections: only locate them here, they are copied by generateConnectionRuntime
+	for (int netId = 0; netId < MAX_NET_PER_SNN && isComplete; netId++) {
+		if (groupPartitionLists[netId].empty())
+			continue;
+
+		NetworkImageNetHeader header;
+		networkImageNetOffset[netId] = cursor - networkImage;
+		isComplete = readNetworkImageArray(cursor, end, &header, 1) && header.netId == netId;
+		if (isComplete) {
+			size_t numN = header.numNAssigned;
+			size_t bytes = (3 * sizeof(unsigned short) + 2 * sizeof(unsigned int)) * numN
+				+ sizeof(DelayInfo) * numN * (header.maxDelay + 1)
+				+ sizeof(SynInfo) * header.numPostSynNet
+				+ (sizeof(SynInfo) + 2 * sizeof(float) + sizeof(short int)) * header.numPreSynNet;
+			isComplete = (size_t)(end - cursor) >= bytes;
+			cursor += isComplete ? bytes : 0;
+		}
+	}
+
+	if (!isComplete) {
+		KERNEL_ERROR("Network image %s is corrupt, please delete it", networkImageFileName_.c_str());
+		exitSimulation(-1);
+	}
+
+	setRandState(randState);
+
+	KERNEL_INFO("Loaded the network connectivity from network image %s (%lu bytes)", networkImageFileName_.c_str(),
+		(unsigned long)networkImageSize);
+
+	return true;
+}
+
+void SNN::loadNetworkImageConnections(int netId) {
+	assert(networkImage != NULL);
+	const char* cursor = networkImage + networkImageNetOffset[netId];
+	const char* end = networkImage + networkImageSize;
+
+	NetworkImageNetHeader header;
+	readNetworkImageArray(cursor, end, &header, 1);
+	if (header.numNAssigned != networkConfigs[netId].numNAssigned || header.numPreSynNet != networkConfigs[netId].numPreSynNet
+		|| header.numPostSynNet != networkConfigs[netId].numPostSynNet || header.maxDelay != glbNetworkConfig.maxDelay
+		|| header.numKernelWt != networkConfigs[netId].numKernelWt) {
+		KERNEL_ERROR("Network image %s does not match local network %d, please delete it", networkImageFileName_.c_str(), netId);
+		exitSimulation(-1);
+	}
+
+	// the sections have been bounds-checked by loadNetworkImage
+	int numN = header.numNAssigned;
+	readNetworkImageArray(cursor, end, managerRuntimeData.Npre, numN);
+	readNetworkImageArray(cursor, end, managerRuntimeData.Npre_plastic, numN);
+	readNetworkImageArray(cursor, end, managerRuntimeData.Npost, numN);
+	readNetworkImageArray(cursor, end, managerRuntimeData.cumulativePre, numN);
+	readNetworkImageArray(cursor, end, managerRuntimeData.cumulativePost, numN);
+	readNetworkImageArray(cursor, end, managerRuntimeData.postDelayInfo, numN * (header.maxDelay + 1));
+	readNetworkImageArray(cursor, end, managerRuntimeData.postSynapticIds, header.numPostSynNet);
+	readNetworkImageArray(cursor, end, managerRuntimeData.preSynapticIds, header.numPreSynNet);
+	readNetworkImageArray(cursor, end, managerRuntimeData.wt, header.numPreSynNet);
+	readNetworkImageArray(cursor, end, managerRuntimeData.maxSynWt, header.numPreSynNet);
+	readNetworkImageArray(cursor, end, managerRuntimeData.connIdsPreIdx, header.numPreSynNet);
+
+	// if network has any plastic synapses at all, this will be set to true
+	for (int lNId = 0; lNId < numN; lNId++) {
+		if (managerRuntimeData.Npre_plastic[lNId] > 0) {
+			sim_with_fixedwts = false;
+			break;
+		}
+	}
+}
+
+void SNN::writeNetworkImageHeader() {
+	std::string tmpFileName = networkImageFileName_ + ".tmp";
+	networkImageFid = fopen(tmpFileName.c_str(), "wb");
+	if (networkImageFid == NULL) {
+		KERNEL_WARN("Could not open network image %s for writing, the network will not be cached", tmpFileName.c_str());
+		return;
+	}
+
+	int signature = NETWORK_IMAGE_SIGNATURE;
+	int version = NETWORK_IMAGE_VERSION;
+	uint64_t hash = computeNetworkConfigHash();
+	unsigned short randState[3];
+	getRandState(randState);
+
+	bool isWritten = writeNetworkImageArray(networkImageFid, &signature, 1)
+		&& writeNetworkImageArray(networkImageFid, &version, 1)
+		&& writeNetworkImageArray(networkImageFid, &hash, 1)
+		&& writeNetworkImageArray(networkImageFid, randState, 3);
+
+	// partition section: the synapse counts of groups and connections in each local network
+	for (int netId = 0; netId < MAX_NET_PER_SNN && isWritten; netId++) {
+		if (groupPartitionLists[netId].empty())
+			continue;
+
+		int numGrps = groupPartitionLists[netId].size();
+		isWritten = writeNetworkImageArray(networkImageFid, &netId, 1) && writeNetworkImageArray(networkImageFid, &numGrps, 1);
+		for (std::list<GroupConfigMD>::iterator grpIt = groupPartitionLists[netId].begin(); grpIt != groupPartitionLists[netId].end() && isWritten; grpIt++) {
+			isWritten = writeNetworkImageArray(networkImageFid, &grpIt->gGrpId, 1)
+				&& writeNetworkImageArray(networkImageFid, &grpIt->numPreSynapses, 1)
+				&& writeNetworkImageArray(networkImageFid, &grpIt->numPostSynapses, 1);
+		}
+
+		int numConns = localConnectLists[netId].size() + externalConnectLists[netId].size();
+		isWritten = isWritten && writeNetworkImageArray(networkImageFid, &numConns, 1);
+		for (int external = 0; external < 2 && isWritten; external++) {
+			std::list<ConnectConfig>& connectList = external ? externalConnectLists[netId] : localConnectLists[netId];
+			for (std::list<ConnectConfig>::iterator connIt = connectList.begin(); connIt != connectList.end() && isWritten; connIt++) {
+				isWritten = writeNetworkImageArray(networkImageFid, &connIt->connId, 1)
+					&& writeNetworkImageArray(networkImageFid, &connIt->numberOfConnections, 1);
+			}
+		}
+	}
+
+	if (!isWritten) {
+		KERNEL_ERROR("Could not write network image %s", tmpFileName.c_str());
+		exitSimulation(-1);
+	}
+}
+
+void SNN::writeNetworkImageConnections(int netId) {
+	assert(networkImageFid != NULL);
+
+	NetworkImageNetHeader header;
+	header.netId = netId;
+	header.numNAssigned = networkConfigs[netId].numNAssigned;
+	header.numPreSynNet = networkConfigs[netId].numPreSynNet;
+	header.numPostSynNet = networkConfigs[netId].numPostSynNet;
+	header.maxNumPreSynN = networkConfigs[netId].maxNumPreSynN;
+	header.maxNumPostSynN = networkConfigs[netId].maxNumPostSynN;
+	header.maxDelay = glbNetworkConfig.maxDelay;
+	header.numKernelWt = networkConfigs[netId].numKernelWt;
+
+	int numN = header.numNAssigned;
+	bool isWritten = writeNetworkImageArray(networkImageFid, &header, 1)
+		&& writeNetworkImageArray(networkImageFid, managerRuntimeData.Npre, numN)
+		&& writeNetworkImageArray(networkImageFid, managerRuntimeData.Npre_plastic, numN)
+		&& writeNetworkImageArray(networkImageFid, managerRuntimeData.Npost, numN)
+		&& writeNetworkImageArray(networkImageFid, managerRuntimeData.cumulativePre, numN)
+		&& writeNetworkImageArray(networkImageFid, managerRuntimeData.cumulativePost, numN)
+		&& writeNetworkImageArray(networkImageFid, managerRuntimeData.postDelayInfo, numN * (header.maxDelay + 1))
+		&& writeNetworkImageArray(networkImageFid, managerRuntimeData.postSynapticIds, header.numPostSynNet)
+		&& writeNetworkImageArray(networkImageFid, managerRuntimeData.preSynapticIds, header.numPreSynNet)
+		&& writeNetworkImageArray(networkImageFid, managerRuntimeData.wt, header.numPreSynNet)
+		&& writeNetworkImageArray(networkImageFid, managerRuntimeData.maxSynWt, header.numPreSynNet)
+		&& writeNetworkImageArray(networkImageFid, managerRuntimeData.connIdsPreIdx, header.numPreSynNet);
+
+	if (!isWritten) {
+		KERNEL_ERROR("Could not write network image %s.tmp", networkImageFileName_.c_str());
+		exitSimulation(-1);
+	}
+}
+
+void SNN::closeNetworkImage() {
+	if (networkImageFid != NULL) {
+		// the image only replaces an older one once it is complete
+		std::string tmpFileName = networkImageFileName_ + ".tmp";
+		fclose(networkImageFid);
+		networkImageFid = NULL;
+		remove(networkImageFileName_.c_str());
+		if (rename(tmpFileName.c_str(), networkImageFileName_.c_str()) != 0) {
+			KERNEL_WARN("Could not rename network image %s", tmpFileName.c_str());
+		} else {
+			KERNEL_INFO("Wrote the network connectivity to network image %s", networkImageFileName_.c_str());
+		}
+	}
+
+	if (networkImage != NULL) {
+#if defined(WIN32) || defined(WIN64)
+		delete[] networkImage;
+#else
+		munmap(networkImage, networkImageSize);
+#endif
+		networkImage = NULL;
+		networkImageSize = 0;
+	}
+}
+
+// hashes the runtime connectivity and neuron parameters, which are not part of a checkpoint
+uint64_t SNN::computeStaticStateHash() {
+	if (staticStateHash != 0)
+		return staticStateHash;
+
+	uint64_t hash = 14695981039346656037ULL;
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (groupPartitionLists[netId].empty())
+			continue;
+
+		const NetworkConfigRT& config = networkConfigs[netId];
+		RuntimeData& rtd = runtimeData[netId];
+		hashNetworkConfigValue(hash, netId);
+		hashNetworkConfigBytes(hash, rtd.Npre, sizeof(unsigned short) * config.numNAssigned);
+		hashNetworkConfigBytes(hash, rtd.Npost, sizeof(unsigned short) * config.numNAssigned);
+		hashNetworkConfigBytes(hash, rtd.preSynapticIds, sizeof(SynInfo) * config.numPreSynNet);
+		hashNetworkConfigBytes(hash, rtd.postSynapticIds, sizeof(SynInfo) * config.numPostSynNet);
+		hashNetworkConfigBytes(hash, rtd.postDelayInfo, sizeof(DelayInfo) * config.numNAssigned * (glbNetworkConfig.maxDelay + 1));
+		if (config.numNReg > 0) {
+			hashNetworkConfigBytes(hash, rtd.Izh_a, sizeof(float) * config.numNReg);
+			hashNetworkConfigBytes(hash, rtd.Izh_b, sizeof(float) * config.numNReg);
+			hashNetworkConfigBytes(hash, rtd.Izh_c, sizeof(float) * config.numNReg);
+			hashNetworkConfigBytes(hash, rtd.Izh_d, sizeof(float) * config.numNReg);
+		}
+	}
+
+	staticStateHash = hash;
+	return staticStateHash;
+}
+
+void SNN::takeCheckpointSnapshot(std::vector<char>& buffer) {
+	std::vector<CheckpointArray> arrays[MAX_NET_PER_SNN];
+	CheckpointHeader header;
+	memset(&header, 0, sizeof(CheckpointHeader)); // the padding bytes end up in the file as well
+
+	header.signature = CHECKPOINT_SIGNATURE;
+	header.version = CHECKPOINT_VERSION;
+	header.configHash = computeNetworkConfigHash();
+	header.staticStateHash = computeStaticStateHash();
+	header.simTime = simTime;
+	header.simTimeMs = simTimeMs;
+	header.simTimeSec = simTimeSec;
+	header.simTimeRunStart = simTimeRunStart;
+	header.simTimeRunStop = simTimeRunStop;
+	header.simTimeLastRunSummary = simTimeLastRunSummary;
+	header.wtANDwtChangeUpdateIntervalCnt = wtANDwtChangeUpdateIntervalCnt_;
+	header.stdpScaleFactor = stdpScaleFactor_;
+	getRandState(header.randState);
+	header.numNets = 0;
+
+	size_t size = sizeof(CheckpointHeader);
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (groupPartitionLists[netId].empty())
+			continue;
+
+		collectCheckpointArrays_CPU(netId, arrays[netId]);
+		size += sizeof(CheckpointNetHeader);
+		for (size_t i = 0; i < arrays[netId].size(); i++)
+			size += arrays[netId][i].size;
+		header.numNets++;
+	}
+
+	// the buffer keeps its capacity, so only the first snapshot allocates memory
+	buffer.resize(size);
+	char* cursor = &buffer[0];
+	memcpy(cursor, &header, sizeof(CheckpointHeader));
+	cursor += sizeof(CheckpointHeader);
+
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (groupPartitionLists[netId].empty())
+			continue;
+
+		CheckpointNetHeader netHeader;
+		memset(&netHeader, 0, sizeof(CheckpointNetHeader));
+		netHeader.netId = netId;
+		netHeader.numArrays = arrays[netId].size();
+		unsigned int* counters[CHECKPOINT_NUM_SPIKE_COUNTERS];
+		getCheckpointSpikeCounters(runtimeData[netId], counters);
+		for (int i = 0; i < CHECKPOINT_NUM_SPIKE_COUNTERS; i++)
+			netHeader.spikeCounters[i] = *counters[i];
+		for (size_t i = 0; i < arrays[netId].size(); i++)
+			netHeader.numBytes += arrays[netId][i].size;
+
+		memcpy(cursor, &netHeader, sizeof(CheckpointNetHeader));
+		cursor += sizeof(CheckpointNetHeader);
+		for (size_t i = 0; i < arrays[netId].size(); i++) {
+			memcpy(cursor, arrays[netId][i].data, arrays[netId][i].size);
+			cursor += arrays[netId][i].size;
+		}
+	}
+	assert(cursor == &buffer[0] + size);
+}
+
+void SNN::joinCheckpointWriter() {
+	if (checkpointWriterActive) {
+		pthread_join(checkpointWriter, NULL);
+		checkpointWriterActive = false;
+	}
+}
+
+void SNN::writeCheckpointBuffer() {
+	const std::vector<char>& buffer = checkpointBuffer[checkpointBufferId];
+
+	// an existing checkpoint is only replaced once the new one is complete
+	std::string tmpFileName = checkpointWriteFileName + ".tmp";
+	FILE* fid = fopen(tmpFileName.c_str(), "wb");
+	bool writeErr = fid == NULL;
+	if (!writeErr) {
+		writeErr = fwrite(&buffer[0], 1, buffer.size(), fid) != buffer.size();
+		writeErr = fclose(fid) != 0 || writeErr;
+	}
+	if (!writeErr) {
+#if defined(WIN32) || defined(WIN64)
+		remove(checkpointWriteFileName.c_str()); // rename does not replace existing files on Windows
+#endif
+		writeErr = rename(tmpFileName.c_str(), checkpointWriteFileName.c_str()) != 0;
+	}
+
+	if (writeErr) {
+		KERNEL_WARN("Could not write checkpoint %s", checkpointWriteFileName.c_str());
+	} else {
+		KERNEL_DEBUG("Wrote checkpoint %s (%.2f MB)", checkpointWriteFileName.c_str(),
+			(float)buffer.size() / (1024 * 1024));
+	}
+}
+
+void* SNN::helperWriteCheckpoint(void* arg) {
+	((SNN*)arg)->writeCheckpointBuffer();
+	return NULL;
+}
+
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+// reads the cores of every NUMA node from sysfs, e.g. "0-3,8-11" for node 0
+static std::vector<std::vector<int> > getNUMANodeCores() {
+	std::vector<std::vector<int> > nodes;
+	for (int node = 0; ; node++) {
+		char path[64];
+		snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+		FILE* fp = fopen(path, "r");
+		if (fp == NULL)
+			break;
+
+		std::vector<int> cores;
+		int first, last;
+		while (fscanf(fp, "%d", &first) == 1) {
+			last = first;
+			int c = fgetc(fp);
+			if (c == '-') {
+				if (fscanf(fp, "%d", &last) != 1)
+					break;
+				c = fgetc(fp);
+			}
+			for (int core = first; core <= last; core++)
+				cores.push_back(core);
+			if (c != ',')
+				break;
+		}
+		fclose(fp);
+
+		if (!cores.empty())
+			nodes.push_back(cores);
+	}
+
+	return nodes;
+}
+#endif
+
+void SNN::assignCPUAffinity() {
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++)
+		runtimeCores[netId].clear();
+
+#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux
+	int numCoresOnline = NUM_CPU_CORES;
+	std::vector<std::vector<int> > nodes;
+	if (cpuAffinityPolicy_ == NODE_PER_PARTITION) {
+		nodes = getNUMANodeCores();
+		if (nodes.empty()) {
+			KERNEL_WARN("NUMA topology is not available, all cores are considered to be on a single node");
+			nodes.push_back(std::vector<int>());
+			for (int core = 0; core < numCoresOnline; core++)
+				nodes[0].push_back(core);
+		}
+	}
+
+	int partitionCount = 0;
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (groupPartitionLists[netId].empty())
+			continue;
+
+		// explicit core list set by the user
+		for (size_t i = 0; i < cpuAffinityUser_[netId].size(); i++) {
+			if (cpuAffinityUser_[netId][i] < numCoresOnline)
+				runtimeCores[netId].push_back(cpuAffinityUser_[netId][i]);
+			else
+				KERNEL_WARN("CPU partition %d: core %d is not online and is ignored", netId - CPU_RUNTIME_BASE,
+					cpuAffinityUser_[netId][i]);
+		}
+
+		if (runtimeCores[netId].empty()) {
+			if (cpuAffinityPolicy_ == NODE_PER_PARTITION)
+				runtimeCores[netId] = nodes[partitionCount % nodes.size()];
+			else
+				runtimeCores[netId].push_back(partitionCount % numCoresOnline);
+		}
+		partitionCount++;
+
+		std::stringstream cores;
+		for (size_t i = 0; i < runtimeCores[netId].size(); i++)
+			cores << (i > 0 ? "," : "") << runtimeCores[netId][i];
+		KERNEL_DEBUG("CPU partition %d runs on core(s) %s (%s)", netId - CPU_RUNTIME_BASE, cores.str().c_str(),
+			cpuAffinityUser_[netId].empty() ? cpuAffinityPolicy_string[cpuAffinityPolicy_] : "user defined");
+	}
+#endif
 }
 
 void SNN::generateRuntimeSNN() {
+	SetupStageScope stageScope(setupReport_, SETUP_GENERATE_RUNTIME);
+
+	// the connectivity lists are at their largest now, they are consumed while the runtime data is generated
+	setupTempBytes = 0;
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++)
+		setupTempBytes += connectionLists[netId].size() * CONNECTION_LIST_NODE_BYTES;
+
+	// 0. cache the connectivity generated by connectNetwork, unless it was loaded from a network image
+	// (or from a saveSimulation file, whose trained weights must not end up in the image)
+	if (!networkImageFileName_.empty() && networkImage == NULL && loadSimFID == NULL)
+		writeNetworkImageHeader();
+
 	// 1. genearte configurations for the simulation
 	// generate (copy) group configs from groupPartitionLists[]
 	generateRuntimeGroupConfigs();
@@ -5437,6 +7415,9 @@ void SNN::generateRuntimeSNN() {
 	// - reset all above
 	allocateManagerRuntimeData();
 
+	// - decide on which cores the worker threads of each CPU runtime run
+	assignCPUAffinity();
+
 	// 3. initialize manager runtime data according to partitions (i.e., local networks)
 	// 4a. allocate appropriate memory space (e.g., main memory (CPU) or device memory (GPU)).
 	// 4b. load (copy) them to appropriate memory space for execution
@@ -5481,10 +7462,15 @@ void SNN::generateRuntimeSNN() {
 				assert(managerRuntimeData.grpIds[lNId] != -1);
 			}
 
+			// - renumber neurons within their groups (optional)
+			generateNeuronOrder(netId);
+
 			// - init mulSynFast, mulSynSlow
 			// - init Npre, Npre_plastic, Npost, cumulativePre, cumulativePost, preSynapticIds, postSynapticIds, postDelayInfo
 			// - init wt, maxSynWt
 			generateConnectionRuntime(netId);
+			if (networkImageFid != NULL)
+				writeNetworkImageConnections(netId);
 
 			generateCompConnectionRuntime(netId);
 
@@ -5501,6 +7487,8 @@ void SNN::generateRuntimeSNN() {
 		}
 	}
 
+	closeNetworkImage();
+
 	// count allocated CPU/GPU runtime
 	numGPUs = 0; numCores = 0;
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
@@ -5718,9 +7706,11 @@ void SNN::deleteManagerRuntimeData() {
 	if (managerRuntimeData.nVBuffer != NULL) delete[] managerRuntimeData.nVBuffer;
 	if (managerRuntimeData.nUBuffer != NULL) delete[] managerRuntimeData.nUBuffer;
 	if (managerRuntimeData.nIBuffer != NULL) delete[] managerRuntimeData.nIBuffer;
+	if (managerRuntimeData.nStreamBuffer != NULL) delete[] managerRuntimeData.nStreamBuffer;
 	managerRuntimeData.voltage=NULL; managerRuntimeData.recovery=NULL; managerRuntimeData.current=NULL; managerRuntimeData.extCurrent=NULL;
 	managerRuntimeData.nextVoltage = NULL; managerRuntimeData.totalCurrent = NULL; managerRuntimeData.curSpike = NULL;
 	managerRuntimeData.nVBuffer = NULL; managerRuntimeData.nUBuffer = NULL; managerRuntimeData.nIBuffer = NULL;
+	managerRuntimeData.nStreamBuffer = NULL;
 
 	if (managerRuntimeData.Izh_a!=NULL) delete[] managerRuntimeData.Izh_a;
 	if (managerRuntimeData.Izh_b!=NULL) delete[] managerRuntimeData.Izh_b;
@@ -5796,6 +7786,12 @@ void SNN::deleteManagerRuntimeData() {
 	if (managerRuntimeData.grpIds!=NULL) delete[] managerRuntimeData.grpIds;
 	managerRuntimeData.grpIds=NULL;
 
+	if (managerRuntimeData.kernelWt!=NULL) delete[] managerRuntimeData.kernelWt;
+	if (managerRuntimeData.kernelWtChange!=NULL) delete[] managerRuntimeData.kernelWtChange;
+	if (managerRuntimeData.kernelMaxWt!=NULL) delete[] managerRuntimeData.kernelMaxWt;
+	managerRuntimeData.kernelWt=NULL;
+	managerRuntimeData.kernelWtChange=NULL; managerRuntimeData.kernelMaxWt=NULL;
+
 	if (managerRuntimeData.timeTableD2 != NULL) delete [] managerRuntimeData.timeTableD2;
 	if (managerRuntimeData.timeTableD1 != NULL) delete [] managerRuntimeData.timeTableD1;
 	managerRuntimeData.timeTableD2 = NULL; managerRuntimeData.timeTableD1 = NULL;
@@ -5817,6 +7813,8 @@ void SNN::deleteManagerRuntimeData() {
 	//if (managerRuntimeData.extFiringTableEndIdxD1 != NULL) CUDA_CHECK_ERRORS(cudaFreeHost(managerRuntimeData.extFiringTableEndIdxD1));
 	//if (managerRuntimeData.extFiringTableEndIdxD2 != NULL) CUDA_CHECK_ERRORS(cudaFreeHost(managerRuntimeData.extFiringTableEndIdxD2));
 	managerRuntimeData.extFiringTableEndIdxD1 = NULL; managerRuntimeData.extFiringTableEndIdxD2 = NULL;
+
+	managerArrayBytes.clear();
 }
 
 /*!
@@ -5874,7 +7872,6 @@ void SNN::resetSpikeCnt(int gGrpId) {
 	if (gGrpId == ALL) {
 		#if !defined(WIN32) && !defined(WIN64) && !defined(__APPLE__) // Linux or MAC
 			pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-			cpu_set_t cpus;	
 			ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
 			int threadCount = 0;
 		#endif
@@ -5889,9 +7886,7 @@ void SNN::resetSpikeCnt(int gGrpId) {
 					#else // Linux or MAC
 						pthread_attr_t attr;
 						pthread_attr_init(&attr);
-						CPU_ZERO(&cpus);
-						CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-						pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+						setThreadAffinity_CPU(netId, &attr);
 
 						argsThreadRoutine[threadCount].snn_pointer = this;
 						argsThreadRoutine[threadCount].netId = netId;
@@ -5994,6 +7989,33 @@ void SNN::fillSpikeGenBits(int netId) {
 	}
 }
 
+void SNN::reduceEventCounters() {
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		eventCountsTotal_[netId] += eventCounters_[netId].counts;
+		eventCountsLastSec_[netId] = eventCounters_[netId].counts;
+		eventCounters_[netId].counts = EventCounts();
+	}
+}
+
+void SNN::dumpTrace() {
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (!groupPartitionLists[netId].empty()) {
+			char name[20];
+			sprintf(name, "CPU %d", netId - CPU_RUNTIME_BASE);
+			tracer_->setThreadName(netId + 1, name);
+		}
+	}
+
+	long long numOverwritten = tracer_->getNumOverwritten();
+	if (!tracer_->dump())
+		KERNEL_WARN("runNetwork: Could not write trace file");
+	if (numOverwritten > traceNumOverwritten_) {
+		KERNEL_WARN("runNetwork: %lld trace events were overwritten, increase maxEventsPerThread or the sample "
+			"interval of setTraceFile", numOverwritten - traceNumOverwritten_);
+		traceNumOverwritten_ = numOverwritten;
+	}
+}
+
 void SNN::startTiming() { prevExecutionTime = cumExecutionTime; }
 void SNN::stopTiming() {
 	executionTime += (cumExecutionTime - prevExecutionTime);
@@ -6041,38 +8063,53 @@ void SNN::stopTesting() {
 }
 
 void SNN::updateConnectionMonitor(short int connId) {
+	ProfilerScope profScope(profPhaseTimeNs_[PROFILER_CONNECTION_MONITOR], &profPhaseCalls_[PROFILER_CONNECTION_MONITOR]);
+	TraceScope traceScope(tracer_, 0, PROFILER_CONNECTION_MONITOR);
+
 	for (int monId=0; monId<numConnectionMonitor; monId++) {
 		if (connId==ALL || connMonCoreList[monId]->getConnectId()==connId) {
 			int timeInterval = connMonCoreList[monId]->getUpdateTimeIntervalSec();
 			if (timeInterval==1 || timeInterval>1 && (getSimTime()%timeInterval)==0) {
 				// this ConnectionMonitor wants periodic recording
-				connMonCoreList[monId]->writeConnectFileSnapshot(simTime,
-					getWeightMatrix2D(connMonCoreList[monId]->getConnectId()));
+				connMonCoreList[monId]->writeConnectFileSnapshot(simTime);
 			}
 		}
 	}
 }
 
-// FIXME: modify this for multi-GPUs
 std::vector< std::vector<float> > SNN::getWeightMatrix2D(short int connId) {
 	assert(connId > ALL); // ALL == -1
-	std::vector< std::vector<float> > wtConnId;
 
 	int grpIdPre = connectConfigMap[connId].grpSrc;
 	int grpIdPost = connectConfigMap[connId].grpDest;
 
-	int netIdPost = groupConfigMDMap[grpIdPost].netId;
-	int lGrpIdPost = groupConfigMDMap[grpIdPost].lGrpId;
+	// init weight matrix with right dimensions, non-existent synapses are NAN
+	std::vector< std::vector<float> > wtConnId(groupConfigMap[grpIdPre].numN,
+		std::vector<float>(groupConfigMap[grpIdPost].numN, NAN));
 
-	// init weight matrix with right dimensions
-	for (int i = 0; i < groupConfigMap[grpIdPre].numN; i++) {
-		std::vector<float> wtSlice;
-		for (int j = 0; j < groupConfigMap[grpIdPost].numN; j++) {
-			wtSlice.push_back(NAN);
-		}
-		wtConnId.push_back(wtSlice);
+	std::vector<int> preIds, postIds;
+	std::vector<float> weights;
+	getWeightsSparse(connId, preIds, postIds, weights);
+	for (int i = 0; i < weights.size(); i++) {
+		wtConnId[preIds[i]][postIds[i]] = weights[i];
 	}
 
+	return wtConnId;
+}
+
+// FIXME: modify this for multi-GPUs
+void SNN::getWeightsSparse(short int connId, std::vector<int>& preIds, std::vector<int>& postIds,
+	std::vector<float>& weights) {
+	assert(connId > ALL); // ALL == -1
+	preIds.clear();
+	postIds.clear();
+	weights.clear();
+
+	int grpIdPost = connectConfigMap[connId].grpDest;
+
+	int netIdPost = groupConfigMDMap[grpIdPost].netId;
+	int lGrpIdPost = groupConfigMDMap[grpIdPost].lGrpId;
+
 	// copy the weights for a given post-group from device
 	// \TODO: check if the weights for this grpIdPost have already been copied
 	// \TODO: even better, but tricky because of ordering, make copyWeightState connection-based
@@ -6093,12 +8130,38 @@ std::vector< std::vector<float> > SNN::getWeightMatrix2D(short int connId) {
 			// find pre-neuron ID and update ConnectionMonitor container
 			int lNIdPre = GET_CONN_NEURON_ID(managerRuntimeData.preSynapticIds[pos_ij]);
 			int lGrpIdPre = GET_CONN_GRP_ID(managerRuntimeData.preSynapticIds[pos_ij]);
-			wtConnId[lNIdPre - groupConfigs[netIdPost][lGrpIdPre].lStartN][lNIdPost - groupConfigs[netIdPost][lGrpIdPost].lStartN] =
-				fabs(managerRuntimeData.wt[pos_ij]);
+			preIds.push_back(restoreLNId(netIdPost, lNIdPre) - groupConfigs[netIdPost][lGrpIdPre].lStartN);
+			postIds.push_back(restoreLNId(netIdPost, lNIdPost) - groupConfigs[netIdPost][lGrpIdPost].lStartN);
+			if (connectConfigMap[connId].type == CONN_SHARED_KERNEL) {
+				// shared kernels only live in CPU partitions, read the weight from the kernel
+				int kIdx = getSharedKernelIdx(netIdPost, connId, lNIdPre, lNIdPost);
+				weights.push_back(fabs(runtimeData[netIdPost].kernelWt[kIdx]));
+			} else {
+				weights.push_back(fabs(managerRuntimeData.wt[pos_ij]));
+			}
 		}
 	}
+}
 
-	return wtConnId;
+std::vector<float> SNN::getSharedKernel(short int connId) {
+	assert(connId > ALL); // ALL == -1
+	std::vector<float> kernel;
+
+	if (connectConfigMap[connId].type != CONN_SHARED_KERNEL) {
+		KERNEL_ERROR("Connection %d is not a shared-kernel connection", connId);
+		exitSimulation(1);
+	}
+
+	int netId = groupConfigMDMap[connectConfigMap[connId].grpDest].netId;
+	int kernelSize = (2 * connectConfigMap[connId].connRadius.radX + 1) * (2 * connectConfigMap[connId].connRadius.radY + 1)
+		* (2 * connectConfigMap[connId].connRadius.radZ + 1);
+
+	// shared kernels only live in CPU partitions, no need to fetch anything
+	assert(runtimeData[netId].memType == CPU_MEM);
+	for (int k = connectConfigMap[connId].kernelOffset; k < connectConfigMap[connId].kernelOffset + kernelSize; k++)
+		kernel.push_back(fabs(runtimeData[netId].kernelWt[k]));
+
+	return kernel;
 }
 
 void SNN::updateGroupMonitor(int gGrpId) {
@@ -6110,6 +8173,10 @@ void SNN::updateGroupMonitor(int gGrpId) {
 		for (int gGrpId = 0; gGrpId < numGroups; gGrpId++)
 			updateGroupMonitor(gGrpId);
 	} else {
+		// ALL recurses into this branch, so only the per-group work is measured
+		ProfilerScope profScope(profPhaseTimeNs_[PROFILER_GROUP_MONITOR], &profPhaseCalls_[PROFILER_GROUP_MONITOR]);
+		TraceScope traceScope(tracer_, 0, PROFILER_GROUP_MONITOR);
+
 		int netId = groupConfigMDMap[gGrpId].netId;
 		int lGrpId = groupConfigMDMap[gGrpId].lGrpId;
 		// update group monitor of a specific group
@@ -6130,6 +8197,17 @@ void SNN::updateGroupMonitor(int gGrpId) {
 		if (getSimTime() - lastUpdate > 1000)
 			KERNEL_ERROR("updateGroupMonitor(grpId=%d) must be called at least once every second", gGrpId);
 
+		// prepare fast access
+		FILE* grpFileId = groupMonCoreList[monitorId]->getGroupFileId();
+		bool writeGroupToFile = grpFileId != NULL;
+		bool writeGroupToArray = grpMonObj->isRecording();
+
+		// nothing to write to
+		if (!writeGroupToFile && !writeGroupToArray) {
+			grpMonObj->setLastUpdated(getSimTime());
+			return;
+		}
+
 		// copy the group status (neuromodulators) to the manager runtime
 		fetchGroupState(netId, lGrpId);
 
@@ -6152,10 +8230,6 @@ void SNN::updateGroupMonitor(int gGrpId) {
 		// save current time as last update time
 		grpMonObj->setLastUpdated(getSimTime());
 
-		// prepare fast access
-		FILE* grpFileId = groupMonCoreList[monitorId]->getGroupFileId();
-		bool writeGroupToFile = grpFileId != NULL;
-		bool writeGroupToArray = grpMonObj->isRecording();
 		float data;
 
 		// Read one peice of data at a time from the buffer and put the data to an appopriate monitor buffer. Later the user
@@ -6168,7 +8242,7 @@ void SNN::updateGroupMonitor(int gGrpId) {
 			int time = currentTimeSec * 1000 + t;
 
 			if (writeGroupToFile) {
-				// TODO: write to group status file
+				grpMonObj->pushFileData(time, data);
 			}
 
 			if (writeGroupToArray) {
@@ -6176,8 +8250,9 @@ void SNN::updateGroupMonitor(int gGrpId) {
 			}
 		}
 
-		if (grpFileId!=NULL) // flush group status file
-			fflush(grpFileId);
+		// the chunk is written by the I/O thread of the spike file writer
+		if (writeGroupToFile)
+			grpMonObj->writeFileChunk();
 	}
 }
 
@@ -6258,12 +8333,12 @@ void SNN::generateUserDefinedSpikes() {
  * \note SpikeTables include firingTableD1(D2) and timeTableD1(D2)
  */
 void SNN::allocateManagerSpikeTables() {
-	managerRuntimeData.firingTableD2 = new int[managerRTDSize.maxMaxSpikeD2];
-	managerRuntimeData.firingTableD1 = new int[managerRTDSize.maxMaxSpikeD1];
-	managerRuntimeData.extFiringTableEndIdxD2 = new int[managerRTDSize.maxNumGroups];
-	managerRuntimeData.extFiringTableEndIdxD1 = new int[managerRTDSize.maxNumGroups];
-	managerRuntimeData.extFiringTableD2 = new int*[managerRTDSize.maxNumGroups];
-	managerRuntimeData.extFiringTableD1 = new int*[managerRTDSize.maxNumGroups];
+	managerRuntimeData.firingTableD2 = allocateManagerArray<int>(managerRTDSize.maxMaxSpikeD2, "firingTableD2");
+	managerRuntimeData.firingTableD1 = allocateManagerArray<int>(managerRTDSize.maxMaxSpikeD1, "firingTableD1");
+	managerRuntimeData.extFiringTableEndIdxD2 = allocateManagerArray<int>(managerRTDSize.maxNumGroups, "extFiringTableEndIdxD2");
+	managerRuntimeData.extFiringTableEndIdxD1 = allocateManagerArray<int>(managerRTDSize.maxNumGroups, "extFiringTableEndIdxD1");
+	managerRuntimeData.extFiringTableD2 = allocateManagerArray<int*>(managerRTDSize.maxNumGroups, "extFiringTableD2");
+	managerRuntimeData.extFiringTableD1 = allocateManagerArray<int*>(managerRTDSize.maxNumGroups, "extFiringTableD1");
 
 	//CUDA_CHECK_ERRORS(cudaMallocHost(&managerRuntimeData.firingTableD2, sizeof(int) * managerRTDSize.maxMaxSpikeD2));
 	//CUDA_CHECK_ERRORS(cudaMallocHost(&managerRuntimeData.firingTableD1, sizeof(int) * managerRTDSize.maxMaxSpikeD1));
@@ -6273,8 +8348,8 @@ void SNN::allocateManagerSpikeTables() {
 	//CUDA_CHECK_ERRORS(cudaMallocHost(&managerRuntimeData.extFiringTableD1, sizeof(int*) * managerRTDSize.maxNumGroups));
 	resetFiringTable();
 	
-	managerRuntimeData.timeTableD2 = new unsigned int[TIMING_COUNT];
-	managerRuntimeData.timeTableD1 = new unsigned int[TIMING_COUNT];
+	managerRuntimeData.timeTableD2 = allocateManagerArray<unsigned int>(TIMING_COUNT, "timeTableD2");
+	managerRuntimeData.timeTableD1 = allocateManagerArray<unsigned int>(TIMING_COUNT, "timeTableD1");
 	resetTimeTable();
 }
 
@@ -6306,17 +8381,57 @@ void SNN::updateSpikeMonitor(int gGrpId) {
 		return;
 
 	if (gGrpId == ALL) {
-		for (int gGrpId = 0; gGrpId < numGroups; gGrpId++)
-			updateSpikeMonitor(gGrpId);
+		// every partition's spike tables are fetched and walked once for all of its monitors
+		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+			if (!groupPartitionLists[netId].empty())
+				updateSpikeMonitorPartition(netId, ALL);
+		}
 	} else {
-		int netId = groupConfigMDMap[gGrpId].netId;
-		int lGrpId = groupConfigMDMap[gGrpId].lGrpId;
-		// update spike monitor of a specific group
-		// find index in spike monitor arrays
-		int monitorId = groupConfigMDMap[gGrpId].spikeMonitorId;
-
 		// don't continue if no spike monitor enabled for this group
-		if (monitorId < 0) return;
+		if (groupConfigMDMap[gGrpId].spikeMonitorId < 0)
+			return;
+
+		updateSpikeMonitorPartition(groupConfigMDMap[gGrpId].netId, gGrpId);
+	}
+}
+
+//! a SpikeMonitor that receives spikes in updateSpikeMonitorPartition
+struct SpikeMonitorDemuxEntry {
+	SpikeMonitorCore* spkMonObj;
+	int lStartN;         //!< first local neuron id of the group
+	int numMsMin;        //!< first ms of the current second that has not been written yet
+	int spkFileStreamId;
+	bool writeSpikesToFile;
+	bool writeSpikesToArray;
+};
+
+void SNN::updateSpikeMonitorPartition(int netId, int gGrpId) {
+	ProfilerScope profScope(profPhaseTimeNs_[PROFILER_SPIKE_MONITOR], &profPhaseCalls_[PROFILER_SPIKE_MONITOR]);
+	TraceScope traceScope(tracer_, 0, PROFILER_SPIKE_MONITOR);
+
+	// find the time interval in which to update spikes
+	// usually, we call updateSpikeMonitor once every second, so the time interval is [0,1000)
+	// however, updateSpikeMonitor can be called at any time t \in [0,1000)... so we can have the cases
+	// [0,t), [t,1000), and even [t1, t2)
+	int numMsMax = getSimTimeMs(); // upper bound is given by current time
+	if (numMsMax == 0)
+		numMsMax = 1000; // special case: full second
+
+	// current time is last completed second in milliseconds (plus t to be added below)
+	// special case is after each completed second where !getSimTimeMs(): here we look 1s back
+	int currentTimeSec = getSimTimeSec();
+	if (!getSimTimeMs())
+		currentTimeSec--;
+
+	// collect the monitors of the partition that have spikes to write, indexed by local group id
+	std::vector<SpikeMonitorDemuxEntry> monitors;
+	// spikes of ghost groups (routed from other partitions) have local group ids in [numGroups, numGroupsAssigned)
+	std::vector<int> monitorOfLGrp(networkConfigs[netId].numGroupsAssigned, -1);
+	int numMsMinAll = numMsMax;
+	for (int g = (gGrpId == ALL ? 0 : gGrpId); g < (gGrpId == ALL ? numGroups : gGrpId + 1); g++) {
+		int monitorId = groupConfigMDMap[g].spikeMonitorId;
+		if (groupConfigMDMap[g].netId != netId || monitorId < 0)
+			continue;
 
 		// find last update time for this group
 		SpikeMonitorCore* spkMonObj = spikeMonCoreList[monitorId];
@@ -6324,89 +8439,92 @@ void SNN::updateSpikeMonitor(int gGrpId) {
 
 		// don't continue if time interval is zero (nothing to update)
 		if ( ((long int)getSimTime()) - lastUpdate <= 0)
-			return;
+			continue;
 
 		if ( ((long int)getSimTime()) - lastUpdate > 1000)
-			KERNEL_ERROR("updateSpikeMonitor(grpId=%d) must be called at least once every second",gGrpId);
-
-        // AER buffer max size warning here.
-        // Because of C++ short-circuit evaluation, the last condition should not be evaluated
-        // if the previous conditions are false.
-        if (spkMonObj->getAccumTime() > LONG_SPIKE_MON_DURATION \
-                && this->getGroupNumNeurons(gGrpId) > LARGE_SPIKE_MON_GRP_SIZE \
-                && spkMonObj->isBufferBig()){
-            // change this warning message to correct message
-            KERNEL_WARN("updateSpikeMonitor(grpId=%d) is becoming very large. (>%lu MB)",gGrpId,(long int) MAX_SPIKE_MON_BUFFER_SIZE/1024 );// make this better
-            KERNEL_WARN("Reduce the cumulative recording time (currently %lu minutes) or the group size (currently %d) to avoid this.",spkMonObj->getAccumTime()/(1000*60),this->getGroupNumNeurons(gGrpId));
-		}
-
-		// copy the neuron firing information to the manager runtime
-		fetchSpikeTables(netId);
-		fetchGrpIdsLookupArray(netId);
-
-		// find the time interval in which to update spikes
-		// usually, we call updateSpikeMonitor once every second, so the time interval is [0,1000)
-		// however, updateSpikeMonitor can be called at any time t \in [0,1000)... so we can have the cases
-		// [0,t), [t,1000), and even [t1, t2)
-		int numMsMin = lastUpdate % 1000; // lower bound is given by last time we called update
-		int numMsMax = getSimTimeMs(); // upper bound is given by current time
-		if (numMsMax == 0)
-			numMsMax = 1000; // special case: full second
-		assert(numMsMin < numMsMax);
+			KERNEL_ERROR("updateSpikeMonitor(grpId=%d) must be called at least once every second",g);
 
-		// current time is last completed second in milliseconds (plus t to be added below)
-		// special case is after each completed second where !getSimTimeMs(): here we look 1s back
-		int currentTimeSec = getSimTimeSec();
-		if (!getSimTimeMs())
-			currentTimeSec--;
+		// AER buffer max size warning here.
+		// Because of C++ short-circuit evaluation, the last condition should not be evaluated
+		// if the previous conditions are false.
+		if (spkMonObj->getAccumTime() > LONG_SPIKE_MON_DURATION \
+				&& this->getGroupNumNeurons(g) > LARGE_SPIKE_MON_GRP_SIZE \
+				&& spkMonObj->isBufferBig()){
+			// change this warning message to correct message
+			KERNEL_WARN("updateSpikeMonitor(grpId=%d) is becoming very large. (>%lu MB)",g,(long int) MAX_SPIKE_MON_BUFFER_SIZE/1024 );// make this better
+			KERNEL_WARN("Reduce the cumulative recording time (currently %lu minutes) or the group size (currently %d) to avoid this.",spkMonObj->getAccumTime()/(1000*60),this->getGroupNumNeurons(g));
+		}
 
 		// save current time as last update time
 		spkMonObj->setLastUpdated( (long int)getSimTime() );
 
-		// prepare fast access
-		FILE* spkFileId = spikeMonCoreList[monitorId]->getSpikeFileId();
-		bool writeSpikesToFile = spkFileId != NULL;
-		bool writeSpikesToArray = spkMonObj->getMode()==AER && spkMonObj->isRecording();
-
-		// Read one spike at a time from the buffer and put the spikes to an appopriate monitor buffer. Later the user
-		// may need need to dump these spikes to an output file
-		for (int k = 0; k < 2; k++) {
-			unsigned int* timeTablePtr = (k == 0) ? managerRuntimeData.timeTableD2 : managerRuntimeData.timeTableD1;
-			int* fireTablePtr = (k == 0) ? managerRuntimeData.firingTableD2 : managerRuntimeData.firingTableD1;
-			for(int t = numMsMin; t < numMsMax; t++) {
-				for(int i = timeTablePtr[t + glbNetworkConfig.maxDelay]; i < timeTablePtr[t + glbNetworkConfig.maxDelay + 1]; i++) {
-					// retrieve the neuron id
-					int lNId = fireTablePtr[i];
-
-					// make sure neuron belongs to currently relevant group
-					int this_grpId = managerRuntimeData.grpIds[lNId];
-					if (this_grpId != lGrpId)
-						continue;
+		// a monitor without a file that is not recording (or in COUNT mode) does not need the spike tables
+		SpikeMonitorDemuxEntry entry;
+		entry.writeSpikesToFile = spkMonObj->getSpikeFileId() != NULL;
+		entry.writeSpikesToArray = spkMonObj->getMode()==AER && spkMonObj->isRecording();
+		if (!entry.writeSpikesToFile && !entry.writeSpikesToArray)
+			continue;
 
-					// adjust nid to be 0-indexed for each group
-					// this way, if a group has 10 neurons, their IDs in the spike file and spike monitor will be
-					// indexed from 0..9, no matter what their real nid is
-					int nId = lNId - groupConfigs[netId][lGrpId].lStartN;
-					assert(nId >= 0);
+		entry.spkMonObj = spkMonObj;
+		entry.lStartN = groupConfigs[netId][groupConfigMDMap[g].lGrpId].lStartN;
+		entry.numMsMin = lastUpdate % 1000; // lower bound is given by last time we called update
+		entry.spkFileStreamId = spkMonObj->getSpikeFileStreamId();
+		assert(entry.numMsMin < numMsMax);
 
-					// current time is last completed second plus whatever is leftover in t
-					int time = currentTimeSec * 1000 + t;
+		numMsMinAll = std::min(numMsMinAll, entry.numMsMin);
+		monitorOfLGrp[groupConfigMDMap[g].lGrpId] = monitors.size();
+		monitors.push_back(entry);
+	}
 
-					if (writeSpikesToFile) {
-						int cnt;
-						cnt = fwrite(&time, sizeof(int), 1, spkFileId); assert(cnt==1);
-						cnt = fwrite(&nId,  sizeof(int), 1, spkFileId); assert(cnt==1);
-					}
+	if (monitors.empty())
+		return;
 
-					if (writeSpikesToArray) {
-						spkMonObj->pushAER(time, nId);
-					}
+	// copy the neuron firing information to the manager runtime
+	fetchSpikeTables(netId);
+	fetchGrpIdsLookupArray(netId);
+
+	// Read one spike at a time from the buffer and put it to the buffer of the monitor of its group. Later the user
+	// may need need to dump these spikes to an output file
+	for (int k = 0; k < 2; k++) {
+		unsigned int* timeTablePtr = (k == 0) ? managerRuntimeData.timeTableD2 : managerRuntimeData.timeTableD1;
+		int* fireTablePtr = (k == 0) ? managerRuntimeData.firingTableD2 : managerRuntimeData.firingTableD1;
+		for(int t = numMsMinAll; t < numMsMax; t++) {
+			// current time is last completed second plus whatever is leftover in t
+			int time = currentTimeSec * 1000 + t;
+
+			for(int i = timeTablePtr[t + glbNetworkConfig.maxDelay]; i < timeTablePtr[t + glbNetworkConfig.maxDelay + 1]; i++) {
+				// retrieve the neuron id
+				int lNId = fireTablePtr[i];
+
+				// make sure the group of the neuron is monitored, and the spike has not been written yet
+				int monIdx = monitorOfLGrp[managerRuntimeData.grpIds[lNId]];
+				if (monIdx < 0 || t < monitors[monIdx].numMsMin)
+					continue;
+				const SpikeMonitorDemuxEntry& entry = monitors[monIdx];
+
+				// adjust nid to be 0-indexed for each group
+				// this way, if a group has 10 neurons, their IDs in the spike file and spike monitor will be
+				// indexed from 0..9, no matter what their real nid is
+				int nId = restoreLNId(netId, lNId) - entry.lStartN;
+				assert(nId >= 0);
+
+				if (entry.writeSpikesToFile) {
+					spikeFileWriter->append(entry.spkFileStreamId, time, nId);
+				}
+
+				if (entry.writeSpikesToArray) {
+					entry.spkMonObj->pushAER(time, nId);
 				}
 			}
 		}
+	}
 
-		if (spkFileId!=NULL) // flush spike file
-			fflush(spkFileId);
+	// the spikes are written by the I/O thread once the buffer is full, or every second if requested
+	if (spikeFileFlushEverySecond_) {
+		for (int m = 0; m < monitors.size(); m++) {
+			if (monitors[m].writeSpikesToFile)
+				spikeFileWriter->flush(monitors[m].spkFileStreamId);
+		}
 	}
 }
 
@@ -6423,6 +8541,10 @@ void SNN::updateNeuronMonitor(int gGrpId) {
 			updateNeuronMonitor(gGrpId);
 	}
 	else {
+		// ALL recurses into this branch, so only the per-group work is measured
+		ProfilerScope profScope(profPhaseTimeNs_[PROFILER_NEURON_MONITOR], &profPhaseCalls_[PROFILER_NEURON_MONITOR]);
+		TraceScope traceScope(tracer_, 0, PROFILER_NEURON_MONITOR);
+
 		//printf("UpdateNeuronMonitor is being executed!\n");
 		int netId = groupConfigMDMap[gGrpId].netId;
 		int lGrpId = groupConfigMDMap[gGrpId].lGrpId;
@@ -6441,6 +8563,27 @@ void SNN::updateNeuronMonitor(int gGrpId) {
 		if (((long int)getSimTime()) - lastUpdate <= 0)
 			return;
 
+		// sampling neuron monitors keep a ring buffer of a different layout, see updateNeuronMonitorStreams
+		if (nrnMonObj->isSampling()) {
+			GroupConfigRT& grpConfig = groupConfigs[netId][lGrpId];
+			int stride = grpConfig.neuronMonitorStreamStride;
+			if (((long int)getSimTime()) - lastUpdate > (long int)grpConfig.neuronMonitorStreamWindow * stride)
+				KERNEL_ERROR("updateNeuronMonitor(grpId=%d) must be called before the sample buffer wraps around", gGrpId);
+
+			fetchNeuronStreamBuffer(netId, lGrpId);
+			nrnMonObj->setLastUpdated((long int)getSimTime());
+
+			// all samples taken in [lastUpdate, simTime)
+			int numN = grpConfig.neuronMonitorStreamNumN;
+			for (long int t = (lastUpdate + stride - 1) / stride * stride; t < (long int)getSimTime(); t += stride) {
+				const float* sample = &managerRuntimeData.nStreamBuffer[grpConfig.neuronMonitorStreamOffset
+					+ (t / stride) % grpConfig.neuronMonitorStreamWindow * 3 * numN];
+				nrnMonObj->pushSample((int)t, sample, sample + numN, sample + 2 * numN);
+			}
+			nrnMonObj->writeSampleBlock();
+			return;
+		}
+
 		if (((long int)getSimTime()) - lastUpdate > 1000)
 			KERNEL_ERROR("updateNeuronMonitor(grpId=%d) must be called at least once every second", gGrpId);
 
@@ -6456,6 +8599,17 @@ void SNN::updateNeuronMonitor(int gGrpId) {
 			KERNEL_WARN("Reduce the cumulative recording time (currently %lu minutes) or the group size (currently %d) to avoid this.", nrnMonObj->getAccumTime() / (1000 * 60), this->getGroupNumNeurons(gGrpId));
 		}*/
 
+		// prepare fast access
+		FILE* nrnFileId = neuronMonCoreList[monitorId]->getNeuronFileId();
+		bool writeNeuronStateToFile = nrnFileId != NULL;
+		bool writeNeuronStateToArray = nrnMonObj->isRecording();
+
+		// nothing to write to
+		if (!writeNeuronStateToFile && !writeNeuronStateToArray) {
+			nrnMonObj->setLastUpdated((long int)getSimTime());
+			return;
+		}
+
 		// copy the neuron information to manager runtime
 		fetchNeuronStateBuffer(netId, lGrpId);
 		
@@ -6478,11 +8632,6 @@ void SNN::updateNeuronMonitor(int gGrpId) {
 		// save current time as last update time
 		nrnMonObj->setLastUpdated((long int)getSimTime());
 
-		// prepare fast access
-		FILE* nrnFileId = neuronMonCoreList[monitorId]->getNeuronFileId();
-		bool writeNeuronStateToFile = nrnFileId != NULL;
-		bool writeNeuronStateToArray = nrnMonObj->isRecording();
-
 		// Read one neuron state value at a time from the buffer and put the neuron state values to an appopriate monitor buffer.
 		// Later the user may need need to dump these neuron state values to an output file
 		//printf("The numMsMin is: %i; and numMsMax is: %i\n", numMsMin, numMsMax);
@@ -6502,7 +8651,11 @@ void SNN::updateNeuronMonitor(int gGrpId) {
 				int nId = lNId - groupConfigs[netId][lGrpId].lStartN;
 				assert(nId >= 0);
 
-				int idxBase = networkConfigs[netId].numGroups * MAX_NEURON_MON_GRP_SZIE * t + lGrpId * MAX_NEURON_MON_GRP_SZIE;
+				// only the first MAX_NEURON_MON_GRP_SZIE neurons of a group have a place in the buffer
+				if (nId >= MAX_NEURON_MON_GRP_SZIE)
+					break;
+
+				int idxBase = (groupConfigs[netId][lGrpId].neuronMonitorSlot * 1000 + t) * MAX_NEURON_MON_GRP_SZIE;
 				v = managerRuntimeData.nVBuffer[idxBase + nId];
 				u = managerRuntimeData.nUBuffer[idxBase + nId];
 				I = managerRuntimeData.nIBuffer[idxBase + nId];
@@ -6533,6 +8686,23 @@ void SNN::updateNeuronMonitor(int gGrpId) {
 	}
 }
 
+void SNN::updateNeuronMonitorStreams(bool force) {
+	ProfilerScope profScope(profPhaseTimeNs_[PROFILER_NEURON_MONITOR], &profPhaseCalls_[PROFILER_NEURON_MONITOR]);
+	TraceScope traceScope(tracer_, 0, PROFILER_NEURON_MONITOR);
+
+	for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+		int monitorId = groupConfigMDMap[gGrpId].neuronMonitorId;
+		if (monitorId < 0 || !neuronMonCoreList[monitorId]->isSampling())
+			continue;
+
+		// drain the ring buffer once it is full
+		GroupConfigRT& grpConfig = groupConfigs[groupConfigMDMap[gGrpId].netId][groupConfigMDMap[gGrpId].lGrpId];
+		long int drainPeriod = (long int)grpConfig.neuronMonitorStreamWindow * grpConfig.neuronMonitorStreamStride;
+		if (force || (long int)getSimTime() - neuronMonCoreList[monitorId]->getLastUpdated() >= drainPeriod)
+			updateNeuronMonitor(gGrpId);
+	}
+}
+
 // FIXME: update summary format for multiGPUs
 void SNN::printSimSummary() {
 	float etime;
@@ -6565,6 +8735,78 @@ void SNN::printSimSummary() {
 	KERNEL_INFO("Overall Spike Count:\t2+ms delay = %d", managerRuntimeData.spikeCountD2);
 	KERNEL_INFO("\t\t\t1ms delay = %d", managerRuntimeData.spikeCountD1);
 	KERNEL_INFO("\t\t\tTotal = %d", managerRuntimeData.spikeCount);
+
+	SetupReport setupReport = getSetupReport();
+	KERNEL_INFO("Setup Report:\t\t%.2f ms in setupNetwork", setupReport.setupTimeMs);
+	KERNEL_INFO("\t\t\t%-26s %12s %8s %14s", "stage", "time (ms)", "calls", "peak RSS (MB)");
+	for (int i = 0; i < NUM_SETUP_STAGES; i++) {
+		if (setupReport.stageCalls[i] == 0)
+			continue;
+		KERNEL_INFO("\t\t\t%-26s %12.2f %8lld %14.2f", setupStage_string[i], setupReport.stageTimeMs[i],
+			setupReport.stageCalls[i], setupReport.stagePeakRssBytes[i] / (1024.0 * 1024.0));
+	}
+
+	if (profNumSteps_ > 0) {
+		PerformanceReport report = getPerformanceReport();
+		KERNEL_INFO("Performance Report:\t%lld ms simulated in %.2f ms (%.2f us per ms)", report.numSteps,
+			report.runTimeMs, 1000.0 * report.runTimeMs / report.numSteps);
+#ifndef __NO_PROFILING__
+		KERNEL_INFO("\t\t\t%-24s %12s %7s %12s", "phase", "time (ms)", "%", "calls");
+		for (int i = 0; i < NUM_PROFILER_PHASES; i++) {
+			if (report.phaseCalls[i] == 0)
+				continue;
+			KERNEL_INFO("\t\t\t%-24s %12.2f %6.1f%% %12lld", profilerPhase_string[i], report.phaseTimeMs[i],
+				100.0 * report.phaseTimeMs[i] / report.runTimeMs, report.phaseCalls[i]);
+		}
+		for (int p = 0; p < report.partitionNames.size(); p++) {
+			double sumMs = 0.0;
+			for (int i = 0; i < NUM_PROFILER_PHASES; i++)
+				sumMs += report.partitionTimeMs[p][i];
+			KERNEL_INFO("\t\t\t%s busy for %.2f ms (findFiring %.2f, doCurrentUpdate %.2f, globalStateUpdate %.2f)",
+				report.partitionNames[p].c_str(), sumMs, report.partitionTimeMs[p][PROFILER_FIND_FIRING],
+				report.partitionTimeMs[p][PROFILER_CURRENT_UPDATE], report.partitionTimeMs[p][PROFILER_STATE_UPDATE]);
+		}
+		if (report.hwCountersEnabled) {
+			KERNEL_INFO("\t\t\t%-24s %12s %7s %14s %14s", "phase", "instructions", "IPC", "LLC misses",
+				"branch misses");
+			for (int i = 0; i < NUM_PROFILER_PHASES; i++) {
+				const long long* hw = report.phaseHwCounts[i];
+				if (hw[HW_INSTRUCTIONS] == 0)
+					continue;
+				KERNEL_INFO("\t\t\t%-24s %12lld %7.2f %14lld %14lld", profilerPhase_string[i], hw[HW_INSTRUCTIONS],
+					hw[HW_CYCLES] > 0 ? (double)hw[HW_INSTRUCTIONS] / hw[HW_CYCLES] : 0.0, hw[HW_LLC_MISSES],
+					hw[HW_BRANCH_MISSES]);
+			}
+		}
+#endif
+		for (int p = 0; p < report.partitionNames.size(); p++) {
+			const EventCounts& events = report.partitionEvents[p];
+			KERNEL_INFO("\t\t\t%s: %lld synaptic events (%.2f M/s), %lld LTP / %lld LTD evaluations",
+				report.partitionNames[p].c_str(), events.synEvents, events.synEvents * 1e-3 / report.runTimeMs,
+				events.ltpEvals, events.ltdEvals);
+			KERNEL_INFO("\t\t\t%s: %lld spikes routed in, %lld spikes dropped, %lld Poisson draws",
+				report.partitionNames[p].c_str(), events.extSpikesRouted, events.spikesDropped, events.poissonDraws);
+		}
+	}
+
+	// total and largest array of every partition, in the order they are listed
+	MemoryReport memReport = getMemoryReport();
+	KERNEL_INFO("Memory Usage:\t\t%.2f MB (peak RSS after setup %.2f MB)", memReport.getBytes() / (1024.0 * 1024.0),
+		memReport.peakRssBytes / (1024.0 * 1024.0));
+	std::vector<std::string> partitions;
+	for (int i = 0; i < memReport.arrays.size(); i++)
+		if (std::find(partitions.begin(), partitions.end(), memReport.arrays[i].partition) == partitions.end())
+			partitions.push_back(memReport.arrays[i].partition);
+	for (int p = 0; p < partitions.size(); p++) {
+		int largest = -1;
+		for (int i = 0; i < memReport.arrays.size(); i++)
+			if (memReport.arrays[i].partition == partitions[p]
+				&& (largest < 0 || memReport.arrays[i].bytes > memReport.arrays[largest].bytes))
+				largest = i;
+		KERNEL_INFO("\t\t\t%-10s %10.2f MB (largest: %s, %.2f MB)", partitions[p].c_str(),
+			memReport.getBytes(partitions[p]) / (1024.0 * 1024.0), memReport.arrays[largest].array.c_str(),
+			memReport.arrays[largest].bytes / (1024.0 * 1024.0));
+	}
 	KERNEL_INFO("*********************************************************************************\n");
 }
 
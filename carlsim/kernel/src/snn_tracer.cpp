@@ -0,0 +1,138 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include <snn_tracer.h>
+
+#include <carlsim_datastructures.h> // profilerPhase_string
+#include <assert.h>
+
+
+SimTracer::SimTracer(FILE* fp, int numThreads, int sampleIntervalMs, int maxEventsPerThread) : fp_(fp),
+	threadNames_(numThreads), threadNameWritten_(numThreads, false), sampleIntervalMs_(sampleIntervalMs), simTime_(0),
+	isSampling_(false), isFirstEvent_(true) {
+	assert(fp != NULL);
+	assert(numThreads > 0);
+	assert(sampleIntervalMs > 0);
+	assert(maxEventsPerThread > 0);
+
+	for (int i = 0; i < numThreads; i++) {
+		TraceRing* ring = new TraceRing;
+		ring->events.resize(maxEventsPerThread);
+		ring->next = 0;
+		ring->count = 0;
+		ring->numOverwritten = 0;
+		rings_.push_back(ring);
+	}
+
+	// all time stamps are relative to the creation of the tracer
+	originNs_ = getProfilerTimeNs();
+	fprintf(fp_, "[\n");
+}
+
+SimTracer::~SimTracer() {
+	fprintf(fp_, "\n]\n");
+	fclose(fp_);
+
+	for (int i = 0; i < rings_.size(); i++)
+		delete rings_[i];
+}
+
+void SimTracer::setThreadName(int thread, const std::string& name) {
+	assert(thread >= 0 && thread < threadNames_.size());
+	if (name != threadNames_[thread]) {
+		threadNames_[thread] = name;
+		threadNameWritten_[thread] = false;
+	}
+}
+
+bool SimTracer::dump() {
+	char event[256];
+	for (int thread = 0; thread < rings_.size(); thread++) {
+		TraceRing& ring = *rings_[thread];
+		if (ring.count == 0)
+			continue;
+
+		// metadata: name of the thread in the viewer
+		if (!threadNameWritten_[thread] && !threadNames_[thread].empty()) {
+			snprintf(event, sizeof(event), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+				"\"args\":{\"name\":\"%s\"}}", thread, threadNames_[thread].c_str());
+			writeEvent(event);
+			threadNameWritten_[thread] = true;
+		}
+
+		// oldest event first
+		size_t capacity = ring.events.size();
+		size_t idx = (ring.next + capacity - ring.count) % capacity;
+		for (size_t i = 0; i < ring.count; i++) {
+			const TraceEvent& ev = ring.events[idx];
+			snprintf(event, sizeof(event), "{\"name\":\"%s\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+				"\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"simTime\":%d}}", profilerPhase_string[ev.nameId], thread,
+				(ev.startNs - originNs_) * 1e-3, ev.durNs * 1e-3, ev.simTime);
+			writeEvent(event);
+			if (++idx == capacity)
+				idx = 0;
+		}
+
+		ring.next = 0;
+		ring.count = 0;
+	}
+
+	fflush(fp_);
+	return !ferror(fp_);
+}
+
+long long SimTracer::getNumOverwritten() {
+	long long numOverwritten = 0;
+	for (int i = 0; i < rings_.size(); i++)
+		numOverwritten += rings_[i]->numOverwritten;
+	return numOverwritten;
+}
+
+void SimTracer::writeEvent(const char* event) {
+	fprintf(fp_, isFirstEvent_ ? "%s" : ",\n%s", event);
+	isFirstEvent_ = false;
+}
@@ -0,0 +1,484 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include <spike_file_writer.h>
+
+#include <snn_definitions.h> // SPIKE_FILE_INDEX_SIGNATURE
+
+#include <assert.h>
+#include <string.h>  // memcpy
+#include <deque>
+#include <vector>
+#include <pthread.h>
+#if !defined(WIN32) && !defined(WIN64)
+#include <errno.h>
+#include <sys/uio.h>  // writev
+#include <unistd.h>
+#endif
+
+
+// the maximum number of buffers that are written with a single writev call
+#define MAX_BUFFERS_PER_WRITE 64
+
+// the maximum number of buffers waiting for the I/O thread before append blocks
+#define MAX_PENDING_BUFFERS 64
+
+
+class SpikeFileWriter::Impl {
+public:
+	// +++++ PUBLIC METHODS: SETUP / TEAR-DOWN ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+	Impl(size_t bufferSize) : _bufferSize(bufferSize), _numPending(0), _threadRunning(false), _stopThread(false),
+		_writeError(false)
+	{
+		// a buffer holds at least one (time, neuron ID) pair
+		if (_bufferSize < 2 * sizeof(int))
+			_bufferSize = 2 * sizeof(int);
+
+		pthread_mutex_init(&_mutex, NULL);
+		pthread_cond_init(&_bufferPending, NULL);
+		pthread_cond_init(&_bufferWritten, NULL);
+	}
+
+	~Impl() {
+		flushAll(true);
+
+		if (_threadRunning) {
+			pthread_mutex_lock(&_mutex);
+			_stopThread = true;
+			pthread_cond_signal(&_bufferPending);
+			pthread_mutex_unlock(&_mutex);
+			pthread_join(_thread, NULL);
+		}
+
+		for (size_t i = 0; i < _streams.size(); i++) {
+			delete _streams[i].fill;
+			delete _streams[i].chunk;
+			delete _streams[i].index;
+		}
+		for (size_t i = 0; i < _freeBuffers.size(); i++)
+			delete _freeBuffers[i];
+
+		pthread_cond_destroy(&_bufferWritten);
+		pthread_cond_destroy(&_bufferPending);
+		pthread_mutex_destroy(&_mutex);
+	}
+
+
+	// +++++ PUBLIC METHODS +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+	int open(FILE* fid, int chunkLengthMs) {
+		assert(fid != NULL);
+		assert(chunkLengthMs >= 0);
+		fflush(fid);
+
+		if (!_threadRunning) {
+			_stopThread = false;
+			_threadRunning = pthread_create(&_thread, NULL, &Impl::helperWriteBuffers, (void*)this) == 0;
+		}
+
+		Stream stream;
+		stream.fid = fid;
+#if defined(WIN32) || defined(WIN64)
+		stream.fd = -1;
+#else
+		stream.fd = fileno(fid);
+#endif
+		stream.fill = getFreeBuffer();
+
+		// chunked streams keep the spikes of the current chunk and the chunk index until they are complete
+		stream.chunkLengthMs = chunkLengthMs;
+		stream.chunk = chunkLengthMs > 0 ? new std::vector<char>() : NULL;
+		stream.index = chunkLengthMs > 0 ? new std::vector<char>() : NULL;
+		stream.chunkFirstTime = 0;
+		stream.chunkLastTime = 0;
+		stream.chunkNumSpikes = 0;
+		stream.chunkLastNeurId = 0;
+		stream.numChunks = 0;
+#if defined(WIN32) || defined(WIN64)
+		stream.offset = _ftelli64(fid);
+#else
+		stream.offset = (long long)ftello(fid);
+#endif
+		_streams.push_back(stream);
+		return _streams.size() - 1;
+	}
+
+	bool close(int streamId) {
+		assert(streamId >= 0 && streamId < _streams.size() && _streams[streamId].fill != NULL);
+
+		Stream& stream = _streams[streamId];
+		if (stream.chunkLengthMs > 0) {
+			// the chunk index and its footer end the file
+			finishChunk(streamId);
+			long long indexOffset = stream.offset;
+			int signature = SPIKE_FILE_INDEX_SIGNATURE;
+			if (!stream.index->empty())
+				appendBytes(stream.fill, &(*stream.index)[0], stream.index->size());
+			appendBytes(stream.fill, &indexOffset, sizeof(long long));
+			appendBytes(stream.fill, &stream.numChunks, sizeof(int));
+			appendBytes(stream.fill, &signature, sizeof(int));
+			delete stream.chunk;
+			delete stream.index;
+			stream.chunk = NULL;
+			stream.index = NULL;
+		}
+
+		handOver(streamId);
+		bool success = waitUntilWritten();
+
+		recycleBuffer(stream.fill);
+		stream.fill = NULL;
+		return success;
+	}
+
+	inline void append(int streamId, int time, int neurId) {
+		Stream& stream = _streams[streamId];
+		if (stream.chunkLengthMs > 0) {
+			appendToChunk(streamId, time, neurId);
+			return;
+		}
+
+		appendBytes(stream.fill, &time, sizeof(int));
+		appendBytes(stream.fill, &neurId, sizeof(int));
+		if (stream.fill->size() >= _bufferSize)
+			handOver(streamId);
+	}
+
+	void appendBlock(int streamId, const void* data, size_t size) {
+		Stream& stream = _streams[streamId];
+		assert(stream.chunkLengthMs == 0);
+
+		appendBytes(stream.fill, data, size);
+		if (stream.fill->size() >= _bufferSize)
+			handOver(streamId);
+	}
+
+	void flush(int streamId) {
+		if (_streams[streamId].chunk != NULL)
+			finishChunk(streamId);
+		handOver(streamId);
+	}
+
+	bool flushAll(bool wait) {
+		for (size_t i = 0; i < _streams.size(); i++)
+			flush(i);
+		if (wait)
+			return waitUntilWritten();
+
+		pthread_mutex_lock(&_mutex);
+		bool success = !_writeError;
+		_writeError = false;
+		pthread_mutex_unlock(&_mutex);
+		return success;
+	}
+
+private:
+	struct Stream {
+		FILE* fid;
+		int fd;                  //!< file descriptor of fid, -1 if writev is not available
+		std::vector<char>* fill; //!< buffer that is currently being filled, NULL if the stream is closed
+		long long offset;        //!< file offset at which the next byte handed to fill will be written
+
+		// chunked streams only
+		int chunkLengthMs;         //!< time covered by a chunk, 0 for (time, neuron ID) pairs
+		std::vector<char>* chunk;  //!< encoded spikes of the current chunk, NULL for unchunked or closed streams
+		std::vector<char>* index;  //!< index entries of all finished chunks
+		int chunkFirstTime;
+		int chunkLastTime;
+		int chunkNumSpikes;
+		int chunkLastNeurId;
+		int numChunks;
+	};
+
+	struct Job {
+		Stream stream;
+		std::vector<char>* buffer;
+	};
+
+	static inline void appendBytes(std::vector<char>* buffer, const void* data, size_t size) {
+		size_t pos = buffer->size();
+		buffer->resize(pos + size);
+		if (size > 0)
+			memcpy(&(*buffer)[pos], data, size);
+	}
+
+	// appends a variable-length integer: 7 bits per byte, least significant group first
+	static inline void appendVarint(std::vector<char>* buffer, unsigned int value) {
+		while (value >= 0x80) {
+			buffer->push_back((char)(value | 0x80));
+			value >>= 7;
+		}
+		buffer->push_back((char)value);
+	}
+
+	// encodes a spike as the time difference and the zigzag-encoded neuron ID difference to the previous spike
+	void appendToChunk(int streamId, int time, int neurId) {
+		Stream& stream = _streams[streamId];
+		if (stream.chunkNumSpikes > 0 && time / stream.chunkLengthMs != stream.chunkFirstTime / stream.chunkLengthMs)
+			finishChunk(streamId);
+
+		if (stream.chunkNumSpikes == 0) {
+			stream.chunkFirstTime = time;
+			stream.chunkLastTime = time;
+			stream.chunkLastNeurId = 0;
+		}
+		assert(time >= stream.chunkLastTime);
+
+		int neurIdDiff = neurId - stream.chunkLastNeurId;
+		appendVarint(stream.chunk, (unsigned int)(time - stream.chunkLastTime));
+		appendVarint(stream.chunk, ((unsigned int)neurIdDiff << 1) ^ (unsigned int)(neurIdDiff >> 31));
+		stream.chunkLastTime = time;
+		stream.chunkLastNeurId = neurId;
+		stream.chunkNumSpikes++;
+	}
+
+	// moves the current chunk (header and encoded spikes) to the buffer of the stream and adds it to the index
+	void finishChunk(int streamId) {
+		Stream& stream = _streams[streamId];
+		if (stream.chunkNumSpikes == 0)
+			return;
+
+		int header[4] = {stream.chunkFirstTime, stream.chunkLastTime, stream.chunkNumSpikes, (int)stream.chunk->size()};
+		appendBytes(stream.index, &stream.offset, sizeof(long long));
+		appendBytes(stream.index, header, 3 * sizeof(int));
+		stream.numChunks++;
+
+		appendBytes(stream.fill, header, sizeof(header));
+		appendBytes(stream.fill, &(*stream.chunk)[0], stream.chunk->size());
+		stream.offset += sizeof(header) + stream.chunk->size();
+		stream.chunk->clear();
+		stream.chunkNumSpikes = 0;
+
+		if (stream.fill->size() >= _bufferSize)
+			handOver(streamId);
+	}
+
+	// hands the buffer of a stream to the I/O thread
+	void handOver(int streamId) {
+		Stream& stream = _streams[streamId];
+		if (stream.fill == NULL || stream.fill->empty())
+			return;
+
+		if (!_threadRunning) {
+			// no I/O thread available, write right away
+			std::vector<char>* buffers[1] = {stream.fill};
+			if (!writeBuffers(stream, buffers, 1))
+				_writeError = true;
+			stream.fill->clear();
+			return;
+		}
+
+		Job job;
+		job.stream = stream;
+		job.buffer = stream.fill;
+
+		pthread_mutex_lock(&_mutex);
+		// limit the memory held by buffers that have not been written yet
+		while (_numPending >= MAX_PENDING_BUFFERS)
+			pthread_cond_wait(&_bufferWritten, &_mutex);
+		_jobs.push_back(job);
+		_numPending++;
+		pthread_cond_signal(&_bufferPending);
+		pthread_mutex_unlock(&_mutex);
+
+		stream.fill = getFreeBuffer();
+	}
+
+	// waits until the I/O thread has written all pending buffers, returns false if a write error occurred
+	bool waitUntilWritten() {
+		pthread_mutex_lock(&_mutex);
+		while (_numPending > 0)
+			pthread_cond_wait(&_bufferWritten, &_mutex);
+		bool success = !_writeError;
+		_writeError = false;
+		pthread_mutex_unlock(&_mutex);
+		return success;
+	}
+
+	std::vector<char>* getFreeBuffer() {
+		std::vector<char>* buffer = NULL;
+		pthread_mutex_lock(&_mutex);
+		if (!_freeBuffers.empty()) {
+			buffer = _freeBuffers.back();
+			_freeBuffers.pop_back();
+		}
+		pthread_mutex_unlock(&_mutex);
+
+		if (buffer == NULL) {
+			buffer = new std::vector<char>();
+			buffer->reserve(_bufferSize);
+		}
+		return buffer;
+	}
+
+	void recycleBuffer(std::vector<char>* buffer) {
+		buffer->clear();
+		pthread_mutex_lock(&_mutex);
+		_freeBuffers.push_back(buffer);
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	// writes consecutive buffers of a stream, returns false on a write error
+	static bool writeBuffers(const Stream& stream, std::vector<char>** buffers, int numBuffers) {
+#if defined(WIN32) || defined(WIN64)
+		for (int i = 0; i < numBuffers; i++)
+			if (fwrite(&(*buffers[i])[0], 1, buffers[i]->size(), stream.fid) != buffers[i]->size())
+				return false;
+		return fflush(stream.fid) == 0;
+#else
+		struct iovec iov[MAX_BUFFERS_PER_WRITE];
+		for (int i = 0; i < numBuffers; i++) {
+			iov[i].iov_base = &(*buffers[i])[0];
+			iov[i].iov_len = buffers[i]->size();
+		}
+
+		// writev might write less than requested, continue where it stopped
+		struct iovec* next = iov;
+		int numLeft = numBuffers;
+		while (numLeft > 0) {
+			ssize_t written = writev(stream.fd, next, numLeft);
+			if (written < 0) {
+				if (errno == EINTR)
+					continue;
+				return false;
+			}
+			while (numLeft > 0 && (size_t)written >= next->iov_len) {
+				written -= next->iov_len;
+				next++;
+				numLeft--;
+			}
+			if (numLeft > 0) {
+				next->iov_base = (char*)next->iov_base + written;
+				next->iov_len -= written;
+			}
+		}
+		return true;
+#endif
+	}
+
+	// the I/O thread: writes pending buffers in the order in which they were handed over
+	void writePendingBuffers() {
+		std::vector<char>* buffers[MAX_BUFFERS_PER_WRITE];
+
+		pthread_mutex_lock(&_mutex);
+		while (true) {
+			while (_jobs.empty() && !_stopThread)
+				pthread_cond_wait(&_bufferPending, &_mutex);
+			if (_jobs.empty())
+				break;
+
+			// collect the consecutive buffers of the same file
+			Stream stream = _jobs.front().stream;
+			int numBuffers = 0;
+			while (!_jobs.empty() && _jobs.front().stream.fid == stream.fid && numBuffers < MAX_BUFFERS_PER_WRITE) {
+				buffers[numBuffers++] = _jobs.front().buffer;
+				_jobs.pop_front();
+			}
+			pthread_mutex_unlock(&_mutex);
+
+			bool success = writeBuffers(stream, buffers, numBuffers);
+			for (int i = 0; i < numBuffers; i++)
+				buffers[i]->clear();
+
+			pthread_mutex_lock(&_mutex);
+			if (!success)
+				_writeError = true;
+			for (int i = 0; i < numBuffers; i++)
+				_freeBuffers.push_back(buffers[i]);
+			_numPending -= numBuffers;
+			pthread_cond_broadcast(&_bufferWritten);
+		}
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	static void* helperWriteBuffers(void* arg) {
+		((Impl*)arg)->writePendingBuffers();
+		return NULL;
+	}
+
+	//! Number of bytes after which the buffer of a stream is handed to the I/O thread
+	size_t _bufferSize;
+
+	//! All streams that were ever opened, indexed by stream ID
+	std::vector<Stream> _streams;
+
+	//! Buffers waiting for the I/O thread, in the order in which they were handed over
+	std::deque<Job> _jobs;
+
+	//! Written buffers that can be reused
+	std::vector<std::vector<char>*> _freeBuffers;
+
+	//! Number of buffers that were handed over but are not written yet
+	int _numPending;
+
+	pthread_t _thread;
+	pthread_mutex_t _mutex;          //!< protects _jobs, _freeBuffers, _numPending, and _writeError
+	pthread_cond_t _bufferPending;   //!< signaled when a buffer is handed over (or the thread has to stop)
+	pthread_cond_t _bufferWritten;   //!< signaled when the I/O thread has written buffers
+	bool _threadRunning;
+	bool _stopThread;
+	bool _writeError;                //!< whether a write failed since the last check
+};
+
+
+// ****************************************************************************************************************** //
+// SPIKEFILEWRITER API IMPLEMENTATION
+// ****************************************************************************************************************** //
+
+// constructor / destructor
+SpikeFileWriter::SpikeFileWriter(size_t bufferSize) :
+	_impl( new Impl(bufferSize) ) {}
+SpikeFileWriter::~SpikeFileWriter() { delete _impl; }
+
+// public methods
+int SpikeFileWriter::open(FILE* fid, int chunkLengthMs) { return _impl->open(fid, chunkLengthMs); }
+bool SpikeFileWriter::close(int streamId) { return _impl->close(streamId); }
+void SpikeFileWriter::append(int streamId, int time, int neurId) { _impl->append(streamId, time, neurId); }
+void SpikeFileWriter::appendBlock(int streamId, const void* data, size_t size) { _impl->appendBlock(streamId, data, size); }
+void SpikeFileWriter::flush(int streamId) { _impl->flush(streamId); }
+bool SpikeFileWriter::flushAll(bool wait) { return _impl->flushAll(wait); }
@@ -67,6 +67,10 @@ std::vector< std::vector<float> > ConnectionMonitor::calcWeightChanges() {
 	return connMonCorePtr_->calcWeightChanges();
 }
 
+std::vector<float> ConnectionMonitor::calcWeightChangesSparse() {
+	return connMonCorePtr_->calcWeightChangesSparse();
+}
+
 short int ConnectionMonitor::getConnectId() {
 	return connMonCorePtr_->getConnectId();
 }
@@ -172,4 +176,8 @@ void ConnectionMonitor::setUpdateTimeIntervalSec(int intervalSec) {
 
 std::vector< std::vector<float> > ConnectionMonitor::takeSnapshot() {
 	return connMonCorePtr_->takeSnapshot();
-}
\ No newline at end of file
+}
+void ConnectionMonitor::takeSnapshotSparse(std::vector<int>& preIds, std::vector<int>& postIds,
+	std::vector<float>& weights) {
+	connMonCorePtr_->takeSnapshotSparse(preIds, postIds, weights);
+}
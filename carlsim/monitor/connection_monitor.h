@@ -85,6 +85,10 @@ class ConnectionMonitorCore; // forward declaration of implementation
  *
  * Weights can also be visualized in C++ using ConnectionMonitor::print and ConnectionMonitor::printSparse.
  *
+ * For large, sparsely connected groups, ConnectionMonitor::takeSnapshotSparse and
+ * ConnectionMonitor::calcWeightChangesSparse report only the synapses that exist, and CARLsim::setConnectFileFormat
+ * selects a sparse connection file format.
+ *
  * Example to store weights in binary every second:
  * \code
  * // configure a network, etc. ...
@@ -185,6 +189,20 @@ class ConnectionMonitor {
 	 */
 	std::vector< std::vector<float> > calcWeightChanges();
 
+	/*!
+	 * \brief Reports the weight changes since the last snapshot per synapse
+	 *
+	 * This function is the sparse version of ConnectionMonitor::calcWeightChanges. Weight changes are reported only
+	 * for the synapses that exist, in the same order as the synapses returned by
+	 * ConnectionMonitor::takeSnapshotSparse (which does not change over the course of a simulation).
+	 * Prefer this function for large, sparsely connected groups, where the 2D weight change matrix would be mostly
+	 * NAN.
+	 *
+	 * \returns a vector of weight changes, one per synapse
+	 * \since v4.0
+	 */
+	std::vector<float> calcWeightChangesSparse();
+
 	/*!
 	 * \brief Returns the connection ID that this ConnectionMonitor is managing
 	 *
@@ -504,6 +522,23 @@ class ConnectionMonitor {
 	 */
 	std::vector< std::vector<float> > takeSnapshot();
 
+	/*!
+	 * \brief Takes a snapshot of the current weight state in coordinate format
+	 *
+	 * This function is the sparse version of ConnectionMonitor::takeSnapshot. Only the synapses that exist are
+	 * returned: the i-th synapse connects pre-synaptic neuron preIds[i] to post-synaptic neuron postIds[i] and has
+	 * weight weights[i]. The order of synapses does not change over the course of a simulation, so the weights of
+	 * two snapshots (and the weight changes of ConnectionMonitor::calcWeightChangesSparse) can be compared
+	 * element-wise.
+	 *
+	 * \param[out] preIds   pre-synaptic neuron ID of every synapse
+	 * \param[out] postIds  post-synaptic neuron ID of every synapse
+	 * \param[out] weights  weight of every synapse
+	 * \note Every snapshot taken will also be stored in the binary file.
+	 * \since v4.0
+	 */
+	void takeSnapshotSparse(std::vector<int>& preIds, std::vector<int>& postIds, std::vector<float>& weights);
+
 private:
 	//! This is a pointer to the actual implementation of the class. The user should never directly instantiate it.
 	ConnectionMonitorCore* connMonCorePtr_;
@@ -73,7 +73,8 @@ ConnectionMonitorCore::ConnectionMonitorCore(SNN* snn,int monitorId,short int co
 	needToWriteFileHeader_ = true;
 	needToInit_ = true;
 	connFileSignature_ = 202029319;
-	connFileVersion_ = 0.3f;
+	connFileFormat_ = snn_->getConnectFileFormat();
+	connFileVersion_ = (connFileFormat_ == CONNECT_FILE_DENSE) ? 0.3f : 0.4f;
 
 	minWt_ = -1.0f;
 	maxWt_ = -1.0f;
@@ -103,18 +104,15 @@ void ConnectionMonitorCore::init() {
 	fpDeb_ = snn_->getLogFpDeb();
 	fpLog_ = snn_->getLogFpLog();
 
-	// init weight matrix with right dimensions
-	for (int i = 0; i < nNeurPre_; i++) {
-		std::vector<float> wt;
-		for (int j = 0; j < nNeurPost_; j++) {
-			wt.push_back(NAN);
-		}
-		wtMat_.push_back(wt);
-		wtMatLast_.push_back(wt);
-	}
+	// find all synapses of the connection, there are no weights yet
+	snn_->getWeightsSparse(connId_, synPreIds_, synPostIds_, wt_);
+	wt_.assign(wt_.size(), NAN);
+	wtLast_ = wt_;
 
-	// then load current weigths from SNN into weight matrix
+	// then load current weigths from SNN
 	updateStoredWeights();
+
+	needToInit_ = false;
 }
 
 ConnectionMonitorCore::~ConnectionMonitorCore() {
@@ -123,7 +121,7 @@ ConnectionMonitorCore::~ConnectionMonitorCore() {
 		if (connFileTimeIntervalSec_ > 0) {
 			// make sure SNN is not already deallocated!
 			assert(snn_!=NULL);
-			writeConnectFileSnapshot(snn_->getSimTime(), snn_->getWeightMatrix2D(connId_));
+			writeConnectFileSnapshot(snn_->getSimTime());
 		}
 
 		// then close file and clean up
@@ -139,35 +137,51 @@ ConnectionMonitorCore::~ConnectionMonitorCore() {
 // calculate weight changes since last update (element-wise )
 std::vector< std::vector<float> > ConnectionMonitorCore::calcWeightChanges() {
 	updateStoredWeights();
-	std::vector< std::vector<float> > wtChange(nNeurPre_, std::vector<float>(nNeurPost_));
+	std::vector< std::vector<float> > wtChange(nNeurPre_, std::vector<float>(nNeurPost_, NAN));
 
-	// take the naive approach for now
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			wtChange[i][j] = wtMat_[i][j] - wtMatLast_[i][j];
-		}
+	std::vector<float> wtChangeSparse;
+	calcWeightChangesSparse(wtChangeSparse);
+	for (int i=0; i<wtChangeSparse.size(); i++) {
+		wtChange[synPreIds_[i]][synPostIds_[i]] = wtChangeSparse[i];
 	}
 
 	return wtChange;
 }
 
+// calculate weight changes since last update (per synapse)
+std::vector<float> ConnectionMonitorCore::calcWeightChangesSparse() {
+	updateStoredWeights();
+	std::vector<float> wtChange;
+	calcWeightChangesSparse(wtChange);
+	return wtChange;
+}
 
-// reset weight matrix
-void ConnectionMonitorCore::clear() {
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			wtMat_[i][j] = NAN;
-			wtMatLast_[i][j] = NAN;
-		}
+void ConnectionMonitorCore::calcWeightChangesSparse(std::vector<float>& wtChange) {
+	wtChange.resize(wt_.size());
+	for (int i=0; i<wt_.size(); i++) {
+		wtChange[i] = wt_[i] - wtLast_[i];
 	}
 }
 
+
+// reset weights
+void ConnectionMonitorCore::clear() {
+	wt_.assign(wt_.size(), NAN);
+	wtLast_.assign(wtLast_.size(), NAN);
+}
+
+// bytes held by the synapse lists and weight snapshots
+size_t ConnectionMonitorCore::getMemoryUsage() {
+	return (synPreIds_.capacity() + synPostIds_.capacity()) * sizeof(int)
+		+ (wt_.capacity() + wtLast_.capacity() + wtWritten_.capacity()) * sizeof(float);
+}
+
 // find number of incoming synapses for a specific post neuron
 int ConnectionMonitorCore::getFanIn(int neurPostId) {
 	assert(neurPostId<nNeurPost_);
 	int nSyn = 0;
-	for (int i=0; i<nNeurPre_; i++) {
-		if (!isnan(wtMat_[i][neurPostId])) {
+	for (int i=0; i<synPostIds_.size(); i++) {
+		if (synPostIds_[i] == neurPostId) {
 			nSyn++;
 		}
 	}
@@ -178,8 +192,8 @@ int ConnectionMonitorCore::getFanIn(int neurPostId) {
 int ConnectionMonitorCore::getFanOut(int neurPreId) {
 	assert(neurPreId<nNeurPre_);
 	int nSyn = 0;
-	for (int j=0; j<nNeurPost_; j++) {
-		if (!isnan(wtMat_[neurPreId][j])) {
+	for (int i=0; i<synPreIds_.size(); i++) {
+		if (synPreIds_[i] == neurPreId) {
 			nSyn++;
 		}
 	}
@@ -192,15 +206,9 @@ float ConnectionMonitorCore::getMaxWeight(bool getCurrent) {
 		updateStoredWeights();
 
 		// find currently largest weight value
-		for (int i=0; i<nNeurPre_; i++) {
-			for (int j=0; j<nNeurPost_; j++) {
-				// skip entries in matrix where no synapse exists
-				if (isnan(wtMat_[i][j]))
-					continue;
-
-				if (wtMat_[i][j] > maxVal) {
-					maxVal = wtMat_[i][j];
-				}
+		for (int i=0; i<wt_.size(); i++) {
+			if (wt_[i] > maxVal) {
+				maxVal = wt_[i];
 			}
 		}
 	} else {
@@ -216,16 +224,10 @@ float ConnectionMonitorCore::getMinWeight(bool getCurrent) {
 	if (getCurrent) {
 		updateStoredWeights();
 
-		// find currently largest weight value
-		for (int i=0; i<nNeurPre_; i++) {
-			for (int j=0; j<nNeurPost_; j++) {
-				// skip entries in matrix where no synapse exists
-				if (isnan(wtMat_[i][j]))
-					continue;
-
-				if (wtMat_[i][j] < minVal) {
-					minVal = wtMat_[i][j];
-				}
+		// find currently smallest weight value
+		for (int i=0; i<wt_.size(); i++) {
+			if (wt_[i] < minVal) {
+				minVal = wt_[i];
 			}
 		}
 	} else {
@@ -239,18 +241,12 @@ float ConnectionMonitorCore::getMinWeight(bool getCurrent) {
 // find number of synapses whose weights changed
 int ConnectionMonitorCore::getNumWeightsChanged(double minAbsChange) {
 	assert(minAbsChange>=0.0);
-	std::vector< std::vector<float> > wtChange = calcWeightChanges();
+	std::vector<float> wtChange = calcWeightChangesSparse();
 
 	int nChanged = 0;
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			// skip entries in matrix where no synapse exists
-			if (isnan(wtMat_[i][j]))
-				continue;
-
-			if (fabs(wtChange[i][j]) >= minAbsChange) {
-				nChanged++;
-			}
+	for (int i=0; i<wtChange.size(); i++) {
+		if (fabs(wtChange[i]) >= minAbsChange) {
+			nChanged++;
 		}
 	}
 	return nChanged;
@@ -268,15 +264,9 @@ int ConnectionMonitorCore::getNumWeightsInRange(double minVal, double maxVal) {
 	}
 
 	int cnt = 0;
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			// skip entries in matrix where no synapse exists
-			if (isnan(wtMat_[i][j]))
-				continue;
-
-			if (wtMat_[i][j]>=minVal && wtMat_[i][j]<=maxVal) {
-				cnt++;
-			}
+	for (int i=0; i<wt_.size(); i++) {
+		if (wt_[i]>=minVal && wt_[i]<=maxVal) {
+			cnt++;
 		}
 	}
 
@@ -295,21 +285,20 @@ int ConnectionMonitorCore::getNumWeightsWithValue(double value) {
 
 // calculate total absolute amount of weight change
 double ConnectionMonitorCore::getTotalAbsWeightChange() {
-	std::vector< std::vector<float> > wtChange = calcWeightChanges();
+	std::vector<float> wtChange = calcWeightChangesSparse();
 	double wtTotalChange = 0.0;
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			// skip entries in matrix where no synapse exists
-			if (isnan(wtMat_[i][j]))
-				continue;
-			wtTotalChange += fabs(wtChange[i][j]);
-		}
+	for (int i=0; i<wtChange.size(); i++) {
+		// skip synapses that had no weight in the last snapshot
+		if (isnan(wtChange[i]))
+			continue;
+		wtTotalChange += fabs(wtChange[i]);
 	}
 	return wtTotalChange;
 }
 
 void ConnectionMonitorCore::print() {
 	updateStoredWeights();
+	std::vector< std::vector<float> > wtMat = snn_->getWeightMatrix2D(connId_);
 
 	KERNEL_INFO("(t=%.3fs) ConnectionMonitor ID=%d: %d(%s) => %d(%s)",
 		(getTimeMsCurrentSnapshot()/1000.0f), connId_,
@@ -331,8 +320,8 @@ void ConnectionMonitorCore::print() {
 		std::stringstream line;
 		line << std::setw(9) << std::setfill(' ') << i << " |";
 		for (int j=0; j<nNeurPost_; j++) {
-			line << std::fixed << std::setprecision(4) << (isnan(wtMat_[i][j])?"      ":(wtMat_[i][j]>=0?"   ":"  "))
-				<< wtMat_[i][j]  << "  ";
+			line << std::fixed << std::setprecision(4) << (isnan(wtMat[i][j])?"      ":(wtMat[i][j]>=0?"   ":"  "))
+				<< wtMat[i][j]  << "  ";
 		}
 		KERNEL_INFO("%s",line.str().c_str());
 	}
@@ -344,12 +333,12 @@ void ConnectionMonitorCore::printSparse(int neurPostId, int maxConn, int connPer
 	assert(connPerLine>0);
 
 	// give the option of not storing the new snapshot
-	std::vector< std::vector<float> > wtNew, wtOld;
+	std::vector<float> wtNew, wtOld;
 	long int timeNew, timeOld;
 	if (!storeNewSnapshot) {
 		// make a copy of current snapshots so that we can restore them later
-		wtNew = wtMat_;
-		wtOld = wtMatLast_;
+		wtNew = wt_;
+		wtOld = wtLast_;
 		timeNew = wtTime_;
 		timeOld = wtTimeLast_;
 	}
@@ -369,33 +358,39 @@ void ConnectionMonitorCore::printSparse(int neurPostId, int maxConn, int connPer
 		postZ = neurPostId;
 	}
 
-	std::vector< std::vector<float> > wtChange;
+	std::vector<float> wtChange;
 	if (isPlastic_) {
-		wtChange = calcWeightChanges();
+		calcWeightChangesSparse(wtChange);
 	}
 
 	std::stringstream line;
 	int nConn = 0;
 	int maxIntDigits = ceil(log10((double)std::max(nNeurPre_,nNeurPost_)));
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j = postA; j <= postZ; j++) {
-			// display only so many connections
-			if (nConn>=maxConn)
-				break;
-
-			if (!isnan(wtMat_[i][j])) {
-				line << "[" << std::setw(maxIntDigits) << i << "," << std::setw(maxIntDigits) << j << "] "
-					<< std::fixed << std::setprecision(4) << wtMat_[i][j];
-				if (isPlastic_) {
-					line << " (" << ((wtChange[i][j]<0)?"":"+");
-					line << std::setprecision(4) << wtChange[i][j] << ")";
-				}
-				line << "   ";
-				if (!(++nConn % connPerLine)) {
-					KERNEL_INFO("%s",line.str().c_str());
-					line.str(std::string());
-				}
-			}
+	// list synapses sorted by pre-synaptic and then post-synaptic neuron ID
+	std::vector< std::pair<std::pair<int,int>, int> > synOrder;
+	for (int k=0; k<wt_.size(); k++) {
+		if (synPostIds_[k] >= postA && synPostIds_[k] <= postZ) {
+			synOrder.push_back(std::make_pair(std::make_pair(synPreIds_[k], synPostIds_[k]), k));
+		}
+	}
+	std::sort(synOrder.begin(), synOrder.end());
+
+	for (int s=0; s<synOrder.size(); s++) {
+		// display only so many connections
+		if (nConn>=maxConn)
+			break;
+
+		int i = synOrder[s].first.first, j = synOrder[s].first.second, k = synOrder[s].second;
+		line << "[" << std::setw(maxIntDigits) << i << "," << std::setw(maxIntDigits) << j << "] "
+			<< std::fixed << std::setprecision(4) << wt_[k];
+		if (isPlastic_) {
+			line << " (" << ((wtChange[k]<0)?"":"+");
+			line << std::setprecision(4) << wtChange[k] << ")";
+		}
+		line << "   ";
+		if (!(++nConn % connPerLine)) {
+			KERNEL_INFO("%s",line.str().c_str());
+			line.str(std::string());
 		}
 	}
 	// flush
@@ -403,8 +398,8 @@ void ConnectionMonitorCore::printSparse(int neurPostId, int maxConn, int connPer
 		KERNEL_INFO("%s",line.str().c_str());
 
 	if (!storeNewSnapshot) {
-		wtMat_ = wtNew;
-		wtMatLast_ = wtOld;
+		wt_ = wtNew;
+		wtLast_ = wtOld;
 		wtTime_ = timeNew;
 		wtTimeLast_ = timeOld;
 	}
@@ -437,10 +432,10 @@ void ConnectionMonitorCore::setUpdateTimeIntervalSec(int intervalSec) {
 void ConnectionMonitorCore::updateStoredWeights() {
 	if (snn_->getSimTime() > wtTime_) {
 		// time has advanced: get new weights
-		wtMatLast_ = wtMat_;
+		wtLast_.swap(wt_);
 		wtTimeLast_ = wtTime_;
 
-		wtMat_ = snn_->getWeightMatrix2D(connId_);
+		snn_->getWeightsSparse(connId_, synPreIds_, synPostIds_, wt_);
 		wtTime_ = snn_->getSimTime();
 	}
 }
@@ -448,8 +443,23 @@ void ConnectionMonitorCore::updateStoredWeights() {
 // returns a current snapshot
 std::vector< std::vector<float> > ConnectionMonitorCore::takeSnapshot() {
 	updateStoredWeights();
-	writeConnectFileSnapshot(wtTime_, wtMat_);
-	return wtMat_;
+	writeConnectFileWeights(wtTime_, wt_);
+
+	std::vector< std::vector<float> > wtMat(nNeurPre_, std::vector<float>(nNeurPost_, NAN));
+	for (int i=0; i<wt_.size(); i++) {
+		wtMat[synPreIds_[i]][synPostIds_[i]] = wt_[i];
+	}
+	return wtMat;
+}
+
+// returns a current snapshot in coordinate format
+void ConnectionMonitorCore::takeSnapshotSparse(std::vector<int>& preIds, std::vector<int>& postIds,
+	std::vector<float>& weights) {
+	updateStoredWeights();
+	writeConnectFileWeights(wtTime_, wt_);
+	preIds = synPreIds_;
+	postIds = synPostIds_;
+	weights = wt_;
 }
 
 // write the header section of the spike file
@@ -511,10 +521,49 @@ void ConnectionMonitorCore::writeConnectFileHeader() {
 
 	// \TODO: write delays
 
+	if (connFileFormat_ != CONNECT_FILE_DENSE) {
+		writeConnectFileSynapses();
+	}
+
 	needToWriteFileHeader_ = false;
 }
 
-void ConnectionMonitorCore::writeConnectFileSnapshot(int simTimeMs, std::vector< std::vector<float> > wts) {
+// write the synapse list of a sparse connect file (right after the header section)
+void ConnectionMonitorCore::writeConnectFileSynapses() {
+	// write whether snapshots contain only the weights that changed
+	int isDelta = (connFileFormat_ == CONNECT_FILE_SPARSE_DELTA) ? 1 : 0;
+	if (!fwrite(&isDelta,sizeof(int),1,connFileId_))
+		KERNEL_ERROR("ConnectionMonitor: writeConnectFileSynapses has fwrite error");
+
+	// write number of synapses, then all pre-synaptic and all post-synaptic neuron IDs
+	int nSyn = synPreIds_.size();
+	if (!fwrite(&nSyn,sizeof(int),1,connFileId_))
+		KERNEL_ERROR("ConnectionMonitor: writeConnectFileSynapses has fwrite error");
+	if (nSyn > 0) {
+		if (fwrite(&synPreIds_[0],sizeof(int),nSyn,connFileId_) != nSyn)
+			KERNEL_ERROR("ConnectionMonitor: writeConnectFileSynapses has fwrite error");
+		if (fwrite(&synPostIds_[0],sizeof(int),nSyn,connFileId_) != nSyn)
+			KERNEL_ERROR("ConnectionMonitor: writeConnectFileSynapses has fwrite error");
+	}
+
+	// nothing written yet: the first delta snapshot contains all weights
+	wtWritten_.assign(nSyn, NAN);
+}
+
+void ConnectionMonitorCore::writeConnectFileSnapshot(int simTimeMs) {
+	// don't fetch weights if we have already written this timestamp to file (or file doesn't exist)
+	if ((long long)simTimeMs <= wtTimeWrite_ || connFileId_==NULL) {
+		return;
+	}
+
+	// the stored snapshots (current and last) are not affected
+	std::vector<int> preIds, postIds;
+	std::vector<float> wts;
+	snn_->getWeightsSparse(connId_, preIds, postIds, wts);
+	writeConnectFileWeights(simTimeMs, wts);
+}
+
+void ConnectionMonitorCore::writeConnectFileWeights(int simTimeMs, const std::vector<float>& wts) {
 	// don't write if we have already written this timestamp to file (or file doesn't exist)
 	if ((long long)simTimeMs <= wtTimeWrite_ || connFileId_==NULL) {
 		return;
@@ -526,12 +575,38 @@ void ConnectionMonitorCore::writeConnectFileSnapshot(int simTimeMs, std::vector<
 	if (!fwrite(&wtTimeWrite_,sizeof(long long),1,connFileId_))
 		KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
 
-	// write all weights
-	for (int i=0; i<nNeurPre_; i++) {
-		for (int j=0; j<nNeurPost_; j++) {
-			if (!fwrite(&wts[i][j],sizeof(float),1,connFileId_)) {
-				KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
+	int nSyn = wts.size();
+	if (connFileFormat_ == CONNECT_FILE_DENSE) {
+		// write all weights of the pre x post matrix, non-existent synapses are NAN
+		std::vector<float> wtMat(nNeurPre_*nNeurPost_, NAN);
+		for (int i=0; i<nSyn; i++) {
+			wtMat[synPreIds_[i]*nNeurPost_ + synPostIds_[i]] = wts[i];
+		}
+		if (fwrite(&wtMat[0],sizeof(float),wtMat.size(),connFileId_) != wtMat.size())
+			KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
+	} else if (connFileFormat_ == CONNECT_FILE_SPARSE) {
+		// write one weight per synapse
+		if (nSyn > 0 && fwrite(&wts[0],sizeof(float),nSyn,connFileId_) != nSyn)
+			KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
+	} else {
+		// write the number of changed weights, then their synapse indices and weights
+		std::vector<int> synIds;
+		std::vector<float> synWts;
+		for (int i=0; i<nSyn; i++) {
+			if (!(wts[i] == wtWritten_[i])) {
+				synIds.push_back(i);
+				synWts.push_back(wts[i]);
+				wtWritten_[i] = wts[i];
 			}
 		}
+		int nChanged = synIds.size();
+		if (!fwrite(&nChanged,sizeof(int),1,connFileId_))
+			KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
+		if (nChanged > 0) {
+			if (fwrite(&synIds[0],sizeof(int),nChanged,connFileId_) != nChanged)
+				KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
+			if (fwrite(&synWts[0],sizeof(float),nChanged,connFileId_) != nChanged)
+				KERNEL_ERROR("ConnectionMonitor: writeConnectFileSnapshot has fwrite error");
+		}
 	}
 }
@@ -51,6 +51,7 @@
 #include <stdio.h>					// FILE
 #include <vector>					// std::vector
 #include <carlsim_definitions.h>	// ALL
+#include <carlsim_datastructures.h>	// ConnectFileFormat
 
 class SNN; // forward declaration of SNN class
 
@@ -78,6 +79,9 @@ public:
 	//! calculates weight changes since last snapshot and reports them in 2D weight change matrix
 	std::vector< std::vector<float> > calcWeightChanges();
 
+	//! calculates weight changes since last snapshot and reports them per synapse (see takeSnapshotSparse)
+	std::vector<float> calcWeightChangesSparse();
+
 	//! returns connection ID
 	short int getConnectId() { return connId_; }
 
@@ -100,6 +104,9 @@ public:
 	//! returns ConnectionMonitor ID
 	int getMonitorId() { return monitorId_; }
 
+	//! returns the number of bytes held by the weight snapshots of the ConnectionMonitor
+	size_t getMemoryUsage();
+
 	//! returns number of neurons in pre-synaptic group
 	int getNumNeuronsPre() { return nNeurPre_; }
 
@@ -144,6 +151,10 @@ public:
 	//! weight: 0.0f).
 	std::vector< std::vector<float> > takeSnapshot();
 
+	//! takes snapshot of current weight state and returns it in coordinate format (pre ID, post ID, weight) of
+	//! only the existing synapses
+	void takeSnapshotSparse(std::vector<int>& preIds, std::vector<int>& postIds, std::vector<float>& weights);
+
 
 	// +++++ PUBLIC METHODS THAT SHOULD NOT BE EXPOSED TO INTERFACE +++++++++//
 
@@ -166,10 +177,19 @@ public:
 	//! sets time update interval (seconds) for periodically storing weights to file
 	void setUpdateTimeIntervalSec(int intervalSec);
 
-	//! writes each snapshot to connect file
-	void writeConnectFileSnapshot(int simTimeMs, std::vector< std::vector<float> > wts);
+	//! writes the current weights to connect file as a snapshot with timestamp simTimeMs
+	void writeConnectFileSnapshot(int simTimeMs);
 	
 private:
+	//! returns the weight changes since last snapshot per synapse (after the snapshot has been updated)
+	void calcWeightChangesSparse(std::vector<float>& wtChange);
+
+	//! writes a snapshot of weights wts (one per synapse) to connect file
+	void writeConnectFileWeights(int simTimeMs, const std::vector<float>& wts);
+
+	//! writes the list of synapses (pre and post neuron IDs) of a sparse connect file
+	void writeConnectFileSynapses();
+
 	//! indicates whether writing the current snapshot is necessary (false it has already been written)
 	bool needToWriteSnapshot();
 
@@ -192,8 +212,12 @@ private:
 
 	bool isPlastic_; //!< whether this connection has plastic synapses
 
-	std::vector< std::vector<float> > wtMat_;      //!< current snapshot of weight matrix
-	std::vector< std::vector<float> > wtMatLast_;  //!< last snapshot of weight matrix
+	// the synapses of the connection in the order the kernel stores them (see SNN::getWeightsSparse)
+	std::vector<int> synPreIds_;    //!< pre-synaptic neuron ID of every synapse
+	std::vector<int> synPostIds_;   //!< post-synaptic neuron ID of every synapse
+	std::vector<float> wt_;         //!< current snapshot of weights (one per synapse)
+	std::vector<float> wtLast_;     //!< last snapshot of weights (one per synapse)
+	std::vector<float> wtWritten_;  //!< weights of the last snapshot written to a sparse delta connect file
 	long long wtTime_;
 	long long wtTimeLast_;
 	long long wtTimeWrite_;
@@ -204,6 +228,7 @@ private:
 	FILE* connFileId_;              //!< file pointer to the conn file or NULL
 	int connFileSignature_;         //!< int signature of conn file
 	float connFileVersion_;         //!< version number of conn file
+	ConnectFileFormat connFileFormat_; //!< format of conn file (dense weight matrix or sparse)
 	int connFileTimeIntervalSec_;   //!< time update interval (seconds) for storing weights to file
 
 	const FILE* fpInf_;             //!< file pointer for info logging
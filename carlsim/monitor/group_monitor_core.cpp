@@ -49,6 +49,7 @@
 
 #include <snn.h>				// CARLsim private implementation
 #include <snn_definitions.h>	// KERNEL_ERROR, KERNEL_INFO, ...
+#include <spike_file_writer.h>	// SpikeFileWriter
 
 #include <algorithm>			// std::sort
 
@@ -66,7 +67,9 @@ GroupMonitorCore::GroupMonitorCore(SNN* snn, int monitorId, int grpId) {
 
 	needToWriteFileHeader_ = true;
 	groupFileSignature_ = 206661989;
-	groupFileVersion_ = 0.2f;
+	groupFileVersion_ = 0.3f;
+	groupFileStreamId_ = -1;
+	chunkFirstTime_ = -1;
 
 	// defer all unsafe operations to init function
 	init();
@@ -87,6 +90,7 @@ void GroupMonitorCore::init() {
 
 GroupMonitorCore::~GroupMonitorCore() {
 	if (groupFileId_ != NULL) {
+		closeGroupFileStream();
 		fclose(groupFileId_);
 		groupFileId_ = NULL;
 	}
@@ -107,6 +111,10 @@ void GroupMonitorCore::clear() {
 	dataVector_.clear();
 }
 
+size_t GroupMonitorCore::getMemoryUsage() {
+	return (chunk_.capacity() + dataVector_.capacity()) * sizeof(float) + timeVector_.capacity() * sizeof(int);
+}
+
 void GroupMonitorCore::pushData(int time, float data) {
 	assert(isRecording());
 
@@ -234,9 +242,44 @@ void GroupMonitorCore::setGroupFileId(FILE* groupFileId) {
 		// for now: file pointer has changed, so we need to write header (again)
 		needToWriteFileHeader_ = true;
 		writeGroupFileHeader();
+
+		// from now on, group data is written asynchronously by the spike file writer of the network
+		groupFileStreamId_ = snn_->getSpikeFileWriter()->open(groupFileId_);
 	}
 }
 
+void GroupMonitorCore::pushFileData(int time, float data) {
+	assert(groupFileStreamId_ >= 0);
+	assert(chunk_.empty() || time == chunkFirstTime_ + (int)chunk_.size());
+
+	if (chunk_.empty())
+		chunkFirstTime_ = time;
+	chunk_.push_back(data);
+}
+
+// a chunk is (int time of first entry, int number of entries), followed by one float per entry (dopamine)
+void GroupMonitorCore::writeFileChunk() {
+	if (chunk_.empty())
+		return;
+
+	SpikeFileWriter* writer = snn_->getSpikeFileWriter();
+	int header[2] = {chunkFirstTime_, (int)chunk_.size()};
+	writer->appendBlock(groupFileStreamId_, header, sizeof(header));
+	writer->appendBlock(groupFileStreamId_, &chunk_[0], sizeof(float) * chunk_.size());
+	chunk_.clear();
+}
+
+// writes the group data that is still buffered before the group data file is closed
+void GroupMonitorCore::closeGroupFileStream() {
+	if (groupFileStreamId_ < 0)
+		return;
+
+	writeFileChunk();
+	if (!snn_->getSpikeFileWriter()->close(groupFileStreamId_))
+		KERNEL_ERROR("GroupMonitorCore: could not write group data file");
+	groupFileStreamId_ = -1;
+}
+
 // write the header section of the group data file
 // this should be done once per file, and should be the very first entries in the file
 void GroupMonitorCore::writeGroupFileHeader() {
@@ -265,6 +308,10 @@ void GroupMonitorCore::writeGroupFileHeader() {
 	if (!fwrite(&tmpInt,sizeof(int),1,groupFileId_))
 		KERNEL_ERROR("GroupMonitorCore: writeGroupFileHeader has fwrite error");
 
+	// write number of values per time step (dopamine concentration for now)
+	tmpInt = 1;
+	if (!fwrite(&tmpInt,sizeof(int),1,groupFileId_))
+		KERNEL_ERROR("GroupMonitorCore: writeGroupFileHeader has fwrite error");
 
 	needToWriteFileHeader_ = false;
 }
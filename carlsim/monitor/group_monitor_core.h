@@ -133,11 +133,20 @@ public:
 	//! deletes the data vector
 	void clear();
 
+	//! returns the number of bytes held by the buffers of the GroupMonitor (including reserved capacity)
+	size_t getMemoryUsage();
+
 	//! returns a pointer to the group data file
 	FILE* getGroupFileId() { return groupFileId_; }
 
 	//! sets pointer to group data file
 	void setGroupFileId(FILE* groupFileId);
+
+	//! appends group data (time, value) to the current chunk of the group data file
+	void pushFileData(int time, float data);
+
+	//! hands the current chunk to the spike file writer of the network, which writes it to the group data file
+	void writeFileChunk();
 	
 	//! returns timestamp of last GroupMonitor update
 	int getLastUpdated() { return grpMonLastUpdated_; }
@@ -152,6 +161,9 @@ private:
 	//! writes the header section (file signature, version number) of a group data file
 	void writeGroupFileHeader();
 
+	//! writes the remaining chunk before the group data file is closed
+	void closeGroupFileStream();
+
 	//! whether we have to write header section of group data file
 	bool needToWriteFileHeader_;
 
@@ -163,6 +175,10 @@ private:
 	FILE* groupFileId_;	//!< file pointer to the group data file or NULL
 	int groupFileSignature_; //!< int signature of group data file
 	float groupFileVersion_; //!< version number of group data file
+	int groupFileStreamId_;  //!< stream of the group data file in the spike file writer, -1 if there is no file
+
+	std::vector<float> chunk_; //!< group data of consecutive time steps that have not been written yet
+	int chunkFirstTime_;       //!< time (ms) of the first entry in chunk_
 
 	//! Used for analyzing the group data (only support dopamine concentration for now)
 	std::vector<int> timeVector_;
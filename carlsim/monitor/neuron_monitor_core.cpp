@@ -50,6 +50,7 @@
 
 #include <snn.h>				// CARLsim private implementation
 #include <snn_definitions.h>	// KERNEL_ERROR, KERNEL_INFO, ...
+#include <spike_file_writer.h>	// SpikeFileWriter
 
 #include <algorithm>			// std::sort
 
@@ -67,6 +68,10 @@ NeuronMonitorCore::NeuronMonitorCore(SNN* snn, int monitorId, int grpId) {
 	needToWriteFileHeader_ = true;
     neuronFileSignature_ = 206661979;
 	neuronFileVersion_ = 0.2f;
+	neuronFileStreamId_ = -1;
+	samplingStrideMs_ = 0;
+	sampleBlockFirstTime_ = -1;
+	sampleBlockNumSamples_ = 0;
 
 	// defer all unsafe operations to init function
 	init();
@@ -92,6 +97,7 @@ void NeuronMonitorCore::init() {
 
 NeuronMonitorCore::~NeuronMonitorCore() {
 	if (neuronFileId_!=NULL) {
+		closeNeuronFileStream();
 		fclose(neuronFileId_);
 		neuronFileId_ = NULL;
 	}
@@ -179,6 +185,7 @@ void NeuronMonitorCore::setNeuronFileId(FILE* neuronFileId) {
 
 	// close previous file pointer if exists
 	if (neuronFileId_!=NULL) {
+		closeNeuronFileStream();
 		fclose(neuronFileId_);
 		neuronFileId_ = NULL;
 	}
@@ -192,9 +199,82 @@ void NeuronMonitorCore::setNeuronFileId(FILE* neuronFileId) {
 		// file pointer has changed, so we need to write header (again)
 		needToWriteFileHeader_ = true;
 		writeNeuronFileHeader();
+
+		// samples are written asynchronously by the spike file writer of the network
+		if (isSampling())
+			neuronFileStreamId_ = snn_->getSpikeFileWriter()->open(neuronFileId_);
+	}
+}
+
+void NeuronMonitorCore::setSampling(const std::vector<int>& neurIds, int strideMs) {
+	assert(!isRecording());
+	assert(strideMs > 0);
+
+	sampledNeurIds_ = neurIds;
+	if (sampledNeurIds_.empty()) {
+		for (int i = 0; i < nNeurons_; i++)
+			sampledNeurIds_.push_back(i);
+	}
+	std::sort(sampledNeurIds_.begin(), sampledNeurIds_.end());
+	sampledNeurIds_.erase(std::unique(sampledNeurIds_.begin(), sampledNeurIds_.end()), sampledNeurIds_.end());
+	assert(sampledNeurIds_.front() >= 0 && sampledNeurIds_.back() < nNeurons_);
+
+	samplingStrideMs_ = strideMs;
+	neuronFileVersion_ = 0.3f;
+	sampleBlock_.clear();
+	sampleBlockNumSamples_ = 0;
+
+	if (neuronFileId_ != NULL) {
+		// only the header has been written so far, replace it by one that lists the sampled neurons
+		closeNeuronFileStream();
+		fseek(neuronFileId_, 0, SEEK_SET);
+		needToWriteFileHeader_ = true;
+		writeNeuronFileHeader();
+		neuronFileStreamId_ = snn_->getSpikeFileWriter()->open(neuronFileId_);
+	}
+}
+
+void NeuronMonitorCore::pushSample(int time, const float* v, const float* u, const float* I) {
+	if (neuronFileStreamId_ < 0)
+		return;
+
+	if (!sampleBlockNumSamples_)
+		sampleBlockFirstTime_ = time;
+	sampleBlockNumSamples_++;
+
+	const float* state[3] = {v, u, I};
+	for (int s = 0; s < 3; s++) {
+		for (size_t i = 0; i < sampledNeurIds_.size(); i++)
+			sampleBlock_.push_back(state[s][i]);
 	}
 }
 
+// a block is (int time of first sample, int number of samples), followed by v, u, and I of all sampled neurons for
+// each sample
+void NeuronMonitorCore::writeSampleBlock() {
+	if (!sampleBlockNumSamples_)
+		return;
+
+	SpikeFileWriter* writer = snn_->getSpikeFileWriter();
+	int header[2] = {sampleBlockFirstTime_, sampleBlockNumSamples_};
+	writer->appendBlock(neuronFileStreamId_, header, sizeof(header));
+	writer->appendBlock(neuronFileStreamId_, &sampleBlock_[0], sizeof(float) * sampleBlock_.size());
+
+	sampleBlock_.clear();
+	sampleBlockNumSamples_ = 0;
+}
+
+// writes the samples that are still buffered before the neuron state file is closed
+void NeuronMonitorCore::closeNeuronFileStream() {
+	if (neuronFileStreamId_ < 0)
+		return;
+
+	writeSampleBlock();
+	if (!snn_->getSpikeFileWriter()->close(neuronFileStreamId_))
+		KERNEL_ERROR("NeuronMonitorCore: could not write neuron state file");
+	neuronFileStreamId_ = -1;
+}
+
 // write the header section of the neuron state file
 void NeuronMonitorCore::writeNeuronFileHeader() {
 	if (!needToWriteFileHeader_)
@@ -222,6 +302,18 @@ void NeuronMonitorCore::writeNeuronFileHeader() {
 	if (!fwrite(&tmpInt,sizeof(int),1,neuronFileId_))
 		KERNEL_ERROR("NeuronMonitorCore: writeNeuronFileHeader has fwrite error");
 
+	// a sampling NeuronMonitor lists the sampling interval and the sampled neurons
+	if (isSampling()) {
+		tmpInt = sampledNeurIds_.size();
+		if (!fwrite(&tmpInt,sizeof(int),1,neuronFileId_))
+			KERNEL_ERROR("NeuronMonitorCore: writeNeuronFileHeader has fwrite error");
+
+		if (!fwrite(&samplingStrideMs_,sizeof(int),1,neuronFileId_))
+			KERNEL_ERROR("NeuronMonitorCore: writeNeuronFileHeader has fwrite error");
+
+		if (fwrite(&sampledNeurIds_[0],sizeof(int),sampledNeurIds_.size(),neuronFileId_) != sampledNeurIds_.size())
+			KERNEL_ERROR("NeuronMonitorCore: writeNeuronFileHeader has fwrite error");
+	}
 
 	needToWriteFileHeader_ = false;
 }
@@ -234,6 +326,19 @@ long int NeuronMonitorCore::getBufferSize(){
     return 3 * bufferSize;
 }
 
+// counts the capacity of all buffers, which is what the state vectors actually occupy
+size_t NeuronMonitorCore::getMemoryUsage() {
+	size_t bytes = (vectorV_.capacity() + vectorU_.capacity() + vectorI_.capacity()) * sizeof(std::vector<float>);
+	for (int i = 0; i < vectorV_.size(); i++)
+		bytes += vectorV_[i].capacity() * sizeof(float);
+	for (int i = 0; i < vectorU_.size(); i++)
+		bytes += vectorU_[i].capacity() * sizeof(float);
+	for (int i = 0; i < vectorI_.size(); i++)
+		bytes += vectorI_[i].capacity() * sizeof(float);
+	bytes += sampleBlock_.capacity() * sizeof(float) + sampledNeurIds_.capacity() * sizeof(int);
+	return bytes;
+}
+
 // check if the state vector is getting large. If it is, return true once until
 // stopRecording is called.
 bool NeuronMonitorCore::isBufferBig(){
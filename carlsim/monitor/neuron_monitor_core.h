@@ -89,6 +89,35 @@ public:
 	//! returns a pointer to the neuron state file
 	FILE* getNeuronFileId() { return neuronFileId_; }
 
+	/*!
+	 * \brief streams the state of a subset of neurons to the neuron state file every strideMs ms
+	 *
+	 * The header of the neuron state file is rewritten (version 0.3) to list the sampled neurons. Samples are only
+	 * written to the file, they are not kept in the state vectors.
+	 * \param[in] neurIds neuron IDs (0-indexed within the group) to sample, or an empty vector for all neurons
+	 * \param[in] strideMs sampling interval (ms)
+	 */
+	void setSampling(const std::vector<int>& neurIds, int strideMs);
+
+	//! returns true if the NeuronMonitor streams a subset of neurons (see setSampling)
+	bool isSampling() { return samplingStrideMs_ > 0; }
+
+	//! returns the sampled neuron IDs in ascending order
+	const std::vector<int>& getSampledNeurIds() { return sampledNeurIds_; }
+
+	//! returns the sampling interval (ms)
+	int getSamplingStride() { return samplingStrideMs_; }
+
+	/*!
+	 * \brief adds the state of all sampled neurons at a time step to the current sample block
+	 *
+	 * \param[in] v,u,I state of the sampled neurons at time (ms), in the order of getSampledNeurIds()
+	 */
+	void pushSample(int time, const float* v, const float* u, const float* I);
+
+	//! hands the current sample block to the spike file writer of the network
+	void writeSampleBlock();
+
     //! returns timestamp of last NeuronMonitor update
 	long int getLastUpdated() { return neuronMonLastUpdated_; }
 
@@ -101,6 +130,9 @@ public:
     //! returns the approximate size of the state vectors in bytes
     long int getBufferSize();
 
+	//! returns the number of bytes held by the buffers of the NeuronMonitor (including reserved capacity)
+	size_t getMemoryUsage();
+
     //! returns the total accumulated time
     long int getAccumTime();
 
@@ -113,6 +145,9 @@ public:
     //! initialization method
 	void init();
 
+	//! writes the remaining samples before the neuron state file is closed
+	void closeNeuronFileStream();
+
     //! whether we have to write header section of neuron file
 	bool needToWriteFileHeader_;
 
@@ -124,6 +159,13 @@ public:
 	FILE* neuronFileId_;	//!< file pointer to the neuron state file or NULL
 	int neuronFileSignature_; //!< int signature of neuron file
 	float neuronFileVersion_; //!< version number of neuron file
+	int neuronFileStreamId_;  //!< stream of the neuron state file in the spike file writer, -1 if not sampling
+
+	std::vector<int> sampledNeurIds_; //!< neuron IDs streamed by a sampling NeuronMonitor (ascending)
+	int samplingStrideMs_;            //!< sampling interval (ms), 0 if all neurons are recorded every ms
+	std::vector<float> sampleBlock_;  //!< (v, u, I) of the sampled neurons at consecutive sampling times
+	int sampleBlockFirstTime_;        //!< time (ms) of the first sample in sampleBlock_
+	int sampleBlockNumSamples_;       //!< number of samples in sampleBlock_
 
 	//! Used to analyzed the neuron state information
 	std::vector<std::vector<float> > vectorV_;
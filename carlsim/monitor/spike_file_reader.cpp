@@ -0,0 +1,514 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include <spike_file_reader.h>
+
+#include <snn_definitions.h>	// SPIKE_FILE_SIGNATURE, SPIKE_FILE_VERSION_*
+#include <user_errors.h>		// fancy user error messages
+
+#include <stdio.h>				// fopen, fread, fclose
+#include <string.h>				// memcpy
+#include <math.h>				// fabs
+#include <limits.h>				// INT_MAX
+#include <assert.h>				// assert
+
+#if defined(WIN32) || defined(WIN64)
+#include <windows.h>			// CreateFileMapping, MapViewOfFile
+#include <io.h>					// _get_osfhandle
+#else
+#include <sys/mman.h>			// mmap, madvise
+#endif
+
+
+// number of (time, neuron ID) pairs read at once from a flat spike file
+#define FLAT_RECORDS_PER_READ 4096
+
+// number of bytes of the header section that is shared by all spike file versions
+#define SPIKE_FILE_HEADER_SIZE (4*sizeof(int)+sizeof(float))
+
+// number of bytes of a chunk header: first spike time, last spike time, number of spikes, number of bytes
+#define SPIKE_FILE_CHUNK_HEADER_SIZE (4*sizeof(int))
+
+// number of bytes of an index entry: file offset, first spike time, last spike time, number of spikes
+#define SPIKE_FILE_INDEX_ENTRY_SIZE (sizeof(long long)+3*sizeof(int))
+
+// number of bytes of the index footer: file offset of the index, number of chunks, index signature
+#define SPIKE_FILE_INDEX_FOOTER_SIZE (sizeof(long long)+2*sizeof(int))
+
+
+class SpikeFileReader::Impl {
+public:
+	// +++++ PUBLIC METHODS: SETUP / TEAR-DOWN ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+	Impl(const std::string& fileName) : _fileName(fileName), _fid(NULL), _chunked(false), _numSpikes(0), _map(NULL) {
+		openFile();
+		rewind();
+	}
+
+	~Impl() {
+		unmapFile();
+		if (_fid != NULL)
+			fclose(_fid);
+		_fid = NULL;
+	}
+
+
+	// +++++ PUBLIC METHODS +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+	Grid3D getGrid3D() { return _grid; }
+	int getNumNeurons() { return _grid.N; }
+	float getVersion() { return _version; }
+	int getNumChunks() { return _chunks.size(); }
+	long long getNumSpikes() { return _numSpikes; }
+
+	void readSpikes(int startTime, int endTime, std::vector<int>& spkTimes, std::vector<int>& neurIds) {
+		if (endTime <= startTime)
+			return;
+
+		if (!_chunked) {
+			// spikes are sorted by time: bisect for the first spike of the window
+			long long lo = 0, hi = _numSpikes;
+			while (lo < hi) {
+				long long mid = lo + (hi - lo) / 2;
+				if (readFlatSpikeTime(mid) < startTime)
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+			readFlatSpikes(lo, _numSpikes, endTime, spkTimes, neurIds);
+			return;
+		}
+
+		// first chunk that can contain spikes of the window
+		int lo = 0, hi = _chunks.size();
+		while (lo < hi) {
+			int mid = lo + (hi - lo) / 2;
+			if (_chunks[mid].lastTime < startTime)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		std::vector<int> chunkTimes, chunkNeurIds;
+		for (int c = lo; c < _chunks.size() && _chunks[c].firstTime < endTime; c++) {
+			chunkTimes.clear();
+			chunkNeurIds.clear();
+			readChunk(c, chunkTimes, chunkNeurIds);
+			for (int i = 0; i < chunkTimes.size(); i++) {
+				if (chunkTimes[i] >= startTime && chunkTimes[i] < endTime) {
+					spkTimes.push_back(chunkTimes[i]);
+					neurIds.push_back(chunkNeurIds[i]);
+				}
+			}
+		}
+	}
+
+	void readNextSpikes(int endTime, std::vector<int>& spkTimes, std::vector<int>& neurIds) {
+		mapFile();
+
+		if (!_chunked) {
+			// the (time, neuron ID) pairs can be read right from the mapped file
+			const int* records = (const int*)(_map + SPIKE_FILE_HEADER_SIZE);
+			while (_cursorSpike < _numSpikes && records[2 * _cursorSpike] < endTime) {
+				spkTimes.push_back(records[2 * _cursorSpike]);
+				neurIds.push_back(records[2 * _cursorSpike + 1]);
+				_cursorSpike++;
+			}
+			return;
+		}
+
+		// the spike at the cursor is decoded ahead, it stays pending until its time is reached
+		while (_cursorPending || decodeNextSpike()) {
+			if (_cursorTime >= endTime)
+				return;
+			spkTimes.push_back(_cursorTime);
+			neurIds.push_back(_cursorNeurId);
+			_cursorPending = false;
+		}
+	}
+
+	void rewind() {
+		_cursorSpike = 0;
+		_cursorChunk = 0;
+		_cursorSpikesLeft = 0;
+		_cursorPending = false;
+	}
+
+	void readSpikes(std::vector<std::vector<int> >& spkVector) {
+		spkVector.assign(_grid.N, std::vector<int>());
+
+		// read the file piece by piece, so that only the 2D spike vector has to fit into memory
+		std::vector<int> spkTimes, neurIds;
+		int numPieces = _chunked ? _chunks.size() : (_numSpikes + FLAT_RECORDS_PER_READ - 1) / FLAT_RECORDS_PER_READ;
+		for (int p = 0; p < numPieces; p++) {
+			spkTimes.clear();
+			neurIds.clear();
+			if (_chunked) {
+				readChunk(p, spkTimes, neurIds);
+			} else {
+				long long first = (long long)p * FLAT_RECORDS_PER_READ;
+				long long last = first + FLAT_RECORDS_PER_READ < _numSpikes ? first + FLAT_RECORDS_PER_READ : _numSpikes;
+				readFlatSpikes(first, last, INT_MAX, spkTimes, neurIds);
+			}
+
+			for (int i = 0; i < spkTimes.size(); i++) {
+				UserErrors::assertTrue(neurIds[i] >= 0 && neurIds[i] < _grid.N, UserErrors::FILE_CANNOT_READ,
+					"readSpikes", _fileName + " (invalid neuron ID)");
+				spkVector[neurIds[i]].push_back(spkTimes[i]);
+			}
+		}
+	}
+
+private:
+	// +++++ PRIVATE METHODS ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+	struct Chunk {
+		long long offset; //!< file offset of the chunk header
+		int firstTime;
+		int lastTime;
+		int numSpikes;
+	};
+
+	void openFile() {
+		std::string funcName = "openFile(" + _fileName + ")";
+		_fid = fopen(_fileName.c_str(), "rb");
+		UserErrors::assertTrue(_fid != NULL, UserErrors::FILE_CANNOT_OPEN, funcName, _fileName);
+
+		// read header section
+		int signature = 0;
+		int grid[3] = {0, 0, 0};
+		_version = 0.0f;
+		bool success = fread(&signature, sizeof(int), 1, _fid) == 1;
+		success = success && fread(&_version, sizeof(float), 1, _fid) == 1;
+		success = success && fread(grid, sizeof(int), 3, _fid) == 3;
+		UserErrors::assertTrue(success && signature == SPIKE_FILE_SIGNATURE, UserErrors::FILE_CANNOT_READ, funcName,
+			_fileName + " (not a spike file)");
+		UserErrors::assertTrue(grid[0] > 0 && grid[1] > 0 && grid[2] > 0, UserErrors::FILE_CANNOT_READ, funcName,
+			_fileName + " (invalid grid dimensions)");
+		_grid = Grid3D(grid[0], grid[1], grid[2]);
+
+		if (fabs(_version - SPIKE_FILE_VERSION_CHUNKED) < 1e-4f) {
+			_chunked = true;
+		} else {
+			UserErrors::assertTrue(fabs(_version - SPIKE_FILE_VERSION_FLAT) < 1e-4f, UserErrors::FILE_CANNOT_READ,
+				funcName, _fileName + " (unknown version)");
+		}
+
+		// get data size
+		seekFile(0, SEEK_END);
+		_fileSize = tellFile();
+
+		if (!_chunked) {
+			_numSpikes = (_fileSize - SPIKE_FILE_HEADER_SIZE) / (2 * sizeof(int));
+		} else {
+			// the index is only written when the file is closed, otherwise fall back to the chunk headers
+			if (!readChunkIndex())
+				scanChunkHeaders();
+			for (int c = 0; c < _chunks.size(); c++)
+				_numSpikes += _chunks[c].numSpikes;
+		}
+	}
+
+	// reads the index at the end of a chunked spike file, returns false if there is no (valid) index
+	bool readChunkIndex() {
+		if (_fileSize < SPIKE_FILE_HEADER_SIZE + SPIKE_FILE_INDEX_FOOTER_SIZE)
+			return false;
+
+		long long indexOffset;
+		int numChunks, signature;
+		seekFile(_fileSize - SPIKE_FILE_INDEX_FOOTER_SIZE, SEEK_SET);
+		if (fread(&indexOffset, sizeof(long long), 1, _fid) != 1 || fread(&numChunks, sizeof(int), 1, _fid) != 1
+				|| fread(&signature, sizeof(int), 1, _fid) != 1)
+			return false;
+		if (signature != SPIKE_FILE_INDEX_SIGNATURE || numChunks < 0 || indexOffset < SPIKE_FILE_HEADER_SIZE
+				|| indexOffset + (long long)numChunks * SPIKE_FILE_INDEX_ENTRY_SIZE + SPIKE_FILE_INDEX_FOOTER_SIZE
+				!= _fileSize)
+			return false;
+
+		std::vector<char> index((size_t)numChunks * SPIKE_FILE_INDEX_ENTRY_SIZE);
+		seekFile(indexOffset, SEEK_SET);
+		if (numChunks > 0 && fread(&index[0], 1, index.size(), _fid) != index.size())
+			return false;
+
+		_chunks.resize(numChunks);
+		for (int c = 0; c < numChunks; c++) {
+			const char* entry = &index[(size_t)c * SPIKE_FILE_INDEX_ENTRY_SIZE];
+			memcpy(&_chunks[c].offset, entry, sizeof(long long));
+			memcpy(&_chunks[c].firstTime, entry + sizeof(long long), sizeof(int));
+			memcpy(&_chunks[c].lastTime, entry + sizeof(long long) + sizeof(int), sizeof(int));
+			memcpy(&_chunks[c].numSpikes, entry + sizeof(long long) + 2 * sizeof(int), sizeof(int));
+		}
+		return true;
+	}
+
+	// builds the chunk index from the chunk headers, ignoring a trailing chunk that has not been written completely
+	void scanChunkHeaders() {
+		_chunks.clear();
+		long long offset = SPIKE_FILE_HEADER_SIZE;
+		while (offset + (long long)SPIKE_FILE_CHUNK_HEADER_SIZE <= _fileSize) {
+			int header[4];
+			seekFile(offset, SEEK_SET);
+			if (fread(header, sizeof(int), 4, _fid) != 4 || header[2] < 0 || header[3] < 0
+					|| offset + SPIKE_FILE_CHUNK_HEADER_SIZE + header[3] > _fileSize)
+				break;
+
+			Chunk chunk;
+			chunk.offset = offset;
+			chunk.firstTime = header[0];
+			chunk.lastTime = header[1];
+			chunk.numSpikes = header[2];
+			_chunks.push_back(chunk);
+			offset += SPIKE_FILE_CHUNK_HEADER_SIZE + header[3];
+		}
+	}
+
+	// decodes all spikes of a chunk
+	void readChunk(int chunkId, std::vector<int>& spkTimes, std::vector<int>& neurIds) {
+		std::string funcName = "readChunk(" + _fileName + ")";
+		const Chunk& chunk = _chunks[chunkId];
+
+		int header[4];
+		seekFile(chunk.offset, SEEK_SET);
+		bool success = fread(header, sizeof(int), 4, _fid) == 4 && header[0] == chunk.firstTime
+			&& header[2] == chunk.numSpikes && header[3] >= 0;
+		if (success) {
+			_payload.resize(header[3]);
+			success = header[3] == 0 || fread(&_payload[0], 1, header[3], _fid) == header[3];
+		}
+		UserErrors::assertTrue(success, UserErrors::FILE_CANNOT_READ, funcName, _fileName + " (corrupt chunk)");
+
+		const unsigned char* p = _payload.empty() ? NULL : &_payload[0];
+		const unsigned char* end = p + _payload.size();
+		int time = chunk.firstTime;
+		int neurId = 0;
+		for (int i = 0; i < chunk.numSpikes; i++) {
+			UserErrors::assertTrue(decodeSpike(p, end, time, neurId), UserErrors::FILE_CANNOT_READ, funcName,
+				_fileName + " (corrupt chunk)");
+			spkTimes.push_back(time);
+			neurIds.push_back(neurId);
+		}
+	}
+
+	// decodes the spike after (time, neurId): the time difference and the zigzag-encoded neuron ID difference
+	static bool decodeSpike(const unsigned char*& p, const unsigned char* end, int& time, int& neurId) {
+		unsigned int dt, dn;
+		if (!readVarint(p, end, dt) || !readVarint(p, end, dn))
+			return false;
+
+		time += (int)dt;
+		neurId += (int)(dn >> 1) ^ -(int)(dn & 1); // undo zigzag encoding
+		return true;
+	}
+
+	// decodes the spike at the cursor of a chunked spike file, returns false at the end of the file
+	bool decodeNextSpike() {
+		std::string funcName = "readNextSpikes(" + _fileName + ")";
+		while (_cursorSpikesLeft == 0) {
+			if (_cursorChunk >= _chunks.size())
+				return false;
+
+			// enter the next chunk
+			const Chunk& chunk = _chunks[_cursorChunk++];
+			int header[4];
+			memcpy(header, _map + chunk.offset, sizeof(header));
+			UserErrors::assertTrue(header[2] == chunk.numSpikes && header[3] >= 0
+				&& chunk.offset + SPIKE_FILE_CHUNK_HEADER_SIZE + header[3] <= _fileSize, UserErrors::FILE_CANNOT_READ,
+				funcName, _fileName + " (corrupt chunk)");
+			_cursorPos = _map + chunk.offset + SPIKE_FILE_CHUNK_HEADER_SIZE;
+			_cursorEnd = _cursorPos + header[3];
+			_cursorSpikesLeft = chunk.numSpikes;
+			_cursorTime = chunk.firstTime;
+			_cursorNeurId = 0;
+		}
+
+		UserErrors::assertTrue(decodeSpike(_cursorPos, _cursorEnd, _cursorTime, _cursorNeurId),
+			UserErrors::FILE_CANNOT_READ, funcName, _fileName + " (corrupt chunk)");
+		_cursorSpikesLeft--;
+		_cursorPending = true;
+		return true;
+	}
+
+	// maps the whole file into memory (read-only), the OS pages it in as the cursor advances
+	void mapFile() {
+		if (_map != NULL)
+			return;
+
+		bool success;
+#if defined(WIN32) || defined(WIN64)
+		HANDLE file = (HANDLE)_get_osfhandle(_fileno(_fid));
+		_mapHandle = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		_map = _mapHandle == NULL ? NULL : (const unsigned char*)MapViewOfFile(_mapHandle, FILE_MAP_READ, 0, 0, 0);
+		success = _map != NULL;
+#else
+		void* addr = mmap(NULL, (size_t)_fileSize, PROT_READ, MAP_PRIVATE, fileno(_fid), 0);
+		success = addr != MAP_FAILED;
+		if (success) {
+			_map = (const unsigned char*)addr;
+			madvise(addr, (size_t)_fileSize, MADV_SEQUENTIAL);
+		}
+#endif
+		UserErrors::assertTrue(success, UserErrors::FILE_CANNOT_READ, "mapFile", _fileName + " (could not map file)");
+	}
+
+	void unmapFile() {
+		if (_map == NULL)
+			return;
+#if defined(WIN32) || defined(WIN64)
+		UnmapViewOfFile(_map);
+		CloseHandle(_mapHandle);
+#else
+		munmap((void*)_map, (size_t)_fileSize);
+#endif
+		_map = NULL;
+	}
+
+	// reads a variable-length integer (7 bits per byte, least significant group first)
+	static bool readVarint(const unsigned char*& p, const unsigned char* end, unsigned int& value) {
+		value = 0;
+		for (int shift = 0; shift < 35 && p < end; shift += 7) {
+			unsigned char byte = *p++;
+			value |= (unsigned int)(byte & 0x7f) << shift;
+			if (!(byte & 0x80))
+				return true;
+		}
+		return false;
+	}
+
+	// returns the spike time of the i-th (time, neuron ID) pair of a flat spike file
+	int readFlatSpikeTime(long long i) {
+		int time;
+		seekFile(SPIKE_FILE_HEADER_SIZE + i * 2 * sizeof(int), SEEK_SET);
+		UserErrors::assertTrue(fread(&time, sizeof(int), 1, _fid) == 1, UserErrors::FILE_CANNOT_READ,
+			"readSpikes", _fileName);
+		return time;
+	}
+
+	// reads the pairs [first, last) of a flat spike file, stopping at the first spike time >= endTime
+	void readFlatSpikes(long long first, long long last, int endTime, std::vector<int>& spkTimes,
+		std::vector<int>& neurIds)
+	{
+		int records[2 * FLAT_RECORDS_PER_READ];
+		seekFile(SPIKE_FILE_HEADER_SIZE + first * 2 * sizeof(int), SEEK_SET);
+		while (first < last) {
+			int numRead = last - first < FLAT_RECORDS_PER_READ ? (int)(last - first) : FLAT_RECORDS_PER_READ;
+			UserErrors::assertTrue(fread(records, 2 * sizeof(int), numRead, _fid) == numRead,
+				UserErrors::FILE_CANNOT_READ, "readSpikes", _fileName);
+			for (int i = 0; i < numRead; i++) {
+				if (records[2 * i] >= endTime)
+					return;
+				spkTimes.push_back(records[2 * i]);
+				neurIds.push_back(records[2 * i + 1]);
+			}
+			first += numRead;
+		}
+	}
+
+	// 64-bit file positioning, spike files can be larger than 2 GB
+	void seekFile(long long offset, int origin) {
+#if defined(WIN32) || defined(WIN64)
+		_fseeki64(_fid, offset, origin);
+#else
+		fseeko(_fid, (off_t)offset, origin);
+#endif
+	}
+
+	long long tellFile() {
+#if defined(WIN32) || defined(WIN64)
+		return _ftelli64(_fid);
+#else
+		return (long long)ftello(_fid);
+#endif
+	}
+
+	std::string _fileName;
+	FILE* _fid;
+	float _version;
+	Grid3D _grid;
+	bool _chunked;                       //!< whether the file has version SPIKE_FILE_VERSION_CHUNKED
+	long long _fileSize;
+	long long _numSpikes;
+	std::vector<Chunk> _chunks;          //!< all (complete) chunks of a chunked spike file
+	std::vector<unsigned char> _payload; //!< the encoded spikes of the last chunk that was read
+
+	// streaming (see readNextSpikes)
+	const unsigned char* _map;           //!< the whole file mapped into memory, NULL if not mapped yet
+#if defined(WIN32) || defined(WIN64)
+	HANDLE _mapHandle;
+#endif
+	long long _cursorSpike;              //!< flat files: index of the next (time, neuron ID) pair
+	int _cursorChunk;                    //!< chunked files: index of the next chunk to enter
+	const unsigned char* _cursorPos;     //!< chunked files: next encoded spike in the current chunk
+	const unsigned char* _cursorEnd;     //!< chunked files: end of the current chunk
+	int _cursorSpikesLeft;               //!< chunked files: number of spikes left in the current chunk
+	int _cursorTime;                     //!< chunked files: time of the last decoded spike
+	int _cursorNeurId;                   //!< chunked files: neuron ID of the last decoded spike
+	bool _cursorPending;                 //!< chunked files: whether the last decoded spike was not returned yet
+};
+
+
+// ****************************************************************************************************************** //
+// SPIKEFILEREADER API IMPLEMENTATION
+// ****************************************************************************************************************** //
+
+// constructor / destructor
+SpikeFileReader::SpikeFileReader(const std::string& fileName) : _impl( new Impl(fileName) ) {}
+SpikeFileReader::~SpikeFileReader() { delete _impl; }
+
+// public methods
+Grid3D SpikeFileReader::getGrid3D() { return _impl->getGrid3D(); }
+int SpikeFileReader::getNumNeurons() { return _impl->getNumNeurons(); }
+float SpikeFileReader::getVersion() { return _impl->getVersion(); }
+int SpikeFileReader::getNumChunks() { return _impl->getNumChunks(); }
+long long SpikeFileReader::getNumSpikes() { return _impl->getNumSpikes(); }
+void SpikeFileReader::readSpikes(int startTime, int endTime, std::vector<int>& spkTimes, std::vector<int>& neurIds) {
+	_impl->readSpikes(startTime, endTime, spkTimes, neurIds);
+}
+void SpikeFileReader::readSpikes(std::vector<std::vector<int> >& spkVector) { _impl->readSpikes(spkVector); }
+void SpikeFileReader::readNextSpikes(int endTime, std::vector<int>& spkTimes, std::vector<int>& neurIds) {
+	_impl->readNextSpikes(endTime, spkTimes, neurIds);
+}
+void SpikeFileReader::rewind() { _impl->rewind(); }
@@ -0,0 +1,159 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+#ifndef _SPIKE_FILE_READER_H_
+#define _SPIKE_FILE_READER_H_
+
+#include <carlsim_datastructures.h> // Grid3D
+#include <string>					// std::string
+#include <vector>					// std::vector
+
+
+/*!
+ * \brief Reads spike files written by a SpikeMonitor
+ *
+ * This class reads both spike file versions a SpikeMonitor can write (see CARLsim::setSpikeFileFormat). Both
+ * versions start with the same header section: the file signature (int), the version number (float), and the
+ * dimensions of the group's 3D grid (three ints).
+ * - Version 0.2 (SPIKE_FILE_FLAT): The header is followed by (spike time, neuron ID) pairs of ints.
+ * - Version 0.3 (SPIKE_FILE_CHUNKED): The header is followed by chunks that cover a fixed number of milliseconds each.
+ *   A chunk starts with the time of its first and last spike, the number of spikes, and the number of bytes that
+ *   follow (four ints). For every spike, the difference to the previous spike time and the (zigzag-encoded)
+ *   difference to the previous neuron ID are stored as variable-length integers (7 bits per byte, least significant
+ *   group first). The differences start from the time of the first spike and from neuron ID 0.
+ *   When the spike file is closed, an index of all chunks is appended: (file offset as long long, first spike time,
+ *   last spike time, number of spikes) per chunk, followed by the file offset of the index (long long), the number
+ *   of chunks (int), and the index signature (int).
+ *
+ * In both versions, spikes are stored in the order of their spike times. A time window can thus be read without
+ * scanning the whole file: flat files are bisected, and chunked files are located through the chunk index. If the
+ * file has no index (e.g., because it is still being written), the chunk headers are read instead.
+ *
+ * Files that are too large to be read at once can be streamed: SpikeFileReader::readNextSpikes maps the file into
+ * memory and advances a cursor through it, so that only the spikes up to a given time are decoded.
+ *
+ * Example usage:
+ * \code
+ * SpikeFileReader reader("results/spk_input.dat");
+ * std::vector<int> spkTimes, neurIds;
+ * reader.readSpikes(10000, 11000, spkTimes, neurIds); // all spikes in [10s, 11s)
+ * \endcode
+ *
+ * \since v4.0
+ */
+class SpikeFileReader {
+public:
+	/*!
+	 * \brief SpikeFileReader constructor
+	 *
+	 * Opens a spike file and reads its header section (and chunk index).
+	 * \param[in] fileName file name of spike file (must be created from SpikeMonitor)
+	 */
+	SpikeFileReader(const std::string& fileName);
+
+	//! SpikeFileReader destructor, closes the file
+	~SpikeFileReader();
+
+	//! returns the 3D grid of the recorded group
+	Grid3D getGrid3D();
+
+	//! returns the number of neurons of the recorded group
+	int getNumNeurons();
+
+	//! returns the version number of the spike file
+	float getVersion();
+
+	//! returns the number of chunks of a chunked spike file, 0 for a flat spike file
+	int getNumChunks();
+
+	//! returns the total number of spikes in the file
+	long long getNumSpikes();
+
+	/*!
+	 * \brief Reads all spikes of a time window
+	 *
+	 * Spikes are appended to the two vectors in the order in which they are stored in the file.
+	 * \param[in] startTime start of the time window (ms, inclusive)
+	 * \param[in] endTime end of the time window (ms, exclusive)
+	 * \param[out] spkTimes spike times
+	 * \param[out] neurIds neuron IDs (within the group) of the spikes
+	 */
+	void readSpikes(int startTime, int endTime, std::vector<int>& spkTimes, std::vector<int>& neurIds);
+
+	/*!
+	 * \brief Reads all spikes of the file into a 2D spike vector
+	 *
+	 * The first dimension of the vector is the neuron ID, the second dimension is spike times (same as
+	 * SpikeMonitor::getSpikeVector2D).
+	 * \param[out] spkVector 2D spike vector, resized to the number of neurons
+	 */
+	void readSpikes(std::vector<std::vector<int> >& spkVector);
+
+	/*!
+	 * \brief Reads the spikes from the cursor up to a point in time
+	 *
+	 * The first call maps the file into memory and places the cursor at the first spike. Every call appends the
+	 * spikes from the cursor up to (but excluding) the first spike at or after endTime, and advances the cursor past
+	 * them. Spikes are appended in the order in which they are stored in the file.
+	 * \param[in] endTime end of the time window (ms, exclusive)
+	 * \param[out] spkTimes spike times
+	 * \param[out] neurIds neuron IDs (within the group) of the spikes
+	 */
+	void readNextSpikes(int endTime, std::vector<int>& spkTimes, std::vector<int>& neurIds);
+
+	//! moves the cursor of SpikeFileReader::readNextSpikes back to the first spike of the file
+	void rewind();
+
+private:
+	// This class provides a pImpl for the CARLsim User API.
+	// \see https://marcmutz.wordpress.com/translated-articles/pimp-my-pimpl/
+	class Impl;
+	Impl* _impl;
+};
+
+#endif
@@ -49,6 +49,7 @@
 
 #include <snn.h>				// CARLsim private implementation
 #include <snn_definitions.h>	// KERNEL_ERROR, KERNEL_INFO, ...
+#include <spike_file_writer.h>	// SpikeFileWriter
 
 #include <algorithm>			// std::sort
 
@@ -61,6 +62,7 @@ SpikeMonitorCore::SpikeMonitorCore(SNN* snn, int monitorId, int grpId) {
 	monitorId_ = monitorId;
 	nNeurons_ = -1;
 	spikeFileId_ = NULL;
+	spikeFileStreamId_ = -1;
 	recordSet_ = false;
 	spkMonLastUpdated_ = 0;
 
@@ -68,8 +70,8 @@ SpikeMonitorCore::SpikeMonitorCore(SNN* snn, int monitorId, int grpId) {
 	persistentData_ = false;
     userHasBeenWarned_ = false;
 	needToWriteFileHeader_ = true;
-	spikeFileSignature_ = 206661989;
-	spikeFileVersion_ = 0.2f;
+	spikeFileSignature_ = SPIKE_FILE_SIGNATURE;
+	spikeFileVersion_ = SPIKE_FILE_VERSION_FLAT;
 
 	// defer all unsafe operations to init function
 	init();
@@ -95,6 +97,7 @@ void SpikeMonitorCore::init() {
 
 SpikeMonitorCore::~SpikeMonitorCore() {
 	if (spikeFileId_!=NULL) {
+		closeSpikeFileStream();
 		fclose(spikeFileId_);
 		spikeFileId_ = NULL;
 	}
@@ -361,6 +364,7 @@ void SpikeMonitorCore::setSpikeFileId(FILE* spikeFileId) {
 
 	// close previous file pointer if exists
 	if (spikeFileId_!=NULL) {
+		closeSpikeFileStream();
 		fclose(spikeFileId_);
 		spikeFileId_ = NULL;
 	}
@@ -371,12 +375,29 @@ void SpikeMonitorCore::setSpikeFileId(FILE* spikeFileId) {
 	if (spikeFileId_==NULL)
 		needToWriteFileHeader_ = false;
 	else {
+		// the version number in the header tells readers whether the spikes are chunked
+		int chunkLengthMs = snn_->getSpikeFileFormat() == SPIKE_FILE_CHUNKED ? snn_->getSpikeFileChunkLength() : 0;
+		spikeFileVersion_ = chunkLengthMs > 0 ? SPIKE_FILE_VERSION_CHUNKED : SPIKE_FILE_VERSION_FLAT;
+
 		// file pointer has changed, so we need to write header (again)
 		needToWriteFileHeader_ = true;
 		writeSpikeFileHeader();
+
+		// from now on, spikes are written asynchronously by the spike file writer of the network
+		spikeFileStreamId_ = snn_->getSpikeFileWriter()->open(spikeFileId_, chunkLengthMs);
 	}
 }
 
+// writes the spikes that are still buffered before the spike file is closed
+void SpikeMonitorCore::closeSpikeFileStream() {
+	if (spikeFileStreamId_ < 0)
+		return;
+
+	if (!snn_->getSpikeFileWriter()->close(spikeFileStreamId_))
+		KERNEL_ERROR("SpikeMonitorCore: could not write spike file");
+	spikeFileStreamId_ = -1;
+}
+
 // calculate average firing rate for every neuron if we haven't done so already
 void SpikeMonitorCore::calculateFiringRates() {
 	// only update if we have to
@@ -462,6 +483,15 @@ long int SpikeMonitorCore::getBufferSize(){
     return bufferSize;
 }
 
+// counts the capacity of all buffers, which is what the spike vector actually occupies
+size_t SpikeMonitorCore::getMemoryUsage() {
+	size_t bytes = spkVector_.capacity() * sizeof(std::vector<int>);
+	for (int i = 0; i < spkVector_.size(); i++)
+		bytes += spkVector_[i].capacity() * sizeof(int);
+	bytes += (firingRates_.capacity() + firingRatesSorted_.capacity()) * sizeof(float);
+	return bytes;
+}
+
 // check if the spike vector is getting large. If it is, return true once until
 // stopRecording is called.
 bool SpikeMonitorCore::isBufferBig(){
@@ -180,6 +180,9 @@ public:
 	//! sets pointer to spike file
 	void setSpikeFileId(FILE* spikeFileId);
 
+	//! returns the stream of the spike file in the SpikeFileWriter of the network, -1 if there is no spike file
+	int getSpikeFileStreamId() { return spikeFileStreamId_; }
+
 	//! returns timestamp of last SpikeMonitor update
 	long int getLastUpdated() { return spkMonLastUpdated_; }
 
@@ -192,6 +195,9 @@ public:
     //! returns the approximate size of the spike vector in bytes
     long int getBufferSize();
 
+	//! returns the number of bytes held by the buffers of the SpikeMonitor (including reserved capacity)
+	size_t getMemoryUsage();
+
     //! returns the total accumulated time
     long int getAccumTime();
 
@@ -208,6 +214,9 @@ private:
 	//! writes the header section (file signature, version number) of a spike file
 	void writeSpikeFileHeader();
 
+	//! hands the remaining spikes of the spike file to the spike file writer and waits until they are written
+	void closeSpikeFileStream();
+
 	//! whether we have to perform calculateFiringRates()
 	bool needToCalculateFiringRates_;
 
@@ -223,6 +232,7 @@ private:
 	int nNeurons_;	//!< number of neurons in the group
 
 	FILE* spikeFileId_;	//!< file pointer to the spike file or NULL
+	int spikeFileStreamId_; //!< stream of the spike file in SNN::getSpikeFileWriter, spikes are written through it
 	int spikeFileSignature_; //!< int signature of spike file
 	float spikeFileVersion_; //!< version number of spike file
 
@@ -362,6 +362,89 @@ TEST(ConnMon, weightFile) {
 	}
 }
 
+TEST(ConnMon, sparseWeights) {
+	CARLsim* sim;
+	const int GRP_SIZE = 20;
+
+	// loop over both CPU and GPU mode.
+	for (int mode = 0; mode < TESTED_MODES; mode++) {
+		long fileLength[3] = {0,0,0};
+		int nSyn = 0;
+		for (int format=CONNECT_FILE_DENSE; format<=CONNECT_FILE_SPARSE_DELTA; format++) {
+			sim = new CARLsim("ConnMon.sparseWeights",mode?GPU_MODE:CPU_MODE,SILENT,1,42);
+
+			int g0 = sim->createGroup("g0", GRP_SIZE, EXCITATORY_NEURON, 0);
+			int g1 = sim->createGroup("g1", GRP_SIZE, EXCITATORY_NEURON, 0);
+			sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+			sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+
+			short int c0 = sim->connect(g0,g1,"random",RangeWeight(0.05f),0.1f);
+			sim->setConductances(true);
+			sim->setConnectFileFormat((ConnectFileFormat)format);
+			sim->setupNetwork();
+
+			ConnectionMonitor* CM = sim->setConnectionMonitor(g0,g1,"results/weights_sparse.dat");
+
+			// the sparse snapshot must list exactly the existing synapses of the dense snapshot
+			std::vector<int> preIds, postIds;
+			std::vector<float> wts;
+			CM->takeSnapshotSparse(preIds, postIds, wts);
+			std::vector< std::vector<float> > wtMat = CM->takeSnapshot();
+			nSyn = CM->getNumSynapses();
+			ASSERT_EQ(wts.size(), nSyn);
+			ASSERT_EQ(preIds.size(), nSyn);
+			ASSERT_EQ(postIds.size(), nSyn);
+			int nNonNan = 0;
+			for (int i=0; i<GRP_SIZE; i++) {
+				for (int j=0; j<GRP_SIZE; j++) {
+					nNonNan += !isnan(wtMat[i][j]);
+				}
+			}
+			EXPECT_EQ(nNonNan, nSyn);
+			for (int i=0; i<nSyn; i++) {
+				EXPECT_FLOAT_EQ(wtMat[preIds[i]][postIds[i]], wts[i]);
+				EXPECT_FLOAT_EQ(wts[i], 0.05f);
+			}
+
+			// snapshots at t=0, 1, 2 sec have the same weights, all weights change before the one at t=3 sec
+			sim->runNetwork(2,0);
+			sim->biasWeights(c0, -0.01f);
+			sim->runNetwork(1,0);
+
+			std::vector<float> wtChangeSparse = CM->calcWeightChangesSparse();
+			std::vector< std::vector<float> > wtChange = CM->calcWeightChanges();
+			ASSERT_EQ(wtChangeSparse.size(), nSyn);
+			for (int i=0; i<nSyn; i++) {
+				EXPECT_NEAR(wtChangeSparse[i], -0.01f, 1e-6f);
+				EXPECT_FLOAT_EQ(wtChange[preIds[i]][postIds[i]], wtChangeSparse[i]);
+			}
+			EXPECT_EQ(CM->getNumWeightsChanged(), nSyn);
+			EXPECT_NEAR(CM->getTotalAbsWeightChange(), nSyn*0.01, 1e-4);
+			EXPECT_EQ(CM->getNumWeightsInRange(0.035, 0.045), nSyn);
+
+			delete sim;
+
+			std::ifstream wtFile("results/weights_sparse.dat", std::ios::binary | std::ios::ate);
+			EXPECT_TRUE(wtFile.is_open());
+			if (wtFile) {
+				fileLength[format] = wtFile.tellg();
+			}
+		}
+		ASSERT_GT(nSyn, 0);
+		ASSERT_LT(nSyn, GRP_SIZE*GRP_SIZE);
+
+		// dense: header + 4 snapshots of (timestamp, all weights of the matrix)
+		long headerSize = fileLength[CONNECT_FILE_DENSE] - 4*(8 + 4*GRP_SIZE*GRP_SIZE);
+
+		// sparse: header + synapse list (isDelta, #synapses, pre IDs, post IDs) + 4 snapshots of (timestamp, weights)
+		EXPECT_EQ(fileLength[CONNECT_FILE_SPARSE], headerSize + 8 + 8*nSyn + 4*(8 + 4*nSyn));
+
+		// delta: header + synapse list + snapshots of (timestamp, #changed, indices, weights): all synapses are
+		// written at t=0 and t=3 sec, none at t=1 and t=2 sec
+		EXPECT_EQ(fileLength[CONNECT_FILE_SPARSE_DELTA], headerSize + 8 + 8*nSyn + 2*(12 + 8*nSyn) + 2*12);
+	}
+}
+
 TEST(ConnMon, weightChange) {
 	// set this flag to make all death tests thread-safe
 	::testing::FLAGS_gtest_death_test_style = "threadsafe";
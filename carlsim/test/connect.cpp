@@ -388,3 +388,186 @@ TEST(Connect, connectGaussian) {
 		}
 	}
 }
+
+TEST(Connect, connectSharedKernel) {
+	CARLsim* sim = new CARLsim("CORE.connectSharedKernel",CPU_MODE,SILENT,1,42);
+	Grid3D grid(7,7,1);
+	int g0=sim->createGroup("excit", grid, EXCITATORY_NEURON);
+	sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+
+	// 3x3 kernel with a hole in the center: self-connections must not be made
+	Grid3D kernelSize(3,3,1);
+	std::vector<float> kernel(kernelSize.N, 0.0f);
+	for (int k=0; k<kernelSize.N; k++)
+		kernel[k] = (k==kernelSize.N/2) ? 0.0f : 0.01f*(k+1);
+	int c0=sim->connect(g0, g0, kernelSize, kernel, 0.2f);
+
+	sim->setupNetwork();
+
+	ConnectionMonitor* CM0 = sim->setConnectionMonitor(g0,g0,"NULL");
+	std::vector< std::vector<float> > wt0 = CM0->takeSnapshot();
+
+	int nSyn = 0;
+	for (int i=0; i<wt0.size(); i++) {
+		Point3D pre = sim->getNeuronLocation3D(g0, i);
+		for (int j=0; j<wt0[0].size(); j++) {
+			Point3D post = sim->getNeuronLocation3D(g0, j);
+			int dX = (int)(pre.x-post.x);
+			int dY = (int)(pre.y-post.y);
+			if (abs(dX)>1 || abs(dY)>1 || (dX==0 && dY==0)) {
+				EXPECT_TRUE(isnan(wt0[i][j]));
+			} else {
+				nSyn++;
+				EXPECT_FLOAT_EQ(wt0[i][j], kernel[(dY+1)*3 + dX+1]);
+			}
+		}
+	}
+	EXPECT_EQ(sim->getNumSynapticConnections(c0), nSyn);
+
+	// there is only one copy of the weights
+	std::vector<float> kernelRT = sim->getSharedKernel(c0);
+	ASSERT_EQ(kernelRT.size(), kernel.size());
+	for (int k=0; k<kernel.size(); k++)
+		EXPECT_FLOAT_EQ(kernelRT[k], kernel[k]);
+
+	delete sim;
+}
+
+// grids of different size: offsets are measured on the post grid, pre-neurons map to the post cell that contains them
+TEST(Connect, connectSharedKernelScaled) {
+	CARLsim* sim = new CARLsim("CORE.connectSharedKernelScaled",CPU_MODE,SILENT,1,42);
+	Grid3D gridPre(8,8,1), gridPost(4,4,1);
+	int g0=sim->createGroup("pre", gridPre, EXCITATORY_NEURON);
+	int g1=sim->createGroup("post", gridPost, EXCITATORY_NEURON);
+	sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+
+	Grid3D kernelSize(3,1,1);
+	std::vector<float> kernel(kernelSize.N);
+	kernel[0] = 0.1f; kernel[1] = 0.2f; kernel[2] = 0.3f;
+	int c0=sim->connect(g0, g1, kernelSize, kernel, 1.0f);
+
+	sim->setupNetwork();
+	ConnectionMonitor* CM0 = sim->setConnectionMonitor(g0,g1,"NULL");
+	std::vector< std::vector<float> > wt0 = CM0->takeSnapshot();
+
+	int nSyn = 0;
+	for (int i=0; i<gridPre.N; i++) {
+		int cellX = (i % gridPre.numX) / 2;
+		int cellY = (i / gridPre.numX) / 2;
+		for (int j=0; j<gridPost.N; j++) {
+			int dX = cellX - j % gridPost.numX;
+			int dY = cellY - j / gridPost.numX;
+			if (abs(dX)>1 || dY!=0) {
+				EXPECT_TRUE(isnan(wt0[i][j]));
+			} else {
+				nSyn++;
+				EXPECT_FLOAT_EQ(wt0[i][j], kernel[dX+1]);
+			}
+		}
+	}
+	EXPECT_EQ(sim->getNumSynapticConnections(c0), nSyn);
+
+	delete sim;
+}
+
+// STDP changes the kernel, and ConnectionMonitor reads the (shared) weights from it
+TEST(Connect, connectSharedKernelPlastic) {
+	CARLsim* sim = new CARLsim("CORE.connectSharedKernelPlastic",CPU_MODE,SILENT,1,42);
+	Grid3D grid(8,8,1);
+	int g0=sim->createGroup("excit", grid, EXCITATORY_NEURON);
+	sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->setESTDP(g0, true, STANDARD, ExpCurve(2e-4f,20.0f, -6.6e-5f,60.0f));
+
+	Grid3D kernelSize(3,3,1);
+	std::vector<float> kernel(kernelSize.N, 0.05f);
+	kernel[kernelSize.N/2] = 0.0f;
+	int c0=sim->connect(g0, g0, kernelSize, kernel, 0.2f, RangeDelay(1,5), SYN_PLASTIC);
+
+	sim->setConductances(true);
+	sim->setupNetwork();
+	ConnectionMonitor* CM0 = sim->setConnectionMonitor(g0,g0,"NULL");
+
+	std::vector<float> current(grid.N);
+	for (int i=0; i<grid.N; i++)
+		current[i] = 4.0f + 0.1f*(i%7);
+	sim->setExternalCurrent(g0, current);
+	sim->runNetwork(2,0,false);
+
+	std::vector<float> kernelRT = sim->getSharedKernel(c0);
+	ASSERT_EQ(kernelRT.size(), kernel.size());
+	bool hasChanged = false;
+	for (int k=0; k<kernel.size(); k++)
+		hasChanged |= (kernelRT[k] != kernel[k]);
+	EXPECT_TRUE(hasChanged);
+
+	std::vector< std::vector<float> > wt0 = CM0->takeSnapshot();
+	for (int i=0; i<wt0.size(); i++) {
+		Point3D pre = sim->getNeuronLocation3D(g0, i);
+		for (int j=0; j<wt0[0].size(); j++) {
+			Point3D post = sim->getNeuronLocation3D(g0, j);
+			int dX = (int)(pre.x-post.x);
+			int dY = (int)(pre.y-post.y);
+			if (abs(dX)>1 || abs(dY)>1 || (dX==0 && dY==0)) {
+				EXPECT_TRUE(isnan(wt0[i][j]));
+			} else {
+				EXPECT_FLOAT_EQ(wt0[i][j], kernelRT[(dY+1)*3 + dX+1]);
+			}
+		}
+	}
+
+	delete sim;
+}
+
+// the kernel entry of a synapse is derived from the grid locations, which do not change if neurons are reordered
+TEST(Connect, connectSharedKernelOrdering) {
+	std::vector<std::vector<int> > spkTimes[2];
+	std::vector<std::vector<float> > wts[2];
+
+	for (int order=0; order<=1; order++) {
+		CARLsim* sim = new CARLsim("CORE.connectSharedKernelOrdering",CPU_MODE,SILENT,1,42);
+		sim->setNeuronOrdering(order == 0 ? CREATION_ORDER : HILBERT_ORDER);
+		Grid3D grid(8,8,1);
+		int g0=sim->createGroup("excit", grid, EXCITATORY_NEURON);
+		sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+
+		// weights that can be summed up exactly, so that the order of spike delivery does not matter
+		Grid3D kernelSize(3,3,1);
+		std::vector<float> kernel(kernelSize.N, 0.5f);
+		kernel[0] = 1.5f;
+		kernel[kernelSize.N/2] = 0.0f;
+		sim->connect(g0, g0, kernelSize, kernel, 2.0f, RangeDelay(3));
+		sim->setConductances(false);
+
+		sim->setupNetwork();
+		ConnectionMonitor* CM0 = sim->setConnectionMonitor(g0,g0,"NULL");
+		SpikeMonitor* SM0 = sim->setSpikeMonitor(g0,"NULL");
+
+		std::vector<float> current(grid.N);
+		for (int i=0; i<grid.N; i++)
+			current[i] = (float)(i%8);
+		sim->setExternalCurrent(g0, current);
+
+		SM0->startRecording();
+		sim->runNetwork(1,0,false);
+		SM0->stopRecording();
+		spkTimes[order] = SM0->getSpikeVector2D();
+		wts[order] = CM0->takeSnapshot();
+
+		delete sim;
+	}
+
+	ASSERT_EQ(spkTimes[0].size(), spkTimes[1].size());
+	for (int i=0; i<spkTimes[0].size(); i++)
+		EXPECT_EQ(spkTimes[0][i], spkTimes[1][i]);
+
+	ASSERT_EQ(wts[0].size(), wts[1].size());
+	for (int i=0; i<wts[0].size(); i++) {
+		for (int j=0; j<wts[0][i].size(); j++) {
+			if (isnan(wts[0][i][j]))
+				EXPECT_TRUE(isnan(wts[1][i][j]));
+			else
+				EXPECT_FLOAT_EQ(wts[0][i][j], wts[1][i][j]);
+		}
+	}
+}
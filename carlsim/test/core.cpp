@@ -50,6 +50,8 @@
 
 #include <carlsim.h>
 #include <vector>
+#include <fstream>
+#include <string>
 
 #include <periodic_spikegen.h>
 
@@ -637,6 +639,153 @@ TEST(Core, saveLoadSimulation) {
 	}
 }
 
+// loadSimulation must restore the saved synapses instead of generating a new random connectivity
+TEST(Core, saveLoadSimulationSynapses) {
+	std::vector<std::vector<float> > wts[2];
+	uint8_t* delays[2];
+	PeriodicSpikeGenerator spkGen(10.0f);
+
+	for (int loadSim = 0; loadSim <= 1; loadSim++) {
+		// a different seed would lead to a different connectivity if the synapses were generated again
+		CARLsim* sim = new CARLsim("Core.saveLoadSimulationSynapses", CPU_MODE, SILENT, 1, loadSim ? 7 : 42);
+		int gIn = sim->createSpikeGeneratorGroup("input", 20, EXCITATORY_NEURON);
+		sim->setSpikeGenerator(gIn, &spkGen);
+		int gExc = sim->createGroup("excit", 20, EXCITATORY_NEURON);
+		sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->connect(gIn, gExc, "random", RangeWeight(0.0f, 0.5f, 1.0f), 0.3f, RangeDelay(1, 10), RadiusRF(-1),
+			SYN_PLASTIC);
+		sim->connect(gExc, gExc, "random", RangeWeight(0.2f), 0.1f, RangeDelay(1, 5));
+		sim->setSTDP(gExc, true, STANDARD, 0.001f, 20.0f, 0.0015f, 20.0f);
+		sim->setConductances(false);
+
+		FILE* simFid = NULL;
+		if (loadSim) {
+			simFid = fopen("results/sim_synapses.dat", "rb");
+			sim->loadSimulation(simFid);
+		}
+
+		sim->setupNetwork();
+		ConnectionMonitor* connMon = sim->setConnectionMonitor(gIn, gExc, "NULL");
+		if (!loadSim) {
+			sim->runNetwork(1, 0, false);
+			sim->saveSimulation("results/sim_synapses.dat", true);
+		}
+
+		wts[loadSim] = connMon->takeSnapshot();
+		int numPre, numPost;
+		delays[loadSim] = sim->getDelays(gIn, gExc, numPre, numPost);
+		ASSERT_EQ(numPre, 20);
+		ASSERT_EQ(numPost, 20);
+
+		if (simFid != NULL) fclose(simFid);
+		delete sim;
+	}
+
+	for (int i = 0; i < 20; i++) {
+		for (int j = 0; j < 20; j++) {
+			if (isnan(wts[0][i][j])) {
+				EXPECT_TRUE(isnan(wts[1][i][j]));
+			} else {
+				EXPECT_FLOAT_EQ(wts[0][i][j], wts[1][i][j]);
+			}
+			EXPECT_EQ(delays[0][i + j * 20], delays[1][i + j * 20]);
+		}
+	}
+
+	delete[] delays[0];
+	delete[] delays[1];
+}
+
+// a network restored from a checkpoint must continue exactly like the one that took the checkpoint
+TEST(Core, saveLoadCheckpoint) {
+	std::vector<std::vector<int> > spkTimes[2];
+	std::vector<std::vector<float> > wts[2];
+	PeriodicSpikeGenerator spkGen(20.0f);
+	PoissonRate poissRate(50, false);
+	poissRate.setRates(15.0f);
+
+	for (int loadCp = 0; loadCp <= 1; loadCp++) {
+		CARLsim* sim = new CARLsim("Core.saveLoadCheckpoint", CPU_MODE, SILENT, 1, 42);
+		int gPer = sim->createSpikeGeneratorGroup("periodic", 50, EXCITATORY_NEURON);
+		sim->setSpikeGenerator(gPer, &spkGen);
+		int gPoiss = sim->createSpikeGeneratorGroup("poisson", 50, EXCITATORY_NEURON);
+		int gExc = sim->createGroup("excit", 50, EXCITATORY_NEURON);
+		sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+
+		// fixed delays, so that both networks have the same connectivity (STP requires delays of 1 ms)
+		sim->connect(gPer, gExc, "random", RangeWeight(0.0f, 0.5f, 1.0f), 0.2f, RangeDelay(1), RadiusRF(-1), SYN_PLASTIC);
+		sim->connect(gPoiss, gExc, "random", RangeWeight(0.5f), 0.2f, RangeDelay(1));
+		sim->connect(gExc, gExc, "random", RangeWeight(0.1f), 0.1f, RangeDelay(1));
+		sim->setSTP(gPoiss, true);
+		sim->setSTDP(gExc, true, STANDARD, 0.001f, 20.0f, 0.0015f, 20.0f);
+		sim->setConductances(true);
+
+		sim->setupNetwork();
+		sim->setSpikeRate(gPoiss, &poissRate);
+		SpikeMonitor* spkMon = sim->setSpikeMonitor(gExc, "NULL");
+		ConnectionMonitor* connMon = sim->setConnectionMonitor(gPer, gExc, "NULL");
+
+		if (loadCp) {
+			sim->loadCheckpoint("results/checkpoint.dat");
+			EXPECT_EQ(sim->getSimTime(), 1300);
+		} else {
+			// the checkpoint is written in the background while the network keeps running
+			sim->runNetwork(1, 300, false);
+			sim->saveCheckpoint("results/checkpoint.dat");
+		}
+
+		spkMon->startRecording();
+		sim->runNetwork(0, 900, false);
+		spkMon->stopRecording();
+
+		spkTimes[loadCp] = spkMon->getSpikeVector2D();
+		wts[loadCp] = connMon->takeSnapshot();
+		delete sim;
+	}
+
+	EXPECT_GT(spkTimes[0].size(), 0);
+	ASSERT_EQ(spkTimes[0].size(), spkTimes[1].size());
+	for (int i = 0; i < spkTimes[0].size(); i++) {
+		ASSERT_EQ(spkTimes[0][i].size(), spkTimes[1][i].size());
+		for (int j = 0; j < spkTimes[0][i].size(); j++)
+			EXPECT_EQ(spkTimes[0][i][j], spkTimes[1][i][j]);
+	}
+	for (int i = 0; i < wts[0].size(); i++) {
+		for (int j = 0; j < wts[0][i].size(); j++) {
+			if (isnan(wts[0][i][j]))
+				EXPECT_TRUE(isnan(wts[1][i][j]));
+			else
+				EXPECT_FLOAT_EQ(wts[0][i][j], wts[1][i][j]);
+		}
+	}
+}
+
+// periodic checkpoints keep the most recent state
+TEST(Core, setCheckpointInterval) {
+	PeriodicSpikeGenerator spkGen(20.0f);
+
+	for (int loadCp = 0; loadCp <= 1; loadCp++) {
+		CARLsim* sim = new CARLsim("Core.setCheckpointInterval", CPU_MODE, SILENT, 1, 42);
+		int gIn = sim->createSpikeGeneratorGroup("input", 10, EXCITATORY_NEURON);
+		sim->setSpikeGenerator(gIn, &spkGen);
+		int gExc = sim->createGroup("excit", 10, EXCITATORY_NEURON);
+		sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->connect(gIn, gExc, "one-to-one", RangeWeight(0.5f), 1.0f, RangeDelay(1));
+		sim->setConductances(false);
+		if (!loadCp)
+			sim->setCheckpointInterval(300, "results/checkpoint_periodic.dat");
+
+		sim->setupNetwork();
+		if (loadCp) {
+			sim->loadCheckpoint("results/checkpoint_periodic.dat");
+			EXPECT_EQ(sim->getSimTime(), 900);
+		} else {
+			sim->runNetwork(1, 0, false);
+		}
+		delete sim;
+	}
+}
+
 TEST(Core, synapseIdOverflow) {
 	::testing::FLAGS_gtest_death_test_style = "threadsafe";
 
@@ -651,3 +800,651 @@ TEST(Core, synapseIdOverflow) {
 	
 	EXPECT_DEATH({ sim.setupNetwork(); }, ""); //sim.setupNetwork();
 }
+
+// the renumbering of neurons is internal: spikes, weights, and delays must be reported with the same IDs
+TEST(Core, setNeuronOrdering) {
+	std::vector<std::vector<int> > spkTimes[2];
+	std::vector<std::vector<float> > wts[2];
+	uint8_t* delays[2];
+
+	for (int order = 0; order < 2; order++) {
+		CARLsim* sim = new CARLsim("Core.setNeuronOrdering", CPU_MODE, SILENT, 1, 42);
+		Grid3D grid(7, 5, 3);
+		int gExc = sim->createGroup("excit", grid, EXCITATORY_NEURON);
+		sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+
+		// weights that can be summed up exactly, so that the order of spike delivery does not matter
+		int c0 = sim->connect(gExc, gExc, "random", RangeWeight(0.5f), 0.3f, RangeDelay(3), RadiusRF(2, 2, 1));
+		sim->setConductances(false);
+		sim->setNeuronOrdering(order == 0 ? CREATION_ORDER : HILBERT_ORDER);
+
+		sim->setupNetwork();
+
+		// drive every neuron with a different external current
+		std::vector<float> current(grid.N, 0.0f);
+		for (int i = 0; i < grid.N; i++)
+			current[i] = (float)(i % 8);
+		sim->setExternalCurrent(gExc, current);
+
+		SpikeMonitor* spkMon = sim->setSpikeMonitor(gExc, "NULL");
+		ConnectionMonitor* connMon = sim->setConnectionMonitor(gExc, gExc, "NULL");
+
+		spkMon->startRecording();
+		sim->runNetwork(1, 0, false);
+		spkMon->stopRecording();
+
+		spkTimes[order] = spkMon->getSpikeVector2D();
+		wts[order] = connMon->takeSnapshot();
+		int numPre, numPost;
+		delays[order] = sim->getDelays(gExc, gExc, numPre, numPost);
+
+		delete sim;
+	}
+
+	ASSERT_EQ(spkTimes[0].size(), spkTimes[1].size());
+	int numSpikes = 0;
+	for (int i = 0; i < spkTimes[0].size(); i++) {
+		EXPECT_EQ(spkTimes[0][i], spkTimes[1][i]);
+		numSpikes += spkTimes[0][i].size();
+	}
+	EXPECT_GT(numSpikes, 0);
+
+	ASSERT_EQ(wts[0].size(), wts[1].size());
+	for (int i = 0; i < wts[0].size(); i++) {
+		for (int j = 0; j < wts[0][i].size(); j++) {
+			if (isnan(wts[0][i][j]))
+				EXPECT_TRUE(isnan(wts[1][i][j]));
+			else
+				EXPECT_FLOAT_EQ(wts[0][i][j], wts[1][i][j]);
+		}
+	}
+
+	for (int i = 0; i < wts[0].size() * wts[0].size(); i++)
+		EXPECT_EQ(delays[0][i], delays[1][i]);
+
+	delete[] delays[0];
+	delete[] delays[1];
+}
+
+TEST(Core, neuronMonitorSlots) {
+	// record the same group once on its own and once next to an unmonitored and a second monitored group;
+	// the recorded neuron states must not depend on which other groups are monitored
+	std::vector<char> record[2];
+
+	for (int numMon = 1; numMon <= 2; numMon++) {
+		CARLsim* sim = new CARLsim("Core.neuronMonitorSlots", CPU_MODE, SILENT, 1, 42);
+		int g0 = sim->createGroup("excit0", 5, EXCITATORY_NEURON);
+		int g1 = sim->createGroup("excit1", 5, EXCITATORY_NEURON);
+		int g2 = sim->createGroup("excit2", 5, EXCITATORY_NEURON);
+		sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->setNeuronParameters(g2, 0.02f, 0.2f, -65.0f, 8.0f);
+		int gIn = sim->createSpikeGeneratorGroup("input", 5, EXCITATORY_NEURON);
+		sim->connect(gIn, g0, "one-to-one", RangeWeight(0.1f), 1.0f, RangeDelay(1));
+		sim->setConductances(false);
+
+		if (numMon > 1)
+			sim->setNeuronMonitor(g0, "NULL");
+		NeuronMonitor* nrnMon = sim->setNeuronMonitor(g2, "results/nrn_excit2.dat");
+
+		sim->setupNetwork();
+		sim->setExternalCurrent(g0, 3.0f);
+		sim->setExternalCurrent(g1, 5.0f);
+		sim->setExternalCurrent(g2, 7.0f);
+
+		nrnMon->startRecording();
+		sim->runNetwork(0, 200, false);
+		nrnMon->stopRecording();
+		delete sim;
+
+		FILE* fId = fopen("results/nrn_excit2.dat", "rb");
+		ASSERT_TRUE(fId != NULL);
+		char c;
+		while (fread(&c, sizeof(char), 1, fId) == 1)
+			record[numMon - 1].push_back(c);
+		fclose(fId);
+	}
+
+	// header plus at least one (nId, time, v, u, I) record per neuron and ms
+	EXPECT_GE(record[0].size(), 5 * sizeof(int) + 200 * 5 * (2 * sizeof(int) + 3 * sizeof(float)));
+	ASSERT_EQ(record[0].size(), record[1].size());
+	EXPECT_TRUE(record[0] == record[1]);
+}
+
+TEST(Core, neuronMonitorSampling) {
+	// a group too large for a NeuronMonitor slot streams three of its neurons every 7 ms; since all neurons are
+	// identical, every sample must match the state of neuron 0 recorded by a regular NeuronMonitor
+	const int numN = 4000, stride = 7, runMs = 1000;
+	std::vector<float> state[2]; // v, u, I of neuron 0 at every ms
+	for (int sampling = 0; sampling <= 1; sampling++) {
+		CARLsim* sim = new CARLsim("Core.neuronMonitorSampling", CPU_MODE, SILENT, 1, 42);
+		int g0 = sim->createGroup("excit", numN, EXCITATORY_NEURON);
+		int g1 = sim->createGroup("other", 5, EXCITATORY_NEURON);
+		sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+		int gIn = sim->createSpikeGeneratorGroup("input", 5, EXCITATORY_NEURON);
+		sim->connect(gIn, g1, "one-to-one", RangeWeight(0.1f), 1.0f, RangeDelay(1));
+		sim->setConductances(false);
+		sim->setNeuronMonitor(g0, "results/nrn_sampling.dat");
+		if (sampling) {
+			std::vector<int> neurIds;
+			neurIds.push_back(numN - 1);
+			neurIds.push_back(0);
+			neurIds.push_back(numN / 2);
+			sim->setNeuronMonitorSampling(g0, neurIds, stride);
+		}
+
+		sim->setupNetwork();
+		sim->setExternalCurrent(g0, 5.0f);
+		sim->runNetwork(0, runMs / 2, false);
+		sim->runNetwork(0, runMs / 2, false);
+		delete sim;
+
+		FILE* fId = fopen("results/nrn_sampling.dat", "rb");
+		ASSERT_TRUE(fId != NULL);
+		int header[5];
+		ASSERT_EQ(fread(header, sizeof(int), 5, fId), 5);
+		if (!sampling) {
+			// (nId, time, v, u, I) records of the first MAX_NEURON_MON_GRP_SZIE neurons
+			int rec[5];
+			while (fread(rec, sizeof(int), 5, fId) == 5) {
+				if (rec[0] == 0) {
+					EXPECT_EQ(rec[1], (int)state[0].size() / 3);
+					state[0].insert(state[0].end(), (float*)&rec[2], (float*)&rec[5]);
+				}
+			}
+		} else {
+			int numSampled, strideMs, ids[3];
+			ASSERT_EQ(fread(&numSampled, sizeof(int), 1, fId), 1);
+			ASSERT_EQ(fread(&strideMs, sizeof(int), 1, fId), 1);
+			EXPECT_EQ(numSampled, 3);
+			EXPECT_EQ(strideMs, stride);
+			ASSERT_EQ(fread(ids, sizeof(int), 3, fId), 3);
+			EXPECT_EQ(ids[0], 0);
+			EXPECT_EQ(ids[1], numN / 2);
+			EXPECT_EQ(ids[2], numN - 1);
+
+			// blocks of consecutive samples, each with v, u, I of all sampled neurons
+			int block[2], numSamples = 0;
+			while (fread(block, sizeof(int), 2, fId) == 2) {
+				EXPECT_EQ(block[0], numSamples * stride);
+				for (int s = 0; s < block[1]; s++, numSamples++) {
+					float sample[9];
+					ASSERT_EQ(fread(sample, sizeof(float), 9, fId), 9);
+					for (int i = 0; i < 3; i++) {
+						EXPECT_FLOAT_EQ(sample[i], sample[0]);
+						EXPECT_FLOAT_EQ(sample[3 + i], sample[3]);
+						EXPECT_FLOAT_EQ(sample[6 + i], sample[6]);
+					}
+					state[1].insert(state[1].end(), &sample[0], &sample[1]);
+					state[1].insert(state[1].end(), &sample[3], &sample[4]);
+					state[1].insert(state[1].end(), &sample[6], &sample[7]);
+				}
+			}
+			EXPECT_EQ(numSamples, (runMs + stride - 1) / stride);
+		}
+		fclose(fId);
+	}
+
+	ASSERT_EQ(state[0].size(), 3 * runMs);
+	ASSERT_EQ(state[1].size(), 3 * ((runMs + stride - 1) / stride));
+	for (int i = 0; i < state[1].size(); i++)
+		EXPECT_FLOAT_EQ(state[1][i], state[0][(i / 3) * stride * 3 + i % 3]);
+}
+
+TEST(Core, neuronMonitorSamplingPacked) {
+	// sampling three neurons spread over a group must only cost a ring buffer of three neurons, and every neuron
+	// must end up in its own column of a sample: without synaptic input, I is the external current of the neuron
+	const int numN = 1000, runMs = 50;
+	CARLsim* sim = new CARLsim("Core.neuronMonitorSamplingPacked", CPU_MODE, SILENT, 1, 42);
+	int g0 = sim->createGroup("excit", numN, EXCITATORY_NEURON);
+	int g1 = sim->createGroup("other", 5, EXCITATORY_NEURON);
+	sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+	int gIn = sim->createSpikeGeneratorGroup("input", 5, EXCITATORY_NEURON);
+	sim->connect(gIn, g1, "one-to-one", RangeWeight(0.1f), 1.0f, RangeDelay(1));
+	sim->setConductances(false);
+	sim->setNeuronMonitor(g0, "results/nrn_sampling_packed.dat");
+	std::vector<int> neurIds;
+	neurIds.push_back(numN - 1);
+	neurIds.push_back(0);
+	neurIds.push_back(numN / 2);
+	sim->setNeuronMonitorSampling(g0, neurIds, 1);
+	sim->setupNetwork();
+
+	MemoryReport mem = sim->getMemoryReport();
+	size_t streamBytes = 0;
+	for (int i = 0; i < mem.arrays.size(); i++)
+		if (mem.arrays[i].partition == "CPU 0" && mem.arrays[i].array == "nStreamBuffer")
+			streamBytes += mem.arrays[i].bytes;
+	EXPECT_EQ(streamBytes, 3 * 3 * 1000 * sizeof(float)); // 3 neurons, (v, u, I), a full second
+
+	std::vector<float> current(numN);
+	for (int i = 0; i < numN; i++)
+		current[i] = 1.0f + 0.01f * i;
+	sim->setExternalCurrent(g0, current);
+	sim->runNetwork(0, runMs, false);
+	delete sim;
+
+	FILE* fId = fopen("results/nrn_sampling_packed.dat", "rb");
+	ASSERT_TRUE(fId != NULL);
+	int header[5], numSampled, strideMs, ids[3];
+	ASSERT_EQ(fread(header, sizeof(int), 5, fId), 5);
+	ASSERT_EQ(fread(&numSampled, sizeof(int), 1, fId), 1);
+	ASSERT_EQ(fread(&strideMs, sizeof(int), 1, fId), 1);
+	ASSERT_EQ(numSampled, 3);
+	ASSERT_EQ(fread(ids, sizeof(int), 3, fId), 3);
+
+	int block[2], numSamples = 0;
+	while (fread(block, sizeof(int), 2, fId) == 2) {
+		for (int s = 0; s < block[1]; s++, numSamples++) {
+			float sample[9];
+			ASSERT_EQ(fread(sample, sizeof(float), 9, fId), 9);
+			for (int i = 0; i < 3; i++)
+				EXPECT_FLOAT_EQ(sample[6 + i], current[ids[i]]);
+		}
+	}
+	EXPECT_EQ(numSamples, runMs);
+	fclose(fId);
+}
+
+TEST(Core, setNetworkImage) {
+	std::vector<std::vector<int> > spkTimes[2];
+	std::vector<std::vector<float> > wts[2];
+	uint8_t* delays[2];
+	remove("results/net_image.dat");
+
+	// 0: the image gets written, 1: the image gets loaded
+	for (int run = 0; run < 2; run++) {
+		CARLsim* sim = new CARLsim("Core.setNetworkImage", CPU_MODE, SILENT, 1, 42);
+		int gExc = sim->createGroup("excit", Grid3D(10, 10, 1), EXCITATORY_NEURON);
+		int gInh = sim->createGroup("inhib", 20, INHIBITORY_NEURON);
+		// parameter noise is drawn after the connectivity and must not depend on whether the image was used
+		sim->setNeuronParameters(gExc, 0.02f, 0.01f, 0.2f, 0.0f, -65.0f, 0.0f, 8.0f, 0.0f);
+		sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+		int cEE = sim->connect(gExc, gExc, "random", RangeWeight(0.0f, 0.5f, 1.0f), 0.1f, RangeDelay(1, 10),
+			RadiusRF(-1), SYN_PLASTIC);
+		sim->connect(gExc, gInh, "random", RangeWeight(0.5f), 0.2f, RangeDelay(1, 5));
+		sim->connect(gInh, gExc, "random", RangeWeight(0.5f), 0.2f, RangeDelay(1));
+		sim->setConductances(false);
+		sim->setNetworkImage("results/net_image.dat");
+
+		sim->setupNetwork();
+		sim->setExternalCurrent(gExc, 6.0f);
+
+		SpikeMonitor* spkMon = sim->setSpikeMonitor(gExc, "NULL");
+		ConnectionMonitor* connMon = sim->setConnectionMonitor(gExc, gExc, "NULL");
+
+		spkMon->startRecording();
+		sim->runNetwork(0, 500, false);
+		spkMon->stopRecording();
+
+		spkTimes[run] = spkMon->getSpikeVector2D();
+		wts[run] = connMon->takeSnapshot();
+		int numPre, numPost;
+		delays[run] = sim->getDelays(gExc, gExc, numPre, numPost);
+		EXPECT_EQ(sim->getNumSynapticConnections(cEE), connMon->getNumSynapses());
+
+		delete sim;
+
+		FILE* fId = fopen("results/net_image.dat", "rb");
+		EXPECT_TRUE(fId != NULL);
+		if (fId != NULL)
+			fclose(fId);
+	}
+
+	// delays are drawn with rand(), so the loaded network only matches the one the image was written from
+	EXPECT_TRUE(spkTimes[0] == spkTimes[1]);
+	ASSERT_EQ(wts[0].size(), wts[1].size());
+	for (int i = 0; i < wts[0].size(); i++) {
+		for (int j = 0; j < wts[0][i].size(); j++) {
+			if (isnan(wts[0][i][j]))
+				EXPECT_TRUE(isnan(wts[1][i][j]));
+			else
+				EXPECT_FLOAT_EQ(wts[0][i][j], wts[1][i][j]);
+		}
+	}
+
+	for (int i = 0; i < wts[0].size() * wts[0].size(); i++)
+		EXPECT_EQ(delays[0][i], delays[1][i]);
+
+	delete[] delays[0];
+	delete[] delays[1];
+}
+
+/*!
+ * \brief Makes sure that the profiler accounts for every phase of every simulated ms
+ *
+ * Two CPU partitions are stepped for 1.5 sec with a SpikeMonitor. Every per-ms phase must be called once per ms, the
+ * phases must not take longer than the run itself, and both partitions must report their own work.
+ */
+TEST(Core, getPerformanceReport) {
+	CARLsim* sim = new CARLsim("Core.getPerformanceReport", CPU_MODE, SILENT, 0, 42);
+	int gIn = sim->createSpikeGeneratorGroup("input", 100, EXCITATORY_NEURON, 0, CPU_CORES);
+	int gExc = sim->createGroup("exc", 100, EXCITATORY_NEURON, 1, CPU_CORES);
+	sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->connect(gIn, gExc, "random", RangeWeight(0.5f), 0.1f);
+	sim->setConductances(true);
+	sim->setupNetwork();
+
+	PoissonRate in(100);
+	in.setRates(20.0f);
+	sim->setSpikeRate(gIn, &in);
+	sim->setSpikeMonitor(gExc, "NULL");
+
+	PerformanceReport report = sim->getPerformanceReport();
+	EXPECT_EQ(report.numSteps, 0);
+	EXPECT_EQ(report.runTimeMs, 0.0);
+
+	sim->runNetwork(1, 0);
+	sim->runNetwork(0, 500);
+	report = sim->getPerformanceReport();
+	delete sim;
+
+	EXPECT_EQ(report.numSteps, 1500);
+	EXPECT_GT(report.runTimeMs, 0.0);
+#ifndef __NO_PROFILING__
+	ASSERT_TRUE(report.enabled);
+	double sumMs = 0.0;
+	for (int i = PROFILER_STP_DECAY; i <= PROFILER_CLEAR_EXT_FIRING; i++) {
+		EXPECT_EQ(report.phaseCalls[i], 1500);
+		EXPECT_GT(report.phaseTimeMs[i], 0.0);
+	}
+	EXPECT_EQ(report.phaseCalls[PROFILER_SPIKE_COUNT], 0); // fetched on query only, SILENT prints no summary
+	EXPECT_EQ(report.phaseCalls[PROFILER_UPDATE_WEIGHTS], 0);
+	EXPECT_GT(report.phaseCalls[PROFILER_SPIKE_MONITOR], 0);
+	for (int i = 0; i < NUM_PROFILER_PHASES; i++)
+		sumMs += report.phaseTimeMs[i];
+	EXPECT_LE(sumMs, report.runTimeMs);
+
+	ASSERT_EQ(report.partitionNames.size(), 2);
+	EXPECT_EQ(report.partitionNames[0], "CPU 0");
+	EXPECT_EQ(report.partitionNames[1], "CPU 1");
+	for (int p = 0; p < 2; p++) {
+		ASSERT_EQ(report.partitionTimeMs[p].size(), NUM_PROFILER_PHASES);
+		EXPECT_GT(report.partitionTimeMs[p][PROFILER_FIND_FIRING], 0.0);
+		EXPECT_LE(report.partitionTimeMs[p][PROFILER_FIND_FIRING], report.phaseTimeMs[PROFILER_FIND_FIRING]);
+		EXPECT_EQ(report.partitionTimeMs[p][PROFILER_ROUTE_SPIKES], 0.0);
+	}
+#else
+	EXPECT_FALSE(report.enabled);
+#endif
+}
+
+/*!
+ * \brief Makes sure that spike counts are only fetched when they are queried
+ *
+ * Without a run summary nothing reads the spike counts, so runNetwork must not fetch them. Every run summary fetches
+ * the spike counts of the monitored group once.
+ */
+TEST(Core, lazySpikeCount) {
+	CARLsim* sim = new CARLsim("Core.lazySpikeCount", CPU_MODE, USER, 0, 42);
+	int gIn = sim->createSpikeGeneratorGroup("input", 10, EXCITATORY_NEURON);
+	int gExc = sim->createGroup("exc", 10, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->connect(gIn, gExc, "one-to-one", RangeWeight(20.0f), 1.0f);
+	sim->setConductances(false);
+	sim->setupNetwork();
+
+	PoissonRate in(10);
+	in.setRates(20.0f);
+	sim->setSpikeRate(gIn, &in);
+	SpikeMonitor* spkMon = sim->setSpikeMonitor(gExc, "NULL");
+
+	sim->runNetwork(1, 0, false);
+	PerformanceReport report = sim->getPerformanceReport();
+#ifndef __NO_PROFILING__
+	EXPECT_EQ(report.phaseCalls[PROFILER_SPIKE_COUNT], 0);
+#endif
+
+	spkMon->startRecording();
+	sim->runNetwork(1, 0, true);
+	sim->runNetwork(0, 500, true);
+	spkMon->stopRecording();
+	report = sim->getPerformanceReport();
+#ifndef __NO_PROFILING__
+	EXPECT_EQ(report.phaseCalls[PROFILER_SPIKE_COUNT], 2);
+#endif
+	EXPECT_GT(spkMon->getPopNumSpikes(), 0);
+
+	delete sim;
+}
+
+/*!
+ * \brief Makes sure that the hot-path event counters count every event exactly once
+ *
+ * A Poisson group on one CPU partition drives a group on another partition one-to-one, so every input spike is
+ * routed to the second partition and delivered to exactly one synapse there. A plastic connection within the second
+ * partition has to evaluate both LTP and LTD.
+ */
+TEST(Core, eventCounts) {
+	const int GRP_SIZE = 100;
+	CARLsim* sim = new CARLsim("Core.eventCounts", CPU_MODE, SILENT, 0, 42);
+	int gIn = sim->createSpikeGeneratorGroup("input", GRP_SIZE, EXCITATORY_NEURON, 0, CPU_CORES);
+	int gExc = sim->createGroup("exc", GRP_SIZE, EXCITATORY_NEURON, 1, CPU_CORES);
+	int gOut = sim->createGroup("out", GRP_SIZE, EXCITATORY_NEURON, 1, CPU_CORES);
+	sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->connect(gIn, gExc, "one-to-one", RangeWeight(1.0f), 1.0f);
+	sim->connect(gExc, gOut, "full", RangeWeight(0.0f, 0.05f, 0.1f), 1.0f, RangeDelay(1, 5), RadiusRF(-1), SYN_PLASTIC);
+	sim->setESTDP(gOut, true, STANDARD, ExpCurve(2e-4f, 20.0f, -6.6e-5f, 60.0f));
+	sim->setConductances(true);
+	sim->setupNetwork();
+
+	PoissonRate in(GRP_SIZE);
+	in.setRates(30.0f);
+	sim->setSpikeRate(gIn, &in);
+	SpikeMonitor* SM = sim->setSpikeMonitor(gIn, "NULL");
+	SM->startRecording();
+	sim->runNetwork(2, 500);
+	SM->stopRecording();
+	int numInputSpikes = SM->getPopNumSpikes();
+	PerformanceReport report = sim->getPerformanceReport();
+	delete sim;
+
+	ASSERT_EQ(report.partitionEvents.size(), 2);
+	ASSERT_EQ(report.partitionEventsLastSec.size(), 2);
+	const EventCounts& ev0 = report.partitionEvents[0];
+	const EventCounts& ev1 = report.partitionEvents[1];
+	EXPECT_EQ(ev0.poissonDraws, 2500 * GRP_SIZE);
+	EXPECT_EQ(ev0.synEvents, 0);
+	EXPECT_EQ(ev1.poissonDraws, 0);
+	EXPECT_EQ(report.partitionEventsLastSec[0].poissonDraws, 1000 * GRP_SIZE);
+
+	// every input spike is routed to partition 1 and delivered through a single synapse
+	ASSERT_GT(numInputSpikes, 0);
+	EXPECT_EQ(ev1.extSpikesRouted, numInputSpikes);
+	EXPECT_GE(ev1.synEvents, numInputSpikes);
+	EXPECT_GT(ev1.ltpEvals, 0);
+	EXPECT_GT(ev1.ltdEvals, 0);
+	EXPECT_EQ(ev0.spikesDropped + ev1.spikesDropped, 0);
+	EXPECT_EQ(report.events.synEvents, ev0.synEvents + ev1.synEvents);
+	EXPECT_EQ(report.events.poissonDraws, ev0.poissonDraws);
+}
+
+/*!
+ * \brief Makes sure that hardware counters are either measured per phase or degrade gracefully
+ *
+ * Whether perf_event counters can be opened depends on the platform and kernel.perf_event_paranoid, so the test only
+ * checks that the report is consistent: either all phases of the simulation step count instructions, or nothing was
+ * measured at all.
+ */
+TEST(Core, hardwareCounters) {
+	CARLsim* sim = new CARLsim("Core.hardwareCounters", CPU_MODE, SILENT, 0, 42);
+	int gIn = sim->createSpikeGeneratorGroup("input", 100, EXCITATORY_NEURON, 0, CPU_CORES);
+	int gExc = sim->createGroup("exc", 100, EXCITATORY_NEURON, 0, CPU_CORES);
+	sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->connect(gIn, gExc, "random", RangeWeight(0.5f), 0.1f);
+	sim->setConductances(true);
+	sim->setHardwareCounters(true);
+	sim->setupNetwork();
+
+	PoissonRate in(100);
+	in.setRates(20.0f);
+	sim->setSpikeRate(gIn, &in);
+	sim->runNetwork(0, 500);
+	PerformanceReport report = sim->getPerformanceReport();
+	delete sim;
+
+	if (report.hwCountersEnabled) {
+		for (int i = PROFILER_STP_DECAY; i <= PROFILER_CLEAR_EXT_FIRING; i++) {
+			EXPECT_GT(report.phaseHwCounts[i][HW_INSTRUCTIONS], 0);
+			EXPECT_GE(report.phaseHwCounts[i][HW_CYCLES], 0);
+		}
+		EXPECT_EQ(report.phaseHwCounts[PROFILER_UPDATE_WEIGHTS][HW_INSTRUCTIONS], 0);
+	} else {
+		for (int i = 0; i < NUM_PROFILER_PHASES; i++)
+			for (int j = 0; j < NUM_HW_COUNTERS; j++)
+				EXPECT_EQ(report.phaseHwCounts[i][j], 0);
+	}
+}
+
+/*!
+ * \brief Makes sure that the trace file contains the sampled steps of every thread
+ *
+ * With a sample interval of 100 ms, 1.5 sec of simulation record the steps at t=0,100,...,1400 plus the step that
+ * finishes the first second (t=999). Both CPU partitions must show up as named threads.
+ */
+TEST(Core, setTraceFile) {
+	CARLsim* sim = new CARLsim("Core.setTraceFile", CPU_MODE, SILENT, 0, 42);
+	int gIn = sim->createSpikeGeneratorGroup("input", 100, EXCITATORY_NEURON, 0, CPU_CORES);
+	int gExc = sim->createGroup("exc", 100, EXCITATORY_NEURON, 1, CPU_CORES);
+	sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->connect(gIn, gExc, "random", RangeWeight(0.5f), 0.1f);
+	sim->setConductances(true);
+	sim->setTraceFile("results/trace.json", 100);
+	sim->setupNetwork();
+
+	PoissonRate in(100);
+	in.setRates(20.0f);
+	sim->setSpikeRate(gIn, &in);
+	sim->setSpikeMonitor(gExc, "NULL");
+	sim->runNetwork(1, 0);
+	sim->runNetwork(0, 500);
+	delete sim;
+
+#ifndef __NO_PROFILING__
+	std::ifstream file("results/trace.json");
+	ASSERT_TRUE(file.is_open());
+	std::string line, lastLine;
+	int numManagerFindFiring = 0, numPartitionFindFiring = 0, numShift = 0;
+	bool foundCpu0 = false, foundCpu1 = false;
+	std::getline(file, line);
+	EXPECT_EQ(line, "[");
+	while (std::getline(file, line)) {
+		if (!line.empty())
+			lastLine = line;
+		if (line.find("\"name\":\"findFiring\"") != std::string::npos) {
+			if (line.find("\"tid\":0,") != std::string::npos)
+				numManagerFindFiring++;
+			else
+				numPartitionFindFiring++;
+		}
+		if (line.find("\"name\":\"shiftSpikeTables\"") != std::string::npos && line.find("\"tid\":0,") != std::string::npos)
+			numShift++;
+		foundCpu0 = foundCpu0 || line.find("\"args\":{\"name\":\"CPU 0\"}") != std::string::npos;
+		foundCpu1 = foundCpu1 || line.find("\"args\":{\"name\":\"CPU 1\"}") != std::string::npos;
+	}
+	EXPECT_EQ(lastLine, "]");
+	EXPECT_EQ(numManagerFindFiring, 16);
+	EXPECT_EQ(numPartitionFindFiring, 2 * 16);
+	EXPECT_EQ(numShift, 1);
+	EXPECT_TRUE(foundCpu0);
+	EXPECT_TRUE(foundCpu1);
+#endif
+}
+
+/*!
+ * \brief testing CARLsim::estimateMemory and CARLsim::getMemoryReport
+ *
+ * For a network with only full connections, the estimate must match the arrays that setupNetwork allocates.
+ */
+TEST(Core, memoryReport) {
+	CARLsim* sim = new CARLsim("Core.memoryReport", CPU_MODE, SILENT, 0, 42);
+	int gIn = sim->createSpikeGeneratorGroup("input", 100, EXCITATORY_NEURON, 0, CPU_CORES);
+	int gExc = sim->createGroup("exc", 200, EXCITATORY_NEURON, 1, CPU_CORES);
+	sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->connect(gIn, gExc, "full", RangeWeight(0.1f), 1.0f, RangeDelay(1, 5));
+	sim->connect(gExc, gExc, "full-no-direct", RangeWeight(0.01f), 1.0f);
+	sim->setConductances(true);
+
+	MemoryReport estimate = sim->estimateMemory();
+	EXPECT_TRUE(estimate.isEstimate);
+	EXPECT_EQ(estimate.peakRssBytes, 0);
+
+	sim->setupNetwork();
+	sim->setSpikeMonitor(gExc, "NULL");
+	MemoryReport report = sim->getMemoryReport();
+	EXPECT_FALSE(report.isEstimate);
+	EXPECT_GT(report.peakRssBytes, 0);
+
+	// the number of synapses held by each partition (the external connection is held by both)
+	size_t numSynCpu0 = 100 * 200;
+	size_t numSynCpu1 = 100 * 200 + 200 * 199;
+	std::map<std::string, size_t> estimateBytes, reportBytes;
+	for (int i = 0; i < estimate.arrays.size(); i++)
+		estimateBytes[estimate.arrays[i].partition + "/" + estimate.arrays[i].array] += estimate.arrays[i].bytes;
+	for (int i = 0; i < report.arrays.size(); i++)
+		reportBytes[report.arrays[i].partition + "/" + report.arrays[i].array] += report.arrays[i].bytes;
+	EXPECT_EQ(reportBytes["CPU 0/wt"], numSynCpu0 * sizeof(float));
+	EXPECT_EQ(reportBytes["CPU 1/wt"], numSynCpu1 * sizeof(float));
+	EXPECT_EQ(reportBytes["setup/connectionLists"], estimateBytes["setup/connectionLists"]);
+	EXPECT_GT(reportBytes["monitors/SpikeMonitor(exc)"], 0);
+
+	const char* partitions[] = {"manager", "CPU 0", "CPU 1"};
+	for (int p = 0; p < 3; p++) {
+		EXPECT_GT(report.getBytes(partitions[p]), 0);
+		EXPECT_EQ(estimate.getBytes(partitions[p]),
+			report.getBytes(partitions[p]) - reportBytes[std::string(partitions[p]) + "/arena (unused)"]);
+	}
+	for (std::map<std::string, size_t>::iterator it = estimateBytes.begin(); it != estimateBytes.end(); it++)
+		EXPECT_EQ(it->second, reportBytes[it->first]) << it->first;
+
+	delete sim;
+}
+
+/*!
+ * \brief testing CARLsim::getSetupReport
+ *
+ * This test sets up a network with two connection types across two partitions and makes sure that every stage was
+ * timed, that nested stages take no longer than the stages that contain them, and that the synapses are attributed
+ * to the right connection types.
+ */
+TEST(Core, setupReport) {
+	CARLsim* sim = new CARLsim("Core.setupReport", CPU_MODE, SILENT, 0, 42);
+	int gIn = sim->createSpikeGeneratorGroup("input", 100, EXCITATORY_NEURON, 0, CPU_CORES);
+	int gExc = sim->createGroup("exc", 100, EXCITATORY_NEURON, 1, CPU_CORES);
+	sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->connect(gIn, gExc, "one-to-one", RangeWeight(0.1f), 1.0f, RangeDelay(1, 5));
+	sim->connect(gExc, gExc, "random", RangeWeight(0.01f), 0.1f);
+	sim->setConductances(true);
+	sim->setupNetwork();
+
+	SetupReport report = sim->getSetupReport();
+	EXPECT_GT(report.setupTimeMs, 0.0);
+	EXPECT_GT(report.peakRssBytes, 0);
+	EXPECT_EQ(report.stageCalls[SETUP_COMPILE], 1);
+	EXPECT_EQ(report.stageCalls[SETUP_PARTITION], 1);
+	EXPECT_EQ(report.stageCalls[SETUP_CONNECT], 1);
+	EXPECT_EQ(report.stageCalls[SETUP_CONNECT_ONE_TO_ONE], 1);
+	EXPECT_EQ(report.stageCalls[SETUP_CONNECT_RANDOM], 1);
+	EXPECT_EQ(report.stageCalls[SETUP_CONNECT_FULL], 0);
+	EXPECT_EQ(report.stageCalls[SETUP_GENERATE_RUNTIME], 1);
+	EXPECT_EQ(report.stageCalls[SETUP_CONNECTION_RUNTIME], 2); // one per partition
+	EXPECT_EQ(report.stageCalls[SETUP_ALLOCATE], 2);
+
+	EXPECT_LE(report.stageTimeMs[SETUP_CONNECT], report.stageTimeMs[SETUP_PARTITION]);
+	EXPECT_LE(report.stageTimeMs[SETUP_CONNECT_ONE_TO_ONE] + report.stageTimeMs[SETUP_CONNECT_RANDOM],
+		report.stageTimeMs[SETUP_CONNECT]);
+	EXPECT_LE(report.stageTimeMs[SETUP_CONNECTION_RUNTIME] + report.stageTimeMs[SETUP_ALLOCATE],
+		report.stageTimeMs[SETUP_GENERATE_RUNTIME]);
+	EXPECT_LE(report.stageTimeMs[SETUP_COMPILE] + report.stageTimeMs[SETUP_PARTITION]
+		+ report.stageTimeMs[SETUP_GENERATE_RUNTIME], report.setupTimeMs);
+
+	EXPECT_EQ(report.stageSynapses[SETUP_CONNECT_ONE_TO_ONE], 100);
+	EXPECT_EQ(report.stageSynapses[SETUP_CONNECT_ONE_TO_ONE] + report.stageSynapses[SETUP_CONNECT_RANDOM],
+		sim->getNumSynapses());
+	EXPECT_LE(report.stagePeakRssBytes[SETUP_COMPILE], report.peakRssBytes);
+
+	delete sim;
+}
@@ -269,3 +269,60 @@ TEST(GroupMon, peakTimeAndValue) {
 		delete sim;
 	}
 }
+
+/*
+ * This test verifies that the group data file holds the dopamine concentration of every ms in consecutive chunks,
+ * and that the values match the ones recorded by the GroupMonitor object.
+ */
+TEST(GroupMon, fileChunks) {
+	CARLsim* sim = new CARLsim("GroupMon.fileChunks", CPU_MODE, SILENT, 1, 42);
+	int g1 = sim->createGroup("g1", 10, EXCITATORY_NEURON);
+	sim->setNeuronParameters(g1, 0.02f, 0.0f, 0.2f, 0.0f, -65.0f, 0.0f, 8.0f, 0.0f);
+	int g0 = sim->createSpikeGeneratorGroup("Input", 10, DOPAMINERGIC_NEURON);
+	sim->setConductances(true);
+	sim->connect(g0, g1, "one-to-one", RangeWeight(1.0f), 1.0f, RangeDelay(1), RadiusRF(-1), SYN_PLASTIC);
+	sim->setESTDP(g1, true, DA_MOD, ExpCurve(0.1f/100, 20, -0.12f/100, 20));
+	sim->setNeuromodulator(ALL);
+	PeriodicSpikeGenerator* spkGen = new PeriodicSpikeGenerator(10, false);
+	sim->setSpikeGenerator(g0, spkGen);
+	GroupMonitor* groupMon = sim->setGroupMonitor(g1, "results/grp_fileChunks.dat");
+	sim->setupNetwork();
+
+	groupMon->startRecording();
+	sim->runNetwork(1, 0);
+	groupMon->stopRecording();
+	sim->runNetwork(0, 500);
+	std::vector<float> dataVector = groupMon->getDataVector();
+	delete sim;
+	delete spkGen;
+
+	FILE* fId = fopen("results/grp_fileChunks.dat", "rb");
+	ASSERT_TRUE(fId != NULL);
+	int signature, grid[3], numValues;
+	float version;
+	ASSERT_EQ(fread(&signature, sizeof(int), 1, fId), 1);
+	ASSERT_EQ(fread(&version, sizeof(float), 1, fId), 1);
+	ASSERT_EQ(fread(grid, sizeof(int), 3, fId), 3);
+	ASSERT_EQ(fread(&numValues, sizeof(int), 1, fId), 1);
+	EXPECT_EQ(signature, 206661989);
+	EXPECT_FLOAT_EQ(version, 0.3f);
+	EXPECT_EQ(numValues, 1);
+
+	std::vector<float> fileData;
+	int chunk[2];
+	while (fread(chunk, sizeof(int), 2, fId) == 2) {
+		EXPECT_EQ(chunk[0], (int)fileData.size());
+		EXPECT_GT(chunk[1], 0);
+		EXPECT_LE(chunk[1], 1000);
+		std::vector<float> values(chunk[1]);
+		ASSERT_EQ(fread(&values[0], sizeof(float), chunk[1], fId), chunk[1]);
+		fileData.insert(fileData.end(), values.begin(), values.end());
+	}
+	fclose(fId);
+
+	ASSERT_EQ(fileData.size(), 1500);
+	ASSERT_EQ(dataVector.size(), 1000);
+	for (int t = 0; t < 1000; t++)
+		EXPECT_FLOAT_EQ(fileData[t], dataVector[t]);
+	EXPECT_GT(fileData[101], 1.0f); // dopamine released by the first spikes
+}
@@ -174,6 +174,60 @@ TEST(MultiRuntimes, spikesSingleVsMultiX2) {
 	}
 }
 
+// thread placement must not change the outcome of a simulation on two CPU partitions
+TEST(MultiRuntimes, setCPUAffinity) {
+	std::vector<std::vector<int> > spikes[3];
+
+	for (int placement = 0; placement < 3; placement++) {
+		CARLsim* sim = new CARLsim("MultiRuntimes.setCPUAffinity", CPU_MODE, SILENT, 0, 42);
+
+		int gExc = sim->createGroup("exc", 10, EXCITATORY_NEURON, 0, CPU_CORES);
+		sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+		int gExc2 = sim->createGroup("exc2", 10, EXCITATORY_NEURON, 1, CPU_CORES);
+		sim->setNeuronParameters(gExc2, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+
+		sim->connect(gExc, gExc2, "one-to-one", RangeWeight(30.0f), 1.0f, RangeDelay(2), RadiusRF(-1), SYN_FIXED);
+		sim->setConductances(false);
+
+		if (placement == 1) {
+			sim->setCPUAffinityPolicy(NODE_PER_PARTITION);
+		} else if (placement == 2) {
+			// both partitions share core 0, the second core does not exist and is ignored
+			sim->setCPUAffinity(0, std::vector<int>(1, 0));
+			std::vector<int> cores;
+			cores.push_back(0);
+			cores.push_back(1 << 20);
+			sim->setCPUAffinity(1, cores);
+		}
+
+		sim->setupNetwork();
+
+		std::vector<float> current(10, 0.0f);
+		for (int i = 0; i < 10; i++)
+			current[i] = 4.0f + i;
+		sim->setExternalCurrent(gExc, current);
+
+		SpikeMonitor* smExc2 = sim->setSpikeMonitor(gExc2, "NULL");
+		smExc2->startRecording();
+		sim->runNetwork(1, 0, false);
+		smExc2->stopRecording();
+
+		spikes[placement] = smExc2->getSpikeVector2D();
+		delete sim;
+	}
+
+	int numSpikes = 0;
+	for (int nId = 0; nId < spikes[0].size(); nId++)
+		numSpikes += spikes[0][nId].size();
+	EXPECT_GT(numSpikes, 0);
+
+	for (int placement = 1; placement < 3; placement++) {
+		ASSERT_EQ(spikes[0].size(), spikes[placement].size());
+		for (int nId = 0; nId < spikes[0].size(); nId++)
+			EXPECT_EQ(spikes[0][nId], spikes[placement][nId]);
+	}
+}
+
 TEST(MultiRuntimes, spikesSingleVsMultiX2_2_GPU_MultiGPU) {
 	int gExc, gExc2, gInput;
 	std::vector<std::vector<int> > spikesSingleRuntime, spikesMultiRuntimes;
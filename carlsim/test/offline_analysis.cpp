@@ -0,0 +1,277 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include "gtest/gtest.h"
+#include "carlsim_tests.h"
+
+#include <carlsim.h>
+
+#include <spike_analyzer.h>
+#include <connection_file_reader.h>
+#include <group_file_reader.h>
+#include <simulation_file_reader.h>
+
+#include <math.h>	// sqrt, isnan
+#include <vector>
+
+
+/// ****************************************************************************
+/// TESTS FOR THE OFFLINE ANALYSIS LIBRARY
+/// ****************************************************************************
+
+/*!
+ * \brief Makes sure that SpikeAnalyzer reproduces the statistics of a SpikeMonitor
+ *
+ * A Poisson group drives an excitatory group. The spike files of both groups are analyzed offline, with several
+ * threads, and the firing rates, population rates, and ISI statistics are compared to the ones computed from the
+ * SpikeMonitor's spike vectors.
+ */
+TEST(OfflineAnalysis, spikeAnalyzer) {
+	const int GRP_SIZE = 50;
+	const int RUN_TIME_SEC = 3;
+
+	for (int mode = 0; mode < TESTED_MODES; mode++) {
+		CARLsim* sim = new CARLsim("OfflineAnalysis.spikeAnalyzer", mode?GPU_MODE:CPU_MODE, SILENT, 1, 42);
+		int gIn = sim->createSpikeGeneratorGroup("input", GRP_SIZE, EXCITATORY_NEURON);
+		int gExc = sim->createGroup("exc", Grid3D(5,5,2), EXCITATORY_NEURON);
+		sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->connect(gIn, gExc, "random", RangeWeight(0.5f), 0.2f, RangeDelay(1,10));
+		sim->setConductances(true);
+		sim->setupNetwork();
+
+		PoissonRate in(GRP_SIZE);
+		in.setRates(20.0f);
+		sim->setSpikeRate(gIn, &in);
+
+		SpikeMonitor* SM[2];
+		SM[0] = sim->setSpikeMonitor(gIn, "results/spk_analysis_in.dat");
+		SM[1] = sim->setSpikeMonitor(gExc, "results/spk_analysis_exc.dat");
+		SM[0]->startRecording();
+		SM[1]->startRecording();
+		sim->runNetwork(RUN_TIME_SEC, 0);
+		SM[0]->stopRecording();
+		SM[1]->stopRecording();
+
+		const char* fileNames[2] = {"results/spk_analysis_in.dat", "results/spk_analysis_exc.dat"};
+		for (int g = 0; g < 2; g++) {
+			std::vector<std::vector<int> > spkVec = SM[g]->getSpikeVector2D();
+			std::vector<float> rates = SM[g]->getAllFiringRates();
+			ASSERT_GT(SM[g]->getPopNumSpikes(), 0);
+
+			SpikeAnalyzer spkAnalyzer(fileNames[g], 3);
+			spkAnalyzer.analyze(0, RUN_TIME_SEC*1000, 500, 5, 20);
+			ASSERT_EQ(spkAnalyzer.getNumNeurons(), GRP_SIZE);
+			EXPECT_EQ(spkAnalyzer.getEndTime(), RUN_TIME_SEC*1000);
+			EXPECT_EQ(spkAnalyzer.getNumSpikes(), SM[g]->getPopNumSpikes());
+			EXPECT_FLOAT_EQ(spkAnalyzer.getMeanFiringRate(), SM[g]->getPopMeanFiringRate());
+
+			std::vector<float> fileRates = spkAnalyzer.getFiringRates();
+			std::vector<float> meanISIs = spkAnalyzer.getMeanISIs();
+			std::vector<float> cvs = spkAnalyzer.getCVs();
+			std::vector<long long> counts = spkAnalyzer.getSpikeCounts();
+			std::vector<long long> isiHist = spkAnalyzer.getISIHistogram();
+			std::vector<float> popRates = spkAnalyzer.getPopulationRates();
+			ASSERT_EQ(isiHist.size(), 20);
+			ASSERT_EQ(popRates.size(), RUN_TIME_SEC*2);
+
+			std::vector<long long> expHist(20, 0);
+			std::vector<int> expPop(RUN_TIME_SEC*2, 0);
+			for (int i = 0; i < GRP_SIZE; i++) {
+				EXPECT_EQ(counts[i], spkVec[i].size());
+				EXPECT_FLOAT_EQ(fileRates[i], rates[i]);
+
+				double sum = 0.0, sumSq = 0.0;
+				for (size_t s = 0; s < spkVec[i].size(); s++) {
+					expPop[spkVec[i][s] / 500]++;
+					if (s == 0)
+						continue;
+					int isi = spkVec[i][s] - spkVec[i][s-1];
+					sum += isi;
+					sumSq += (double)isi*isi;
+					expHist[isi/5 < 20 ? isi/5 : 19]++;
+				}
+				int numIsi = spkVec[i].size() > 1 ? spkVec[i].size() - 1 : 0;
+				if (numIsi == 0) {
+					EXPECT_TRUE(isnan(meanISIs[i]));
+				} else {
+					double mean = sum / numIsi;
+					EXPECT_NEAR(meanISIs[i], mean, 1e-3);
+					if (numIsi >= 2) {
+						double sd = sqrt(sumSq / numIsi - mean*mean);
+						EXPECT_NEAR(cvs[i], sd/mean, 1e-3);
+					}
+				}
+			}
+			for (int b = 0; b < 20; b++)
+				EXPECT_EQ(isiHist[b], expHist[b]);
+			for (int b = 0; b < RUN_TIME_SEC*2; b++)
+				EXPECT_NEAR(popRates[b], expPop[b] * 1000.0f / (500.0f * GRP_SIZE), 1e-3f);
+
+			// a sub-window must only count the spikes inside it
+			spkAnalyzer.analyze(1000, 2000, 1000);
+			long long numSpikes = 0;
+			for (int i = 0; i < GRP_SIZE; i++)
+				for (size_t s = 0; s < spkVec[i].size(); s++)
+					numSpikes += spkVec[i][s] >= 1000 && spkVec[i][s] < 2000;
+			EXPECT_EQ(spkAnalyzer.getNumSpikes(), numSpikes);
+		}
+		delete sim;
+	}
+}
+
+/*!
+ * \brief Makes sure that ConnectionFileReader reads the weights of all connection file formats
+ *
+ * The weights of every snapshot and the weight histogram are compared to the ones of the ConnectionMonitor.
+ */
+TEST(OfflineAnalysis, connectionFileReader) {
+	const int GRP_SIZE = 20;
+
+	for (int mode = 0; mode < TESTED_MODES; mode++) {
+		for (int format = CONNECT_FILE_DENSE; format <= CONNECT_FILE_SPARSE_DELTA; format++) {
+			CARLsim* sim = new CARLsim("OfflineAnalysis.connectionFileReader", mode?GPU_MODE:CPU_MODE, SILENT, 1, 42);
+			int g0 = sim->createGroup("g0", GRP_SIZE, EXCITATORY_NEURON);
+			int g1 = sim->createGroup("g1", GRP_SIZE, EXCITATORY_NEURON);
+			sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+			sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+			short int c0 = sim->connect(g0, g1, "random", RangeWeight(0.05f), 0.1f);
+			sim->setConductances(true);
+			sim->setConnectFileFormat((ConnectFileFormat)format);
+			sim->setupNetwork();
+
+			ConnectionMonitor* CM = sim->setConnectionMonitor(g0, g1, "results/weights_analysis.dat");
+			CM->setUpdateTimeIntervalSec(-1);
+
+			// snapshot 0: initial weights, snapshot 1: unchanged, snapshot 2: all weights changed
+			std::vector<int> preIds, postIds;
+			std::vector<std::vector<float> > wts(3);
+			CM->takeSnapshotSparse(preIds, postIds, wts[0]);
+			sim->runNetwork(1, 0);
+			CM->takeSnapshotSparse(preIds, postIds, wts[1]);
+			sim->biasWeights(c0, -0.0225f);
+			sim->runNetwork(1, 0);
+			CM->takeSnapshotSparse(preIds, postIds, wts[2]);
+			delete sim;
+
+			ConnectionFileReader connReader("results/weights_analysis.dat", 2);
+			EXPECT_EQ(connReader.getConnectId(), c0);
+			EXPECT_EQ(connReader.getGrpIdPre(), g0);
+			EXPECT_EQ(connReader.getGrpIdPost(), g1);
+			EXPECT_FALSE(connReader.isPlastic());
+			EXPECT_FLOAT_EQ(connReader.getMaxWeight(), 0.05f);
+			ASSERT_EQ(connReader.getNumSynapses(), preIds.size());
+			ASSERT_EQ(connReader.getNumSnapshots(), 3);
+
+			// dense files list the synapses in (pre, post) order, so compare them by their (pre, post) pair
+			std::vector<int> filePreIds, filePostIds;
+			connReader.getSynapses(filePreIds, filePostIds);
+			ASSERT_EQ(filePreIds.size(), preIds.size());
+			std::vector<int> synIdx(GRP_SIZE*GRP_SIZE, -1);
+			for (size_t i = 0; i < preIds.size(); i++)
+				synIdx[preIds[i]*GRP_SIZE + postIds[i]] = i;
+			for (int s = 0; s < 3; s++) {
+				EXPECT_EQ(connReader.getSnapshotTime(s), s*1000);
+				std::vector<float> fileWts = connReader.getWeights(s);
+				ASSERT_EQ(fileWts.size(), wts[s].size());
+				for (size_t i = 0; i < fileWts.size(); i++) {
+					int idx = synIdx[filePreIds[i]*GRP_SIZE + filePostIds[i]];
+					ASSERT_GE(idx, 0);
+					EXPECT_FLOAT_EQ(fileWts[i], wts[s][idx]);
+				}
+			}
+
+			// 10 bins in [0, 0.05]: all weights of the last snapshot are 0.0275
+			std::vector<long long> hist = connReader.getWeightHistogram(2, 10);
+			ASSERT_EQ(hist.size(), 10);
+			EXPECT_EQ(hist[5], preIds.size());
+		}
+	}
+}
+
+/*!
+ * \brief Makes sure that the group and simulation file readers match the network
+ */
+TEST(OfflineAnalysis, groupAndSimulationFileReader) {
+	for (int mode = 0; mode < TESTED_MODES; mode++) {
+		CARLsim* sim = new CARLsim("OfflineAnalysis.groupAndSimulationFileReader", mode?GPU_MODE:CPU_MODE, SILENT, 1, 42);
+		int gIn = sim->createSpikeGeneratorGroup("input", 10, EXCITATORY_NEURON);
+		int gDA = sim->createGroup("dopaminergic", Grid3D(2,3,4), DOPAMINERGIC_NEURON);
+		sim->setNeuronParameters(gDA, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->connect(gIn, gDA, "full", RangeWeight(0.1f), 1.0f);
+		sim->setConductances(true);
+		sim->setupNetwork();
+
+		GroupMonitor* GM = sim->setGroupMonitor(gDA, "results/grp_analysis.dat");
+		GM->startRecording();
+		sim->runNetwork(1, 500);
+		GM->stopRecording();
+		std::vector<int> times = GM->getTimeVector();
+		std::vector<float> data = GM->getDataVector();
+		sim->saveSimulation("results/sim_analysis.dat", false);
+		delete sim;
+
+		GroupFileReader grpReader("results/grp_analysis.dat");
+		EXPECT_EQ(grpReader.getGrid3D().numX, 2);
+		EXPECT_EQ(grpReader.getGrid3D().numY, 3);
+		EXPECT_EQ(grpReader.getGrid3D().numZ, 4);
+		ASSERT_EQ(grpReader.getNumValues(), 1);
+		EXPECT_TRUE(grpReader.getTimeVector() == times);
+		ASSERT_EQ(grpReader.getDataVector().size(), data.size());
+		for (size_t i = 0; i < data.size(); i++)
+			EXPECT_FLOAT_EQ(grpReader.getDataVector()[i], data[i]);
+
+		SimulationFileReader simReader("results/sim_analysis.dat");
+		EXPECT_FLOAT_EQ(simReader.getSimTimeSec(), 1.5f);
+		EXPECT_EQ(simReader.getNumNeurons(), 34);
+		EXPECT_EQ(simReader.getNumSynapses(), 240);
+		ASSERT_EQ(simReader.getNumGroups(), 2);
+		EXPECT_EQ(simReader.getGroupName(gIn), "input");
+		EXPECT_EQ(simReader.getGroupName(gDA), "dopaminergic");
+		EXPECT_EQ(simReader.getGroupGrid3D(gDA).numZ, 4);
+		EXPECT_EQ(simReader.getGroupEndNeuronId(gDA) - simReader.getGroupStartNeuronId(gDA) + 1, 24);
+	}
+}
@@ -202,6 +202,127 @@ TEST(spikeGenFunc, SpikeGeneratorFromFile) {
 	}
 }
 
+// SpikeGeneratorFromFile must replay chunked spike files exactly like flat ones
+TEST(spikeGenFunc, SpikeGeneratorFromChunkedFile) {
+	std::string fileName0 = "results/spk_chunked0.dat";
+	std::vector< std::vector<int> > spkVec0, spkVec1;
+
+	for (int run=0; run<=1; run++) {
+		CARLsim* sim = new CARLsim("SpikeGeneratorFromChunkedFile",CPU_MODE,SILENT,1,42);
+		int g1 = sim->createGroup("g1", 10, EXCITATORY_NEURON);
+		sim->setNeuronParameters(g1, 0.02, 0.2, -65.0, 8.0);
+		int g0 = sim->createSpikeGeneratorGroup("g0", 10, EXCITATORY_NEURON);
+
+		SpikeGeneratorFromFile* sgf = NULL;
+		PoissonRate* poiss = NULL;
+		if (run==1) {
+			sgf = new SpikeGeneratorFromFile(fileName0);
+			sim->setSpikeGenerator(g0, sgf);
+		}
+		sim->connect(g0,g1,"full",RangeWeight(0.1f), 0.5f);
+		sim->setConductances(false);
+		sim->setSpikeFileFormat(SPIKE_FILE_CHUNKED, 100);
+		sim->setupNetwork();
+
+		if (run==0) {
+			poiss = new PoissonRate(10);
+			poiss->setRates(50.0f);
+			sim->setSpikeRate(g0, poiss);
+		}
+		SpikeMonitor* SM = sim->setSpikeMonitor(g0, run==0 ? fileName0 : "NULL");
+		SM->startRecording();
+		for (int i=0; i<4; i++) {
+			sim->runNetwork(0,250,false);
+		}
+		SM->stopRecording();
+		if (run==0) {
+			spkVec0 = SM->getSpikeVector2D();
+		} else {
+			spkVec1 = SM->getSpikeVector2D();
+		}
+
+		delete sim;
+		if (poiss != NULL) {
+			delete poiss;
+		}
+		if (sgf != NULL) {
+			delete sgf;
+		}
+	}
+
+	ASSERT_EQ(spkVec0.size(), spkVec1.size());
+	for (int neurId=0; neurId<spkVec0.size(); neurId++) {
+		EXPECT_GT(spkVec0[neurId].size(), 0);
+		EXPECT_EQ(spkVec0[neurId], spkVec1[neurId]);
+	}
+}
+
+TEST(spikeGenFunc, SpikeGeneratorFromFileStreaming) {
+	std::string fileName0 = "results/spk_stream0.dat";
+
+	for (int isChunked=0; isChunked<=1; isChunked++) {
+		std::vector< std::vector<int> > spkVec0, spkVec1;
+		for (int run=0; run<=1; run++) {
+			CARLsim* sim = new CARLsim("SpikeGeneratorFromFileStreaming",CPU_MODE,SILENT,1,42);
+			int g1 = sim->createGroup("g1", 10, EXCITATORY_NEURON);
+			sim->setNeuronParameters(g1, 0.02, 0.2, -65.0, 8.0);
+			int g0 = sim->createSpikeGeneratorGroup("g0", 10, EXCITATORY_NEURON);
+
+			SpikeGeneratorFromFile* sgf = NULL;
+			PoissonRate* poiss = NULL;
+			if (run==1) {
+				// stream the file instead of buffering it
+				sgf = new SpikeGeneratorFromFile(fileName0, 0, true);
+				sim->setSpikeGenerator(g0, sgf);
+			}
+			sim->connect(g0,g1,"full",RangeWeight(0.1f), 0.5f);
+			sim->setConductances(false);
+			sim->setSpikeFileFormat(isChunked ? SPIKE_FILE_CHUNKED : SPIKE_FILE_FLAT, 100);
+			sim->setupNetwork();
+
+			if (run==0) {
+				poiss = new PoissonRate(10);
+				poiss->setRates(50.0f);
+				sim->setSpikeRate(g0, poiss);
+			}
+			SpikeMonitor* SM = sim->setSpikeMonitor(g0, run==0 ? fileName0 : "NULL");
+			SM->startRecording();
+			for (int i=0; i<4; i++) {
+				sim->runNetwork(0,250,false);
+			}
+			if (run==1) {
+				// replay the file a second time, shifted by one second
+				sgf->rewind((int)sim->getSimTime());
+				sim->runNetwork(1,0,false);
+			}
+			SM->stopRecording();
+			if (run==0) {
+				spkVec0 = SM->getSpikeVector2D();
+			} else {
+				spkVec1 = SM->getSpikeVector2D();
+			}
+
+			delete sim;
+			if (poiss != NULL) {
+				delete poiss;
+			}
+			if (sgf != NULL) {
+				delete sgf;
+			}
+		}
+
+		ASSERT_EQ(spkVec0.size(), spkVec1.size());
+		for (int neurId=0; neurId<spkVec0.size(); neurId++) {
+			EXPECT_GT(spkVec0[neurId].size(), 0);
+			ASSERT_EQ(spkVec1[neurId].size(), 2*spkVec0[neurId].size());
+			for (int i=0; i<spkVec0[neurId].size(); i++) {
+				EXPECT_EQ(spkVec1[neurId][i], spkVec0[neurId][i]);
+				EXPECT_EQ(spkVec1[neurId][i+spkVec0[neurId].size()], spkVec0[neurId][i]+1000);
+			}
+		}
+	}
+}
+
 TEST(spikeGenFunc, SpikeGeneratorFromFileLoadFile) {
 	PoissonRate* poiss = NULL;
 	SpikeGeneratorFromFile* sgf = NULL;
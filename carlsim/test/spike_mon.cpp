@@ -52,6 +52,7 @@
 #include <snn_definitions.h> // MAX_GRP_PER_SNN
 
 #include <periodic_spikegen.h>
+#include <spike_file_reader.h>
 
 
 // TODO: I should probably use a google tests figure for this to reduce the
@@ -401,6 +402,242 @@ TEST(SpikeMon, spikeTimes) {
 	}
 }
 
+// small spike file buffers must be handed to the I/O thread many times per run, and the file must still
+// contain every spike (in order) once runNetwork returns
+TEST(SpikeMon, spikeFileBuffering) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	const int GRP_SIZE = 50;
+	const int isi = 10; // 100 Hz
+
+	for (int flushEverySecond = 0; flushEverySecond <= 1; flushEverySecond++) {
+		CARLsim* sim = new CARLsim("SpikeMon.spikeFileBuffering",CPU_MODE,SILENT,1,42);
+		int g1 = sim->createGroup("g1", GRP_SIZE, EXCITATORY_NEURON);
+		sim->setNeuronParameters(g1, 0.02f, 0.0f, 0.2f, 0.0f, -65.0f, 0.0f, 8.0f, 0.0f);
+		int g0 = sim->createSpikeGeneratorGroup("Input",GRP_SIZE,EXCITATORY_NEURON);
+
+		PeriodicSpikeGenerator spkGenG0(1000.0f/isi);
+		sim->setSpikeGenerator(g0, &spkGenG0);
+		sim->connect(g0,g1,"one-to-one", RangeWeight(0.01f), 1.0f, RangeDelay(1));
+		sim->setConductances(true);
+
+		// 1 KB holds 128 spikes, so each second of input fills ~40 buffers
+		sim->setSpikeFileBuffering(1, flushEverySecond==1);
+		sim->setupNetwork();
+
+		SpikeMonitor* spikeMonG0 = sim->setSpikeMonitor(g0,"spkBufG0.dat");
+		spikeMonG0->startRecording();
+		sim->runNetwork(1,0);
+
+		// file must be complete at the end of every run
+		int* inputArray = NULL;
+		long inputSize;
+		readAndReturnSpikeFile("spkBufG0.dat",inputArray,inputSize);
+		EXPECT_EQ(inputSize/2, 1000/isi * GRP_SIZE);
+		delete[] inputArray;
+
+		sim->runNetwork(2,500);
+		spikeMonG0->stopRecording();
+
+		std::vector<std::vector<int> > spkVector = spikeMonG0->getSpikeVector2D();
+		readAndReturnSpikeFile("spkBufG0.dat",inputArray,inputSize);
+		ASSERT_EQ(inputSize/2, 3500/isi * GRP_SIZE);
+
+		// spikes are written in time order, each neuron's train must match the monitor's
+		std::vector<int> numSpikes(GRP_SIZE, 0);
+		for (int i=2; i<inputSize; i+=2)
+			EXPECT_LE(inputArray[i-2], inputArray[i]);
+		for (int i=0; i<inputSize; i+=2) {
+			int nId = inputArray[i+1];
+			ASSERT_GE(nId, 0);
+			ASSERT_LT(nId, GRP_SIZE);
+			ASSERT_LT(numSpikes[nId], spkVector[nId].size());
+			EXPECT_EQ(inputArray[i], spkVector[nId][numSpikes[nId]]);
+			numSpikes[nId]++;
+		}
+
+#if defined(WIN32) || defined(WIN64)
+		int ret = system("del spkBufG0.dat");
+#else
+		int ret = system("rm -rf spkBufG0.dat");
+#endif
+		delete[] inputArray;
+		delete sim;
+	}
+}
+
+// chunked spike files must hold the same spikes as the SpikeMonitor, with and without the chunk index, and time
+// windows must be read correctly through the index
+TEST(SpikeMon, chunkedSpikeFile) {
+	const int GRP_SIZE = 50;
+	const char* fileName = "spkChunkedG0.dat";
+
+	CARLsim* sim = new CARLsim("SpikeMon.chunkedSpikeFile",CPU_MODE,SILENT,1,42);
+	int g1 = sim->createGroup("g1", GRP_SIZE, EXCITATORY_NEURON);
+	sim->setNeuronParameters(g1, 0.02f, 0.0f, 0.2f, 0.0f, -65.0f, 0.0f, 8.0f, 0.0f);
+	int g0 = sim->createSpikeGeneratorGroup("Input",GRP_SIZE,EXCITATORY_NEURON);
+	sim->connect(g0,g1,"one-to-one", RangeWeight(0.01f), 1.0f, RangeDelay(1));
+	sim->setConductances(true);
+	sim->setSpikeFileFormat(SPIKE_FILE_CHUNKED, 100);
+	sim->setupNetwork();
+
+	PoissonRate in(GRP_SIZE);
+	in.setRates(40.0f);
+	sim->setSpikeRate(g0, &in);
+
+	SpikeMonitor* spikeMonG0 = sim->setSpikeMonitor(g0,fileName);
+	spikeMonG0->setPersistentData(true);
+	spikeMonG0->startRecording();
+	sim->runNetwork(1,0);
+	spikeMonG0->stopRecording();
+
+	// the file is still open: there is no index yet, but all chunks of the run are complete
+	{
+		SpikeFileReader reader(fileName);
+		EXPECT_FLOAT_EQ(reader.getVersion(), 0.3f);
+		EXPECT_EQ(reader.getNumNeurons(), GRP_SIZE);
+		EXPECT_EQ(reader.getNumChunks(), 10);
+		EXPECT_EQ(reader.getNumSpikes(), spikeMonG0->getPopNumSpikes());
+	}
+
+	spikeMonG0->startRecording();
+	sim->runNetwork(2,500);
+	spikeMonG0->stopRecording();
+	std::vector<std::vector<int> > spkVector = spikeMonG0->getSpikeVector2D();
+	int numSpikes = spikeMonG0->getPopNumSpikes();
+	delete sim; // closing the file appends the chunk index
+
+	SpikeFileReader reader(fileName);
+	EXPECT_EQ(reader.getNumChunks(), 35);
+	EXPECT_EQ(reader.getNumSpikes(), numSpikes);
+
+	// flat files take 8 bytes per spike
+	FILE* fid = fopen(fileName, "rb");
+	fseek(fid, 0, SEEK_END);
+	EXPECT_LT(ftell(fid), numSpikes * 8 / 2);
+	fclose(fid);
+
+	std::vector<std::vector<int> > spkVectorFile;
+	reader.readSpikes(spkVectorFile);
+	ASSERT_EQ(spkVectorFile.size(), GRP_SIZE);
+	for (int i=0; i<GRP_SIZE; i++)
+		EXPECT_EQ(spkVectorFile[i], spkVector[i]);
+
+	// windows that do not start or end on chunk boundaries
+	int windows[3][2] = {{0, 1}, {1234, 2345}, {3450, 4000}};
+	for (int w=0; w<3; w++) {
+		std::vector<int> spkTimes, neurIds;
+		reader.readSpikes(windows[w][0], windows[w][1], spkTimes, neurIds);
+
+		std::vector<int> numSpikesInWindow(GRP_SIZE, 0);
+		for (int i=0; i<spkTimes.size(); i++) {
+			EXPECT_GE(spkTimes[i], windows[w][0]);
+			EXPECT_LT(spkTimes[i], windows[w][1]);
+			numSpikesInWindow[neurIds[i]]++;
+		}
+		for (int i=0; i<GRP_SIZE; i++) {
+			int expected = 0;
+			for (int j=0; j<spkVector[i].size(); j++)
+				expected += spkVector[i][j] >= windows[w][0] && spkVector[i][j] < windows[w][1];
+			EXPECT_EQ(numSpikesInWindow[i], expected);
+		}
+	}
+
+#if defined(WIN32) || defined(WIN64)
+	int ret = system("del spkChunkedG0.dat");
+#else
+	int ret = system("rm -rf spkChunkedG0.dat");
+#endif
+}
+
+// the spike tables of a partition are demultiplexed to all of its monitors in one pass: every monitor must get exactly
+// the spikes of its own group, also if it started recording later than the others, writes to a file, or its spikes
+// are routed to the other partition
+TEST(SpikeMon, demuxPartitions) {
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+	const int GRP_SIZE = 5;
+	const int NUM_GRP = 3;
+	float rates[NUM_GRP] = {10.0f, 20.0f, 40.0f};
+
+	CARLsim* sim = new CARLsim("SpikeMon.demuxPartitions",CPU_MODE,SILENT,0,42);
+	int g[2][NUM_GRP];
+	std::vector<PeriodicSpikeGenerator*> spkGens;
+	for (int p=0; p<2; p++) {
+		for (int k=0; k<NUM_GRP; k++) {
+			char name[20];
+			sprintf(name, "input%d_%d", p, k);
+			g[p][k] = sim->createSpikeGeneratorGroup(name, GRP_SIZE, EXCITATORY_NEURON, p, CPU_CORES);
+			spkGens.push_back(new PeriodicSpikeGenerator(rates[k]));
+			sim->setSpikeGenerator(g[p][k], spkGens.back());
+		}
+		// spikes of an unmonitored group must not show up anywhere
+		int gOther = sim->createSpikeGeneratorGroup(p ? "other1" : "other0", GRP_SIZE, EXCITATORY_NEURON, p, CPU_CORES);
+		spkGens.push_back(new PeriodicSpikeGenerator(50.0f));
+		sim->setSpikeGenerator(gOther, spkGens.back());
+	}
+	for (int p=0; p<2; p++) {
+		int gOut = sim->createGroup(p ? "out1" : "out0", GRP_SIZE, EXCITATORY_NEURON, p, CPU_CORES);
+		sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->connect(g[p][0], gOut, "one-to-one", RangeWeight(0.01f), 1.0f, RangeDelay(1));
+
+		// spikes routed in from the other partition end up in this partition's firing tables as ghost groups
+		for (int k=0; k<NUM_GRP; k++)
+			sim->connect(g[1-p][k], gOut, "one-to-one", RangeWeight(0.01f), 1.0f, RangeDelay(1, 3));
+	}
+	sim->setConductances(true);
+	sim->setupNetwork();
+
+	SpikeMonitor* spkMon[2][NUM_GRP];
+	for (int p=0; p<2; p++)
+		for (int k=0; k<NUM_GRP; k++)
+			spkMon[p][k] = sim->setSpikeMonitor(g[p][k], (p==1 && k==NUM_GRP-1) ? "spkDemux.dat" : "NULL");
+
+	// all monitors but spkMon[0][0] record from the start
+	for (int p=0; p<2; p++)
+		for (int k=0; k<NUM_GRP; k++)
+			if (p || k)
+				spkMon[p][k]->startRecording();
+	sim->runNetwork(0,250);
+	spkMon[0][0]->startRecording();
+	sim->runNetwork(1,0);
+	for (int p=0; p<2; p++)
+		for (int k=0; k<NUM_GRP; k++)
+			spkMon[p][k]->stopRecording();
+
+	// groups of the same rate spike at the same times in both partitions
+	for (int k=1; k<NUM_GRP; k++) {
+		EXPECT_EQ(spkMon[0][k]->getPopNumSpikes(), (int)(1250 * rates[k] / 1000) * GRP_SIZE);
+		EXPECT_EQ(spkMon[0][k]->getSpikeVector2D(), spkMon[1][k]->getSpikeVector2D());
+	}
+	std::vector<std::vector<int> > spkLate = spkMon[0][0]->getSpikeVector2D();
+	std::vector<std::vector<int> > spkRef = spkMon[1][0]->getSpikeVector2D();
+	for (int i=0; i<GRP_SIZE; i++) {
+		std::vector<int> spkRefLate;
+		for (int j=0; j<spkRef[i].size(); j++)
+			if (spkRef[i][j] >= 250)
+				spkRefLate.push_back(spkRef[i][j]);
+		EXPECT_GT(spkRefLate.size(), 0);
+		EXPECT_EQ(spkLate[i], spkRefLate);
+	}
+
+	// the file holds the same spikes as the AER struct of its monitor
+	int* inputArray = NULL;
+	long inputSize;
+	readAndReturnSpikeFile("spkDemux.dat",inputArray,inputSize);
+	EXPECT_EQ(inputSize/2, spkMon[1][NUM_GRP-1]->getPopNumSpikes());
+
+#if defined(WIN32) || defined(WIN64)
+	int ret = system("del spkDemux.dat");
+#else
+	int ret = system("rm -rf spkDemux.dat");
+#endif
+	delete[] inputArray;
+	delete sim;
+	for (int i=0; i<spkGens.size(); i++)
+		delete spkGens[i];
+}
+
 /*
  * This test checks for the correctness of the getGroupFiringRate method.
  * A PeriodicSpikeGenerator is used to periodically generate input spikes, so that the input spike times are known.
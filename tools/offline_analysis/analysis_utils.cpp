@@ -0,0 +1,175 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include <analysis_utils.h>
+
+#include <user_errors.h>	// fancy user error messages
+
+#include <stdio.h>			// fopen, fclose
+#include <vector>			// std::vector
+
+#if defined(WIN32) || defined(WIN64)
+#include <windows.h>		// CreateFileMapping, MapViewOfFile
+#else
+#include <sys/mman.h>		// mmap
+#include <sys/stat.h>		// fstat
+#include <fcntl.h>			// open
+#include <unistd.h>			// close, sysconf
+#include <pthread.h>
+#endif
+
+
+MappedFile::MappedFile(const std::string& fileName) : _fileName(fileName), _data(NULL), _size(0), _handle(NULL) {
+	std::string funcName = "MappedFile(" + fileName + ")";
+	bool success;
+
+#if defined(WIN32) || defined(WIN64)
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, NULL);
+	UserErrors::assertTrue(file != INVALID_HANDLE_VALUE, UserErrors::FILE_CANNOT_OPEN, funcName, fileName);
+	LARGE_INTEGER size;
+	GetFileSizeEx(file, &size);
+	_size = size.QuadPart;
+	if (_size > 0) {
+		_handle = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		_data = _handle == NULL ? NULL : (const unsigned char*)MapViewOfFile(_handle, FILE_MAP_READ, 0, 0, 0);
+	}
+	CloseHandle(file);
+	success = _size == 0 || _data != NULL;
+#else
+	int fd = open(fileName.c_str(), O_RDONLY);
+	UserErrors::assertTrue(fd >= 0, UserErrors::FILE_CANNOT_OPEN, funcName, fileName);
+	struct stat st;
+	success = fstat(fd, &st) == 0;
+	_size = success ? (long long)st.st_size : 0;
+	if (success && _size > 0) {
+		void* addr = mmap(NULL, (size_t)_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		success = addr != MAP_FAILED;
+		if (success) {
+			_data = (const unsigned char*)addr;
+			madvise(addr, (size_t)_size, MADV_SEQUENTIAL);
+		}
+	}
+	close(fd);
+#endif
+	UserErrors::assertTrue(success, UserErrors::FILE_CANNOT_READ, funcName, fileName + " (could not map file)");
+}
+
+MappedFile::~MappedFile() {
+	if (_data == NULL)
+		return;
+#if defined(WIN32) || defined(WIN64)
+	UnmapViewOfFile(_data);
+	CloseHandle((HANDLE)_handle);
+#else
+	munmap((void*)_data, (size_t)_size);
+#endif
+	_data = NULL;
+}
+
+void MappedFile::checkRange(long long offset, long long size) {
+	UserErrors::assertTrue(offset >= 0 && size >= 0 && offset + size <= _size, UserErrors::FILE_CANNOT_READ,
+		"MappedFile::read", _fileName + " (unexpected end of file)");
+}
+
+int getNumAnalysisThreads(int numThreads, long long numItems) {
+	if (numThreads <= 0) {
+#if defined(WIN32) || defined(WIN64)
+		numThreads = 1;
+#else
+		numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	}
+	if (numThreads > numItems)
+		numThreads = (int)numItems;
+	return numThreads < 1 ? 1 : numThreads;
+}
+
+struct ParallelForArgs {
+	long long begin;
+	long long end;
+	int threadId;
+	void (*body)(long long, long long, int, void*);
+	void* arg;
+};
+
+static void* parallelForThread(void* ptr) {
+	ParallelForArgs* args = (ParallelForArgs*)ptr;
+	args->body(args->begin, args->end, args->threadId, args->arg);
+	return NULL;
+}
+
+void parallelFor(long long begin, long long end, int numThreads,
+	void (*body)(long long begin, long long end, int threadId, void* arg), void* arg)
+{
+	if (end <= begin)
+		return;
+
+	numThreads = getNumAnalysisThreads(numThreads, end - begin);
+	std::vector<ParallelForArgs> args(numThreads);
+	long long rangeSize = (end - begin + numThreads - 1) / numThreads;
+	for (int i = 0; i < numThreads; i++) {
+		args[i].begin = (begin + i * rangeSize < end) ? begin + i * rangeSize : end;
+		args[i].end = (args[i].begin + rangeSize < end) ? args[i].begin + rangeSize : end;
+		args[i].threadId = i;
+		args[i].body = body;
+		args[i].arg = arg;
+	}
+
+#if defined(WIN32) || defined(WIN64)
+	for (int i = 0; i < numThreads; i++)
+		parallelForThread(&args[i]);
+#else
+	// the calling thread processes the first range itself
+	std::vector<pthread_t> threads(numThreads);
+	for (int i = 1; i < numThreads; i++)
+		pthread_create(&threads[i], NULL, &parallelForThread, &args[i]);
+	parallelForThread(&args[0]);
+	for (int i = 1; i < numThreads; i++)
+		pthread_join(threads[i], NULL);
+#endif
+}
@@ -0,0 +1,121 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#ifndef _ANALYSIS_UTILS_H_
+#define _ANALYSIS_UTILS_H_
+
+#include <string>	// std::string
+#include <string.h>	// memcpy
+
+
+/*!
+ * \brief Maps a binary CARLsim output file into memory (read-only)
+ *
+ * The readers of the offline analysis library use this class to access connection, group, and simulation files
+ * without copying them. The OS pages the file in as it is accessed.
+ *
+ * \since v4.0
+ */
+class MappedFile {
+public:
+	//! maps the file, exits with a user error if the file cannot be opened or mapped
+	MappedFile(const std::string& fileName);
+
+	//! unmaps and closes the file
+	~MappedFile();
+
+	//! returns the first byte of the file
+	const unsigned char* getData() { return _data; }
+
+	//! returns the size of the file in bytes
+	long long getSize() { return _size; }
+
+	//! returns the name of the file
+	const std::string& getFileName() { return _fileName; }
+
+	/*!
+	 * \brief Copies a value from a byte offset and advances the offset
+	 *
+	 * Values in CARLsim files are not necessarily aligned (e.g., the connection ID of a connection file is a short
+	 * int), so they are copied instead of dereferenced. Exits with a user error if the file is too short.
+	 */
+	template<typename T> T read(long long& offset) {
+		T value;
+		checkRange(offset, sizeof(T));
+		memcpy(&value, _data + offset, sizeof(T));
+		offset += sizeof(T);
+		return value;
+	}
+
+	//! exits with a user error if [offset, offset+size) is not within the file
+	void checkRange(long long offset, long long size);
+
+private:
+	std::string _fileName;
+	const unsigned char* _data;
+	long long _size;
+	void* _handle; //!< file mapping handle (Windows only)
+
+	// no copies
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+};
+
+/*!
+ * \brief Runs body on [begin, end) split into one contiguous range per thread
+ *
+ * The ranges are processed by pthreads (sequentially on Windows). Range i of numThreads ranges is passed to
+ * body together with its thread index and arg.
+ * \param[in] numThreads number of threads, 0 for one thread per core
+ */
+void parallelFor(long long begin, long long end, int numThreads,
+	void (*body)(long long begin, long long end, int threadId, void* arg), void* arg);
+
+//! returns the number of threads parallelFor uses for numThreads (0: one per core), but at most numItems
+int getNumAnalysisThreads(int numThreads, long long numItems);
+
+#endif
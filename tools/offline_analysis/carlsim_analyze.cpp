@@ -0,0 +1,352 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+/*
+ * carlsim-analyze: command-line front end of the offline analysis library
+ *
+ * Usage:
+ *   carlsim-analyze spikes  <file> [--start ms] [--end ms] [--bin ms] [--isi-bin ms] [--isi-bins n]
+ *   carlsim-analyze weights <file> [--snapshot k] [--bins n]
+ *   carlsim-analyze group   <file>
+ *   carlsim-analyze sim     <file>
+ * Common options: [--threads n] [--csv | --json] [--out file]
+ *
+ * The default output is a human-readable summary. With --csv or --json, a compact machine-readable summary is
+ * written instead (per-neuron rates, population rates, ISI histograms, weight histograms, etc.).
+ */
+
+#include <spike_analyzer.h>
+#include <connection_file_reader.h>
+#include <group_file_reader.h>
+#include <simulation_file_reader.h>
+
+#include <stdio.h>			// printf, fprintf
+#include <stdlib.h>			// atoi
+#include <string.h>			// strcmp
+#include <math.h>			// isnan
+#include <string>
+#include <vector>
+
+enum OutputFormat { OUTPUT_TEXT, OUTPUT_CSV, OUTPUT_JSON };
+
+struct AnalyzeOptions {
+	int startTime;
+	int endTime;
+	int binSize;
+	int isiBinSize;
+	int numIsiBins;
+	int snapshot;
+	int numWtBins;
+	int numThreads;
+	OutputFormat format;
+	std::string outFile;
+
+	AnalyzeOptions() : startTime(0), endTime(-1), binSize(100), isiBinSize(1), numIsiBins(100), snapshot(-1),
+		numWtBins(20), numThreads(0), format(OUTPUT_TEXT) {}
+};
+
+static void printUsage() {
+	fprintf(stderr,
+		"Usage: carlsim-analyze <spikes|weights|group|sim> <file> [options]\n"
+		"  spikes  options: --start ms, --end ms, --bin ms, --isi-bin ms, --isi-bins n\n"
+		"  weights options: --snapshot k (default: last), --bins n\n"
+		"  common  options: --threads n (0: one per core), --csv, --json, --out file\n");
+}
+
+// prints a float vector as a JSON array or a CSV row (NAN as null or empty)
+static void printFloats(FILE* fp, const std::vector<float>& v, OutputFormat format) {
+	for (size_t i = 0; i < v.size(); i++) {
+		if (i)
+			fprintf(fp, ",");
+		if (isnan(v[i]))
+			fprintf(fp, format == OUTPUT_JSON ? "null" : "");
+		else
+			fprintf(fp, "%g", v[i]);
+	}
+}
+
+static void printCounts(FILE* fp, const std::vector<long long>& v) {
+	for (size_t i = 0; i < v.size(); i++)
+		fprintf(fp, i ? ",%lld" : "%lld", v[i]);
+}
+
+static void analyzeSpikes(FILE* fp, const std::string& fileName, const AnalyzeOptions& opt) {
+	SpikeAnalyzer spkAnalyzer(fileName, opt.numThreads);
+	spkAnalyzer.analyze(opt.startTime, opt.endTime, opt.binSize, opt.isiBinSize, opt.numIsiBins);
+	Grid3D grid = spkAnalyzer.getGrid3D();
+
+	if (opt.format == OUTPUT_JSON) {
+		fprintf(fp, "{\"file\":\"%s\",\"grid\":[%d,%d,%d],\"startTime\":%d,\"endTime\":%d,\"numSpikes\":%lld,"
+			"\"meanRate\":%g,\n", fileName.c_str(), grid.numX, grid.numY, grid.numZ, spkAnalyzer.getStartTime(),
+			spkAnalyzer.getEndTime(), spkAnalyzer.getNumSpikes(), spkAnalyzer.getMeanFiringRate());
+		fprintf(fp, "\"rates\":[");      printFloats(fp, spkAnalyzer.getFiringRates(), opt.format);
+		fprintf(fp, "],\n\"binSize\":%d,\"popRates\":[", spkAnalyzer.getBinSize());
+		printFloats(fp, spkAnalyzer.getPopulationRates(), opt.format);
+		fprintf(fp, "],\n\"meanISIs\":[");  printFloats(fp, spkAnalyzer.getMeanISIs(), opt.format);
+		fprintf(fp, "],\n\"CVs\":[");       printFloats(fp, spkAnalyzer.getCVs(), opt.format);
+		fprintf(fp, "],\n\"isiBinSize\":%d,\"isiHist\":[", spkAnalyzer.getISIBinSize());
+		printCounts(fp, spkAnalyzer.getISIHistogram());
+		fprintf(fp, "]}\n");
+	} else if (opt.format == OUTPUT_CSV) {
+		// one row per neuron
+		std::vector<long long> counts = spkAnalyzer.getSpikeCounts();
+		std::vector<float> rates = spkAnalyzer.getFiringRates();
+		std::vector<float> isis = spkAnalyzer.getMeanISIs();
+		std::vector<float> cvs = spkAnalyzer.getCVs();
+		fprintf(fp, "neurId,numSpikes,rate,meanISI,CV\n");
+		for (size_t i = 0; i < counts.size(); i++) {
+			fprintf(fp, "%d,%lld,%g,", (int)i, counts[i], rates[i]);
+			if (!isnan(isis[i]))
+				fprintf(fp, "%g", isis[i]);
+			fprintf(fp, ",");
+			if (!isnan(cvs[i]))
+				fprintf(fp, "%g", cvs[i]);
+			fprintf(fp, "\n");
+		}
+	} else {
+		fprintf(fp, "Spike file:        %s\n", fileName.c_str());
+		fprintf(fp, "Grid:              (%d, %d, %d), %d neurons\n", grid.numX, grid.numY, grid.numZ,
+			spkAnalyzer.getNumNeurons());
+		fprintf(fp, "Time window:       [%d, %d) ms\n", spkAnalyzer.getStartTime(), spkAnalyzer.getEndTime());
+		fprintf(fp, "Number of spikes:  %lld\n", spkAnalyzer.getNumSpikes());
+		fprintf(fp, "Mean firing rate:  %g Hz\n", spkAnalyzer.getMeanFiringRate());
+
+		std::vector<float> cvs = spkAnalyzer.getCVs();
+		double sumCV = 0.0;
+		int numCV = 0;
+		for (size_t i = 0; i < cvs.size(); i++) {
+			if (!isnan(cvs[i])) {
+				sumCV += cvs[i];
+				numCV++;
+			}
+		}
+		if (numCV)
+			fprintf(fp, "Mean ISI CV:       %g (%d neurons)\n", sumCV / numCV, numCV);
+		fprintf(fp, "Population rate:   ");
+		printFloats(fp, spkAnalyzer.getPopulationRates(), opt.format);
+		fprintf(fp, " Hz (%d ms bins)\n", spkAnalyzer.getBinSize());
+	}
+}
+
+static void analyzeWeights(FILE* fp, const std::string& fileName, const AnalyzeOptions& opt) {
+	ConnectionFileReader connReader(fileName, opt.numThreads);
+	int numSnapshots = connReader.getNumSnapshots();
+	int snapshot = opt.snapshot < 0 ? numSnapshots - 1 : opt.snapshot;
+	UserErrors::assertTrue(snapshot >= 0 && snapshot < numSnapshots, UserErrors::MUST_BE_IN_RANGE,
+		"carlsim-analyze", "snapshot", "[0, number of snapshots)");
+
+	std::vector<long long> hist = connReader.getWeightHistogram(snapshot, opt.numWtBins);
+	float lo = connReader.getMinWeight() < 0.0f ? connReader.getMinWeight() : 0.0f;
+	float binWidth = (connReader.getMaxWeight() - lo) / opt.numWtBins;
+
+	if (opt.format == OUTPUT_JSON) {
+		fprintf(fp, "{\"file\":\"%s\",\"connId\":%d,\"grpIdPre\":%d,\"grpIdPost\":%d,\"numSynapses\":%d,"
+			"\"plastic\":%s,\"numSnapshots\":%d,\"snapshot\":%d,\"time\":%lld,\"binMin\":%g,\"binWidth\":%g,"
+			"\"hist\":[", fileName.c_str(), connReader.getConnectId(), connReader.getGrpIdPre(),
+			connReader.getGrpIdPost(), connReader.getNumSynapses(), connReader.isPlastic() ? "true" : "false",
+			numSnapshots, snapshot, connReader.getSnapshotTime(snapshot), lo, binWidth);
+		printCounts(fp, hist);
+		fprintf(fp, "]}\n");
+	} else if (opt.format == OUTPUT_CSV) {
+		fprintf(fp, "binStart,binEnd,count\n");
+		for (int i = 0; i < opt.numWtBins; i++)
+			fprintf(fp, "%g,%g,%lld\n", lo + i * binWidth, lo + (i + 1) * binWidth, hist[i]);
+	} else {
+		fprintf(fp, "Connection file:   %s (version %.1f)\n", fileName.c_str(), connReader.getVersion());
+		fprintf(fp, "Connection:        %d (group %d -> group %d), %s\n", connReader.getConnectId(),
+			connReader.getGrpIdPre(), connReader.getGrpIdPost(), connReader.isPlastic() ? "plastic" : "fixed");
+		fprintf(fp, "Synapses:          %d\n", connReader.getNumSynapses());
+		fprintf(fp, "Snapshots:         %d (showing #%d at t=%lld ms)\n", numSnapshots, snapshot,
+			connReader.getSnapshotTime(snapshot));
+		for (int i = 0; i < opt.numWtBins; i++)
+			fprintf(fp, "  [%8.4f, %8.4f): %lld\n", lo + i * binWidth, lo + (i + 1) * binWidth, hist[i]);
+	}
+}
+
+static void analyzeGroup(FILE* fp, const std::string& fileName, const AnalyzeOptions& opt) {
+	GroupFileReader grpReader(fileName);
+	const std::vector<int>& times = grpReader.getTimeVector();
+	const std::vector<float>& data = grpReader.getDataVector();
+	int numValues = grpReader.getNumValues();
+
+	if (opt.format == OUTPUT_CSV) {
+		fprintf(fp, "time,DA\n");
+		for (size_t i = 0; i < times.size(); i++)
+			fprintf(fp, "%d,%g\n", times[i], data[i * numValues]);
+		return;
+	}
+
+	double sum = 0.0;
+	float minVal = 0.0f, maxVal = 0.0f;
+	for (size_t i = 0; i < times.size(); i++) {
+		float da = data[i * numValues];
+		sum += da;
+		if (i == 0 || da < minVal)
+			minVal = da;
+		if (i == 0 || da > maxVal)
+			maxVal = da;
+	}
+	double mean = times.empty() ? 0.0 : sum / times.size();
+	int first = times.empty() ? 0 : times.front(), last = times.empty() ? 0 : times.back();
+
+	if (opt.format == OUTPUT_JSON) {
+		fprintf(fp, "{\"file\":\"%s\",\"numEntries\":%d,\"firstTime\":%d,\"lastTime\":%d,\"meanDA\":%g,"
+			"\"minDA\":%g,\"maxDA\":%g}\n", fileName.c_str(), (int)times.size(), first, last, mean, minVal, maxVal);
+	} else {
+		fprintf(fp, "Group file:        %s\n", fileName.c_str());
+		fprintf(fp, "Entries:           %d ms ([%d, %d])\n", (int)times.size(), first, last);
+		fprintf(fp, "Dopamine:          mean %g, min %g, max %g\n", mean, minVal, maxVal);
+	}
+}
+
+static void analyzeSimulation(FILE* fp, const std::string& fileName, const AnalyzeOptions& opt) {
+	SimulationFileReader simReader(fileName);
+	int numGroups = simReader.getNumGroups();
+
+	if (opt.format == OUTPUT_JSON) {
+		fprintf(fp, "{\"file\":\"%s\",\"simTimeSec\":%g,\"exeTimeSec\":%g,\"numNeurons\":%d,\"numSynapses\":%d,"
+			"\"groups\":[", fileName.c_str(), simReader.getSimTimeSec(), simReader.getExecutionTimeSec(),
+			simReader.getNumNeurons(), simReader.getNumSynapses());
+		for (int g = 0; g < numGroups; g++) {
+			Grid3D grid = simReader.getGroupGrid3D(g);
+			fprintf(fp, "%s{\"name\":\"%s\",\"startN\":%d,\"endN\":%d,\"grid\":[%d,%d,%d]}", g ? "," : "",
+				simReader.getGroupName(g).c_str(), simReader.getGroupStartNeuronId(g),
+				simReader.getGroupEndNeuronId(g), grid.numX, grid.numY, grid.numZ);
+		}
+		fprintf(fp, "]}\n");
+	} else if (opt.format == OUTPUT_CSV) {
+		fprintf(fp, "grpId,name,startN,endN,numX,numY,numZ\n");
+		for (int g = 0; g < numGroups; g++) {
+			Grid3D grid = simReader.getGroupGrid3D(g);
+			fprintf(fp, "%d,%s,%d,%d,%d,%d,%d\n", g, simReader.getGroupName(g).c_str(),
+				simReader.getGroupStartNeuronId(g), simReader.getGroupEndNeuronId(g), grid.numX, grid.numY,
+				grid.numZ);
+		}
+	} else {
+		fprintf(fp, "Simulation file:   %s (version %.1f)\n", fileName.c_str(), simReader.getVersion());
+		fprintf(fp, "Simulated time:    %g s (execution time %g s)\n", simReader.getSimTimeSec(),
+			simReader.getExecutionTimeSec());
+		fprintf(fp, "Neurons:           %d\n", simReader.getNumNeurons());
+		fprintf(fp, "Synapses:          %d\n", simReader.getNumSynapses());
+		for (int g = 0; g < numGroups; g++) {
+			Grid3D grid = simReader.getGroupGrid3D(g);
+			fprintf(fp, "  group %d \"%s\": neurons [%d, %d], grid (%d, %d, %d)\n", g,
+				simReader.getGroupName(g).c_str(), simReader.getGroupStartNeuronId(g),
+				simReader.getGroupEndNeuronId(g), grid.numX, grid.numY, grid.numZ);
+		}
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		printUsage();
+		return 1;
+	}
+	std::string command = argv[1];
+	std::string fileName = argv[2];
+
+	AnalyzeOptions opt;
+	for (int i = 3; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--csv") {
+			opt.format = OUTPUT_CSV;
+		} else if (arg == "--json") {
+			opt.format = OUTPUT_JSON;
+		} else if (arg == "--out" && hasValue) {
+			opt.outFile = argv[++i];
+		} else if (arg == "--start" && hasValue) {
+			opt.startTime = atoi(argv[++i]);
+		} else if (arg == "--end" && hasValue) {
+			opt.endTime = atoi(argv[++i]);
+		} else if (arg == "--bin" && hasValue) {
+			opt.binSize = atoi(argv[++i]);
+		} else if (arg == "--isi-bin" && hasValue) {
+			opt.isiBinSize = atoi(argv[++i]);
+		} else if (arg == "--isi-bins" && hasValue) {
+			opt.numIsiBins = atoi(argv[++i]);
+		} else if (arg == "--snapshot" && hasValue) {
+			opt.snapshot = atoi(argv[++i]);
+		} else if (arg == "--bins" && hasValue) {
+			opt.numWtBins = atoi(argv[++i]);
+		} else if (arg == "--threads" && hasValue) {
+			opt.numThreads = atoi(argv[++i]);
+		} else {
+			fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+			printUsage();
+			return 1;
+		}
+	}
+
+	FILE* fp = stdout;
+	if (!opt.outFile.empty()) {
+		fp = fopen(opt.outFile.c_str(), "w");
+		if (fp == NULL) {
+			fprintf(stderr, "Could not open output file %s\n", opt.outFile.c_str());
+			return 1;
+		}
+	}
+
+	int status = 0;
+	if (command == "spikes") {
+		analyzeSpikes(fp, fileName, opt);
+	} else if (command == "weights") {
+		analyzeWeights(fp, fileName, opt);
+	} else if (command == "group") {
+		analyzeGroup(fp, fileName, opt);
+	} else if (command == "sim") {
+		analyzeSimulation(fp, fileName, opt);
+	} else {
+		fprintf(stderr, "Unknown command: %s\n", command.c_str());
+		printUsage();
+		status = 1;
+	}
+
+	if (fp != stdout)
+		fclose(fp);
+	return status;
+}
@@ -0,0 +1,244 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include <connection_file_reader.h>
+
+#include <analysis_utils.h>		// MappedFile, parallelFor
+#include <user_errors.h>		// fancy user error messages
+
+#include <math.h>				// fabs, isnan
+#include <algorithm>			// std::min
+
+// int signature of connection files
+#define CONNECT_FILE_SIGNATURE 202029319
+
+
+ConnectionFileReader::ConnectionFileReader(const std::string& fileName, int numThreads) {
+	std::string funcName = "ConnectionFileReader(" + fileName + ")";
+	file_ = new MappedFile(fileName);
+	numThreads_ = numThreads;
+	cachedSnapshot_ = -1;
+
+	// header section
+	long long offset = 0;
+	int signature = file_->read<int>(offset);
+	UserErrors::assertTrue(signature == CONNECT_FILE_SIGNATURE, UserErrors::FILE_CANNOT_READ, funcName,
+		fileName + " (unknown file signature)");
+	version_ = file_->read<float>(offset);
+	isSparse_ = fabs(version_ - 0.4f) < 1e-4f;
+	UserErrors::assertTrue(isSparse_ || fabs(version_ - 0.3f) < 1e-4f, UserErrors::FILE_CANNOT_READ, funcName,
+		fileName + " (unknown version number)");
+
+	connId_ = file_->read<short int>(offset);
+	grpIdPre_ = file_->read<int>(offset);
+	int x = file_->read<int>(offset), y = file_->read<int>(offset), z = file_->read<int>(offset);
+	gridPre_ = Grid3D(x, y, z);
+	grpIdPost_ = file_->read<int>(offset);
+	x = file_->read<int>(offset); y = file_->read<int>(offset); z = file_->read<int>(offset);
+	gridPost_ = Grid3D(x, y, z);
+	file_->read<int>(offset); // number of synapses (the synapse list is read below)
+	isPlastic_ = file_->read<bool>(offset);
+	minWt_ = file_->read<float>(offset);
+	maxWt_ = file_->read<float>(offset);
+
+	if (isSparse_) {
+		// the synapse list follows the header section
+		isDelta_ = file_->read<int>(offset) != 0;
+		int nSyn = file_->read<int>(offset);
+		UserErrors::assertTrue(nSyn >= 0, UserErrors::FILE_CANNOT_READ, funcName, fileName + " (corrupt synapse list)");
+		file_->checkRange(offset, 2LL * nSyn * sizeof(int));
+		preIds_.resize(nSyn);
+		postIds_.resize(nSyn);
+		if (nSyn > 0) {
+			memcpy(&preIds_[0], file_->getData() + offset, nSyn * sizeof(int));
+			memcpy(&postIds_[0], file_->getData() + offset + nSyn * sizeof(int), nSyn * sizeof(int));
+		}
+		offset += 2LL * nSyn * sizeof(int);
+	} else {
+		isDelta_ = false;
+	}
+
+	readSnapshotOffsets(offset);
+
+	// dense files do not store the synapse list: take the entries of the first weight matrix that are not NAN
+	if (!isSparse_ && !snapshotOffsets_.empty()) {
+		const float* wtMat = (const float*)(file_->getData() + snapshotOffsets_[0] + sizeof(long long));
+		for (int i = 0; i < gridPre_.N; i++) {
+			for (int j = 0; j < gridPost_.N; j++) {
+				float wt;
+				memcpy(&wt, &wtMat[(long long)i * gridPost_.N + j], sizeof(float));
+				if (!isnan(wt)) {
+					preIds_.push_back(i);
+					postIds_.push_back(j);
+				}
+			}
+		}
+	}
+}
+
+ConnectionFileReader::~ConnectionFileReader() {
+	delete file_;
+}
+
+void ConnectionFileReader::readSnapshotOffsets(long long offset) {
+	long long fileSize = file_->getSize();
+	if (!isDelta_) {
+		// snapshots have a fixed size
+		long long numWts = isSparse_ ? (long long)preIds_.size() : (long long)gridPre_.N * gridPost_.N;
+		long long snapshotSize = sizeof(long long) + numWts * sizeof(float);
+		for (; offset + snapshotSize <= fileSize; offset += snapshotSize)
+			snapshotOffsets_.push_back(offset);
+	} else {
+		// a delta snapshot is the time stamp, the number of changed weights, their synapse indices and weights
+		while (offset + (long long)(sizeof(long long) + sizeof(int)) <= fileSize) {
+			long long pos = offset + sizeof(long long);
+			int nChanged = file_->read<int>(pos);
+			UserErrors::assertTrue(nChanged >= 0 && nChanged <= (int)preIds_.size(), UserErrors::FILE_CANNOT_READ,
+				"ConnectionFileReader", file_->getFileName() + " (corrupt snapshot)");
+			if (pos + 2LL * nChanged * sizeof(int) > fileSize)
+				break; // incomplete snapshot at the end of the file
+			snapshotOffsets_.push_back(offset);
+			offset = pos + 2LL * nChanged * sizeof(int);
+		}
+	}
+}
+
+long long ConnectionFileReader::getSnapshotTime(int snapshot) {
+	UserErrors::assertTrue(snapshot >= 0 && snapshot < getNumSnapshots(), UserErrors::MUST_BE_IN_RANGE,
+		"ConnectionFileReader::getSnapshotTime", "snapshot", "[0, getNumSnapshots())");
+	long long offset = snapshotOffsets_[snapshot];
+	return file_->read<long long>(offset);
+}
+
+void ConnectionFileReader::getSynapses(std::vector<int>& preIds, std::vector<int>& postIds) {
+	preIds = preIds_;
+	postIds = postIds_;
+}
+
+std::vector<float> ConnectionFileReader::getWeights(int snapshot) {
+	UserErrors::assertTrue(snapshot >= 0 && snapshot < getNumSnapshots(), UserErrors::MUST_BE_IN_RANGE,
+		"ConnectionFileReader::getWeights", "snapshot", "[0, getNumSnapshots())");
+	int nSyn = preIds_.size();
+	const unsigned char* data = file_->getData() + snapshotOffsets_[snapshot] + sizeof(long long);
+
+	if (!isDelta_) {
+		std::vector<float> wts(nSyn);
+		if (isSparse_) {
+			if (nSyn > 0)
+				memcpy(&wts[0], data, nSyn * sizeof(float));
+		} else {
+			const float* wtMat = (const float*)data;
+			for (int i = 0; i < nSyn; i++)
+				memcpy(&wts[i], &wtMat[(long long)preIds_[i] * gridPost_.N + postIds_[i]], sizeof(float));
+		}
+		return wts;
+	}
+
+	// accumulate the changes since the cached snapshot (or since the first one)
+	if (cachedSnapshot_ < 0 || cachedSnapshot_ > snapshot) {
+		cachedSnapshot_ = -1;
+		cachedWeights_.assign(nSyn, NAN);
+	}
+	for (int s = cachedSnapshot_ + 1; s <= snapshot; s++) {
+		long long pos = snapshotOffsets_[s] + sizeof(long long);
+		int nChanged = file_->read<int>(pos);
+		const unsigned char* synIds = file_->getData() + pos;
+		const unsigned char* synWts = synIds + nChanged * sizeof(int);
+		for (int i = 0; i < nChanged; i++) {
+			int synId;
+			memcpy(&synId, synIds + i * sizeof(int), sizeof(int));
+			UserErrors::assertTrue(synId >= 0 && synId < nSyn, UserErrors::FILE_CANNOT_READ,
+				"ConnectionFileReader::getWeights", file_->getFileName() + " (corrupt snapshot)");
+			memcpy(&cachedWeights_[synId], synWts + i * sizeof(float), sizeof(float));
+		}
+	}
+	cachedSnapshot_ = snapshot;
+	return cachedWeights_;
+}
+
+struct WeightHistogramArgs {
+	const std::vector<float>* wts;
+	float minWt;
+	float binWidth;
+	std::vector<std::vector<long long> >* threadHists;
+};
+
+static void countWeights(long long begin, long long end, int threadId, void* ptr) {
+	WeightHistogramArgs* args = (WeightHistogramArgs*)ptr;
+	std::vector<long long>& hist = (*args->threadHists)[threadId];
+	int numBins = hist.size();
+	for (long long i = begin; i < end; i++) {
+		float wt = (*args->wts)[i];
+		if (isnan(wt))
+			continue;
+		int bin = args->binWidth > 0.0f ? (int)((wt - args->minWt) / args->binWidth) : 0;
+		hist[std::max(0, std::min(bin, numBins - 1))]++;
+	}
+}
+
+std::vector<long long> ConnectionFileReader::getWeightHistogram(int snapshot, int numBins) {
+	UserErrors::assertTrue(numBins > 0, UserErrors::MUST_BE_POSITIVE, "ConnectionFileReader::getWeightHistogram",
+		"numBins");
+	std::vector<float> wts = getWeights(snapshot);
+
+	// every thread counts a range of the weights
+	int numThreads = getNumAnalysisThreads(numThreads_, wts.size());
+	std::vector<std::vector<long long> > threadHists(numThreads, std::vector<long long>(numBins, 0));
+	WeightHistogramArgs args;
+	args.wts = &wts;
+	args.minWt = std::min(0.0f, minWt_);
+	args.binWidth = (maxWt_ - args.minWt) / numBins;
+	args.threadHists = &threadHists;
+	parallelFor(0, wts.size(), numThreads, &countWeights, &args);
+
+	std::vector<long long> hist(numBins, 0);
+	for (int t = 0; t < numThreads; t++) {
+		for (int b = 0; b < numBins; b++)
+			hist[b] += threadHists[t][b];
+	}
+	return hist;
+}
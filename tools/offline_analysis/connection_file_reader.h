@@ -0,0 +1,162 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#ifndef _CONNECTION_FILE_READER_H_
+#define _CONNECTION_FILE_READER_H_
+
+#include <carlsim_datastructures.h>	// Grid3D
+#include <string>					// std::string
+#include <vector>					// std::vector
+
+class MappedFile;
+
+
+/*!
+ * \brief Reads the weight snapshots of a connection file written by a ConnectionMonitor
+ *
+ * This class is the C++ counterpart of the MATLAB ConnectionReader (see tools/offline_analysis_toolbox). The file is
+ * memory-mapped and indexed once, so that any snapshot can be accessed without reading the ones before it (except
+ * for delta snapshots, which are accumulated). All connection file formats are supported (see
+ * CARLsim::setConnectFileFormat):
+ * - Version 0.3 (CONNECT_FILE_DENSE): every snapshot holds the full (pre x post) weight matrix, where NAN marks
+ *   non-existent synapses.
+ * - Version 0.4 (CONNECT_FILE_SPARSE, CONNECT_FILE_SPARSE_DELTA): the header is followed by the synapse list, and
+ *   every snapshot holds one weight per synapse (or only the changed weights).
+ *
+ * \since v4.0
+ */
+class ConnectionFileReader {
+public:
+	/*!
+	 * \brief ConnectionFileReader constructor
+	 *
+	 * \param[in] fileName   name of a connection file written by a ConnectionMonitor
+	 * \param[in] numThreads number of threads used by getWeightHistogram, 0 for one thread per core
+	 */
+	ConnectionFileReader(const std::string& fileName, int numThreads=0);
+
+	//! ConnectionFileReader destructor, unmaps the file
+	~ConnectionFileReader();
+
+	//! returns the version number of the connection file
+	float getVersion() { return version_; }
+
+	//! returns the connection ID
+	short int getConnectId() { return connId_; }
+
+	//! returns the ID of the pre-synaptic group
+	int getGrpIdPre() { return grpIdPre_; }
+
+	//! returns the ID of the post-synaptic group
+	int getGrpIdPost() { return grpIdPost_; }
+
+	//! returns the 3D grid of the pre-synaptic group
+	Grid3D getGrid3DPre() { return gridPre_; }
+
+	//! returns the 3D grid of the post-synaptic group
+	Grid3D getGrid3DPost() { return gridPost_; }
+
+	//! returns the number of synapses of the connection
+	int getNumSynapses() { return preIds_.size(); }
+
+	//! returns whether the synapses are plastic
+	bool isPlastic() { return isPlastic_; }
+
+	//! returns the minimum weight of the connection
+	float getMinWeight() { return minWt_; }
+
+	//! returns the maximum weight of the connection
+	float getMaxWeight() { return maxWt_; }
+
+	//! returns the number of weight snapshots in the file
+	int getNumSnapshots() { return snapshotOffsets_.size(); }
+
+	//! returns the time (ms) of a snapshot
+	long long getSnapshotTime(int snapshot);
+
+	/*!
+	 * \brief Returns the synapse list
+	 *
+	 * The weights returned by getWeights are in the same order. For dense files, the synapses are the entries of the
+	 * first weight matrix that are not NAN, in (pre, post) order.
+	 */
+	void getSynapses(std::vector<int>& preIds, std::vector<int>& postIds);
+
+	//! returns the weight of every synapse (see getSynapses) at a snapshot
+	std::vector<float> getWeights(int snapshot);
+
+	/*!
+	 * \brief Returns the histogram of the weights at a snapshot
+	 *
+	 * The bins evenly divide [min(0, minWt), maxWt]; weights outside are counted in the first or last bin.
+	 */
+	std::vector<long long> getWeightHistogram(int snapshot, int numBins);
+
+private:
+	//! indexes the snapshots of the file
+	void readSnapshotOffsets(long long offset);
+
+	MappedFile* file_;
+	int numThreads_;
+
+	float version_;
+	short int connId_;
+	int grpIdPre_, grpIdPost_;
+	Grid3D gridPre_, gridPost_;
+	bool isPlastic_;
+	float minWt_, maxWt_;
+	bool isSparse_, isDelta_;
+
+	std::vector<int> preIds_, postIds_;
+	std::vector<long long> snapshotOffsets_; //!< file offset of every snapshot (time stamp)
+
+	// the snapshot that getWeights returned last, delta snapshots are accumulated from there
+	int cachedSnapshot_;
+	std::vector<float> cachedWeights_;
+};
+
+#endif
@@ -0,0 +1,87 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include <simulation_file_reader.h>
+
+#include <analysis_utils.h>		// MappedFile
+#include <user_errors.h>		// fancy user error messages
+
+#include <algorithm>				// std::find
+
+// int signature of simulation files
+#define SIMULATION_FILE_SIGNATURE 294338571
+
+
+SimulationFileReader::SimulationFileReader(const std::string& fileName) {
+	std::string funcName = "SimulationFileReader(" + fileName + ")";
+	MappedFile file(fileName);
+
+	long long offset = 0;
+	UserErrors::assertTrue(file.read<int>(offset) == SIMULATION_FILE_SIGNATURE, UserErrors::FILE_CANNOT_READ,
+		funcName, fileName + " (unknown file signature)");
+	version_ = file.read<float>(offset);
+	simTimeSec_ = file.read<float>(offset);
+	exeTimeSec_ = file.read<float>(offset);
+	numN_ = file.read<int>(offset);
+	numSyn_ = file.read<int>(offset);
+	file.read<int>(offset); // number of synapses (written twice)
+	int numGroups = file.read<int>(offset);
+	UserErrors::assertTrue(numGroups >= 0, UserErrors::FILE_CANNOT_READ, funcName, fileName + " (corrupt header)");
+
+	for (int g = 0; g < numGroups; g++) {
+		grpStartN_.push_back(file.read<int>(offset));
+		grpEndN_.push_back(file.read<int>(offset));
+		int x = file.read<int>(offset), y = file.read<int>(offset), z = file.read<int>(offset);
+		grpGrids_.push_back(Grid3D(x, y, z));
+
+		// names are stored in 100 chars, not necessarily null-terminated
+		file.checkRange(offset, 100);
+		const char* name = (const char*)file.getData() + offset;
+		grpNames_.push_back(std::string(name, std::find(name, name + 100, '\0')));
+		offset += 100;
+	}
+}
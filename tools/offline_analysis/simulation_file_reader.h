@@ -0,0 +1,111 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#ifndef _SIMULATION_FILE_READER_H_
+#define _SIMULATION_FILE_READER_H_
+
+#include <carlsim_datastructures.h>	// Grid3D
+#include <string>					// std::string
+#include <vector>					// std::vector
+
+
+/*!
+ * \brief Reads the header and group info of a simulation file written by CARLsim::saveSimulation
+ *
+ * This class is the C++ counterpart of the MATLAB SimulationReader (see tools/offline_analysis_toolbox). The synapse
+ * sections of the file are not read.
+ *
+ * \since v4.0
+ */
+class SimulationFileReader {
+public:
+	//! opens and reads a simulation file
+	SimulationFileReader(const std::string& fileName);
+
+	//! returns the version number of the simulation file
+	float getVersion() { return version_; }
+
+	//! returns the simulated time (s) at which the file was written
+	float getSimTimeSec() { return simTimeSec_; }
+
+	//! returns the execution time (s) at which the file was written
+	float getExecutionTimeSec() { return exeTimeSec_; }
+
+	//! returns the number of neurons in the network
+	int getNumNeurons() { return numN_; }
+
+	//! returns the number of synapses in the network
+	int getNumSynapses() { return numSyn_; }
+
+	//! returns the number of groups in the network
+	int getNumGroups() { return grpNames_.size(); }
+
+	//! returns the name of a group
+	const std::string& getGroupName(int grpId) { return grpNames_[grpId]; }
+
+	//! returns the first neuron ID of a group
+	int getGroupStartNeuronId(int grpId) { return grpStartN_[grpId]; }
+
+	//! returns the last neuron ID of a group
+	int getGroupEndNeuronId(int grpId) { return grpEndN_[grpId]; }
+
+	//! returns the 3D grid of a group
+	Grid3D getGroupGrid3D(int grpId) { return grpGrids_[grpId]; }
+
+private:
+	float version_;
+	float simTimeSec_;
+	float exeTimeSec_;
+	int numN_;
+	int numSyn_;
+	std::vector<std::string> grpNames_;
+	std::vector<int> grpStartN_;
+	std::vector<int> grpEndN_;
+	std::vector<Grid3D> grpGrids_;
+};
+
+#endif
@@ -0,0 +1,243 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include <spike_analyzer.h>
+
+#include <analysis_utils.h>		// parallelFor
+#include <spike_file_reader.h>	// SpikeFileReader
+#include <user_errors.h>		// fancy user error messages
+
+#include <math.h>				// sqrt, NAN
+#include <limits.h>				// INT_MAX
+#include <algorithm>			// std::min, std::max
+
+// length of the slices in which the spike file is read (ms)
+#define SPIKE_ANALYZER_SLICE_MS 10000
+
+
+SpikeAnalyzer::SpikeAnalyzer(const std::string& fileName, int numThreads) {
+	reader_ = new SpikeFileReader(fileName);
+	numThreads_ = numThreads;
+	numNeurons_ = reader_->getNumNeurons();
+	startTime_ = 0;
+	endTime_ = 0;
+	binSizeMs_ = 1;
+	isiBinSizeMs_ = 1;
+	numSpikes_ = 0;
+}
+
+SpikeAnalyzer::~SpikeAnalyzer() {
+	delete reader_;
+}
+
+Grid3D SpikeAnalyzer::getGrid3D() { return reader_->getGrid3D(); }
+int SpikeAnalyzer::getNumNeurons() { return numNeurons_; }
+
+void SpikeAnalyzer::analyze(int startTime, int endTime, int binSizeMs, int isiBinSizeMs, int numIsiBins) {
+	std::string funcName = "SpikeAnalyzer::analyze()";
+	UserErrors::assertTrue(startTime >= 0, UserErrors::CANNOT_BE_NEGATIVE, funcName, "startTime");
+	UserErrors::assertTrue(endTime == -1 || endTime > startTime, UserErrors::MUST_BE_LARGER, funcName, "endTime",
+		"startTime (or -1)");
+	UserErrors::assertTrue(binSizeMs > 0, UserErrors::MUST_BE_POSITIVE, funcName, "binSizeMs");
+	UserErrors::assertTrue(isiBinSizeMs > 0, UserErrors::MUST_BE_POSITIVE, funcName, "isiBinSizeMs");
+	UserErrors::assertTrue(numIsiBins > 0, UserErrors::MUST_BE_POSITIVE, funcName, "numIsiBins");
+
+	startTime_ = startTime;
+	binSizeMs_ = binSizeMs;
+	isiBinSizeMs_ = isiBinSizeMs;
+	numSpikes_ = 0;
+	spikeCounts_.assign(numNeurons_, 0);
+	lastSpikeTimes_.assign(numNeurons_, -1);
+	numISIs_.assign(numNeurons_, 0);
+	sumISIs_.assign(numNeurons_, 0.0);
+	sumSqISIs_.assign(numNeurons_, 0.0);
+	popCounts_.clear();
+	isiHist_.assign(numIsiBins, 0);
+
+	// stream the file slice by slice, until all spikes of the time window have been read
+	std::vector<int> spkTimes, neurIds;
+	long long numRead = 0;
+	int lastSpikeTime = -1;
+	reader_->rewind();
+	for (long long sliceEnd = SPIKE_ANALYZER_SLICE_MS; numRead < reader_->getNumSpikes(); sliceEnd += SPIKE_ANALYZER_SLICE_MS) {
+		int sliceStart = (int)(sliceEnd - SPIKE_ANALYZER_SLICE_MS);
+		if (endTime >= 0 && sliceStart >= endTime)
+			break;
+
+		int readEnd = (int)std::min(sliceEnd, (long long)(endTime >= 0 ? endTime : INT_MAX));
+		spkTimes.clear();
+		neurIds.clear();
+		reader_->readNextSpikes(readEnd, spkTimes, neurIds);
+		numRead += spkTimes.size();
+		if (!spkTimes.empty())
+			lastSpikeTime = spkTimes.back();
+
+		if (readEnd > startTime_)
+			analyzeSlice(spkTimes, neurIds, std::max(sliceStart, startTime_), readEnd);
+	}
+
+	// without an end time, the window ends with the last second that contains a spike
+	endTime_ = (endTime >= 0) ? endTime : std::max(startTime_, (lastSpikeTime / 1000 + 1) * 1000);
+	popCounts_.resize((endTime_ - startTime_ + binSizeMs_ - 1) / binSizeMs_, 0);
+}
+
+void SpikeAnalyzer::analyzeSlice(const std::vector<int>& spkTimes, const std::vector<int>& neurIds, int sliceStart,
+	int sliceEnd)
+{
+	// sort the spike times of the slice by neuron (counting sort keeps them sorted by time)
+	sliceOffsets_.assign(numNeurons_ + 1, 0);
+	for (size_t i = 0; i < spkTimes.size(); i++) {
+		if (spkTimes[i] >= sliceStart) {
+			UserErrors::assertTrue(neurIds[i] >= 0 && neurIds[i] < numNeurons_, UserErrors::FILE_CANNOT_READ,
+				"SpikeAnalyzer::analyze()", "spike file (neuron ID out of range)");
+			sliceOffsets_[neurIds[i] + 1]++;
+		}
+	}
+	for (int n = 0; n < numNeurons_; n++)
+		sliceOffsets_[n + 1] += sliceOffsets_[n];
+	int numSliceSpikes = sliceOffsets_[numNeurons_];
+	numSpikes_ += numSliceSpikes;
+	if (!numSliceSpikes)
+		return;
+
+	sliceTimes_.resize(numSliceSpikes);
+	std::vector<int> pos(sliceOffsets_.begin(), sliceOffsets_.end() - 1);
+	for (size_t i = 0; i < spkTimes.size(); i++) {
+		if (spkTimes[i] >= sliceStart)
+			sliceTimes_[pos[neurIds[i]]++] = spkTimes[i];
+	}
+
+	// every thread counts the bins of the slice for its neurons
+	int numThreads = getNumAnalysisThreads(numThreads_, numNeurons_);
+	sliceFirstBin_ = (sliceStart - startTime_) / binSizeMs_;
+	int numSliceBins = (sliceEnd - 1 - startTime_) / binSizeMs_ - sliceFirstBin_ + 1;
+	threadPopCounts_.assign(numThreads, std::vector<long long>(numSliceBins, 0));
+	threadIsiHists_.assign(numThreads, std::vector<long long>(isiHist_.size(), 0));
+
+	parallelFor(0, numNeurons_, numThreads, &SpikeAnalyzer::analyzeNeurons, this);
+
+	if (popCounts_.size() < sliceFirstBin_ + numSliceBins)
+		popCounts_.resize(sliceFirstBin_ + numSliceBins, 0);
+	for (int t = 0; t < numThreads; t++) {
+		for (int b = 0; b < numSliceBins; b++)
+			popCounts_[sliceFirstBin_ + b] += threadPopCounts_[t][b];
+		for (size_t b = 0; b < isiHist_.size(); b++)
+			isiHist_[b] += threadIsiHists_[t][b];
+	}
+}
+
+void SpikeAnalyzer::analyzeNeurons(long long begin, long long end, int threadId, void* self) {
+	SpikeAnalyzer* obj = (SpikeAnalyzer*)self;
+	std::vector<long long>& popCounts = obj->threadPopCounts_[threadId];
+	std::vector<long long>& isiHist = obj->threadIsiHists_[threadId];
+	int numIsiBins = isiHist.size();
+
+	// neurons are disjoint among threads, so the per-neuron statistics need no locking
+	for (int n = (int)begin; n < end; n++) {
+		for (int i = obj->sliceOffsets_[n]; i < obj->sliceOffsets_[n + 1]; i++) {
+			int time = obj->sliceTimes_[i];
+			obj->spikeCounts_[n]++;
+			popCounts[(time - obj->startTime_) / obj->binSizeMs_ - obj->sliceFirstBin_]++;
+
+			if (obj->lastSpikeTimes_[n] >= 0) {
+				int isi = time - obj->lastSpikeTimes_[n];
+				obj->numISIs_[n]++;
+				obj->sumISIs_[n] += isi;
+				obj->sumSqISIs_[n] += (double)isi * isi;
+				isiHist[std::min(isi / obj->isiBinSizeMs_, numIsiBins - 1)]++;
+			}
+			obj->lastSpikeTimes_[n] = time;
+		}
+	}
+}
+
+std::vector<float> SpikeAnalyzer::getFiringRates() {
+	std::vector<float> rates(numNeurons_, 0.0f);
+	if (endTime_ > startTime_) {
+		for (int n = 0; n < numNeurons_; n++)
+			rates[n] = spikeCounts_[n] * 1000.0f / (endTime_ - startTime_);
+	}
+	return rates;
+}
+
+float SpikeAnalyzer::getMeanFiringRate() {
+	if (endTime_ <= startTime_)
+		return 0.0f;
+	return (float)(numSpikes_ * 1000.0 / ((double)(endTime_ - startTime_) * numNeurons_));
+}
+
+std::vector<float> SpikeAnalyzer::getPopulationRates() {
+	std::vector<float> rates(popCounts_.size());
+	for (size_t b = 0; b < popCounts_.size(); b++) {
+		// the last bin might be cut off by the end of the time window
+		int binStart = startTime_ + b * binSizeMs_;
+		int binLength = std::min(binSizeMs_, endTime_ - binStart);
+		rates[b] = (float)(popCounts_[b] * 1000.0 / ((double)binLength * numNeurons_));
+	}
+	return rates;
+}
+
+std::vector<float> SpikeAnalyzer::getMeanISIs() {
+	std::vector<float> meanISIs(numNeurons_, NAN);
+	for (int n = 0; n < numNeurons_; n++) {
+		if (numISIs_[n] > 0)
+			meanISIs[n] = (float)(sumISIs_[n] / numISIs_[n]);
+	}
+	return meanISIs;
+}
+
+std::vector<float> SpikeAnalyzer::getCVs() {
+	std::vector<float> cvs(numNeurons_, NAN);
+	for (int n = 0; n < numNeurons_; n++) {
+		if (numISIs_[n] < 2)
+			continue;
+		double mean = sumISIs_[n] / numISIs_[n];
+		double var = std::max(0.0, sumSqISIs_[n] / numISIs_[n] - mean * mean);
+		cvs[n] = (float)(sqrt(var) / mean);
+	}
+	return cvs;
+}
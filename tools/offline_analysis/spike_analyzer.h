@@ -0,0 +1,177 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#ifndef _SPIKE_ANALYZER_H_
+#define _SPIKE_ANALYZER_H_
+
+#include <carlsim_datastructures.h>	// Grid3D
+#include <string>					// std::string
+#include <vector>					// std::vector
+
+class SpikeFileReader;
+
+
+/*!
+ * \brief Computes spike statistics of a spike file in a single pass
+ *
+ * This class is the C++ counterpart of the analysis methods of the MATLAB SpikeReader (see
+ * tools/offline_analysis_toolbox). It streams a spike file (any version SpikeFileReader can read) through memory in
+ * slices of 10 seconds, so that files larger than the available memory can be analyzed. The spikes of each slice are
+ * sorted by neuron and the neurons are distributed over multiple threads.
+ *
+ * Example usage:
+ * \code
+ * SpikeAnalyzer spkAnalyzer("results/spk_exc.dat");
+ * spkAnalyzer.analyze(0, -1, 100); // whole file, population rate in 100 ms bins
+ * std::vector<float> rates = spkAnalyzer.getFiringRates();
+ * \endcode
+ *
+ * \since v4.0
+ */
+class SpikeAnalyzer {
+public:
+	/*!
+	 * \brief SpikeAnalyzer constructor
+	 *
+	 * \param[in] fileName   name of a spike file written by a SpikeMonitor
+	 * \param[in] numThreads number of threads, 0 for one thread per core
+	 */
+	SpikeAnalyzer(const std::string& fileName, int numThreads=0);
+
+	//! SpikeAnalyzer destructor
+	~SpikeAnalyzer();
+
+	/*!
+	 * \brief Computes all statistics of a time window
+	 *
+	 * \param[in] startTime    start of the time window (ms, inclusive)
+	 * \param[in] endTime      end of the time window (ms, exclusive), or -1 for the end of the last second that
+	 *                         contains a spike
+	 * \param[in] binSizeMs    bin size (ms) of the population rate
+	 * \param[in] isiBinSizeMs bin size (ms) of the ISI histogram
+	 * \param[in] numIsiBins   number of bins of the ISI histogram, longer ISIs are counted in the last bin
+	 */
+	void analyze(int startTime=0, int endTime=-1, int binSizeMs=100, int isiBinSizeMs=1, int numIsiBins=100);
+
+	//! returns the 3D grid of the recorded group
+	Grid3D getGrid3D();
+
+	//! returns the number of neurons of the recorded group
+	int getNumNeurons();
+
+	//! returns the start of the analyzed time window (ms)
+	int getStartTime() { return startTime_; }
+
+	//! returns the end of the analyzed time window (ms)
+	int getEndTime() { return endTime_; }
+
+	//! returns the number of spikes in the time window
+	long long getNumSpikes() { return numSpikes_; }
+
+	//! returns the number of spikes of every neuron
+	std::vector<long long> getSpikeCounts() { return spikeCounts_; }
+
+	//! returns the mean firing rate (Hz) of every neuron
+	std::vector<float> getFiringRates();
+
+	//! returns the mean firing rate (Hz) of the group
+	float getMeanFiringRate();
+
+	//! returns the bin size (ms) of the population rate
+	int getBinSize() { return binSizeMs_; }
+
+	//! returns the mean firing rate (Hz) of the group in every bin
+	std::vector<float> getPopulationRates();
+
+	//! returns the mean inter-spike interval (ms) of every neuron, NAN for neurons with less than two spikes
+	std::vector<float> getMeanISIs();
+
+	//! returns the coefficient of variation of the ISIs of every neuron, NAN for neurons with less than three spikes
+	std::vector<float> getCVs();
+
+	//! returns the bin size (ms) of the ISI histogram
+	int getISIBinSize() { return isiBinSizeMs_; }
+
+	//! returns the histogram of the ISIs of all neurons
+	std::vector<long long> getISIHistogram() { return isiHist_; }
+
+private:
+	//! accumulates the statistics of the spikes of a slice, which are sorted by time
+	void analyzeSlice(const std::vector<int>& spkTimes, const std::vector<int>& neurIds, int sliceStart, int sliceEnd);
+
+	//! body of the threads of analyzeSlice
+	static void analyzeNeurons(long long begin, long long end, int threadId, void* self);
+
+	SpikeFileReader* reader_;
+	int numThreads_;
+	int numNeurons_;
+
+	int startTime_;
+	int endTime_;
+	int binSizeMs_;
+	int isiBinSizeMs_;
+	long long numSpikes_;
+
+	// per neuron
+	std::vector<long long> spikeCounts_;
+	std::vector<int> lastSpikeTimes_;
+	std::vector<long long> numISIs_;
+	std::vector<double> sumISIs_;
+	std::vector<double> sumSqISIs_;
+
+	std::vector<long long> popCounts_; //!< number of spikes in every bin of the population rate
+	std::vector<long long> isiHist_;
+
+	// state of the current slice: spike times sorted by neuron, and counts of every thread
+	std::vector<int> sliceOffsets_;
+	std::vector<int> sliceTimes_;
+	int sliceFirstBin_;
+	std::vector<std::vector<long long> > threadPopCounts_;
+	std::vector<std::vector<long long> > threadIsiHists_;
+};
+
+#endif
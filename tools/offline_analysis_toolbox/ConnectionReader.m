@@ -33,6 +33,11 @@ classdef ConnectionReader < handle
         fileSizeByteHeader;    % byte size of header section
         fileSizeByteSnapshot;  % byte size of a single snapshot
 
+        isSparse;              % whether snapshots list weights per synapse
+        isDelta;               % whether snapshots list changed weights only
+        synIdx;                % weight matrix index of every synapse
+        snapshotOffsets;       % byte offset of every snapshot (delta)
+
         weights;
         timeStamps;
         nSnapshots;            % number of weight matrix snapshots
@@ -160,6 +165,13 @@ classdef ConnectionReader < handle
             obj.timeStamps = [];
             obj.weights = [];
             
+            if obj.isSparse
+                obj.readSparseWeights(snapShots);
+                timeStamps = obj.timeStamps;
+                weights = obj.weights;
+                return
+            end
+            
             for i=1:numel(snapShots)
                 frame = snapShots(i);
 
@@ -187,6 +199,44 @@ classdef ConnectionReader < handle
     
     %% PRIVATE METHODS
     methods (Hidden, Access = private)
+        function readSparseWeights(obj, snapShots)
+            % CR.readSparseWeights(snapShots) reads snapshots of a sparse
+            % connect file (version 0.4) and expands them to full weight
+            % matrices (non-existent synapses are NaN).
+            wt = nan(1, obj.nNeurPre*obj.nNeurPost);
+            wtSyn = nan(1, numel(obj.synIdx));
+            lastFrame = 0;
+            for i=1:numel(snapShots)
+                frame = snapShots(i);
+                if obj.isDelta
+                    % replay all changes up to the requested snapshot
+                    if frame<=lastFrame
+                        wtSyn(:) = nan;
+                        lastFrame = 0;
+                    end
+                    for f=lastFrame+1:frame
+                        fseek(obj.fileId, obj.snapshotOffsets(f), 'bof');
+                        timeStamp = fread(obj.fileId, 1, 'int64');
+                        nChanged = fread(obj.fileId, 1, 'int32');
+                        changedIdx = fread(obj.fileId, nChanged, 'int32');
+                        wtSyn(changedIdx+1) = fread(obj.fileId, ...
+                            nChanged, 'float32');
+                    end
+                    lastFrame = frame;
+                else
+                    fseek(obj.fileId, obj.fileSizeByteHeader ...
+                        + obj.fileSizeByteSnapshot*(frame-1), 'bof');
+                    timeStamp = fread(obj.fileId, 1, 'int64');
+                    wtSyn = fread(obj.fileId, numel(obj.synIdx), ...
+                        'float32')';
+                end
+                
+                wt(obj.synIdx) = wtSyn;
+                obj.timeStamps = [obj.timeStamps timeStamp];
+                obj.weights(end+1,:) = wt;
+            end
+        end
+        
         function isSupported = isErrorModeSupported(obj, errMode)
             % determines whether an error mode is currently supported
             isSupported = sum(ismember(obj.supportedErrorModes,errMode))>0;
@@ -211,6 +261,10 @@ classdef ConnectionReader < handle
             obj.nSynapses = -1;
             obj.isPlastic = false;
             obj.nSnapshots = -1;
+            obj.isSparse = false;
+            obj.isDelta = false;
+            obj.synIdx = [];
+            obj.snapshotOffsets = [];
             
             obj.supportedErrorModes = {'standard', 'warning', 'silent'};
 
@@ -323,13 +377,52 @@ classdef ConnectionReader < handle
                         num2str(obj.maxWt) ')'])
             end
             
+            % sparse files (version 0.4) list all synapses after the header:
+            % isDelta flag, number of synapses, pre IDs, post IDs
+            obj.isSparse = floor((version-obj.fileVersionMajor)*10.01)>=4;
+            if obj.isSparse
+                obj.isDelta = fread(obj.fileId, 1, 'int32')~=0;
+                nSyn = fread(obj.fileId, 1, 'int32');
+                preIds = fread(obj.fileId, nSyn, 'int32')';
+                postIds = fread(obj.fileId, nSyn, 'int32')';
+                if feof(obj.fileId) || nSyn<0
+                    obj.throwError('Could not read list of synapses.')
+                    return
+                end
+                
+                % index into a weight matrix row, as in dense files
+                obj.synIdx = preIds*obj.nNeurPost + postIds + 1;
+            end
+            
             % store the size of the header section, so that we can skip it
             % when re-reading spikes
             obj.fileSizeByteHeader = ftell(obj.fileId);
             
+            if obj.isDelta
+                % delta snapshots vary in size: find all of them
+                fseek(obj.fileId, 0, 'eof');
+                szByteTot = ftell(obj.fileId);
+                offset = obj.fileSizeByteHeader;
+                obj.snapshotOffsets = [];
+                while offset+12 <= szByteTot
+                    fseek(obj.fileId, offset+8, 'bof');
+                    nChanged = fread(obj.fileId, 1, 'int32');
+                    if offset+12+nChanged*8 > szByteTot
+                        break
+                    end
+                    obj.snapshotOffsets(end+1) = offset;
+                    offset = offset + 12 + nChanged*8;
+                end
+                obj.nSnapshots = numel(obj.snapshotOffsets);
+                return
+            end
+            
             % find size of each snapshot: #weights * sizeof(float32) +
             % sizeof(long int)
             obj.fileSizeByteSnapshot = obj.nNeurPre*obj.nNeurPost*4+8;
+            if obj.isSparse
+                obj.fileSizeByteSnapshot = numel(obj.synIdx)*4+8;
+            end
 
             % compute number of snapshots present in the file
             % find byte size from here on until end of file, divide it by
@@ -91,7 +91,7 @@ classdef SimulationReader < handle
             obj.fileId = -1;
             obj.fileSignature = 294338571;
             obj.fileVersionMajor = 0;
-            obj.fileVersionMinor = 2;
+            obj.fileVersionMinor = 3;
 
 			% disable backtracing for warnings and errors
 			warning off backtrace
@@ -188,25 +188,35 @@ classdef SimulationReader < handle
             %% READ SYNAPSES
             % reading synapse info is optional
             if loadSynapseInfo
-                weightData = cell(sim.nNeurons,1);
-                nrSynTot = 0;
-                for i=1:sim.nNeurons
+                % synapses are stored per partition as contiguous arrays
+                numPartitions = fread(fid,1,'int32');
+                preIDs = cell(numPartitions,1);
+                postIDs = cell(numPartitions,1);
+                weights = cell(numPartitions,1);
+                maxWeights = cell(numPartitions,1);
+                delays = cell(numPartitions,1);
+                plastic = cell(numPartitions,1);
+                for p=1:numPartitions
+                    fread(fid,1,'int32'); % netId
                     nrSyn = fread(fid,1,'int32');
-                    nrSynTot = nrSynTot + nrSyn;
-                    if nrSyn>0
-                        weightData{i} = fread(fid,[18 nrSyn],'uint8=>uint8');
-                    end
-				end
-				
-                alldata = cat(2,weightData{:});
-                clear weightData;
-                
-                obj.syn_preIDs = typecast(reshape(alldata(1:4,:),[],1),'uint32');
-                obj.syn_postIDs = typecast(reshape(alldata(5:8,:),[],1),'uint32');
-                obj.syn_weights = typecast(reshape(alldata(9:12,:),[],1),'single');
-                obj.syn_maxWeights = typecast(reshape(alldata(13:16,:),[],1),'single');
-                obj.syn_delays = alldata(17,:);
-                obj.syn_plastic = alldata(18,:);
+                    nrConns = fread(fid,1,'int32');
+                    fread(fid,2*nrConns,'int32'); % connIds, number of synapses per connection
+                    preIDs{p} = fread(fid,nrSyn,'int32=>uint32');
+                    postIDs{p} = fread(fid,nrSyn,'int32=>uint32');
+                    weights{p} = fread(fid,nrSyn,'single=>single');
+                    maxWeights{p} = fread(fid,nrSyn,'single=>single');
+                    delays{p} = fread(fid,nrSyn,'uint8=>uint8');
+                    plastic{p} = fread(fid,nrSyn,'uint8=>uint8');
+                    nrKernelWt = fread(fid,1,'int32');
+                    fread(fid,nrKernelWt,'single'); % shared kernels
+                end
+
+                obj.syn_preIDs = cat(1,preIDs{:});
+                obj.syn_postIDs = cat(1,postIDs{:});
+                obj.syn_weights = cat(1,weights{:});
+                obj.syn_maxWeights = cat(1,maxWeights{:});
+                obj.syn_delays = cat(1,delays{:})';
+                obj.syn_plastic = cat(1,plastic{:})';
             end
             
             obj.fileId = fid;
@@ -32,6 +32,9 @@ classdef SpikeReader < handle
         fileVersionMajor;    % required major version number
         fileVersionMinor;    % required minimum minor version number
         fileSizeByteHeader;  % byte size of header section
+        isChunked;           % whether the file is chunked (version 0.3)
+        chunks;              % chunk table of a chunked file: one row
+        % <file offset, first spike time, last spike time, nr spikes>
         
         grid3D;              % 3D grid dimensions of group
         binWindow;           % binning window for spike times (ms)
@@ -142,6 +145,14 @@ classdef SpikeReader < handle
             %
             % The total simulation duration is usually stored in a
             % "sim_{simName}.dat" file and can be retrieved by using a
+            if obj.isChunked
+                % last spike time of the last chunk
+                simDurMs = 0;
+                if ~isempty(obj.chunks)
+                    simDurMs = obj.chunks(end,3);
+                end
+                return
+            end
             fseek(obj.fileId, -8, 'eof'); % jump to penultimate int
             simDurMs = fread(obj.fileId, 1, 'int32');
         end
@@ -176,14 +187,23 @@ classdef SpikeReader < handle
             fseek(obj.fileId, obj.fileSizeByteHeader, 'bof');
             
             nrRead=1e6;
-            d=zeros(0,nrRead);
+            chunkId=0;
+            moreData=true;
             spk=[];
             
-            while size(d,2)==nrRead
+            while moreData
                 % D is a 2xNRREAD matrix.  Row 1 contains the times that
                 % the neuron spiked. Row 2 contains the neuron id that
                 % spiked at this corresponding time.
-                d = fread(obj.fileId, [2 nrRead], 'int32');
+                if obj.isChunked
+                    % read one chunk at a time
+                    chunkId = chunkId + 1;
+                    d = obj.readChunk(chunkId);
+                    moreData = chunkId < size(obj.chunks,1);
+                else
+                    d = fread(obj.fileId, [2 nrRead], 'int32');
+                    moreData = size(d,2)==nrRead;
+                end
 
                 if ~isempty(d)
                     if obj.binWindow<0
@@ -249,6 +269,8 @@ classdef SpikeReader < handle
             obj.fileVersionMajor = 0;
             obj.fileVersionMinor = 2;
             obj.fileSizeByteHeader = -1; % to be set in openFile
+            obj.isChunked = false; % to be set in openFile
+            obj.chunks = zeros(0,4); % to be set in openFile
             
             obj.grid3D = -1; % to be set in openFile
             
@@ -326,6 +348,88 @@ classdef SpikeReader < handle
             % store the size of the header section, so that we can skip it
             % when re-reading spikes
             obj.fileSizeByteHeader = ftell(obj.fileId);
+            
+            % version 0.3 stores spikes in compressed chunks
+            obj.isChunked = floor((version-obj.fileVersionMajor)*10.01)>=3;
+            if obj.isChunked
+                obj.readChunkTable();
+            end
+        end
+        
+        function readChunkTable(obj)
+            % SR.readChunkTable() reads the chunk index at the end of a
+            % chunked spike file. If the file has no index (because it is
+            % still being written), the chunk headers are read instead.
+            fseek(obj.fileId, 0, 'eof');
+            fileSize = ftell(obj.fileId);
+            indexSignature = 1480871497; % 'INDX'
+            
+            % footer: <index offset (int64), nr chunks, signature>
+            if fileSize >= obj.fileSizeByteHeader+16
+                fseek(obj.fileId, -16, 'eof');
+                idxOffset = fread(obj.fileId, 1, 'int64');
+                nrChunks = fread(obj.fileId, 1, 'int32');
+                sign = fread(obj.fileId, 1, 'int32');
+                if sign==indexSignature && nrChunks>=0 ...
+                        && idxOffset+20*nrChunks+16==fileSize
+                    % index entry: <offset (int64), first, last, nr spikes>
+                    obj.chunks = zeros(nrChunks,4);
+                    fseek(obj.fileId, idxOffset, 'bof');
+                    obj.chunks(:,1) = fread(obj.fileId, nrChunks, 'int64', 12);
+                    for i=2:4
+                        fseek(obj.fileId, idxOffset+4*i, 'bof');
+                        obj.chunks(:,i) = fread(obj.fileId, nrChunks, ...
+                            'int32', 16);
+                    end
+                    return
+                end
+            end
+            
+            % no index: follow the chunk headers, skipping a trailing chunk
+            % that is incomplete
+            obj.chunks = zeros(0,4);
+            offset = obj.fileSizeByteHeader;
+            while offset+16 <= fileSize
+                fseek(obj.fileId, offset, 'bof');
+                hdr = fread(obj.fileId, 4, 'int32');
+                if numel(hdr)<4 || hdr(4)<0 || offset+16+hdr(4)>fileSize
+                    break
+                end
+                obj.chunks(end+1,:) = [offset hdr(1:3)'];
+                offset = offset+16+hdr(4);
+            end
+        end
+        
+        function d = readChunk(obj, chunkId)
+            % d = SR.readChunk(chunkId) decodes all spikes of a chunk and
+            % returns them in AER format [times;nIDs].
+            d = zeros(2,0);
+            if chunkId > size(obj.chunks,1)
+                return
+            end
+            
+            % chunk header: <first time, last time, nr spikes, nr bytes>
+            fseek(obj.fileId, obj.chunks(chunkId,1), 'bof');
+            hdr = fread(obj.fileId, 4, 'int32');
+            bytes = fread(obj.fileId, [1 hdr(4)], 'uint8=>double');
+            if hdr(3)==0
+                return
+            end
+            
+            % decode variable-length integers: 7 bits per byte, least
+            % significant group first, last byte has the high bit unset
+            isLast = bytes<128;
+            grp = cumsum([1 isLast(1:end-1)]);
+            firstByte = find([true isLast(1:end-1)]);
+            shift = (1:numel(bytes)) - firstByte(grp);
+            vals = accumarray(grp', (mod(bytes,128).*128.^shift)')';
+            
+            % every spike stores the time difference and the zigzag-encoded
+            % neuron ID difference to the previous spike
+            dt = vals(1:2:end);
+            dn = vals(2:2:end);
+            dn = dn/2.*(mod(dn,2)==0) - (dn+1)/2.*(mod(dn,2)==1);
+            d = [hdr(1)+cumsum(dt); cumsum(dn)];
         end
         
         function throwError(obj, errorMsg, errorMode)
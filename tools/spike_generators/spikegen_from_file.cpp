@@ -48,21 +48,22 @@
 #include <spikegen_from_file.h>
 
 #include <carlsim.h>
+#include <spike_file_reader.h>	// SpikeFileReader
 //#include <user_errors.h>		// fancy user error messages
 
-#include <stdio.h>				// fopen, fread, fclose
+#include <stdio.h>				// printf
 #include <string.h>				// std::string
 #include <assert.h>				// assert
 
 // #define VERBOSE
 
-SpikeGeneratorFromFile::SpikeGeneratorFromFile(std::string fileName, int offsetTimeMs) {
+SpikeGeneratorFromFile::SpikeGeneratorFromFile(std::string fileName, int offsetTimeMs, bool streaming) {
 	fileName_ = fileName;
-	fpBegin_ = NULL;
+	reader_ = NULL;
 
 	nNeur_ = -1;
-	szByteHeader_ = -1;
 	offsetTimeMs_ = offsetTimeMs;
+	streaming_ = streaming;
 
 	// move unsafe operations out of constructor
 	openFile();
@@ -70,18 +71,18 @@ SpikeGeneratorFromFile::SpikeGeneratorFromFile(std::string fileName, int offsetT
 }
 
 SpikeGeneratorFromFile::~SpikeGeneratorFromFile() {
-	if (fpBegin_ != NULL) {
-		fclose(fpBegin_);
+	if (reader_ != NULL) {
+		delete reader_;
 	}
-	fpBegin_ = NULL;
+	reader_ = NULL;
 }
 
 void SpikeGeneratorFromFile::loadFile(std::string fileName, int offsetTimeMs) {
 	// close previously opened file (if any)
-	if (fpBegin_ != NULL) {
-		fclose(fpBegin_);
+	if (reader_ != NULL) {
+		delete reader_;
 	}
-	fpBegin_ = NULL;
+	reader_ = NULL;
 
 	// update file name and open
 	fileName_ = fileName;
@@ -94,6 +95,16 @@ void SpikeGeneratorFromFile::loadFile(std::string fileName, int offsetTimeMs) {
 void SpikeGeneratorFromFile::rewind(int offsetTimeMs) {
 	offsetTimeMs_ = offsetTimeMs;
 
+	if (streaming_) {
+		// move the cursor back to the first spike, the next time slice will be read anew
+		reader_->rewind();
+		sliceStart_ = -1;
+		sliceEnd_ = -1;
+		sliceSpikes_.assign(nNeur_, std::vector<int>());
+		sliceSpikesIdx_.assign(nNeur_, 0);
+		return;
+	}
+
 	// reset all iterators
 	spikesIt_.clear();
 	for (int i=0; i<nNeur_; i++) {
@@ -102,25 +113,11 @@ void SpikeGeneratorFromFile::rewind(int offsetTimeMs) {
 }
 
 void SpikeGeneratorFromFile::openFile() {
-	std::string funcName = "openFile("+fileName_+")";
-	fpBegin_ = fopen(fileName_.c_str(),"rb");
-	UserErrors::assertTrue(fpBegin_!=NULL, UserErrors::FILE_CANNOT_OPEN, funcName, fileName_);
-
-	// \TODO there should be a common/standard way to read spike files
-	// \FIXME: this is a hack...to get the size of the header section
-	// needs to be updated every time header changes
-	FILE* fp = fpBegin_;
-	szByteHeader_ = 4*sizeof(int)+1*sizeof(float);
-	fseek(fp, sizeof(int)+sizeof(float), SEEK_SET); // skipping signature+version
+	// reads the header section, the reader works with both spike file versions
+	reader_ = new SpikeFileReader(fileName_);
 
 	// get number of neurons from header
-	nNeur_ = 1;
-	int grid;
-	for (int i=1; i<=3; i++) {
-		size_t result = fread(&grid, sizeof(int), 1, fp);
-		UserErrors::assertTrue(result == 1, UserErrors::FILE_CANNOT_READ, funcName, fileName_);
-		nNeur_ *= grid;
-	}
+	nNeur_ = reader_->getNumNeurons();
 
 	// make sure number of neurons is now valid
 	assert(nNeur_>0);
@@ -129,31 +126,17 @@ void SpikeGeneratorFromFile::openFile() {
 void SpikeGeneratorFromFile::init() {
 	assert(nNeur_>0);
 
-	// allocate spike vector
-	// we organize AER format into a 2D spike vector: first dim=neuron, second dim=spike times
-	// then we just need to maintain an iterator for each neuron to know which spike to schedule next
-	spikes_.clear();
-	for (int i=0; i<nNeur_; i++) {
-		spikes_.push_back(std::vector<int>());
+	if (streaming_) {
+		// spikes are read one time slice at a time in nextSpikeTime
+		spikes_.clear();
+		rewind(offsetTimeMs_);
+		return;
 	}
 
 	// read spike file
-	FILE* fp = fpBegin_;
-	fseek(fp, szByteHeader_, SEEK_SET); // skip header section
-
-	std::string funcName = "readFile("+fileName_+")";
-	int tmpTime = -1;
-	int tmpNeurId = -1;
-	size_t result1, result2;
-
-	while (!feof(fp)) {
-		result1 = fread(&tmpTime, sizeof(int), 1, fp); // i-th time
-		//UserErrors::assertTrue(result == 1, UserErrors::FILE_CANNOT_READ, funcName, fileName_);
-		result2 = fread(&tmpNeurId, sizeof(int), 1, fp); // i-th nid
-		//UserErrors::assertTrue(result == 1, UserErrors::FILE_CANNOT_READ, funcName, fileName_);
-		if (result1 + result2 == 2) // validate the size of reading
-			spikes_[tmpNeurId].push_back(tmpTime); // add spike time to 2D vector
-	}
+	// we organize AER format into a 2D spike vector: first dim=neuron, second dim=spike times
+	// then we just need to maintain an iterator for each neuron to know which spike to schedule next
+	reader_->readSpikes(spikes_);
 
 #ifdef VERBOSE
 	for (int neurId=0; neurId<1; neurId++) {
@@ -173,6 +156,19 @@ int SpikeGeneratorFromFile::nextSpikeTime(CARLsim* sim, int grpId, int nid, int
 	assert(nNeur_>0);
 	assert(nid < nNeur_);
 
+	if (streaming_) {
+		// the first call of a new time slice advances the cursor through the spike file
+		if (currentTime != sliceStart_ || endOfTimeSlice != sliceEnd_) {
+			streamTimeSlice(currentTime, endOfTimeSlice);
+		}
+
+		// spikes of a neuron were queued in time order
+		if (sliceSpikesIdx_[nid] < sliceSpikes_[nid].size()) {
+			return sliceSpikes_[nid][sliceSpikesIdx_[nid]++];
+		}
+		return -1;
+	}
+
 	if (spikesIt_[nid] != spikes_[nid].end()) {
 		// if there are spikes left in the vector ...
 
@@ -194,3 +190,28 @@ int SpikeGeneratorFromFile::nextSpikeTime(CARLsim* sim, int grpId, int nid, int
 	// this will signal CARLsim to break the nextSpikeTime loop
 	return -1; // large positive number
 }
+
+// reads the spikes in [currentTime, endOfTimeSlice) from the spike file and queues them per neuron
+void SpikeGeneratorFromFile::streamTimeSlice(int currentTime, int endOfTimeSlice) {
+	for (int i=0; i<nNeur_; i++) {
+		sliceSpikes_[i].clear();
+		sliceSpikesIdx_[i] = 0;
+	}
+	sliceStart_ = currentTime;
+	sliceEnd_ = endOfTimeSlice;
+
+	streamTimes_.clear();
+	streamIds_.clear();
+	reader_->readNextSpikes(endOfTimeSlice-offsetTimeMs_, streamTimes_, streamIds_);
+
+	for (int i=0; i<streamTimes_.size(); i++) {
+		int spikeTime = streamTimes_[i]+offsetTimeMs_;
+		int nid = streamIds_[i];
+
+		// spikes before the time slice cannot be scheduled anymore
+		if (spikeTime < currentTime || nid < 0 || nid >= nNeur_)
+			continue;
+
+		sliceSpikes_[nid].push_back(spikeTime);
+	}
+}
@@ -54,6 +54,7 @@
 
 
 class CARLsim;
+class SpikeFileReader;
 
 /*!
  * \brief a SpikeGeneratorFromFile schedules spikes from a spike file binary
@@ -79,10 +80,18 @@ class CARLsim;
  * It is also possible to repeatedly parse the spike file, adding different offsetTimeMs offsets per loop.
  * This can be achieved by passing an optional argument to SpikeGeneratorFromFile::rewind.
  *
+ * Both spike file versions that a SpikeMonitor can write (flat and chunked, see CARLsim::setSpikeFileFormat) are
+ * supported. The file is read with a SpikeFileReader.
+ *
  * Upon initialization, the class parses and buffers all spikes from the spike file in a format that allows for
  * more efficient scheduling. Note that this might take up a lot of memory if you have a large and highly active
  * neuron group.
  *
+ * Alternatively, the spike file can be streamed (see constructor flag streaming). In this mode, the file is mapped
+ * into memory, and a cursor advances through it once per scheduling time slice: only the spikes that fall into the
+ * current time slice are decoded and handed to CARLsim. Because spike files are ordered by spike time, no per-neuron
+ * buffers of the whole recording are needed, and the memory footprint does not grow with the length of the file.
+ *
  * Usage example:
  * \code
  * // configure a CARLsim network
@@ -114,7 +123,7 @@ class CARLsim;
  * \note Make sure the new neuron group has the exact same number of neurons as the group that was used to record
  * the spike file.
  * \attention Upon initializiation, all spikes from the spike file will be buffered as vectors of ints, which might
- * take up a lot of memory if you have a large and highly active neuron group.
+ * take up a lot of memory if you have a large and highly active neuron group. Use streaming mode for long recordings.
  * \since v3.0
  */
 class SpikeGeneratorFromFile : public SpikeGenerator {
@@ -125,8 +134,11 @@ public:
 	 * \param[in] fileName file name of spike file (must be created from SpikeMonitor)
 	 * \param[in] offsetTimeMs optional offset (ms) that will be applied to all scheduled spike times. Can assume
 	 *                         both positive and negative values. Default: 0.
+	 * \param[in] streaming optional flag to stream the spike file one scheduling time slice at a time instead of
+	 *                      buffering all spikes upon initialization. Spikes that fall before the current time
+	 *                      slice (e.g., because of a small offset) are skipped. Default: false.
 	 */
-	SpikeGeneratorFromFile(std::string fileName, int offsetTimeMs=0);
+	SpikeGeneratorFromFile(std::string fileName, int offsetTimeMs=0, bool streaming=false);
 
 	//! SpikeGeneratorFromFile destructor
 	~SpikeGeneratorFromFile();
@@ -190,11 +202,10 @@ public:
 private:
 	void openFile();
 	void init();
+	void streamTimeSlice(int currentTime, int endOfTimeSlice);
 
 	std::string fileName_;		//!< file name
-	FILE* fpBegin_;				//!< pointer to beginning of file
-	int szByteHeader_;          //!< number of bytes in header section
-                                //!< \FIXME: there should be a standardized SpikeReader++ utility
+	SpikeFileReader* reader_;	//!< reader of the spike file, NULL if no file is open
 
 	//! A 2D vector of spike times, first dim=neuron ID, second dim=spike times.
 	//! This makes it easy to keep track of which spike needs to be scheduled next, by maintaining
@@ -206,6 +217,19 @@ private:
 
 	int nNeur_;                 //!< number of neurons in the group
 	int offsetTimeMs_;			//!< offset (ms) to add to every scheduled spike time
+
+	bool streaming_;			//!< whether to stream the file instead of buffering all spikes
+	int sliceStart_;			//!< streaming: start (ms) of the time slice whose spikes are in sliceSpikes_
+	int sliceEnd_;				//!< streaming: end (ms) of the time slice whose spikes are in sliceSpikes_
+
+	//! streaming: spike times of the current time slice, first dim=neuron ID, second dim=spike times
+	std::vector< std::vector<int> > sliceSpikes_;
+
+	//! streaming: position of the next spike to schedule in sliceSpikes_ (per neuron)
+	std::vector<int> sliceSpikesIdx_;
+
+	std::vector<int> streamTimes_;	//!< streaming: spike times read from the file in the current time slice
+	std::vector<int> streamIds_;	//!< streaming: neuron IDs read from the file in the current time slice
 };
 
 #endif
\ No newline at end of file